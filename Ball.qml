@@ -1,5 +1,6 @@
 import QtQuick 2.0
 import Box2D 2.0
+import LL.BBallSet 1.0
 import "shared"
 
 PhysicsItem {
@@ -9,6 +10,9 @@ PhysicsItem {
     property alias radius: circle.radius
     property alias color: circle.color
 
+    // C++ reads the position and radius from here, the ball leaves it when destroyed
+    Component.onCompleted: BallSet.addBall(ball)
+
     Rectangle{
         id: circle
 
@@ -1,4 +1,4 @@
-QT += quick
+QT += quick concurrent
 CONFIG += c++11 resources_big
 
 # The following define makes your compiler emit warnings if you use
@@ -29,6 +29,7 @@ SOURCES += main.cpp \
     GeoLib/C2DArc.cpp \
     GeoLib/C2DBaseSet.cpp \
     GeoLib/C2DCircle.cpp \
+    GeoLib/C2DFlatPolygon.cpp \
     GeoLib/C2DHoledPolyArc.cpp \
     GeoLib/C2DHoledPolyArcSet.cpp \
     GeoLib/C2DHoledPolyBase.cpp \
@@ -50,17 +51,25 @@ SOURCES += main.cpp \
     GeoLib/C2DPolygonSet.cpp \
     GeoLib/C2DRect.cpp \
     GeoLib/C2DRectSet.cpp \
+    GeoLib/C2DRectTree.cpp \
     GeoLib/C2DRoute.cpp \
     GeoLib/C2DSegment.cpp \
     GeoLib/C2DTriangle.cpp \
     GeoLib/C2DVector.cpp \
     GeoLib/C3DPoint.cpp \
+    GeoLib/GeoArena.cpp \
     GeoLib/Grid.cpp \
     GeoLib/IndexSet.cpp \
     GeoLib/Interval.cpp \
+    GeoLib/PlaneSweep.cpp \
+    GeoLib/PointWelder.cpp \
+    GeoLib/Predicates.cpp \
     GeoLib/RandomNumber.cpp \
+    GeoLib/SegmentSweep.cpp \
     GeoLib/TravellingSalesman.cpp \
-    qquickline.cpp
+    GeoLib/Triangulator.cpp \
+    qquickline.cpp \
+    qballset.cpp
 
 RESOURCES += qml.qrc
 
@@ -81,6 +90,7 @@ HEADERS += \
     GeoLib/C2DBase.h \
     GeoLib/C2DBaseSet.h \
     GeoLib/C2DCircle.h \
+    GeoLib/C2DFlatPolygon.h \
     GeoLib/C2DHoledPolyArc.h \
     GeoLib/C2DHoledPolyArcSet.h \
     GeoLib/C2DHoledPolyBase.h \
@@ -102,24 +112,32 @@ HEADERS += \
     GeoLib/C2DPolygonSet.h \
     GeoLib/C2DRect.h \
     GeoLib/C2DRectSet.h \
+    GeoLib/C2DRectTree.h \
     GeoLib/C2DRoute.h \
     GeoLib/C2DSegment.h \
     GeoLib/C2DTriangle.h \
     GeoLib/C2DVector.h \
     GeoLib/C3DPoint.h \
     GeoLib/Constants.h \
+    GeoLib/GeoArena.h \
     GeoLib/GeoLib.h \
     GeoLib/Grid.h \
     GeoLib/IndexSet.h \
     GeoLib/Interval.h \
     GeoLib/MemoryPool.h \
+    GeoLib/PlaneSweep.h \
+    GeoLib/PointWelder.h \
+    GeoLib/Predicates.h \
     GeoLib/RandomNumber.h \
     GeoLib/resource.h \
+    GeoLib/SegmentSweep.h \
     GeoLib/Sort.h \
     GeoLib/StdAfx.h \
     GeoLib/Transformation.h \
     GeoLib/TravellingSalesman.h \
-    qquickline.h
+    GeoLib/Triangulator.h \
+    qquickline.h \
+    qballset.h
 
 DISTFILES += \
     android/AndroidManifest.xml \
@@ -4,6 +4,7 @@ import QtQuick.Window 2.2
 import QtQuick.Layouts 1.3
 
 import LL.BPolygon 1.0
+import LL.BBallSet 1.0
 import Box2D 2.0
 
 
@@ -304,6 +305,11 @@ Item {
       World {
           id: physicsWorld
           gravity: "0.0,0.0"
+
+          onStepped: {
+              BallSet.endStep();
+              SLogic.checkLineOnStep(gameZone,progressBar);
+          }
       }
 
       LLSoundEffect {
@@ -347,8 +353,7 @@ Item {
           onPressed: {
               if(mouse.button == Qt.LeftButton){
                   tutorial.visible = false;
-                  SLogic.x1 = mouse.x;
-                  SLogic.y1 = mouse.y;
+                  SLogic.beginDrag(mouse.x,mouse.y);
                   SLogic.isMouseClicked = true;
               }
 
@@ -44,6 +44,7 @@ C2DArc::C2DArc(const C2DArc& Other) : C2DLineBase(ArcedLine)
 	m_dRadius = Other.GetRadius();
 	m_bCentreOnRight = Other.GetCentreOnRight();
 	m_bArcOnRight = Other.GetArcOnRight();
+	m_nAttributes = Other.GetAttributes();
 }
 
 
@@ -164,7 +165,7 @@ C2DArc::C2DArc
 void C2DArc::Grow(double dFactor, const C2DPoint& Origin)
 {
 	m_Line.Grow(dFactor,  Origin);
-	m_dRadius *= dFactor;
+	m_dRadius *= fabs(dFactor);
 	
 }
 
@@ -907,6 +908,10 @@ void C2DArc::GetSubLines(const C2DPointSet& PtsOnLine, C2DLineBaseSet& LineSet)
 		Line.Set( *TempPts.GetLast(), m_Line.GetPointTo() );
 		LineSet.Add(new C2DArc( Line,  m_dRadius, 
 								   Line.IsOnRight(ptCentre), m_bArcOnRight)  );
+
+		// The sub arcs are part of this so they keep its attributes.
+		for (unsigned int i = LineSet.size() - usPointsCount - 1; i < LineSet.size(); i++)
+			LineSet[i].SetAttributes(m_nAttributes);
 	}
 }
 
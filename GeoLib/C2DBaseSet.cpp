@@ -25,46 +25,339 @@ Declaration file for C2DBaseSet, a set of geometric entities of different types.
 #include "C2DTriangle.h"
 #include "C2DCircle.h"
 #include "C2DRoute.h"
+#include "C2DArc.h"
+#include "C2DRectSet.h"
+#include "C2DPointSet.h"
+#include "C2DLineBaseSetSet.h"
+#include "C2DPolyBase.h"
+#include "C2DPolygon.h"
+#include "C2DPolyArc.h"
+#include "C2DHoledPolyBase.h"
+#include "C2DHoledPolygon.h"
+#include "C2DHoledPolyArc.h"
+#include "C2DPolyBaseSet.h"
+#include "C2DPolygonSet.h"
+#include "C2DPolyArcSet.h"
+#include "C2DHoledPolyBaseSet.h"
+#include "C2DHoledPolygonSet.h"
+#include "C2DHoledPolyArcSet.h"
 #include "C2DBase.h"
 #include "Interval.h"
 #include "Sort.h"
+#include "GeoArena.h"
+#include <algorithm>
+#include <atomic>
 
 
 _MEMORY_POOL_IMPLEMENATION(C2DBaseSet)
 
 
+/// The items and the number of sets holding them. The items are deleted with the
+/// last set. Items added while an arena is installed may not outlive it so those
+/// are copied rather than shared.
+struct C2DBaseSetData
+{
+	C2DBaseSetData(void) : nRef(1), bArena(false) {}
+
+	C2DBaseData Items;
+	std::atomic<unsigned int> nRef;
+	bool bArena;
+};
+
+
+/// The data held by all empty sets until they are changed. Its own reference
+/// means it is never deleted.
+static C2DBaseSetData* GetSharedEmpty(void)
+{
+	static C2DBaseSetData SharedEmpty;
+	return &SharedEmpty;
+}
+
+
+/// Adds a set to those holding the data.
+static C2DBaseSetData* AddRef(void* pData)
+{
+	C2DBaseSetData* pSetData = static_cast<C2DBaseSetData*>(pData);
+	pSetData->nRef.fetch_add(1, std::memory_order_relaxed);
+	return pSetData;
+}
+
+
+/// Removes a set from those holding the data, deleting it and the items with the last.
+static void Release(void* pData)
+{
+	C2DBaseSetData* pSetData = static_cast<C2DBaseSetData*>(pData);
+	if (pSetData->nRef.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		for (unsigned int i = 0 ; i < pSetData->Items.size(); i++)
+		{
+			delete pSetData->Items[i];
+		}
+		delete pSetData;
+	}
+}
+
+
+/// Notes the items if they are being added in an arena or from a set noted already.
+static void NoteArena(void* pData, const void* pFrom = 0)
+{
+	if (CGeoArena::GetCurrent() != 0 ||
+		(pFrom != 0 && static_cast<const C2DBaseSetData*>(pFrom)->bArena))
+	{
+		static_cast<C2DBaseSetData*>(pData)->bArena = true;
+	}
+}
+
+
+/// Returns the data to hold in place of that given, shared unless in an arena.
+static C2DBaseSetData* Share(void* pData)
+{
+	C2DBaseSetData* pSetData = static_cast<C2DBaseSetData*>(pData);
+	if (!pSetData->bArena)
+		return AddRef(pSetData);
+
+	C2DBaseSetData* pCopy = new C2DBaseSetData;
+	pCopy->Items.reserve(pSetData->Items.size());
+
+	for (unsigned int i = 0 ; i < pSetData->Items.size(); i++)
+	{
+		const C2DBase* pItem = pSetData->Items[i];
+		pCopy->Items.push_back(pItem != 0 ? C2DBaseSet::CreateCopy(*pItem) : 0);
+	}
+	NoteArena(pCopy);
+
+	return pCopy;
+}
+
+
 /**--------------------------------------------------------------------------<BR>
 C2DBaseSet::C2DBaseSet
 \brief Constructor.
 <P>---------------------------------------------------------------------------*/
 C2DBaseSet::C2DBaseSet() : C2DBase( BaseSet)
 {
-	m_Data = new C2DBaseData;
+	m_Data = AddRef(GetSharedEmpty());
 
 	m_Type = C2DBase::BaseSet;
 }
 
 
+/**--------------------------------------------------------------------------<BR>
+C2DBaseSet::C2DBaseSet
+\brief Constructor. Shares the items of the other until either is changed.
+<P>---------------------------------------------------------------------------*/
+C2DBaseSet::C2DBaseSet(const C2DBaseSet& Other) : C2DBase( Other.GetType())
+{
+	m_Data = Share(Other.m_Data);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DBaseSet::C2DBaseSet
+\brief Constructor. Takes the items of the other leaving it empty.
+<P>---------------------------------------------------------------------------*/
+C2DBaseSet::C2DBaseSet(C2DBaseSet&& Other) : C2DBase( Other.GetType())
+{
+	m_Data = Other.m_Data;
+
+	Other.m_Data = AddRef(GetSharedEmpty());
+}
+
+
 /**--------------------------------------------------------------------------<BR>
 C2DBaseSet::~C2DBaseSet
 \brief Destructor.
 <P>---------------------------------------------------------------------------*/
 C2DBaseSet::~C2DBaseSet()
 {
-	DeleteAll();
+	Release(m_Data);
+
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DBaseSet::operator=
+\brief Assignment. Shares the items of the other until either is changed.
+<P>---------------------------------------------------------------------------*/
+const C2DBaseSet& C2DBaseSet::operator=(const C2DBaseSet& Other)
+{
+	if (m_Data != Other.m_Data)
+	{
+		void* pOld = m_Data;
+		m_Data = Share(Other.m_Data);
+		Release(pOld);
+	}
+
+	return *this;
+}
 
-	delete reinterpret_cast<C2DBaseData*>(m_Data);
 
+/**--------------------------------------------------------------------------<BR>
+C2DBaseSet::operator=
+\brief Assignment. Takes the items of the other leaving it empty.
+<P>---------------------------------------------------------------------------*/
+const C2DBaseSet& C2DBaseSet::operator=(C2DBaseSet&& Other)
+{
+	if (this != &Other)
+	{
+		Swap(Other);
+		Other.DeleteAll();
+	}
+
+	return *this;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DBaseSet::Swap
+\brief Swaps the items with those of the other.
+<P>---------------------------------------------------------------------------*/
+void C2DBaseSet::Swap(C2DBaseSet& Other)
+{
+	void* pTemp = m_Data;
+	m_Data = Other.m_Data;
+	Other.m_Data = pTemp;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DBaseSet::IsShared
+\brief True if the items are shared with another set.
+<P>---------------------------------------------------------------------------*/
+bool C2DBaseSet::IsShared(void) const
+{
+	return static_cast<C2DBaseSetData*>(m_Data)->nRef.load(std::memory_order_acquire) != 1;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DBaseSet::Detach
+\brief Copies the items if they are shared so they belong to this set alone.
+<P>---------------------------------------------------------------------------*/
+void C2DBaseSet::Detach(void)
+{
+	if (!IsShared())
+		return;
+
+	const C2DBaseData& Items = static_cast<C2DBaseSetData*>(m_Data)->Items;
+
+	C2DBaseSetData* pCopy = new C2DBaseSetData;
+	pCopy->Items.reserve(Items.size());
+
+	for (unsigned int i = 0 ; i < Items.size(); i++)
+	{
+		pCopy->Items.push_back(Items[i] != 0 ? CreateCopy(*Items[i]) : 0);
+	}
+	NoteArena(pCopy);
+
+	Release(m_Data);
+	m_Data = pCopy;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DBaseSet::GetData
+\brief Returns the items to read.
+<P>---------------------------------------------------------------------------*/
+const C2DBaseData& C2DBaseSet::GetData(void) const
+{
+	return static_cast<C2DBaseSetData*>(m_Data)->Items;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DBaseSet::GetData
+\brief Returns the items to change, copying them first if shared.
+<P>---------------------------------------------------------------------------*/
+C2DBaseData& C2DBaseSet::GetData(void)
+{
+	Detach();
+
+	return static_cast<C2DBaseSetData*>(m_Data)->Items;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DBaseSet::CreateCopy
+\brief Returns a new copy of the item of whatever type it is.
+<P>---------------------------------------------------------------------------*/
+C2DBase* C2DBaseSet::CreateCopy(const C2DBase& Item)
+{
+	switch (Item.GetType())
+	{
+	case Point:
+		return new C2DPoint(dynamic_cast<const C2DPoint&>(Item));
+	case StraightLine:
+		return new C2DLine(dynamic_cast<const C2DLine&>(Item));
+	case ArcedLine:
+		return new C2DArc(dynamic_cast<const C2DArc&>(Item));
+	case PolyBase:
+		return new C2DPolyBase(dynamic_cast<const C2DPolyBase&>(Item));
+	case PolyHoledBase:
+		return new C2DHoledPolyBase(dynamic_cast<const C2DHoledPolyBase&>(Item));
+	case PolyLine:
+		return new C2DPolygon(dynamic_cast<const C2DPolygon&>(Item));
+	case PolyLineHoled:
+		return new C2DHoledPolygon(dynamic_cast<const C2DHoledPolygon&>(Item));
+	case PolyArc:
+		return new C2DPolyArc(dynamic_cast<const C2DPolyArc&>(Item));
+	case PolyArcHoled:
+		return new C2DHoledPolyArc(dynamic_cast<const C2DHoledPolyArc&>(Item));
+	case Route:
+		return new C2DRoute(dynamic_cast<const C2DRoute&>(Item));
+	case Circle:
+		return new C2DCircle(dynamic_cast<const C2DCircle&>(Item));
+	case Segment:
+		return new C2DSegment(dynamic_cast<const C2DSegment&>(Item));
+	case Rect:
+		return new C2DRect(dynamic_cast<const C2DRect&>(Item));
+	case Triangle:
+		return new C2DTriangle(dynamic_cast<const C2DTriangle&>(Item));
+	case BaseSet:
+		return new C2DBaseSet(dynamic_cast<const C2DBaseSet&>(Item));
+	case LineBaseSet:
+		return new C2DLineBaseSet(dynamic_cast<const C2DLineBaseSet&>(Item));
+	case LineBaseSetSet:
+		return new C2DLineBaseSetSet(dynamic_cast<const C2DLineBaseSetSet&>(Item));
+	case PointSet:
+		return new C2DPointSet(dynamic_cast<const C2DPointSet&>(Item));
+	case StraightLineSet:
+		return new C2DLineSet(dynamic_cast<const C2DLineSet&>(Item));
+	case PolyBaseSet:
+		return new C2DPolyBaseSet(dynamic_cast<const C2DPolyBaseSet&>(Item));
+	case PolyHoledBaseSet:
+		return new C2DHoledPolyBaseSet(dynamic_cast<const C2DHoledPolyBaseSet&>(Item));
+	case PolyLineSet:
+		return new C2DPolygonSet(dynamic_cast<const C2DPolygonSet&>(Item));
+	case PolyLineHoledSet:
+		return new C2DHoledPolygonSet(dynamic_cast<const C2DHoledPolygonSet&>(Item));
+	case PolyArcSet:
+		return new C2DPolyArcSet(dynamic_cast<const C2DPolyArcSet&>(Item));
+	case PolyArcHoledSet:
+		return new C2DHoledPolyArcSet(dynamic_cast<const C2DHoledPolyArcSet&>(Item));
+	case RectSet:
+		return new C2DRectSet(dynamic_cast<const C2DRectSet&>(Item));
+	default:
+		assert(0);
+		return 0;
+	}
 }
 
 
 /**--------------------------------------------------------------------------<BR>
 C2DBaseSet::DeleteAll
-\brief Deletes all.
+\brief Deletes all. Items shared with another set are left to it.
 <P>---------------------------------------------------------------------------*/
 void C2DBaseSet::DeleteAll(void)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	if (IsShared())
+	{
+		Release(m_Data);
+		m_Data = AddRef(GetSharedEmpty());
+		return;
+	}
+
+	C2DBaseData& Data = GetData();
 
 	for (unsigned int i = 0 ; i < Data.size(); i++)
 	{
@@ -76,7 +369,14 @@ void C2DBaseSet::DeleteAll(void)
 
 void C2DBaseSet::RemoveAll(void)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	if (IsShared())
+	{
+		Release(m_Data);
+		m_Data = AddRef(GetSharedEmpty());
+		return;
+	}
+
+	C2DBaseData& Data = GetData();
 
 	Data.clear();
 }
@@ -88,7 +388,8 @@ C2DBaseSet::Add
 <P>---------------------------------------------------------------------------*/
 void C2DBaseSet::Add(C2DBase* NewItem)
 {
-	(reinterpret_cast<C2DBaseData*>(m_Data))->push_back(NewItem);
+	GetData().push_back(NewItem);
+	NoteArena(m_Data);
 }
 
 
@@ -99,7 +400,8 @@ C2DBaseSet::DeleteAndSet
 <P>---------------------------------------------------------------------------*/
 void C2DBaseSet::DeleteAndSet(int nIndx, C2DBase* NewItem)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
+	NoteArena(m_Data);
 
 	C2DBase* pDel = Data[nIndx];
 
@@ -114,7 +416,8 @@ C2DBaseSet::ExtractAndSet
 <P>---------------------------------------------------------------------------*/
 C2DBase* C2DBaseSet::ExtractAndSet(int nIndx, C2DBase* NewItem)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
+	NoteArena(m_Data);
 
 	C2DBase* pEx = Data[nIndx];
 
@@ -129,7 +432,7 @@ C2DBaseSet::size
 <P>---------------------------------------------------------------------------*/
 unsigned int C2DBaseSet::size(void) const
 {
-	return (reinterpret_cast<C2DBaseData*>(m_Data))->size();
+	return GetData().size();
 
 }
 
@@ -139,7 +442,7 @@ C2DBaseSet::GetAt
 <P>---------------------------------------------------------------------------*/
 C2DBase* C2DBaseSet::GetAt(int nIndx)
 {
-	return (*reinterpret_cast<C2DBaseData*>(m_Data))[nIndx];
+	return GetData()[nIndx];
 
 }
 
@@ -150,7 +453,7 @@ C2DBaseSet::GetAt
 const C2DBase* C2DBaseSet::GetAt(int nIndx) const
 {
 
-	return (*reinterpret_cast<C2DBaseData*>(m_Data))[nIndx];
+	return GetData()[nIndx];
 }
 
 /**--------------------------------------------------------------------------<BR>
@@ -159,7 +462,7 @@ C2DBaseSet::operator[]
 <P>---------------------------------------------------------------------------*/
 C2DBase& C2DBaseSet::operator[] (int nIndx)
 {
-	return *(*reinterpret_cast<C2DBaseData*>(m_Data))[nIndx];
+	return *GetData()[nIndx];
 }
 
 /**--------------------------------------------------------------------------<BR>
@@ -168,7 +471,7 @@ C2DBaseSet::operator[]
 <P>---------------------------------------------------------------------------*/
 const C2DBase& C2DBaseSet::operator[] (int nIndx) const
 {
-	return *(*reinterpret_cast<C2DBaseData*>(m_Data))[nIndx];
+	return *GetData()[nIndx];
 }
 
 
@@ -178,7 +481,7 @@ C2DBaseSet::GetLast
 <P>---------------------------------------------------------------------------*/
 C2DBase* C2DBaseSet::GetLast(void)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
 
 	unsigned int n = Data.size();
 
@@ -195,7 +498,7 @@ C2DBaseSet::DeleteAt
 <P>---------------------------------------------------------------------------*/
 void C2DBaseSet::DeleteAt(unsigned int nIndx)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
 
 	C2DBase* pItem = Data[nIndx];
 	if (pItem != 0)
@@ -205,13 +508,30 @@ void C2DBaseSet::DeleteAt(unsigned int nIndx)
 
 }
 
+/**--------------------------------------------------------------------------<BR>
+C2DBaseSet::DeleteRange
+\brief Deletes the run of items starting at the index, closing the gap once.
+<P>---------------------------------------------------------------------------*/
+void C2DBaseSet::DeleteRange(unsigned int nIndx, unsigned int nCount)
+{
+	C2DBaseData& Data = GetData();
+
+	for (unsigned int i = nIndx; i < nIndx + nCount; i++)
+	{
+		if (Data[i] != 0)
+			delete Data[i];
+	}
+
+	Data.erase(Data.begin() + nIndx, Data.begin() + nIndx + nCount);
+}
+
 /**--------------------------------------------------------------------------<BR>
 C2DBaseSet::DeleteLast
 \brief Deletion of the last.
 <P>---------------------------------------------------------------------------*/
 void C2DBaseSet::DeleteLast(void)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
 
 	unsigned int n = Data.size();
 
@@ -233,7 +553,7 @@ C2DBaseSet::ExtractAt
 <P>---------------------------------------------------------------------------*/
 C2DBase* C2DBaseSet::ExtractAt(unsigned int nIndx)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
 
 	C2DBase* Result = Data[nIndx];
 	Data.erase( Data.begin() + nIndx);
@@ -247,7 +567,7 @@ C2DBaseSet::ExtractLast
 <P>---------------------------------------------------------------------------*/
 C2DBase* C2DBaseSet::ExtractLast(void)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
 
 	C2DBase* Result = Data.back();
 	Data.pop_back();
@@ -261,7 +581,8 @@ C2DBaseSet::InsertAt
 <P>---------------------------------------------------------------------------*/
 void C2DBaseSet::InsertAt(unsigned int nIndx, C2DBase* NewItem)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
+	NoteArena(m_Data);
 
 	if (NewItem != 0)
 	{
@@ -271,14 +592,18 @@ void C2DBaseSet::InsertAt(unsigned int nIndx, C2DBase* NewItem)
 
 /**--------------------------------------------------------------------------<BR>
 C2DBaseSet::InsertAt
-\brief Inserts the pointer.
+\brief Inserts the pointers of the other in one go, leaving the other empty.
 <P>---------------------------------------------------------------------------*/
 void C2DBaseSet::InsertAt(unsigned int nIndx, C2DBaseSet& Other)
 {
-	while (Other.size() > 0)
-	{
-		InsertAt(nIndx, Other.ExtractLast());
-	}
+	C2DBaseData& Data = GetData();
+	C2DBaseData& OtherData = Other.GetData();
+	NoteArena(m_Data, Other.m_Data);
+
+	OtherData.erase(std::remove(OtherData.begin(), OtherData.end(), (C2DBase*)0), OtherData.end());
+
+	Data.insert(Data.begin() + nIndx, OtherData.begin(), OtherData.end());
+	OtherData.clear();
 }
 
 /**--------------------------------------------------------------------------<BR>
@@ -287,7 +612,7 @@ C2DBaseSet::ReverseOrder
 <P>---------------------------------------------------------------------------*/
 void C2DBaseSet::ReverseOrder(void)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
 
 	C2DBase* Temp;
 	unsigned int nCount = Data.size(); 
@@ -306,7 +631,9 @@ C2DBaseSet::operator<<
 <P>---------------------------------------------------------------------------*/
 void C2DBaseSet::operator<<(C2DBaseSet& Other)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
+	Other.Detach();
+	NoteArena(m_Data, Other.m_Data);
 
 	C2DBaseData Temp;
 	while (Other.size() > 0)
@@ -424,7 +751,7 @@ C2DBaseSet::SortByDistance
 <P>---------------------------------------------------------------------------*/
 void C2DBaseSet::SortByDistance(const C2DPoint& pt,  bool bAscending)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
 
 
 	std::vector<double> dDists;
@@ -434,7 +761,7 @@ void C2DBaseSet::SortByDistance(const C2DPoint& pt,  bool bAscending)
 		dDists.push_back( GetAt(i)->Distance(pt));
 	}
 
-	GeoSort::PQuickSort<std::vector<double>, double, C2DBaseData, C2DBase*>(dDists, Data);
+	GeoSort::RadixSort(dDists, Data);
 
 	if (! bAscending)
 		ReverseOrder();
@@ -11,6 +11,16 @@ any modified versions of this cannot be resold to any other party.
 
 Declaration file for C2DBaseSet, a set of geometric entities of different types.
 
+Copies of a set share the items until one of them is changed, when that one
+copies the items for itself. The items are only changed through the non const
+functions so those held by a const set, or through a const pointer, are safe to
+read however many sets share them.
+
+Any non const function copies shared items, including GetAt, operator[] and GetLast,
+so only read through a const set. A pointer or reference to an item is only good
+until the set it came from is changed: if the items were shared it is then left
+pointing at those of the other sets, which go with the last of them.
+
 \class C2DBaseSet.
 \brief A set of geometric entities of different types held as pointers to a base
 class geometric entity.
@@ -24,6 +34,8 @@ class geometric entity.
 
 #include "C2DBase.h"
 #include "MemoryPool.h"
+#include <vector>
+#include <utility>
 
 
 class C2DBase;
@@ -48,8 +60,24 @@ public:
 	_MEMORY_POOL_DECLARATION
 	/// Constructor
 	C2DBaseSet();
-	/// Constructor
+	/// Constructor. Shares the items of the other until either is changed.
+	C2DBaseSet(const C2DBaseSet& Other);
+	/// Constructor. Takes the items of the other leaving it empty.
+	C2DBaseSet(C2DBaseSet&& Other);
+	/// Destructor
 	~C2DBaseSet();
+	/// Assignment. Shares the items of the other until either is changed.
+	const C2DBaseSet& operator=(const C2DBaseSet& Other);
+	/// Assignment. Takes the items of the other leaving it empty.
+	const C2DBaseSet& operator=(C2DBaseSet&& Other);
+	/// Swaps the items with those of the other.
+	void Swap(C2DBaseSet& Other);
+	/// True if the items are shared with another set.
+	bool IsShared(void) const;
+	/// Copies the items if they are shared so they belong to this set alone.
+	void Detach(void);
+	/// Returns a new copy of the item of whatever type it is.
+	static C2DBase* CreateCopy(const C2DBase& Item);
 	/// Deletes all the pointers and removes them.
 	void DeleteAll(void);
 	/// Removes all the pointers DOES NOT DELETE.
@@ -75,6 +103,8 @@ public:
 	C2DBase* GetLast(void);
 	/// Deletion
 	void DeleteAt(unsigned int nIndx);
+	/// Deletion of the run of items starting at the index.
+	void DeleteRange(unsigned int nIndx, unsigned int nCount);
 	/// Deletion of the last
 	void DeleteLast(void);
 	/// Extracts the pointer passing deletion responsibility over.
@@ -116,8 +146,11 @@ public:
 	void Project(const C2DVector& Vector, CInterval& Interval) const;
 
 protected:
-
-	/// This is a pointer to the data which is defined is the constructor.
+	/// Returns the items to read.
+	const std::vector<C2DBase*>& GetData(void) const;
+	/// Returns the items to change, copying them first if shared.
+	std::vector<C2DBase*>& GetData(void);
+	/// This is a pointer to the shared data which is defined is the constructor.
 	void* m_Data;
 };
 
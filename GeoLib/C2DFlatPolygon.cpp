@@ -0,0 +1,659 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file C2DFlatPolygon.cpp
+\brief Implementation file for the C2DFlatPolygon Class
+
+Implementation file for C2DFlatPolygon, a straight edged polygon held in
+contiguous arrays.
+<P>---------------------------------------------------------------------------*/
+
+
+#include "StdAfx.h"
+#include "C2DFlatPolygon.h"
+#include "C2DPolygon.h"
+#include "C2DPointSet.h"
+#include "C2DLine.h"
+#include "C2DVector.h"
+#include "C2DHoledPolygonSet.h"
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::C2DFlatPolygon <BR>
+\brief Constructor.
+<P>---------------------------------------------------------------------------*/
+C2DFlatPolygon::C2DFlatPolygon(void)
+{
+	Clear();
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::C2DFlatPolygon <BR>
+\brief Constructor.
+<P>---------------------------------------------------------------------------*/
+C2DFlatPolygon::C2DFlatPolygon(const C2DPolygon& Polygon)
+{
+	Create(Polygon);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::~C2DFlatPolygon <BR>
+\brief Destructor.
+<P>---------------------------------------------------------------------------*/
+C2DFlatPolygon::~C2DFlatPolygon(void)
+{
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::Clear <BR>
+\brief Clears all.
+<P>---------------------------------------------------------------------------*/
+void C2DFlatPolygon::Clear(void)
+{
+	m_X.clear();
+	m_Y.clear();
+	m_EdgeRects.clear();
+
+	m_dMinX = 0;
+	m_dMinY = 0;
+	m_dMaxX = 0;
+	m_dMaxY = 0;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::Create <BR>
+\brief Creates from the polygon given, made clockwise if it is not already.
+<P>---------------------------------------------------------------------------*/
+bool C2DFlatPolygon::Create(const C2DPolygon& Polygon)
+{
+	Clear();
+
+	unsigned int nCount = Polygon.GetPointsCount();
+
+	if (nCount < 3)
+		return false;
+
+	m_X.resize(nCount);
+	m_Y.resize(nCount);
+
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		const C2DPoint* pPoint = Polygon.GetPoint(i);
+		if (pPoint == 0)
+		{
+			Clear();
+			return false;
+		}
+		m_X[i] = pPoint->x;
+		m_Y[i] = pPoint->y;
+	}
+
+	MakeClockwise();
+
+	MakeRects();
+
+	return true;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::Create <BR>
+\brief Creates from separate arrays of x and y coordinates.
+<P>---------------------------------------------------------------------------*/
+bool C2DFlatPolygon::Create(const double* pX, const double* pY, unsigned int nNumber)
+{
+	Clear();
+
+	if (nNumber < 3)
+		return false;
+
+	m_X.assign(pX, pX + nNumber);
+	m_Y.assign(pY, pY + nNumber);
+
+	MakeClockwise();
+
+	MakeRects();
+
+	return true;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::Create <BR>
+\brief Creates from an array of x, y pairs of nNumber points.
+<P>---------------------------------------------------------------------------*/
+bool C2DFlatPolygon::Create(const double* pPoint, unsigned int nNumber)
+{
+	Clear();
+
+	if (nNumber < 3)
+		return false;
+
+	m_X.resize(nNumber);
+	m_Y.resize(nNumber);
+
+	for (unsigned int i = 0; i < nNumber; i++)
+	{
+		m_X[i] = pPoint[i * 2];
+		m_Y[i] = pPoint[i * 2 + 1];
+	}
+
+	MakeClockwise();
+
+	MakeRects();
+
+	return true;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::GetPolygon <BR>
+\brief Creates the polygon given from this.
+<P>---------------------------------------------------------------------------*/
+void C2DFlatPolygon::GetPolygon(C2DPolygon& Polygon) const
+{
+	unsigned int nCount = m_X.size();
+
+	std::vector<double> Points(nCount * 2);
+
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		Points[i * 2] = m_X[i];
+		Points[i * 2 + 1] = m_Y[i];
+	}
+
+	if (nCount == 0)
+		Polygon.Clear();
+	else
+		Polygon.Create(&Points[0], nCount);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::GetPoint <BR>
+\brief Returns the point specified by the index. Cyclic.
+<P>---------------------------------------------------------------------------*/
+C2DPoint C2DFlatPolygon::GetPoint(unsigned int nPointIndex) const
+{
+	if (m_X.empty())
+		return C2DPoint(0, 0);
+
+	nPointIndex %= m_X.size();
+
+	return C2DPoint(m_X[nPointIndex], m_Y[nPointIndex]);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::GetBoundingRect <BR>
+\brief Returns the bounding rectangle.
+<P>---------------------------------------------------------------------------*/
+void C2DFlatPolygon::GetBoundingRect(C2DRect& Rect) const
+{
+	Rect.Set(m_dMinX, m_dMaxY, m_dMaxX, m_dMinY);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::Contains <BR>
+\brief True if the point is inside. Uses the crossing number of a horizontal ray
+to the right. A point on an edge is inside.
+<P>---------------------------------------------------------------------------*/
+bool C2DFlatPolygon::Contains(const C2DPoint& pt) const
+{
+	if (pt.x < m_dMinX || pt.x > m_dMaxX || pt.y < m_dMinY || pt.y > m_dMaxY)
+		return false;
+
+	unsigned int nCount = m_X.size();
+
+	bool bInside = false;
+
+	for (unsigned int i = 0, j = nCount - 1; i < nCount; j = i++)
+	{
+		const double* pRect = &m_EdgeRects[j * 4];
+
+		if (pt.y < pRect[1] || pt.y > pRect[3] || pt.x > pRect[2])
+			continue;
+
+		double dx1 = m_X[j] - pt.x;
+		double dy1 = m_Y[j] - pt.y;
+		double dx2 = m_X[i] - pt.x;
+		double dy2 = m_Y[i] - pt.y;
+
+		double dCross = dx1 * dy2 - dx2 * dy1;
+
+		// On the edge.
+		if (dCross == 0 && pt.x >= pRect[0])
+			return true;
+
+		if ((dy1 > 0) != (dy2 > 0))
+		{
+			// The edge crosses the ray if the point is on the side the edge is heading to.
+			if ((dCross > 0) == (dy2 > dy1))
+				bInside = !bInside;
+		}
+	}
+
+	return bInside;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::Crosses <BR>
+\brief True if the line crosses any edge.
+<P>---------------------------------------------------------------------------*/
+bool C2DFlatPolygon::Crosses(const C2DLine& Line) const
+{
+	return Crosses(Line, 0);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::Crosses <BR>
+\brief True if the line crosses any edge. Adds the intersection points if a set is
+given. Each edge and the line are treated as the point set [a,b) as in C2DLine.
+<P>---------------------------------------------------------------------------*/
+bool C2DFlatPolygon::Crosses(const C2DLine& Line, C2DPointSet* IntersectionPts) const
+{
+	double x1 = Line.point.x;
+	double y1 = Line.point.y;
+	double x2 = x1 + Line.vector.i;
+	double y2 = y1 + Line.vector.j;
+
+	double dMinX = x1 < x2 ? x1 : x2;
+	double dMaxX = x1 < x2 ? x2 : x1;
+	double dMinY = y1 < y2 ? y1 : y2;
+	double dMaxY = y1 < y2 ? y2 : y1;
+
+	if (dMaxX < m_dMinX || dMinX > m_dMaxX || dMaxY < m_dMinY || dMinY > m_dMaxY)
+		return false;
+
+	unsigned int nCount = m_X.size();
+
+	bool bResult = false;
+
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		const double* pRect = &m_EdgeRects[i * 4];
+
+		if (dMaxX < pRect[0] || dMinX > pRect[2] || dMaxY < pRect[1] || dMinY > pRect[3])
+			continue;
+
+		unsigned int nNext = (i + 1 == nCount) ? 0 : i + 1;
+
+		double x3 = m_X[i];
+		double y3 = m_Y[i];
+		double x4 = m_X[nNext];
+		double y4 = m_Y[nNext];
+
+		double dDenominator = (y4 - y3) * (x2 - x1) - (x4 - x3) * (y2 - y1);
+
+		if (dDenominator == 0)
+			continue;
+
+		double Ua = ((x4 - x3) * (y1 - y3) - (y4 - y3) * (x1 - x3)) / dDenominator;
+		double Ub = ((x2 - x1) * (y1 - y3) - (y2 - y1) * (x1 - x3)) / dDenominator;
+
+		if (Ua >= 0 && Ua < 1 && Ub >= 0 && Ub < 1)
+		{
+			bResult = true;
+
+			if (IntersectionPts == 0)
+				return true;
+
+			IntersectionPts->AddCopy(C2DPoint(x1 + Ua * (x2 - x1), y1 + Ua * (y2 - y1)));
+		}
+	}
+
+	return bResult;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::GetArea <BR>
+\brief Returns the area.
+<P>---------------------------------------------------------------------------*/
+double C2DFlatPolygon::GetArea(void) const
+{
+	return fabs(GetAreaSigned());
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::GetAreaSigned <BR>
+\brief Returns the area signed (-ve if clockwise).
+<P>---------------------------------------------------------------------------*/
+double C2DFlatPolygon::GetAreaSigned(void) const
+{
+	unsigned int nCount = m_X.size();
+
+	double dArea = 0;
+
+	for (unsigned int i = 0, j = nCount - 1; i < nCount; j = i++)
+	{
+		dArea += m_X[j] * m_Y[i] - m_X[i] * m_Y[j];
+	}
+
+	return dArea / 2.0;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::GetPerimeter <BR>
+\brief Returns the perimeter.
+<P>---------------------------------------------------------------------------*/
+double C2DFlatPolygon::GetPerimeter(void) const
+{
+	unsigned int nCount = m_X.size();
+
+	double dPerimeter = 0;
+
+	for (unsigned int i = 0, j = nCount - 1; i < nCount; j = i++)
+	{
+		double dx = m_X[i] - m_X[j];
+		double dy = m_Y[i] - m_Y[j];
+		dPerimeter += sqrt(dx * dx + dy * dy);
+	}
+
+	return dPerimeter;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::Distance <BR>
+\brief Returns the distance to the point, negative if inside. Edges whose bounding
+rectangle is further than the closest found so far are skipped.
+<P>---------------------------------------------------------------------------*/
+double C2DFlatPolygon::Distance(const C2DPoint& pt) const
+{
+	unsigned int nCount = m_X.size();
+
+	if (nCount == 0)
+		return 0;
+
+	double dMin = EdgeDistanceSquared(0, pt.x, pt.y);
+
+	for (unsigned int i = 1; i < nCount; i++)
+	{
+		const double* pRect = &m_EdgeRects[i * 4];
+
+		double dx = pt.x < pRect[0] ? pRect[0] - pt.x : (pt.x > pRect[2] ? pt.x - pRect[2] : 0);
+		double dy = pt.y < pRect[1] ? pRect[1] - pt.y : (pt.y > pRect[3] ? pt.y - pRect[3] : 0);
+
+		if (dx * dx + dy * dy >= dMin)
+			continue;
+
+		double dDist = EdgeDistanceSquared(i, pt.x, pt.y);
+		if (dDist < dMin)
+			dMin = dDist;
+	}
+
+	dMin = sqrt(dMin);
+
+	if (Contains(pt))
+		return -dMin;
+	else
+		return dMin;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::Distance <BR>
+\brief Returns the distance to the line, 0 if it crosses and negative if it is
+inside.
+<P>---------------------------------------------------------------------------*/
+double C2DFlatPolygon::Distance(const C2DLine& Line) const
+{
+	unsigned int nCount = m_X.size();
+
+	if (nCount == 0)
+		return 0;
+
+	double x1 = Line.point.x;
+	double y1 = Line.point.y;
+	double x2 = x1 + Line.vector.i;
+	double y2 = y1 + Line.vector.j;
+
+	double dLineMinX = x1 < x2 ? x1 : x2;
+	double dLineMaxX = x1 < x2 ? x2 : x1;
+	double dLineMinY = y1 < y2 ? y1 : y2;
+	double dLineMaxY = y1 < y2 ? y2 : y1;
+
+	double dLineLength2 = Line.vector.i * Line.vector.i + Line.vector.j * Line.vector.j;
+
+	double dMin = -1;
+
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		const double* pRect = &m_EdgeRects[i * 4];
+
+		double dx = dLineMaxX < pRect[0] ? pRect[0] - dLineMaxX : (dLineMinX > pRect[2] ? dLineMinX - pRect[2] : 0);
+		double dy = dLineMaxY < pRect[1] ? pRect[1] - dLineMaxY : (dLineMinY > pRect[3] ? dLineMinY - pRect[3] : 0);
+
+		if (dMin >= 0 && dx * dx + dy * dy >= dMin)
+			continue;
+
+		unsigned int nNext = (i + 1 == nCount) ? 0 : i + 1;
+
+		double x3 = m_X[i];
+		double y3 = m_Y[i];
+		double x4 = m_X[nNext];
+		double y4 = m_Y[nNext];
+
+		// The sides each segment's ends are on relative to the other.
+		double d1 = (x2 - x1) * (y3 - y1) - (y2 - y1) * (x3 - x1);
+		double d2 = (x2 - x1) * (y4 - y1) - (y2 - y1) * (x4 - x1);
+		double d3 = (x4 - x3) * (y1 - y3) - (y4 - y3) * (x1 - x3);
+		double d4 = (x4 - x3) * (y2 - y3) - (y4 - y3) * (x2 - x3);
+
+		if (((d1 <= 0 && d2 >= 0) || (d1 >= 0 && d2 <= 0)) &&
+			((d3 <= 0 && d4 >= 0) || (d3 >= 0 && d4 <= 0)) &&
+			!(d1 == 0 && d2 == 0))
+		{
+			return 0;
+		}
+
+		double dDist = EdgeDistanceSquared(i, x1, y1);
+		double dTest = EdgeDistanceSquared(i, x2, y2);
+		if (dTest < dDist)
+			dDist = dTest;
+
+		// Distances from the edge ends to the line.
+		double pEnds[4] = {x3, y3, x4, y4};
+		for (unsigned int e = 0; e < 4; e += 2)
+		{
+			double dProj = dLineLength2 == 0 ? 0 :
+				((pEnds[e] - x1) * (x2 - x1) + (pEnds[e + 1] - y1) * (y2 - y1)) / dLineLength2;
+			if (dProj < 0) dProj = 0;
+			if (dProj > 1) dProj = 1;
+			double dex = pEnds[e] - (x1 + dProj * (x2 - x1));
+			double dey = pEnds[e + 1] - (y1 + dProj * (y2 - y1));
+			dTest = dex * dex + dey * dey;
+			if (dTest < dDist)
+				dDist = dTest;
+		}
+
+		if (dMin < 0 || dDist < dMin)
+			dMin = dDist;
+	}
+
+	dMin = sqrt(dMin);
+
+	if (Contains(Line.point))
+		return -dMin;
+	else
+		return dMin;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::Move <BR>
+\brief Moves the polygon.
+<P>---------------------------------------------------------------------------*/
+void C2DFlatPolygon::Move(const C2DVector& Vector)
+{
+	unsigned int nCount = m_X.size();
+
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		m_X[i] += Vector.i;
+		m_Y[i] += Vector.j;
+	}
+
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		m_EdgeRects[i * 4] += Vector.i;
+		m_EdgeRects[i * 4 + 1] += Vector.j;
+		m_EdgeRects[i * 4 + 2] += Vector.i;
+		m_EdgeRects[i * 4 + 3] += Vector.j;
+	}
+
+	m_dMinX += Vector.i;
+	m_dMinY += Vector.j;
+	m_dMaxX += Vector.i;
+	m_dMaxY += Vector.j;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::GetOverlaps <BR>
+\brief Returns the overlap between this and the other using C2DPolygon.
+<P>---------------------------------------------------------------------------*/
+void C2DFlatPolygon::GetOverlaps(const C2DFlatPolygon& Other, C2DHoledPolygonSet& HoledPolygons,
+										CGrid::eDegenerateHandling eDegen) const
+{
+	C2DPolygon This;
+	C2DPolygon Poly;
+	GetPolygon(This);
+	Other.GetPolygon(Poly);
+
+	This.GetOverlaps(Poly, HoledPolygons, eDegen);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::GetUnion <BR>
+\brief Returns the union of this and the other using C2DPolygon.
+<P>---------------------------------------------------------------------------*/
+void C2DFlatPolygon::GetUnion(const C2DFlatPolygon& Other, C2DHoledPolygonSet& HoledPolygons,
+										CGrid::eDegenerateHandling eDegen) const
+{
+	C2DPolygon This;
+	C2DPolygon Poly;
+	GetPolygon(This);
+	Other.GetPolygon(Poly);
+
+	This.GetUnion(Poly, HoledPolygons, eDegen);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::GetNonOverlaps <BR>
+\brief Returns the parts of this not overlapping the other using C2DPolygon.
+<P>---------------------------------------------------------------------------*/
+void C2DFlatPolygon::GetNonOverlaps(const C2DFlatPolygon& Other, C2DHoledPolygonSet& HoledPolygons,
+										CGrid::eDegenerateHandling eDegen) const
+{
+	C2DPolygon This;
+	C2DPolygon Poly;
+	GetPolygon(This);
+	Other.GetPolygon(Poly);
+
+	This.GetNonOverlaps(Poly, HoledPolygons, eDegen);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::MakeRects <BR>
+\brief Makes the packed edge bounding rectangles and the overall bounds.
+<P>---------------------------------------------------------------------------*/
+void C2DFlatPolygon::MakeRects(void)
+{
+	unsigned int nCount = m_X.size();
+
+	m_EdgeRects.resize(nCount * 4);
+
+	if (nCount == 0)
+		return;
+
+	m_dMinX = m_dMaxX = m_X[0];
+	m_dMinY = m_dMaxY = m_Y[0];
+
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		unsigned int nNext = (i + 1 == nCount) ? 0 : i + 1;
+
+		double* pRect = &m_EdgeRects[i * 4];
+
+		pRect[0] = m_X[i] < m_X[nNext] ? m_X[i] : m_X[nNext];
+		pRect[1] = m_Y[i] < m_Y[nNext] ? m_Y[i] : m_Y[nNext];
+		pRect[2] = m_X[i] < m_X[nNext] ? m_X[nNext] : m_X[i];
+		pRect[3] = m_Y[i] < m_Y[nNext] ? m_Y[nNext] : m_Y[i];
+
+		if (m_X[i] < m_dMinX) m_dMinX = m_X[i];
+		if (m_X[i] > m_dMaxX) m_dMaxX = m_X[i];
+		if (m_Y[i] < m_dMinY) m_dMinY = m_Y[i];
+		if (m_Y[i] > m_dMaxY) m_dMaxY = m_Y[i];
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::MakeClockwise <BR>
+\brief Reverses the order of the points if they are anticlockwise.
+<P>---------------------------------------------------------------------------*/
+void C2DFlatPolygon::MakeClockwise(void)
+{
+	if (GetAreaSigned() <= 0)
+		return;
+
+	unsigned int nCount = m_X.size();
+
+	for (unsigned int i = 0, j = nCount - 1; i < j; i++, j--)
+	{
+		double dTemp = m_X[i];
+		m_X[i] = m_X[j];
+		m_X[j] = dTemp;
+
+		dTemp = m_Y[i];
+		m_Y[i] = m_Y[j];
+		m_Y[j] = dTemp;
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DFlatPolygon::EdgeDistanceSquared <BR>
+\brief The distance squared from the point to the edge starting at the index given.
+<P>---------------------------------------------------------------------------*/
+double C2DFlatPolygon::EdgeDistanceSquared(unsigned int nEdge, double x, double y) const
+{
+	unsigned int nNext = (nEdge + 1 == m_X.size()) ? 0 : nEdge + 1;
+
+	double dEdgeX = m_X[nNext] - m_X[nEdge];
+	double dEdgeY = m_Y[nNext] - m_Y[nEdge];
+	double dx = x - m_X[nEdge];
+	double dy = y - m_Y[nEdge];
+
+	double dLength2 = dEdgeX * dEdgeX + dEdgeY * dEdgeY;
+	double dProj = dLength2 == 0 ? 0 : (dx * dEdgeX + dy * dEdgeY) / dLength2;
+
+	if (dProj < 0)
+		dProj = 0;
+	else if (dProj > 1)
+		dProj = 1;
+
+	dx -= dProj * dEdgeX;
+	dy -= dProj * dEdgeY;
+
+	return dx * dx + dy * dy;
+}
@@ -0,0 +1,138 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file C2DFlatPolygon.h
+\brief Declaration file for the C2DFlatPolygon Class
+
+Declaration file for C2DFlatPolygon, a straight edged polygon held in contiguous
+arrays.
+
+\class C2DFlatPolygon.
+\brief Class which represents a straight edged polygon in flat arrays.
+
+Class which holds the x and y coordinates of a polygon in two arrays along with
+the bounding rectangle of every edge packed into a third. There are no per edge
+objects so queries run through memory in order with no virtual calls.
+
+Like C2DPolygon the points are held clockwise. Converts to and from C2DPolygon,
+which is used for the boolean operations.
+<P>---------------------------------------------------------------------------*/
+
+#ifndef _GEOLIB_C2DFLATPOLYGON_H
+#define _GEOLIB_C2DFLATPOLYGON_H
+
+
+#include "C2DPoint.h"
+#include "C2DRect.h"
+#include "Grid.h"
+#include <vector>
+
+
+class C2DPolygon;
+class C2DLine;
+class C2DVector;
+class C2DPointSet;
+class C2DHoledPolygonSet;
+
+#ifdef _POLY_EXPORTING
+	#define POLY_DECLSPEC		__declspec(dllexport)
+#else
+	#ifdef _STATIC
+		#define POLY_DECLSPEC
+	#else
+		#define POLY_DECLSPEC		__declspec(dllimport)
+	#endif
+#endif
+
+
+class POLY_DECLSPEC C2DFlatPolygon
+{
+public:
+	/// Constructor.
+	C2DFlatPolygon(void);
+	/// Constructor.
+	C2DFlatPolygon(const C2DPolygon& Polygon);
+	/// Destructor.
+	~C2DFlatPolygon(void);
+
+	/// Creates from the polygon given.
+	bool Create(const C2DPolygon& Polygon);
+	/// Creates from separate x and y coordinates.
+	bool Create(const double* pX, const double* pY, unsigned int nNumber);
+	/// Creates from x, y pairs.
+	bool Create(const double* pPoint, unsigned int nNumber);
+	/// Clears all.
+	void Clear(void);
+
+	/// Creates the polygon given from this.
+	void GetPolygon(C2DPolygon& Polygon) const;
+
+	/// Returns the number of points.
+	unsigned int GetPointsCount(void) const { return (unsigned int)m_X.size();}
+	/// Returns the x coordinates.
+	const double* GetX(void) const { return m_X.empty() ? 0 : &m_X[0];}
+	/// Returns the y coordinates.
+	const double* GetY(void) const { return m_Y.empty() ? 0 : &m_Y[0];}
+	/// Returns the point. Cyclic.
+	C2DPoint GetPoint(unsigned int nPointIndex) const;
+	/// Returns the bounding rectangle.
+	void GetBoundingRect(C2DRect& Rect) const;
+
+	/// True if the point is inside or on the edge.
+	bool Contains(const C2DPoint& pt) const;
+	/// True if the line crosses an edge.
+	bool Crosses(const C2DLine& Line) const;
+	/// True if the line crosses an edge. Adds the intersection points.
+	bool Crosses(const C2DLine& Line, C2DPointSet* IntersectionPts) const;
+
+	/// Returns the area.
+	double GetArea(void) const;
+	/// Returns the area signed (-ve if clockwise).
+	double GetAreaSigned(void) const;
+	/// Returns the perimeter.
+	double GetPerimeter(void) const;
+
+	/// Returns the distance to the point. Negative if inside.
+	double Distance(const C2DPoint& pt) const;
+	/// Returns the distance to the line. Negative if the line starts inside.
+	double Distance(const C2DLine& Line) const;
+
+	/// Moves the polygon.
+	void Move(const C2DVector& Vector);
+
+	/// Returns the overlap between this and the other.
+	void GetOverlaps(const C2DFlatPolygon& Other, C2DHoledPolygonSet& HoledPolygons,
+										CGrid::eDegenerateHandling eDegen = CGrid::None) const;
+	/// Returns the union of this and the other.
+	void GetUnion(const C2DFlatPolygon& Other, C2DHoledPolygonSet& HoledPolygons,
+										CGrid::eDegenerateHandling eDegen = CGrid::None) const;
+	/// Returns the difference between this and the other.
+	void GetNonOverlaps(const C2DFlatPolygon& Other, C2DHoledPolygonSet& HoledPolygons,
+										CGrid::eDegenerateHandling eDegen = CGrid::None) const;
+
+private:
+	/// Makes the edge and overall bounding rectangles.
+	void MakeRects(void);
+	/// Reverses the point order if not clockwise.
+	void MakeClockwise(void);
+	/// Distance squared from the point to the edge.
+	double EdgeDistanceSquared(unsigned int nEdge, double x, double y) const;
+
+	/// The coordinates.
+	std::vector<double> m_X;
+	std::vector<double> m_Y;
+	/// Edge bounding rectangles as min x, min y, max x, max y per edge.
+	std::vector<double> m_EdgeRects;
+
+	double m_dMinX;
+	double m_dMinY;
+	double m_dMaxX;
+	double m_dMaxY;
+};
+
+#endif
@@ -26,6 +26,7 @@ holes. The Rim and Holes are pointers to C2DPolyBase classes.
 #include "C2DArc.h"
 #include "C2DPointSet.h"
 #include "IndexSet.h"
+#include "GeoArena.h"
 
 _MEMORY_POOL_IMPLEMENATION(C2DHoledPolyBase)
 
@@ -65,6 +66,20 @@ C2DHoledPolyBase::C2DHoledPolyBase(const C2DHoledPolyBase& Other) : C2DBase(Poly
 	m_Type = Other.GetType();
 }
 
+/**--------------------------------------------------------------------------<BR>
+C2DHoledPolyBase::C2DHoledPolyBase
+\brief Constructor. Takes the rim and holes of the other leaving it empty.
+<P>---------------------------------------------------------------------------*/
+C2DHoledPolyBase::C2DHoledPolyBase(C2DHoledPolyBase&& Other) : C2DBase(PolyHoledBase)
+{
+	m_Rim = Other.m_Rim;
+	Other.m_Rim = 0;
+
+	m_Holes.Swap(Other.m_Holes);
+
+	m_Type = Other.GetType();
+}
+
 /**--------------------------------------------------------------------------<BR>
 C2DHoledPolyBase::C2DHoledPolyBase
 \brief Assignment.
@@ -84,6 +99,25 @@ const C2DHoledPolyBase& C2DHoledPolyBase::operator=(const C2DHoledPolyBase& Othe
 	return *this;
 }
 
+/**--------------------------------------------------------------------------<BR>
+C2DHoledPolyBase::operator=
+\brief Assignment. Takes the rim and holes of the other leaving it empty.
+<P>---------------------------------------------------------------------------*/
+const C2DHoledPolyBase& C2DHoledPolyBase::operator=(C2DHoledPolyBase&& Other)
+{
+	if (&Other == this)
+		return *this;
+
+	Clear();
+
+	m_Rim = Other.m_Rim;
+	Other.m_Rim = 0;
+
+	m_Holes.Swap(Other.m_Holes);
+
+	return *this;
+}
+
 
 
 /**--------------------------------------------------------------------------<BR>
@@ -258,7 +292,7 @@ C2DHoledPolyBase::IsValid
 \brief True if there are no overlaps and all shapes have at least 3 lines. All
 holes must be inside the rim.
 <P>---------------------------------------------------------------------------*/
-bool C2DHoledPolyBase::IsValid(void)
+bool C2DHoledPolyBase::IsValid(void) const
 {
 	if (m_Rim == 0)
 		return false;
@@ -494,6 +528,28 @@ bool C2DHoledPolyBase::Contains(const C2DPoint& pt) const
 	return true;
 }
 
+
+/**--------------------------------------------------------------------------<BR>
+C2DHoledPolyBase::ContainsPerturbed
+\brief Contains with the point or this moved by an infinitesimal amount.
+<P>---------------------------------------------------------------------------*/
+bool C2DHoledPolyBase::ContainsPerturbed(const C2DPoint& pt, bool bMovePoint) const 
+{
+	if (m_Rim == 0)
+		return false;
+
+	if (!m_Rim->ContainsPerturbed(pt, bMovePoint))
+		return false;
+
+	for (unsigned int i = 0 ; i < m_Holes.size(); i++)
+	{
+		if (m_Holes[i].ContainsPerturbed(pt, bMovePoint))
+			return false;
+	}
+
+	return true;
+}
+
 /**--------------------------------------------------------------------------<BR>
 C2DHoledPolyBase::Contains
 \brief Contains
@@ -731,12 +787,14 @@ double C2DHoledPolyBase::GetPerimeter(void) const
 
 /**--------------------------------------------------------------------------<BR>
 C2DHoledPolyBase::GetRoutes
-\brief GetRoutes
+\brief GetRoutes. If Poly2 is taken as moved by an infinitesimal amount then every
+intersection is found with it as the other set so the same move is used throughout.
 <P>---------------------------------------------------------------------------*/
 void C2DHoledPolyBase::GetRoutes(const C2DHoledPolyBase& Poly1, bool bP1RoutesInside, 
 				const C2DHoledPolyBase& Poly2, bool bP2RoutesInside, 
 				C2DLineBaseSetSet& Routes1, C2DLineBaseSetSet& Routes2, 
-				C2DPolyBaseSet& CompleteHoles1, C2DPolyBaseSet& CompleteHoles2)
+				C2DPolyBaseSet& CompleteHoles1, C2DPolyBaseSet& CompleteHoles2,
+				bool bPerturbPoly2)
 {
 		const C2DPolyBase* pRim1 = Poly1.GetRim();
 		const C2DPolyBase* pRim2 = Poly2.GetRim();
@@ -762,10 +820,13 @@ void C2DHoledPolyBase::GetRoutes(const C2DHoledPolyBase& Poly1, bool bP1RoutesIn
 		unsigned int usP1Holes = Poly1.GetHoleCount();
 		unsigned int usP2Holes = Poly2.GetHoleCount();
 
+		// Shared by all the sweeps below.
+		C2DLineBaseSet::CSweepBuffer SweepBuffer;
+
 		// *** Rim Rim Intersections
 		pRim1->GetLines().GetIntersections(  pRim2->GetLines(),
 			&IntPointsTemp, &IndexesRim1, &IndexesRim2, 
-			&pRim1->GetBoundingRect(), &pRim2->GetBoundingRect() );
+			&pRim1->GetBoundingRect(), &pRim2->GetBoundingRect(), bPerturbPoly2, &SweepBuffer );
 
 		IntPointsRim1.AddCopy( IntPointsTemp );
 		IntPointsRim2 << IntPointsTemp;
@@ -778,11 +839,12 @@ void C2DHoledPolyBase::GetRoutes(const C2DHoledPolyBase& Poly1, bool bP1RoutesIn
 			IntPoints2AllHoles.push_back(new C2DPointSet());
 			Indexes2AllHoles.push_back( new CIndexSet() );
 
-			if (pRim1->GetBoundingRect().Overlaps( Poly2.GetHole(i)->GetBoundingRect() ))
+			if (bPerturbPoly2 ? pRim1->GetBoundingRect().Touches( Poly2.GetHole(i)->GetBoundingRect() ) :
+								pRim1->GetBoundingRect().Overlaps( Poly2.GetHole(i)->GetBoundingRect() ))
 			{
 				pRim1->GetLines().GetIntersections(  Poly2.GetHole(i)->GetLines(),
 						&IntPointsTemp, &IndexesRim1, Indexes2AllHoles[i],
-						&pRim1->GetBoundingRect(), &Poly2.GetHole(i)->GetBoundingRect());
+						&pRim1->GetBoundingRect(), &Poly2.GetHole(i)->GetBoundingRect(), bPerturbPoly2, &SweepBuffer);
 				
 				IntPointsRim1.AddCopy( IntPointsTemp);
 				*IntPoints2AllHoles[i] << IntPointsTemp;
@@ -796,11 +858,23 @@ void C2DHoledPolyBase::GetRoutes(const C2DHoledPolyBase& Poly1, bool bP1RoutesIn
 			IntPoints1AllHoles.push_back( new C2DPointSet());
 			Indexes1AllHoles.push_back( new CIndexSet());
 
-			if (pRim2->GetBoundingRect().Overlaps( Poly1.GetHole(j)->GetBoundingRect() ))
+			if (bPerturbPoly2)
+			{
+				if (Poly1.GetHole(j)->GetBoundingRect().Touches( pRim2->GetBoundingRect() ))
+				{
+					Poly1.GetHole(j)->GetLines().GetIntersections(  pRim2->GetLines(),
+							&IntPointsTemp, Indexes1AllHoles[j], &IndexesRim2,
+							&Poly1.GetHole(j)->GetBoundingRect(), &pRim2->GetBoundingRect(), true, &SweepBuffer);
+
+					IntPointsRim2.AddCopy( IntPointsTemp);
+					*IntPoints1AllHoles[j] << IntPointsTemp;
+				}
+			}
+			else if (pRim2->GetBoundingRect().Overlaps( Poly1.GetHole(j)->GetBoundingRect() ))
 			{
 				pRim2->GetLines().GetIntersections(  Poly1.GetHole(j)->GetLines(),
 						&IntPointsTemp, &IndexesRim2, Indexes1AllHoles[j],
-						&pRim2->GetBoundingRect(), &Poly1.GetHole(j)->GetBoundingRect());
+						&pRim2->GetBoundingRect(), &Poly1.GetHole(j)->GetBoundingRect(), false, &SweepBuffer);
 				
 				IntPointsRim2.AddCopy( IntPointsTemp);
 				*IntPoints1AllHoles[j] << IntPointsTemp;
@@ -809,8 +883,12 @@ void C2DHoledPolyBase::GetRoutes(const C2DHoledPolyBase& Poly1, bool bP1RoutesIn
 		}
 
 		// *** Quick Escape
-		bool bRim1StartInPoly2 = Poly2.Contains( pRim1->GetLine(0)->GetPointFrom() );
-		bool bRim2StartInPoly1 = Poly1.Contains( pRim2->GetLine(0)->GetPointFrom() );
+		bool bRim1StartInPoly2 = bPerturbPoly2 ?
+			Poly2.ContainsPerturbed( pRim1->GetLine(0)->GetPointFrom(), false ) :
+			Poly2.Contains( pRim1->GetLine(0)->GetPointFrom() );
+		bool bRim2StartInPoly1 = bPerturbPoly2 ?
+			Poly1.ContainsPerturbed( pRim2->GetLine(0)->GetPointFrom(), true ) :
+			Poly1.Contains( pRim2->GetLine(0)->GetPointFrom() );
 
 		if (IntPointsRim1.size() != 0 || IntPointsRim2.size() != 0 ||
 					bRim1StartInPoly2 || bRim2StartInPoly1			)	
@@ -841,11 +919,12 @@ void C2DHoledPolyBase::GetRoutes(const C2DHoledPolyBase& Poly1, bool bP1RoutesIn
 					const C2DPolyBase* pHole1 = Poly1.GetHole(h);
 					const C2DPolyBase* pHole2 = Poly2.GetHole(k);
 
-					if ( pHole1->GetBoundingRect().Overlaps( pHole2->GetBoundingRect()) )
+					if ( bPerturbPoly2 ? pHole1->GetBoundingRect().Touches( pHole2->GetBoundingRect()) :
+										 pHole1->GetBoundingRect().Overlaps( pHole2->GetBoundingRect()) )
 					{
 						pHole1->GetLines().GetIntersections( pHole2->GetLines(), 
 							&IntPointsTemp, Indexes1AllHoles[h], Indexes2AllHoles[k],
-							&pHole1->GetBoundingRect(), &pHole2->GetBoundingRect());
+							&pHole1->GetBoundingRect(), &pHole2->GetBoundingRect(), bPerturbPoly2, &SweepBuffer);
 
 						IntPoints1AllHoles[h]->AddCopy( IntPointsTemp);
 						*IntPoints2AllHoles[k] << IntPointsTemp;
@@ -866,7 +945,9 @@ void C2DHoledPolyBase::GetRoutes(const C2DHoledPolyBase& Poly1, bool bP1RoutesIn
 
 				if (pHole->GetLineCount() != 0)
 				{
-					bool bHole1StartInside = Poly2.Contains( pHole->GetLine(0)->GetPointFrom() );
+					bool bHole1StartInside = bPerturbPoly2 ?
+						Poly2.ContainsPerturbed( pHole->GetLine(0)->GetPointFrom(), false ) :
+						Poly2.Contains( pHole->GetLine(0)->GetPointFrom() );
 					if ( IntPoints1AllHoles[a]->size() == 0)
 					{
 						if ( bHole1StartInside == bP1RoutesInside)
@@ -891,7 +972,9 @@ void C2DHoledPolyBase::GetRoutes(const C2DHoledPolyBase& Poly1, bool bP1RoutesIn
 
 				if (pHole->GetLineCount() != 0)
 				{
-					bool bHole2StartInside = Poly1.Contains( pHole->GetLine(0)->GetPointFrom() );
+					bool bHole2StartInside = bPerturbPoly2 ?
+						Poly1.ContainsPerturbed( pHole->GetLine(0)->GetPointFrom(), true ) :
+						Poly1.Contains( pHole->GetLine(0)->GetPointFrom() );
 					if ( IntPoints2AllHoles[b]->size() == 0)
 					{
 						if ( bHole2StartInside == bP2RoutesInside)
@@ -1243,6 +1326,19 @@ void C2DHoledPolyBase::GetBoolean(const C2DHoledPolyBase& Other, C2DHoledPolyBas
 						bool bThisInside, bool bOtherInside, 
 						CGrid::eDegenerateHandling eDegen ) const
 {
+	if (CGeoArena::GetCurrent() == 0)
+	{
+		// Build all the temporaries in the thread arena and copy out only the results.
+		CGeoArenaScope Arena;
+		C2DHoledPolyBaseSet Results;
+		GetBoolean( Other, Results, bThisInside, bOtherInside, eDegen);
+
+		Arena.Suspend();
+		for (unsigned int i = 0; i < Results.size(); i++)
+			HoledPolys.Add(new C2DHoledPolyBase( *Results.GetAt(i)));
+		return;
+	}
+
 	if (m_Rim == 0)
 		return;
 	
@@ -1252,16 +1348,21 @@ void C2DHoledPolyBase::GetBoolean(const C2DHoledPolyBase& Other, C2DHoledPolyBas
 	if (m_Rim->GetLineCount() == 0 || Other.GetRim()->GetLineCount() == 0 )
 		return;
 
+	// The perturbed predicates are for straight lines only.
+	if (eDegen == CGrid::SymbolicPerturbation && (HasArcs() || Other.HasArcs()))
+		eDegen = CGrid::RandomPerturbation;
+
 	if (m_Rim->GetBoundingRect().Overlaps(Other.GetRim()->GetBoundingRect() ))
 	{
 		switch (eDegen)
 		{
 		case CGrid::None:
+		case CGrid::SymbolicPerturbation:
 			{
 				C2DPolyBaseSet CompleteHoles1,CompleteHoles2;
 				C2DLineBaseSetSet Routes1, Routes2;
 				GetRoutes( *this, bThisInside, Other, bOtherInside, Routes1, Routes2,
-								CompleteHoles1, CompleteHoles2);
+								CompleteHoles1, CompleteHoles2, eDegen == CGrid::SymbolicPerturbation);
 
 				Routes1 << Routes2;
 
@@ -1274,7 +1375,12 @@ void C2DHoledPolyBase::GetBoolean(const C2DHoledPolyBase& Other, C2DHoledPolyBas
 					for (int i = Routes1.size() - 1; i >= 0; i--)
 					{
 						C2DLineBaseSet* pRoute = Routes1.GetAt(i);
-						if (pRoute->IsClosed() )
+						if (eDegen == CGrid::SymbolicPerturbation && pRoute->GetLength() == 0)
+						{
+							// Where the shapes touch the moved one overlaps by an infinitesimal
+							// amount which leaves a route collapsed to a point.
+						}
+						else if (pRoute->IsClosed() )
 						{
 							Polygons.Add(new C2DPolyBase);
 							Polygons.GetLast()->CreateDirect( *pRoute);
@@ -53,13 +53,17 @@ public:
 	_MEMORY_POOL_DECLARATION
 	/// Constructor
 	C2DHoledPolyBase(void);
-	/// Copy constructor 
+	/// Copy constructor. Shares the lines of the other until either is changed.
 	C2DHoledPolyBase(const C2DHoledPolyBase& Other);
+	/// Constructor. Takes the rim and holes of the other leaving it empty.
+	C2DHoledPolyBase(C2DHoledPolyBase&& Other);
 	/// Destructor
 	~C2DHoledPolyBase(void);
 
 	/// Assignment
 	const C2DHoledPolyBase& operator=(const C2DHoledPolyBase& Other);
+	/// Assignment. Takes the rim and holes of the other leaving it empty.
+	const C2DHoledPolyBase& operator=(C2DHoledPolyBase&& Other);
 
 	/// Sets the rim to a copy of the polygon given.
 	void SetRim(const C2DPolyBase& Polygon);
@@ -98,7 +102,7 @@ public:
 	void Clear(void);
 
 	/// True if the holes are contained and non-intersecting.
-	bool IsValid(void);
+	bool IsValid(void) const;
 	// True if all the arcs are valid
 	bool IsValidArcs(void) const;
 	// Makes all arc valid if not already by adjusting radius to minimum required.
@@ -147,6 +151,8 @@ public:
 
 	/// Point inside test.
 	bool Contains(const C2DPoint& pt) const ;
+	/// Point inside test with the point or this moved by an infinitesimal amount.
+	bool ContainsPerturbed(const C2DPoint& pt, bool bMovePoint) const;
 	/// Line entirely inside test.
 	bool Contains(const C2DLineBase& Line) const;
 	/// Polygon entirely inside test.
@@ -194,7 +200,8 @@ public:
 	static void GetRoutes(const C2DHoledPolyBase& Poly1, bool bP1RoutesInside, 
 				const C2DHoledPolyBase& Poly2, bool bP2RoutesInside, 
 				C2DLineBaseSetSet& Routes1, C2DLineBaseSetSet& Routes2, 
-				C2DPolyBaseSet& CompleteHoles1, C2DPolyBaseSet& CompleteHoles2);
+				C2DPolyBaseSet& CompleteHoles1, C2DPolyBaseSet& CompleteHoles2,
+				bool bPerturbPoly2 = false);
 
 	/// Moves this by a small random amount.
 	void RandomPerturb(void);
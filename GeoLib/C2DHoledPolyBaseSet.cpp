@@ -18,6 +18,7 @@ Implementation file for C2DHoledPolyBaseSet, a collection of holed polygons.
 #include "C2DHoledPolyBase.h"
 #include "C2DPolyBase.h"
 #include "C2DLineBase.h"
+#include "PlaneSweep.h"
 
 
 _MEMORY_POOL_IMPLEMENATION(C2DHoledPolyBaseSet)
@@ -254,7 +255,7 @@ bool C2DHoledPolyBaseSet::AddIfUnify(C2DHoledPolyBase* pPoly)
 C2DHoledPolyBaseSet::GetLineCount
 \brief This function gets the line count for the entire set.
 <P>---------------------------------------------------------------------------*/
-unsigned int C2DHoledPolyBaseSet::GetLineCount(void)
+unsigned int C2DHoledPolyBaseSet::GetLineCount(void) const
 {
 	unsigned int nResult = 0 ;
 
@@ -271,7 +272,7 @@ unsigned int C2DHoledPolyBaseSet::GetLineCount(void)
 C2DHoledPolyBaseSet::GetMinLineCount
 \brief Returns the minimum line count of all polys in the set.
 <P>---------------------------------------------------------------------------*/
-unsigned int C2DHoledPolyBaseSet::GetMinLineCount(void)
+unsigned int C2DHoledPolyBaseSet::GetMinLineCount(void) const
 {
 	unsigned int nMin = ~(unsigned int)0;
 
@@ -315,6 +316,9 @@ void C2DHoledPolyBaseSet::UnifyProgressive(CGrid::eDegenerateHandling eDegen)
 		break;
 	case CGrid::PreDefinedGridPreSnapped:
 
+		break;
+	case CGrid::SymbolicPerturbation:
+		// Each union moves the other shape symbolically so nothing is needed here.
 		break;
 	}
 
@@ -425,6 +429,43 @@ void C2DHoledPolyBaseSet::UnifyProgressive(CGrid::eDegenerateHandling eDegen)
 	(*this) << NoUnionSet;
 }
 
+
+/**--------------------------------------------------------------------------<BR>
+C2DHoledPolyBaseSet::UnifySweep
+\brief Unifies the whole set in one sweep of all the lines rather than union by
+union. Lines are taken as straight so arcs become their chords.
+<P>---------------------------------------------------------------------------*/
+void C2DHoledPolyBaseSet::UnifySweep(CPlaneSweep::eFillRule eFill)
+{
+	if (size() < 2)
+		return;
+
+	CPlaneSweep Sweep;
+	Sweep.AddSubject(*this);
+
+	DeleteAll();
+
+	Sweep.Execute(CPlaneSweep::Union, *this, eFill);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DHoledPolyBaseSet::GetBooleanSweep
+\brief Adds the result of the operation with this set as the subject and the other
+as the clip to the set given, in one sweep of all the lines. Lines are taken as
+straight so arcs become their chords.
+<P>---------------------------------------------------------------------------*/
+void C2DHoledPolyBaseSet::GetBooleanSweep(const C2DHoledPolyBaseSet& Other,
+			CPlaneSweep::eOperation eOp, C2DHoledPolyBaseSet& Result,
+			CPlaneSweep::eFillRule eFill) const
+{
+	CPlaneSweep Sweep;
+	Sweep.AddSubject(*this);
+	Sweep.AddClip(Other);
+
+	Sweep.Execute(eOp, Result, eFill);
+}
+
 /**--------------------------------------------------------------------------<BR>
 C2DHoledPolyBaseSet::AddKnownHoles
 \brief Adds the shapes provided assuming they are known holes - adds them as holes
@@ -21,6 +21,7 @@ Class which represents a collection of holed polygons.
 
 
 #include "Grid.h"
+#include "PlaneSweep.h"
 #include "C2DHoledPolyBase.h"
 #include "C2DBaseSet.h"
 #include "MemoryPool.h"
@@ -92,6 +93,11 @@ public:
 	void UnifyBasic(void);
 	/// Unification by growing shapes of fairly equal size (fastest for large groups).
 	void UnifyProgressive(CGrid::eDegenerateHandling eDegen = CGrid::None);
+	/// Unification of the whole set in one sweep (fastest for large groups of straight lines).
+	void UnifySweep(CPlaneSweep::eFillRule eFill = CPlaneSweep::NonZero);
+	/// Boolean operation with this as the subject and the other as the clip in one sweep.
+	void GetBooleanSweep(const C2DHoledPolyBaseSet& Other, CPlaneSweep::eOperation eOp,
+				C2DHoledPolyBaseSet& Result, CPlaneSweep::eFillRule eFill = CPlaneSweep::NonZero) const;
 	/// Assumes current set is distinct.
 	void AddAndUnify(C2DHoledPolyBase* pPoly);
 	/// Assumes both sets are distinct.
@@ -102,9 +108,9 @@ public:
 	void AddKnownHoles( C2DPolyBaseSet& pOther );
 
 	/// Total Line count for all polygons contained.
-	unsigned int GetLineCount(void);
+	unsigned int GetLineCount(void) const;
 	/// Minimum line count of all polys.
-	unsigned int GetMinLineCount(void);
+	unsigned int GetMinLineCount(void) const;
 
 	// Passes all the pointers from the Other into this
 	void operator<<(C2DPolyBaseSet& Other);
@@ -19,6 +19,7 @@ with holes.
 #include "C2DHoledPolygonSet.h"
 #include "C2DPolygon.h"
 #include "C2DVector.h"
+#include "Triangulator.h"
 
 _MEMORY_POOL_IMPLEMENATION(C2DHoledPolygon)
 
@@ -41,15 +42,23 @@ C2DHoledPolygon::C2DHoledPolygon(const C2DHoledPolygon& Other)
 {
 	this->SetRim(*Other.GetRim());
 
-	for (unsigned int i = 0 ; i < Other.GetHoleCount(); i++)
-	{
-		AddHole( *Other.GetHole(i) );
-	}
+	// The holes are shared until either polygon changes them.
+	m_Holes = Other.m_Holes;
 
 	m_Type = PolyLineHoled;
 }
 
 
+/**--------------------------------------------------------------------------<BR>
+C2DHoledPolygon::C2DHoledPolygon
+\brief Constructor. Takes the rim and holes of the other leaving it empty.
+<P>---------------------------------------------------------------------------*/
+C2DHoledPolygon::C2DHoledPolygon(C2DHoledPolygon&& Other) : C2DHoledPolyBase(std::move(Other))
+{
+	m_Type = PolyLineHoled;
+}
+
+
 /**--------------------------------------------------------------------------<BR>
 C2DHoledPolygon::C2DHoledPolygon
 \brief Constructor
@@ -269,6 +278,18 @@ const C2DHoledPolygon& C2DHoledPolygon::operator=(C2DHoledPolygon& Other)
 }
 
 
+/**--------------------------------------------------------------------------<BR>
+C2DHoledPolygon::operator=
+\brief Assignment. Takes the rim and holes of the other leaving it empty.
+<P>---------------------------------------------------------------------------*/
+const C2DHoledPolygon& C2DHoledPolygon::operator=(C2DHoledPolygon&& Other)
+{
+	C2DHoledPolyBase::operator=(std::move(Other));
+
+	return *this;
+}
+
+
 
 
 /**--------------------------------------------------------------------------<BR>
@@ -360,6 +381,48 @@ double C2DHoledPolygon::GetArea() const
 }
 
 
+/**--------------------------------------------------------------------------<BR>
+C2DHoledPolygon::Triangulate
+\brief Replaces the indexes with three for each triangle covering the polygon. The
+points are numbered through the rim then each hole in turn. Holes are joined to the
+rim so there is one triangulation of the whole.
+<P>---------------------------------------------------------------------------*/
+void C2DHoledPolygon::Triangulate(std::vector<uint32_t>& Indices) const
+{
+	Indices.clear();
+
+	const C2DPolygon* pRim = GetRim();
+
+	if (pRim == 0)
+		return;
+
+	std::vector<C2DPoint> Points;
+	std::vector<unsigned int> HoleStarts;
+
+	Points.reserve(GetLineCount());
+	HoleStarts.reserve(m_Holes.size());
+
+	for (unsigned int i = 0; i < pRim->GetPointsCount(); i++)
+		Points.push_back(*pRim->GetPoint(i));
+
+	for (unsigned int h = 0; h < m_Holes.size(); h++)
+	{
+		const C2DPolygon* pHole = GetHole(h);
+		HoleStarts.push_back((unsigned int)Points.size());
+
+		for (unsigned int i = 0; i < pHole->GetPointsCount(); i++)
+			Points.push_back(*pHole->GetPoint(i));
+	}
+
+	if (Points.empty())
+		return;
+
+	CTriangulator Triangulator;
+	Triangulator.Triangulate(&Points[0], (unsigned int)Points.size(),
+				HoleStarts.empty() ? 0 : &HoleStarts[0], (unsigned int)HoleStarts.size(), Indices);
+}
+
+
 /**--------------------------------------------------------------------------<BR>
 C2DHoledPolygon::GetOverlaps
 \brief Returns the overlaps between this and the other complex polygon.
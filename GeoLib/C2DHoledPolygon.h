@@ -26,6 +26,8 @@ polygons (without holes) representing the rim and the hole.
 #include "C2DHoledPolyBase.h"
 #include "Grid.h"
 #include "MemoryPool.h"
+#include <vector>
+#include <cstdint>
 
 
 class C2DPolygon;
@@ -49,8 +51,10 @@ public:
 
 	/// Constructor.
 	C2DHoledPolygon(void);
-	/// Constructor with assignment.
+	/// Constructor with assignment. Shares the lines of the other until either is changed.
 	C2DHoledPolygon(const C2DHoledPolygon& Other);
+	/// Constructor. Takes the rim and holes of the other leaving it empty.
+	C2DHoledPolygon(C2DHoledPolygon&& Other);
 	/// Constructor with assignment.
 	C2DHoledPolygon(const C2DHoledPolyBase& Other);
 
@@ -85,6 +89,8 @@ public:
 
 	/// Assignement to another.
 	const C2DHoledPolygon& operator=(C2DHoledPolygon& Other);
+	/// Assignment. Takes the rim and holes of the other leaving it empty.
+	const C2DHoledPolygon& operator=(C2DHoledPolygon&& Other);
 
 	/// Grows the polygon by the amount.
 	void Grow(double dFactor);
@@ -96,6 +102,9 @@ public:
 	void RotateToRight(double dAng, const C2DPoint& Origin);
 	/// Returns the centroid.
 	C2DPoint GetCentroid(void);
+	/// Replaces the indexes with three for each triangle covering the polygon.
+	/// The points are those of the rim then those of each hole in turn.
+	void Triangulate(std::vector<uint32_t>& Indices) const;
 
 	/// Area.
 	double GetArea() const ;
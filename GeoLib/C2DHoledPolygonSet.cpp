@@ -58,8 +58,7 @@ C2DHoledPolygonSet::MakeCopy
 <P>---------------------------------------------------------------------------*/
 void C2DHoledPolygonSet::MakeCopy( const C2DHoledPolygonSet& Other)
 {
-	DeleteAll();
-	AddCopy( Other);
+	C2DBaseSet::operator=(Other);
 
 }
 
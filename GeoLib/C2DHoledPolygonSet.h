@@ -48,6 +48,14 @@ public:
 	C2DHoledPolygonSet(void);
 	/// Destructor
 	~C2DHoledPolygonSet(void);
+	/// Constructor. Shares the polygons of the other until either is changed.
+	C2DHoledPolygonSet(const C2DHoledPolygonSet& Other) : C2DBaseSet(Other) {}
+	/// Constructor. Takes the polygons of the other leaving it empty.
+	C2DHoledPolygonSet(C2DHoledPolygonSet&& Other) : C2DBaseSet(std::move(Other)) {}
+	/// Assignment. Shares the polygons of the other until either is changed.
+	const C2DHoledPolygonSet& operator=(const C2DHoledPolygonSet& Other) { C2DBaseSet::operator=(Other); return *this;}
+	/// Assignment. Takes the polygons of the other leaving it empty.
+	const C2DHoledPolygonSet& operator=(C2DHoledPolygonSet&& Other) { C2DBaseSet::operator=(std::move(Other)); return *this;}
 	/// Adds a copy of the other pointer array
 	void AddCopy(const C2DHoledPolygonSet& Other);
 	/// Makes a copy of the other
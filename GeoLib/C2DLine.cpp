@@ -22,6 +22,8 @@ finite line.
 #include "C2DRect.h"
 #include "C2DPointSet.h"
 #include "Transformation.h"
+#include "Predicates.h"
+#include "C2DCircle.h"
 
 
 _MEMORY_POOL_IMPLEMENATION(C2DLine)
@@ -49,7 +51,7 @@ C2DLine::C2DLine(const C2DLine& Other) : C2DLineBase(StraightLine)
 	point.y = Other.point.y;
 	vector.i = Other.vector.i;
 	vector.j = Other.vector.j;	
-
+	m_nAttributes = Other.m_nAttributes;
 }
 
 
@@ -149,7 +151,7 @@ C2DLine::IsOnRight
 <P>---------------------------------------------------------------------------*/
 bool C2DLine::IsOnRight(const C2DPoint& OtherPoint) const
 {
-	return ( C2DTriangle::GetAreaSigned( point, GetPointTo(), OtherPoint) < 0);
+	return ( CPredicates::Orient2D( point, GetPointTo(), OtherPoint) < 0);
 }
 
 
@@ -248,6 +250,20 @@ C2DPoint C2DLine::GetPointOn(double dFactorFromStart) const
 }
 
 
+/**--------------------------------------------------------------------------<BR>
+IsCrossingHalfOpen
+\brief Given the orientations of the ends of a line about another, true if the other
+meets it in the point set [start, end).
+<P>---------------------------------------------------------------------------*/
+static inline bool IsCrossingHalfOpen(double dStart, double dEnd)
+{
+	if (dEnd == 0)
+		return false;
+
+	return dStart == 0 || ((dStart > 0) != (dEnd > 0));
+}
+
+
 /**--------------------------------------------------------------------------<BR>
 C2DLine::Crosses
 \brief  True if this line crosses the other. Returns the point is a collection is provided.
@@ -276,8 +292,11 @@ bool C2DLine::Crosses(const C2DLine& Other, C2DPointSet* IntersectionPts
 	Ua = Ua / dDenominator;
 	Ub = Ub / dDenominator;
 
-	bOnThis = (Ua >= 0 && Ua < 1);		// For ints we need the line to be the point set [a,b);
-	bOnOther = (Ub >= 0 && Ub < 1);		// For ints we need the line to be the point set [a,b);
+	// The sides of each line the ends of the other are on are found exactly rather than
+	// from Ua and Ub so rounding cannot count a crossing twice or miss it.
+	// For ints we need the line to be the point set [a,b);
+	bOnThis = IsCrossingHalfOpen( CPredicates::Orient2D(p3, p4, p1), CPredicates::Orient2D(p3, p4, p2));
+	bOnOther = IsCrossingHalfOpen( CPredicates::Orient2D(p1, p2, p3), CPredicates::Orient2D(p1, p2, p4));
 	bool bResult  = bOnThis && bOnOther;
 
 	if (pbOnThis != 0) *pbOnThis = bOnThis;
@@ -285,12 +304,54 @@ bool C2DLine::Crosses(const C2DLine& Other, C2DPointSet* IntersectionPts
 
 	if (IntersectionPts != 0 && (bAddPtIfFalse || bResult))
 	{
+		if (bResult)
+			Ua = Ua < 0 ? 0 : (Ua > 1 ? 1 : Ua);	// Keep the point on the line.
 		IntersectionPts->AddCopy(C2DPoint(p1.x + Ua*(p2.x - p1.x) , p1.y + Ua*(p2.y - p1.y)));
 	}
 
 	return (bResult);
 }
 
+
+/**--------------------------------------------------------------------------<BR>
+C2DLine::CrossesPerturbed
+\brief True if this crosses the other moved by the infinitesimal vector (e, e * e).
+The lines can then never touch or overlap so a crossing is always a proper one and
+no tolerance is needed. The point is where the unmoved lines meet.
+<P>---------------------------------------------------------------------------*/
+bool C2DLine::CrossesPerturbed(const C2DLine& Other, C2DPointSet* IntersectionPts) const
+{
+	C2DPoint p1 = point;
+	C2DPoint p2 = GetPointTo();
+
+	C2DPoint p3 = Other.point;
+	C2DPoint p4 = Other.GetPointTo();
+
+	int nSide1 = CPredicates::Orient2DPerturbed(p3, true, p4, true, p1, false);
+	int nSide2 = CPredicates::Orient2DPerturbed(p3, true, p4, true, p2, false);
+	if (nSide1 == nSide2)
+		return false;
+
+	int nSide3 = CPredicates::Orient2DPerturbed(p1, false, p2, false, p3, true);
+	int nSide4 = CPredicates::Orient2DPerturbed(p1, false, p2, false, p4, true);
+	if (nSide3 == nSide4)
+		return false;
+
+	if (IntersectionPts != 0)
+	{
+		double dDenominator = (p4.y - p3.y)*(p2.x - p1.x) - (p4.x - p3.x) * (p2.y - p1.y);
+		double Ua = 0.5;
+		if (dDenominator != 0)
+		{
+			Ua = ((p4.x - p3.x)*(p1.y - p3.y) - (p4.y - p3.y) * (p1.x - p3.x)) / dDenominator;
+			Ua = Ua < 0 ? 0 : (Ua > 1 ? 1 : Ua);
+		}
+		IntersectionPts->AddCopy(C2DPoint(p1.x + Ua*(p2.x - p1.x) , p1.y + Ua*(p2.y - p1.y)));
+	}
+
+	return true;
+}
+
 /**--------------------------------------------------------------------------<BR>
 C2DLine::GetBoundingRect
 \brief  Returns the bounding rectangle.
@@ -678,6 +739,10 @@ void C2DLine::GetSubLines(const C2DPointSet& PtsOnLine, C2DLineBaseSet& LineSet)
 
 		// Add the line from the last point on this to the end of this.
 		LineSet.Add(new C2DLine( *TempPts.GetLast() , GetPointTo() ));
+
+		// The sub lines are part of this so they keep its attributes.
+		for (unsigned int i = LineSet.size() - usPointsCount - 1; i < LineSet.size(); i++)
+			LineSet[i].SetAttributes(m_nAttributes);
 	}
 
 	assert (LineSet.size() == (PtsOnLine.size() + 1) );
@@ -952,6 +1017,100 @@ double C2DLine::DistanceAsRay(const C2DPoint& TestPoint,  C2DPoint* ptOnThis) co
 }
 
 
+/**--------------------------------------------------------------------------<BR>
+C2DLine::FirstContactTime
+\brief Returns the first time from 0 to that given at which the circle, with its centre
+moving at the velocity given per unit time, touches this. Returns -1 if it does not.
+The time is solved for rather than sampled so a circle moving further than its own
+size in the time cannot pass through this unseen. Returns 0 if already touching.
+<P>---------------------------------------------------------------------------*/
+double C2DLine::FirstContactTime(const C2DCircle& Circle, const C2DVector& Velocity, double dTime) const
+{
+	const C2DPoint& ptCentre = Circle.GetCentre();
+	double dRadius = Circle.GetRadius();
+
+	if (Distance(ptCentre) <= dRadius)
+		return 0;
+
+	double dFirst = -1;
+
+	// The side of the line is first touched when the centre is a radius off the line
+	// and between the ends.
+	double dLength = vector.GetLength();
+	if (dLength > 0)
+	{
+		double dNormalX = -vector.j / dLength;
+		double dNormalY = vector.i / dLength;
+		double dOff = (ptCentre.x - point.x) * dNormalX + (ptCentre.y - point.y) * dNormalY;
+		double dClosing = Velocity.i * dNormalX + Velocity.j * dNormalY;
+
+		if (dOff * dClosing < 0)
+		{
+			double dSide = dOff > 0 ? dRadius : -dRadius;
+			double t = (dSide - dOff) / dClosing;
+			if (t >= 0 && t <= dTime)
+			{
+				double dAlong = ((ptCentre.x + Velocity.i * t - point.x) * vector.i + 
+								 (ptCentre.y + Velocity.j * t - point.y) * vector.j) / dLength;
+				if (dAlong >= 0 && dAlong <= dLength)
+					dFirst = t;
+			}
+		}
+	}
+
+	// Otherwise an end is first touched when the centre is a radius from it.
+	double dSpeedSq = Velocity.i * Velocity.i + Velocity.j * Velocity.j;
+	if (dSpeedSq > 0)
+	{
+		C2DPoint Ends[2] = {point, GetPointTo()};
+		for (unsigned int i = 0; i < 2; i++)
+		{
+			double dx = ptCentre.x - Ends[i].x;
+			double dy = ptCentre.y - Ends[i].y;
+			double b = dx * Velocity.i + dy * Velocity.j;
+			double c = dx * dx + dy * dy - dRadius * dRadius;
+			double dDisc = b * b - dSpeedSq * c;
+			if (b < 0 && dDisc >= 0)
+			{
+				double t = (-b - sqrt(dDisc)) / dSpeedSq;
+				if (t >= 0 && t <= dTime && (dFirst < 0 || t < dFirst))
+					dFirst = t;
+			}
+		}
+	}
+
+	return dFirst;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DLine::FirstContactTime
+\brief Returns the first time from 0 to that given at which any of the circles, each
+moving at its own velocity, touches this. Returns -1 if none do. The index of the
+circle is set if asked for. Each circle is only solved up to the best time so far.
+<P>---------------------------------------------------------------------------*/
+double C2DLine::FirstContactTime(const C2DCircle* pCircles, const C2DVector* pVelocities, 
+		unsigned int nCount, double dTime, unsigned int* pIndex) const
+{
+	double dFirst = -1;
+
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		double t = FirstContactTime(pCircles[i], pVelocities[i], dFirst < 0 ? dTime : dFirst);
+		if (t >= 0 && (dFirst < 0 || t < dFirst))
+		{
+			dFirst = t;
+			if (pIndex != 0)
+				*pIndex = i;
+			if (dFirst == 0)
+				break;
+		}
+	}
+
+	return dFirst;
+}
+
+
 /**--------------------------------------------------------------------------<BR>
 C2DLine::Join
 \brief Function to join the 2 lines at the point where they do / would intersect. If they do then
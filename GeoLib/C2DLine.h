@@ -28,6 +28,7 @@ and a vector representing the movement to the new point.
 
 
 class C2DLineBaseSet;
+class C2DCircle;
 class C2DPointSet;
 class CTransformation;
 
@@ -89,6 +90,8 @@ public:
 	/// where the cross would occur (if not parallel) even if they don't cross.
 	bool Crosses(const C2DLine& Other, C2DPointSet* IntersectionPts = 0, 
 		bool* pbOnThis = 0, bool* pbOnOther = 0, bool bAddPtIfFalse = false) const;
+	/// True if this crosses the other moved by an infinitesimal amount. See CPredicates.
+	bool CrossesPerturbed(const C2DLine& Other, C2DPointSet* IntersectionPts = 0) const;
 	/// True if the ray provided (infinite line starting from the first point) crosses this. 
 	bool CrossesRay(const C2DLine& Ray, 
 		C2DPointSet* IntersectionPts = 0) const;
@@ -109,6 +112,14 @@ public:
 	/// Returns the distance from this to the point with this as a ray.
 	double DistanceAsRay(const C2DPoint& TestPoint,  C2DPoint* ptOnThis) const;
 
+	/// Returns the first time up to that given at which the circle, moving at the velocity
+	/// given per unit time, touches this. Returns -1 if it does not.
+	double FirstContactTime(const C2DCircle& Circle, const C2DVector& Velocity, double dTime) const;
+	/// Returns the first time up to that given at which any of the circles, each moving at
+	/// its velocity, touches this and the index of that circle. Returns -1 if none do.
+	double FirstContactTime(const C2DCircle* pCircles, const C2DVector* pVelocities, 
+		unsigned int nCount, double dTime, unsigned int* pIndex = 0) const;
+
 
 
 	/// Gets the mid point on the line.
@@ -21,7 +21,7 @@ class for all lines.
 C2DLineBase::C2DLineBase <BR>
 \brief Constructor.
 <P>---------------------------------------------------------------------------*/
-C2DLineBase::C2DLineBase(C2DBase::E_TYPE Type) : C2DBase( Type )
+C2DLineBase::C2DLineBase(C2DBase::E_TYPE Type) : C2DBase( Type ), m_nAttributes(0)
 {
 }
 
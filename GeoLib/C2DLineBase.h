@@ -77,6 +77,15 @@ public:
 	virtual void Transform(CTransformation* pProject) = 0;
 	/// Transformation by the provided operator.
 	virtual void InverseTransform(CTransformation* pProject) = 0;
+
+	/// The attributes, a word of flags for the user. Copies and sub lines keep them.
+	unsigned int GetAttributes(void) const {return m_nAttributes;}
+	/// Sets the attributes.
+	void SetAttributes(unsigned int nAttributes) {m_nAttributes = nAttributes;}
+
+protected:
+	/// The attributes.
+	unsigned int m_nAttributes;
 };
 
 #endif
\ No newline at end of file
@@ -125,13 +125,16 @@ void C2DLineBaseSet::GetIntersections(C2DPointSet* pPoints,
 		unsigned int usIndex;
 	};
 
-	// Set up an array of these structures and the left most points of the line rects
+	// Set up an array of these structures held together and the left most points of the line rects
+	std::vector<sLineBaseRect> LineRects(size());
 	std::vector<sLineBaseRect*> Lines;
 	std::vector<double> xValues;
+	Lines.reserve(size());
+	xValues.reserve(size());
 
 	for (unsigned int i = 0 ; i <  size() ; i++)
 	{
-		sLineBaseRect* pLineRect = new sLineBaseRect;
+		sLineBaseRect* pLineRect = &LineRects[i];
 		pLineRect->pLine = GetAt(i);
 		pLineRect->pLine->GetBoundingRect(pLineRect->Rect);
 		pLineRect->usIndex = i;
@@ -139,7 +142,7 @@ void C2DLineBaseSet::GetIntersections(C2DPointSet* pPoints,
 		xValues.push_back(  pLineRect->Rect.GetLeft());
 	}
 	// Sort them all according to the left most point of the line rects.
-	GeoSort::PQuickSort< std::vector<double>, double, std::vector<sLineBaseRect*>, sLineBaseRect*>( xValues, Lines);
+	GeoSort::RadixSort(xValues, Lines);
 
 	unsigned int j = 0;
 	C2DPointSet IntPt;
@@ -160,6 +163,8 @@ void C2DLineBaseSet::GetIntersections(C2DPointSet* pPoints,
 				{
 					if (pPoints != 0)
 						pPoints->Add( IntPt.ExtractLast());
+					else
+						delete IntPt.ExtractLast();
 
 					if (pIndexes1)
 					{
@@ -175,124 +180,190 @@ void C2DLineBaseSet::GetIntersections(C2DPointSet* pPoints,
 		}	
 		j++;
 	}
+}
 
-	unsigned int d = 0 ;
-	while (d < Lines.size())
-	{
-		delete Lines.at(d);
-		d++;
-	}
+/**--------------------------------------------------------------------------<BR>
+CrossesPerturbed
+\brief True if the lines cross with the one not from this set moved by an
+infinitesimal amount. Arcs are tested as they are.
+<P>---------------------------------------------------------------------------*/
+static bool CrossesPerturbed(const C2DLineBase& Line1, bool bLine1InThis,
+							 const C2DLineBase& Line2, C2DPointSet& IntPts)
+{
+	if (Line1.GetType() != C2DBase::StraightLine || Line2.GetType() != C2DBase::StraightLine)
+		return Line1.Crosses(Line2, &IntPts);
+
+	const C2DLine& Straight1 = static_cast<const C2DLine&>(Line1);
+	const C2DLine& Straight2 = static_cast<const C2DLine&>(Line2);
+
+	if (bLine1InThis)
+		return Straight1.CrossesPerturbed(Straight2, &IntPts);
+	else
+		return Straight2.CrossesPerturbed(Straight1, &IntPts);
 }
 
+
 /**--------------------------------------------------------------------------<BR>
 C2DLineBaseSet::GetIntersections
-\brief Gets the intersections between this set and the other.
+\brief Gets the intersections between this set and the other. If the other is taken
+as moved by an infinitesimal amount then lines which touch may cross, so rectangles
+which touch are tested, and straight lines are tested with exact predicates.
+
+The lines are swept from left to right. Those the sweep is on are held for each set
+in bands by height, each as high as the lines are on average, so a line is only
+tested against those of the other set in the bands it covers and many long lines
+over the same width are not all tested against each other. A pair is only tested
+in the band where the higher of their bottoms is. Lines are dropped from a band
+when found to be behind the sweep.
 <P>---------------------------------------------------------------------------*/
 void C2DLineBaseSet::GetIntersections(const C2DLineBaseSet& Other, C2DPointSet* pPoints, 
 			CIndexSet* pIndexesThis, CIndexSet* pIndexesOther,
-			const C2DRect* pBoundingRectThis , const  C2DRect* pBoundingRectOther) const
+			const C2DRect* pBoundingRectThis , const  C2DRect* pBoundingRectOther,
+			bool bPerturbOther, CSweepBuffer* pBuffer) const
 {
-	struct sLineBaseRect
-	{
-		const C2DLineBase* pLine;
-		C2DRect Rect;
-		unsigned int usIndex;
-		bool bSetFlag;
-	};
+	CSweepBuffer LocalBuffer;
+	CSweepBuffer& Buffer = pBuffer != 0 ? *pBuffer : LocalBuffer;
 
-	std::vector<sLineBaseRect*> Lines;
-	std::vector<double> xValues;
+	std::vector<CSweepBuffer::sLineRect>& Lines = Buffer.m_Lines;
+	std::vector<double>& Lefts = Buffer.m_Lefts;
+	Lines.clear();
+	Lefts.clear();
 
-	for (unsigned int i = 0 ; i <  size() ; i++)
+	double dBottom = 0;
+	double dTop = 0;
+	double dHeights = 0;
+
+	for (unsigned int nSet = 0; nSet < 2; nSet++)
 	{
-		sLineBaseRect* pLineRect = new sLineBaseRect;
-		pLineRect->pLine = GetAt(i);
-		pLineRect->pLine->GetBoundingRect(pLineRect->Rect);
-		pLineRect->usIndex = i;
-		pLineRect->bSetFlag = true;
+		const C2DLineBaseSet& Set = nSet == 0 ? *this : Other;
+		const C2DRect* pBounds = nSet == 0 ? pBoundingRectOther : pBoundingRectThis;
 
-		if (pBoundingRectOther == 0 || pBoundingRectOther->Overlaps( pLineRect->Rect))
-		{
-			Lines.push_back(pLineRect);
-			xValues.push_back(  pLineRect->Rect.GetLeft());
-		}
-		else
+		for (unsigned int i = 0 ; i < Set.size() ; i++)
 		{
-			delete pLineRect;
+			CSweepBuffer::sLineRect LineRect;
+			LineRect.pLine = Set.GetAt(i);
+			LineRect.pLine->GetBoundingRect(LineRect.Rect);
+			LineRect.nIndex = i;
+			LineRect.bThis = nSet == 0;
+
+			if (pBounds == 0 || (bPerturbOther ? pBounds->Touches( LineRect.Rect) :
+												pBounds->Overlaps( LineRect.Rect)))
+			{
+				if (Lines.empty() || LineRect.Rect.GetBottom() < dBottom)
+					dBottom = LineRect.Rect.GetBottom();
+				if (Lines.empty() || LineRect.Rect.GetTop() > dTop)
+					dTop = LineRect.Rect.GetTop();
+				dHeights += LineRect.Rect.Height();
+
+				Lines.push_back(LineRect);
+				Lefts.push_back(LineRect.Rect.GetLeft());
+			}
 		}
 	}
 
-	for (unsigned int d = 0 ; d <  Other.size() ; d++)
-	{
-		sLineBaseRect* pLineRect = new sLineBaseRect;
-		pLineRect->pLine = Other.GetAt(d);
-		pLineRect->pLine->GetBoundingRect(pLineRect->Rect);
-		pLineRect->usIndex = d;
-		pLineRect->bSetFlag = false;
+	if (Lines.empty())
+		return;
 
-		if (pBoundingRectThis == 0 || pBoundingRectThis->Overlaps( pLineRect->Rect))
-		{
-			Lines.push_back(pLineRect);
-			xValues.push_back(  pLineRect->Rect.GetLeft());
-		}
-		else
-		{
-			delete pLineRect;
-		}
-	}
+	GeoSort::RadixOrder(Lefts, Buffer.m_Sort);
+	const std::vector<unsigned int>& Order = Buffer.m_Sort.Order;
 
-	GeoSort::PQuickSort< std::vector<double>, double, std::vector<sLineBaseRect*>, sLineBaseRect*>( xValues, Lines);
+	// Bands as high as the average line, no more than the lines.
+	unsigned int nBands = 1;
+	double dBandScale = 0;
+	if (dTop > dBottom)
+	{
+		double dBandHeight = dHeights / Lines.size();
+		double dBands = dBandHeight > 0 ? (dTop - dBottom) / dBandHeight : Lines.size();
+		if (dBands > Lines.size())
+			dBands = Lines.size();
+		if (dBands > 1)
+			nBands = (unsigned int)dBands;
+		dBandScale = nBands / (dTop - dBottom);
+	}
 
+	// The bands of this set then the other.
+	std::vector< std::vector<unsigned int> >& Bands = Buffer.m_Bands;
+	if (Bands.size() < nBands * 2)
+		Bands.resize(nBands * 2);
+	for (unsigned int b = 0; b < nBands * 2; b++)
+		Bands[b].clear();
 
-	unsigned int j = 0;
 	C2DPointSet IntPt;
-	while (j < Lines.size())
+	for (unsigned int k = 0; k < Order.size(); k++)
 	{
-		unsigned int r = j + 1;
-
-		double dXLimit = Lines[j]->Rect.GetRight();
+		const CSweepBuffer::sLineRect& Line = Lines[Order[k]];
+		double dLeft = Line.Rect.GetLeft();
+		unsigned int nLow = Band(Line.Rect.GetBottom(), dBottom, dBandScale, nBands);
+		unsigned int nHigh = Band(Line.Rect.GetTop(), dBottom, dBandScale, nBands);
+		unsigned int nOtherBands = Line.bThis ? nBands : 0;
 
-		while (r < Lines.size() && 
-			   Lines[r]->Rect.GetLeft() < dXLimit)
+		for (unsigned int b = nLow; b <= nHigh; b++)
 		{
-			
-			if (  ( Lines[j]->bSetFlag ^ Lines[r]->bSetFlag  ) &&				
-					Lines[j]->Rect.Overlaps(  Lines[r]->Rect) &&
-					Lines[j]->pLine->Crosses(  *Lines[r]->pLine, &IntPt) )
+			std::vector<unsigned int>& Active = Bands[nOtherBands + b];
+			unsigned int i = 0;
+			while (i < Active.size())
 			{
-				while (IntPt.size() >0)
+				const CSweepBuffer::sLineRect& Prev = Lines[Active[i]];
+
+				if (Prev.Rect.GetRight() < dLeft || (!bPerturbOther && Prev.Rect.GetRight() == dLeft))
 				{
-					if (pPoints != 0)
-						pPoints->Add( IntPt.ExtractLast());
+					Active[i] = Active.back();
+					Active.pop_back();
+					continue;
+				}
+				i++;
+
+				double dPairBottom = Prev.Rect.GetBottom() > Line.Rect.GetBottom() ?
+							Prev.Rect.GetBottom() : Line.Rect.GetBottom();
+				if (Band(dPairBottom, dBottom, dBandScale, nBands) != b)
+					continue;
+
+				if (  ( bPerturbOther ? Prev.Rect.Touches(  Line.Rect) :
+										Prev.Rect.Overlaps(  Line.Rect) ) &&
+						( bPerturbOther ?
+							CrossesPerturbed( *Prev.pLine, Prev.bThis, *Line.pLine, IntPt) :
+							Prev.pLine->Crosses(  *Line.pLine, &IntPt) ) )
+				{
+					const CSweepBuffer::sLineRect& LineThis = Prev.bThis ? Prev : Line;
+					const CSweepBuffer::sLineRect& LineOther = Prev.bThis ? Line : Prev;
 
-					if (pIndexesThis)
+					while (IntPt.size() >0)
 					{
-						if (Lines[j]->bSetFlag)
-							pIndexesThis->Add( Lines[j]->usIndex );
+						if (pPoints != 0)
+							pPoints->Add( IntPt.ExtractLast());
 						else
-							pIndexesThis->Add( Lines[r]->usIndex );
-					}
-					if (pIndexesOther)
-					{
-						if (Lines[j]->bSetFlag)
-							pIndexesOther->Add( Lines[r]->usIndex );
-						else
-							pIndexesOther->Add( Lines[j]->usIndex );
+							delete IntPt.ExtractLast();
+
+						if (pIndexesThis)
+							pIndexesThis->Add( LineThis.nIndex );
+						if (pIndexesOther)
+							pIndexesOther->Add( LineOther.nIndex );
 					}
 				}
 			}
-			r++;
-		}	
-		j++;
+		}
+
+		unsigned int nOwnBands = Line.bThis ? 0 : nBands;
+		for (unsigned int b = nLow; b <= nHigh; b++)
+			Bands[nOwnBands + b].push_back(Order[k]);
 	}
+}
 
 
-	unsigned int d = 0 ;
-	while (d < Lines.size())
-	{
-		delete Lines.at(d);
-		d++;
-	}
+/**--------------------------------------------------------------------------<BR>
+C2DLineBaseSet::Band
+\brief The band of the height, limited to those there are.
+<P>---------------------------------------------------------------------------*/
+unsigned int C2DLineBaseSet::Band(double dY, double dBottom, double dBandScale, unsigned int nBands)
+{
+	double dBand = (dY - dBottom) * dBandScale;
+
+	if (dBand <= 0)
+		return 0;
+	if (dBand >= nBands - 1)
+		return nBands - 1;
+
+	return (unsigned int)dBand;
 }
 
 /**--------------------------------------------------------------------------<BR>
@@ -309,19 +380,22 @@ bool C2DLineBaseSet::HasCrossingLines(void) const
 	};
 
 	// Set up an array of these structures and the left most points of the line rects
+	std::vector<sLineBaseRect> LineRects(size());
 	std::vector<sLineBaseRect*> Lines;
 	std::vector<double> xValues;
+	Lines.reserve(size());
+	xValues.reserve(size());
 
 	for (unsigned int i = 0 ; i <  size() ; i++)
 	{
-		sLineBaseRect* pLineRect = new sLineBaseRect;
+		sLineBaseRect* pLineRect = &LineRects[i];
 		pLineRect->pLine = GetAt(i);
 		pLineRect->pLine->GetBoundingRect(pLineRect->Rect);
 		Lines.push_back(pLineRect);
 		xValues.push_back(  pLineRect->Rect.GetLeft());
 	}
 	// Sort them all according to the left most point of the line rects.
-	GeoSort::PQuickSort< std::vector<double>, double, std::vector<sLineBaseRect*>, sLineBaseRect*>( xValues, Lines);
+	GeoSort::RadixSort(xValues, Lines);
 
 	unsigned int j = 0;
 	C2DPointSet IntPt;
@@ -345,13 +419,6 @@ bool C2DLineBaseSet::HasCrossingLines(void) const
 		j++;
 	}
 
-	unsigned int d = 0 ;
-	while (d < Lines.size())
-	{
-		delete Lines.at(d);
-		d++;
-	}
-
 	return bIntersect;
 }
 
@@ -385,6 +452,21 @@ bool C2DLineBaseSet::IsClosed(bool bEndsOnly) const
 }
 
 
+/**--------------------------------------------------------------------------<BR>
+C2DLineBaseSet::GetLength
+\brief Returns the total length of the lines.
+<P>---------------------------------------------------------------------------*/
+double C2DLineBaseSet::GetLength(void) const
+{
+	double dLength = 0;
+
+	for (unsigned int i = 0; i < size(); i++)
+		dLength += GetAt(i)->GetLength();
+
+	return dLength;
+}
+
+
 /**--------------------------------------------------------------------------<BR>
 C2DLineBaseSet::AddCopy
 \brief Adds a copy of the line.
@@ -22,6 +22,9 @@ File for the C2DLineBaseSet class, a collection of lines.
 #include "C2DBaseSet.h"
 #include "C2DLineBase.h"
 #include "MemoryPool.h"
+#include "C2DRect.h"
+#include "Sort.h"
+#include <vector>
 
 
 class C2DBaseSet;
@@ -42,6 +45,30 @@ class CLASS_DECLSPEC C2DLineBaseSet :  public C2DBaseSet
 public:
 	_MEMORY_POOL_DECLARATION
 
+	/// Working space for finding the intersections with another set. A caller finding
+	/// many can keep one so that once it has grown no call allocates.
+	class CSweepBuffer
+	{
+	private:
+		friend class C2DLineBaseSet;
+
+		/// A line, its bounds, its index and whether it is from this set.
+		struct sLineRect
+		{
+			C2DRect Rect;
+			const C2DLineBase* pLine;
+			unsigned int nIndex;
+			bool bThis;
+		};
+
+		/// The lines and the left of each, which they are swept in order of.
+		std::vector<sLineRect> m_Lines;
+		std::vector<double> m_Lefts;
+		GeoSort::sRadixBuffer m_Sort;
+		/// The lines of each set the sweep is on, in bands by height.
+		std::vector< std::vector<unsigned int> > m_Bands;
+	};
+
 	/// Constructor
 	C2DLineBaseSet(void);
 	/// Destructor
@@ -94,15 +121,19 @@ public:
 	/// Calls base class
 	void GetIntersections(C2DPointSet* pPoints, CIndexSet* pIndexes1 = 0, 
 			CIndexSet* pIndexes2 = 0) const;
-	/// Calls base class
+	/// Calls base class. Can treat the other as moved by an infinitesimal amount, see CPredicates.
+	/// The buffer is used for the sweep if given.
 	void GetIntersections(const C2DLineBaseSet& Other, C2DPointSet* pPoints, 
 			CIndexSet* pIndexesThis = 0, CIndexSet* pIndexesOther  = 0,
-			const C2DRect* pBoundingRectThis = 0, const C2DRect* pBoundingRectOther = 0) const;
+			const C2DRect* pBoundingRectThis = 0, const C2DRect* pBoundingRectOther = 0,
+			bool bPerturbOther = false, CSweepBuffer* pBuffer = 0) const;
 	/// True if there are crossing lines in the set.
 	bool HasCrossingLines(void) const;
 
 	/// Checks for closure i.e. it forms a closed shape.
 	bool IsClosed(bool bEndsOnly = true) const;
+	/// Returns the total length of the lines.
+	double GetLength(void) const;
 
 	/// Adds the other to this if there is a common end i.e. they can be joined up.
 	bool AddIfCommonEnd( C2DLineBaseSet& Other);
@@ -111,6 +142,9 @@ public:
 	/// Reverses the direction.
 	void ReverseDirection(void );
 
+private:
+	/// The band of the height for the bands of the scale given from the bottom.
+	static unsigned int Band(double dY, double dBottom, double dBandScale, unsigned int nBands);
 };
 
 
@@ -23,25 +23,7 @@ Implementation file for C2DPoint, a class which represents a cartesian point.
 #include "C2DRect.h"
 
 
-//_MEMORY_POOL_IMPLEMENATION(C2DPoint)
-
-
-void* C2DPoint::operator new(unsigned int)
-{
-	return ::new C2DPoint;
- }
-
-
-void C2DPoint::operator delete(void* p)
-{
-	::delete p;
-}
-
-
-void* C2DPoint::operator new(unsigned int, const char*,int)
-{
-	return ::new C2DPoint;
-}
+_MEMORY_POOL_IMPLEMENATION(C2DPoint)
 
 
 /**--------------------------------------------------------------------------<BR>
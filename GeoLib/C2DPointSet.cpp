@@ -19,6 +19,11 @@ Implementation file for C2DPointSet, a class which represents a set of points.
 #include "C2DBaseSet.h"
 #include "C2DRect.h"
 #include "C2DCircle.h"
+#include "PointWelder.h"
+#include "Predicates.h"
+#include <algorithm>
+#include <thread>
+#include <cstdint>
 
 
 _MEMORY_POOL_IMPLEMENATION(C2DPointSet)
@@ -106,7 +111,7 @@ C2DPointSet::SortByAngleFromNorth<BR>
 <P>---------------------------------------------------------------------------*/
 void C2DPointSet::SortByAngleFromNorth( const C2DPoint& Origin)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
 
 	std::vector<double> AngFromNorth;
 
@@ -116,12 +121,13 @@ void C2DPointSet::SortByAngleFromNorth( const C2DPoint& Origin)
 		AngFromNorth.push_back(Vec.AngleFromNorth());
 	}
 
-	GeoSort::PQuickSort<std::vector<double>, double, C2DBaseData, C2DBase*>(AngFromNorth, Data);
+	GeoSort::RadixSort(AngFromNorth, Data);
 }
 
 /**--------------------------------------------------------------------------<BR>
 C2DPointSet::ExtractConvexHull<BR>
-\brief Extracts the convex hull from the points given. Uses Graham's scan.
+\brief Extracts the convex hull from the points given, clockwise from the left most.
+The rest are left in the other set in their order.
 <P>---------------------------------------------------------------------------*/
 void C2DPointSet::ExtractConvexHull( C2DPointSet& Other)
 {
@@ -133,52 +139,188 @@ void C2DPointSet::ExtractConvexHull( C2DPointSet& Other)
 		return;
 	}
 
-	C2DPoint ptLeftMost = Other[0];
-	int nLeftMost = 0;
-	
-	// Find left most
-	for (unsigned int i = 1 ; i < Other.size(); i++)
+	std::vector<unsigned int> Hull;
+	Other.GetConvexHull(Hull);
+
+	// Move the hull points over leaving gaps, then close the gaps in the rest.
+	for (unsigned int i = 0; i < Hull.size(); i++)
+		Add(dynamic_cast<C2DPoint*>(Other.ExtractAndSet(Hull[i], 0)));
+
+	std::vector<C2DPoint*> Rest;
+	Rest.reserve(Other.size() - Hull.size());
+	for (unsigned int i = 0; i < Other.size(); i++)
 	{
-		C2DPoint pt = Other[i];
-		if (pt.x < ptLeftMost.x)
-		{
-			ptLeftMost = pt;
-			nLeftMost = i;
-		}
+		C2DPoint* pPoint = dynamic_cast<C2DPoint*>(Other.ExtractAndSet(i, 0));
+		if (pPoint != 0)
+			Rest.push_back(pPoint);
 	}
 
-	this->Add(Other.ExtractAt(nLeftMost));
-
-	Other.SortByAngleFromNorth( (*this)[0]);
+	Other.RemoveAll();
+	for (unsigned int i = 0; i < Rest.size(); i++)
+		Other.Add(Rest[i]);
+}
 
-	// Always add the left most and the first of the rest.
-	Add(Other.ExtractAt(0));
 
-	// Add others if needed.
-	unsigned int nIndx = 0;
+/**--------------------------------------------------------------------------<BR>
+C2DPointSet::GetConvexHull<BR>
+\brief Gets the indexes of the convex hull, clockwise from the left most point, using
+Andrew's monotone chain on a flat copy of the coordinates. The set is not changed.
+Points in line along the hull and repeats are left out.
+
+Points strictly inside the octagon of the points furthest out in x, y and the two
+diagonals cannot be on the hull, so they are dropped before the sort. Above the size for a
+thread the set is split into a run for each thread. Each run is reduced to its own
+hull at the same time and the hull of those hulls is the hull of the whole.
+<P>---------------------------------------------------------------------------*/
+void C2DPointSet::GetConvexHull(std::vector<unsigned int>& Indexes, unsigned int nThreads) const
+{
+	static const unsigned int conMinPerThread = 50000;
 
-	C2DPointSet Unused;
+	Indexes.clear();
 
-	while (nIndx < Other.size())
-	{
-			unsigned int nLast = size() - 1;
-			C2DLine LastLine( (*this)[nLast-1], (*this)[nLast]);
+	unsigned int nCount = size();
+	if (nCount == 0)
+		return;
 
-			C2DVector Test((*this)[nLast], Other[nIndx]);
+	if (nThreads > nCount / conMinPerThread)
+		nThreads = nCount / conMinPerThread;
+	if (nThreads < 1)
+		nThreads = 1;
 
-			double dAng = Test.AngleFromNorth();
+	std::vector< std::vector<sHullPoint> > Runs(nThreads);
 
-			if (dAng < LastLine.vector.AngleFromNorth())
+	struct sRun
+	{
+		const C2DPointSet* pSet;
+		std::vector<sHullPoint>* pRun;
+		unsigned int nStart;
+		unsigned int nEnd;
+		void operator()() const
+		{
+			std::vector<sHullPoint>& Run = *pRun;
+			Run.resize(nEnd - nStart);
+			// The extremes clockwise from the left in x, y - x, y, x + y, x, x - y, -y, -x - y.
+			unsigned int Extreme[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+			for (unsigned int i = nStart; i < nEnd; i++)
 			{
-				Unused.Add( ExtractAt(nLast) );
+				// Only points are ever added so no need to check the type.
+				const C2DPoint* pPoint = static_cast<const C2DPoint*>(pSet->C2DBaseSet::GetAt(i));
+				unsigned int n = i - nStart;
+				sHullPoint& Pt = Run[n];
+				Pt.x = pPoint->x;
+				Pt.y = pPoint->y;
+				Pt.pPoint = pPoint;
+				Pt.nIndex = i;
+				if (Pt.x < Run[Extreme[0]].x) Extreme[0] = n;
+				if (Pt.y - Pt.x > Run[Extreme[1]].y - Run[Extreme[1]].x) Extreme[1] = n;
+				if (Pt.y > Run[Extreme[2]].y) Extreme[2] = n;
+				if (Pt.x + Pt.y > Run[Extreme[3]].x + Run[Extreme[3]].y) Extreme[3] = n;
+				if (Pt.x > Run[Extreme[4]].x) Extreme[4] = n;
+				if (Pt.x - Pt.y > Run[Extreme[5]].x - Run[Extreme[5]].y) Extreme[5] = n;
+				if (Pt.y < Run[Extreme[6]].y) Extreme[6] = n;
+				if (Pt.x + Pt.y < Run[Extreme[7]].x + Run[Extreme[7]].y) Extreme[7] = n;
 			}
-			else
+
+			// Drop the points strictly inside the extremes before sorting. The sums
+			// only pick the corners, being inside is decided exactly.
+			const C2DPoint* Corners[8];
+			for (int q = 0; q < 8; q++)
+				Corners[q] = Run[Extreme[q]].pPoint;
+			unsigned int nKept = 0;
+			for (unsigned int n = 0; n < Run.size(); n++)
 			{
-				Add(Other.ExtractAt(nIndx));
+				const C2DPoint& pt = *Run[n].pPoint;
+				bool bInside = true;
+				for (int q = 0; q < 8 && bInside; q++)
+					bInside = CPredicates::Orient2D(*Corners[q], *Corners[(q + 1) % 8], pt) < 0;
+				if (!bInside)
+					Run[nKept++] = Run[n];
 			}
+			Run.resize(nKept);
+
+			MonotoneChain(Run);
+		}
+	};
+
+	std::vector<std::thread> Threads;
+	for (unsigned int t = 0; t < nThreads; t++)
+	{
+		sRun Run = { this, &Runs[t], (unsigned int)((uint64_t)nCount * t / nThreads),
+					(unsigned int)((uint64_t)nCount * (t + 1) / nThreads) };
+		if (t + 1 < nThreads)
+			Threads.push_back(std::thread(Run));
+		else
+			Run();
+	}
+	for (unsigned int t = 0; t < Threads.size(); t++)
+		Threads[t].join();
+
+	std::vector<sHullPoint>& Hull = Runs[0];
+	if (nThreads > 1)
+	{
+		for (unsigned int t = 1; t < nThreads; t++)
+			Hull.insert(Hull.end(), Runs[t].begin(), Runs[t].end());
+		MonotoneChain(Hull);
+	}
+
+	Indexes.resize(Hull.size());
+	for (unsigned int i = 0; i < Hull.size(); i++)
+		Indexes[i] = Hull[i].nIndex;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPointSet::MonotoneChain<BR>
+\brief Sorts the points left to right and replaces them with the upper chain then the
+lower chain back, so the hull goes clockwise from the left most. A point is dropped
+unless the chain turns right at it, decided exactly by CPredicates.
+<P>---------------------------------------------------------------------------*/
+void C2DPointSet::MonotoneChain(std::vector<sHullPoint>& Points)
+{
+	struct sLeftToRight
+	{
+		bool operator()(const sHullPoint& Pt1, const sHullPoint& Pt2) const
+		{ return Pt1.x < Pt2.x || (Pt1.x == Pt2.x && (Pt1.y < Pt2.y ||
+			(Pt1.y == Pt2.y && Pt1.nIndex < Pt2.nIndex)));}
+	};
+
+	std::sort(Points.begin(), Points.end(), sLeftToRight());
+
+	// Keep only the first of points which are exactly the same.
+	unsigned int nCount = 0;
+	for (unsigned int i = 0; i < Points.size(); i++)
+	{
+		if (nCount == 0 || Points[i].x != Points[nCount - 1].x || Points[i].y != Points[nCount - 1].y)
+			Points[nCount++] = Points[i];
+	}
+	Points.resize(nCount);
+
+	if (nCount < 3)
+		return;
+
+	std::vector<sHullPoint> Hull(nCount * 2);
+	unsigned int k = 0;
+
+	// The upper chain left to right.
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		while (k >= 2 && CPredicates::Orient2D(*Hull[k - 2].pPoint, *Hull[k - 1].pPoint, *Points[i].pPoint) >= 0)
+			k--;
+		Hull[k++] = Points[i];
 	}
 
-	Other << Unused;	
+	// The lower chain right to left.
+	unsigned int nUpper = k + 1;
+	for (int i = (int)nCount - 2; i >= 0; i--)
+	{
+		while (k >= nUpper && CPredicates::Orient2D(*Hull[k - 2].pPoint, *Hull[k - 1].pPoint, *Points[i].pPoint) >= 0)
+			k--;
+		Hull[k++] = Points[i];
+	}
+
+	// The last is the left most again.
+	Hull.resize(k - 1);
+	Points.swap(Hull);
 }
 
 /**--------------------------------------------------------------------------<BR>
@@ -425,30 +567,35 @@ unsigned int C2DPointSet::GetFurthestPoint(unsigned int nIndex, double& dDist) c
 
 /**--------------------------------------------------------------------------<BR>
 C2DPointSet::RemoveRepeatedPoints<BR>
-\brief Removes repeated points from the set.
+\brief Removes repeated points from the set, keeping the first of each. The points
+are welded with a hash of a grid so only those near each other are compared.
 <P>---------------------------------------------------------------------------*/
 void C2DPointSet::RemoveRepeatedPoints(void)
 {
 	if (size() < 2)
 		return;
 
-	unsigned int i = 0;
-	while (i < size())
+	C2DRect Bounds;
+	GetBoundingRect(Bounds);
+
+	CPointWelder Welder;
+	Welder.Reset(Bounds, size());
+
+	// Take every point out and put back only those which start a new weld.
+	std::vector<C2DPoint*> Kept;
+	Kept.reserve(size());
+	for (unsigned int i = 0; i < size(); i++)
 	{
-		unsigned int r = i + 1;
-		while (r < size())
-		{
-			if ( (*GetAt(i)) == (*GetAt(r)))
-			{
-				DeleteAt(r);
-			}
-			else
-			{
-				r++;
-			}
-		}
-		i++;
+		C2DPoint* pPoint = dynamic_cast<C2DPoint*>(ExtractAndSet(i, 0));
+		if (Welder.Add(*pPoint) == Kept.size())
+			Kept.push_back(pPoint);
+		else
+			delete pPoint;
 	}
+
+	RemoveAll();
+	for (unsigned int i = 0; i < Kept.size(); i++)
+		Add(Kept[i]);
 }
 
 /**--------------------------------------------------------------------------<BR>
@@ -459,7 +606,7 @@ each other.
 <P>---------------------------------------------------------------------------*/
 void C2DPointSet::SortByAngleToRight( const C2DLine& Line)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
 
 
 	std::vector<double> Angs;
@@ -470,7 +617,7 @@ void C2DPointSet::SortByAngleToRight( const C2DLine& Line)
 		Angs.push_back( Line.vector.AngleToRight( vec ));
 	}
 
-	GeoSort::PQuickSort< std::vector<double>, double, C2DBaseData, C2DBase*>(Angs, Data);
+	GeoSort::RadixSort(Angs, Data);
 }
 
 
@@ -482,7 +629,7 @@ each other.
 <P>---------------------------------------------------------------------------*/
 void C2DPointSet::SortByAngleToLeft( const C2DLine& Line)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
 
 	std::vector<double> Angs;
 
@@ -492,7 +639,7 @@ void C2DPointSet::SortByAngleToLeft( const C2DLine& Line)
 		Angs.push_back( Line.vector.AngleToLeft( vec ));
 	}
 
-	GeoSort::PQuickSort< std::vector<double>, double, C2DBaseData, C2DBase*>(Angs, Data);
+	GeoSort::RadixSort(Angs, Data);
 
 }
 
@@ -614,7 +761,7 @@ double C2DPointSet::GetClosestPair(unsigned int& nIndex1, unsigned int& nIndex2)
 	}
 
 	// Sort them all according to the left most point of the line rects.
-	GeoSort::PQuickSort< std::vector<double>, double, std::vector<sPointIndex*>, sPointIndex*>( xValues, Pts);
+	GeoSort::RadixSort(xValues, Pts);
 
 	double dResult = C2DPointSet::GetClosestPair(Pts, nIndex1, nIndex2);
 
@@ -632,7 +779,7 @@ C2DPointSet::SortLeftToRight<BR>
 <P>---------------------------------------------------------------------------*/
 void C2DPointSet::SortLeftToRight(void)
 {
-	C2DBaseData& Data = *reinterpret_cast<C2DBaseData*>(m_Data);
+	C2DBaseData& Data = GetData();
 
 	std::vector<double> dLefts;
 
@@ -641,6 +788,6 @@ void C2DPointSet::SortLeftToRight(void)
 		dLefts.push_back( this->GetAt(i)->x);
 	}
 
-	GeoSort::PQuickSort<std::vector<double>, double, C2DBaseData, C2DBase*>(dLefts, Data);
+	GeoSort::RadixSort(dLefts, Data);
 
 }
@@ -24,6 +24,7 @@ sorting functions and a convex hull algorithm.
 #include "C2DBaseSet.h"
 #include "C2DPoint.h"
 #include "MemoryPool.h"
+#include <vector>
 
 
 
@@ -99,6 +100,9 @@ public:
 
 	/// Removes the convex hull from the point set given.
 	void ExtractConvexHull( C2DPointSet& Other);
+	/// Gets the indexes of the points on the convex hull going clockwise from the left
+	/// most. Large sets are split over the threads given and the hulls merged.
+	void GetConvexHull(std::vector<unsigned int>& Indexes, unsigned int nThreads = 1) const;
 	/// Sorts by the angle from north relative to the origin given.
 	void SortByAngleFromNorth( const C2DPoint& Origin);
 	/// Sorts by the angle to the right of the line.
@@ -129,6 +133,17 @@ private:
 	/// Gets the closts pair of points in the set.
 	static double GetClosestPair(PointIndexSet& Pts, unsigned int& nIndex1, unsigned int& nIndex2);
 
+	/// A point for the hull, its coordinates copied out so the sort is on flat data.
+	struct sHullPoint
+	{
+		double x;
+		double y;
+		const C2DPoint* pPoint;
+		unsigned int nIndex;
+	};
+	/// Sorts the points and replaces them with their hull, clockwise from the left most.
+	static void MonotoneChain(std::vector<sHullPoint>& Points);
+
 };
 
 
@@ -101,6 +101,8 @@ void C2DPolyArc::LineTo(const C2DPoint& Point, double dRadius,
 	if (m_Lines.size() == 0)
 		return;
 
+	InvalidateProperties();
+
 	C2DArc* pLine = new C2DArc( m_Lines.GetLast()->GetPointTo(), Point, 
 								dRadius, bCentreOnRight, bArcOnRight);
 
@@ -124,6 +126,8 @@ void C2DPolyArc::LineTo(const C2DPoint& Point)
 	if (m_Lines.size() == 0)
 		return;
 
+	InvalidateProperties();
+
 	C2DLine* pLine = new C2DLine( m_Lines.GetLast()->GetPointTo(), Point );
 
 	if (m_Lines.size() == 1 && m_Lines[0].GetType() == C2DBase::StraightLine &&
@@ -233,6 +237,10 @@ C2DPoint C2DPolyArc::GetCentroid(void) const
 {
 	// Find the centroid and area of the straight line polygon.
 	C2DPoint Centroid(0, 0);
+
+	if (GetCachedCentroid(Centroid))
+		return Centroid;
+
 	C2DPoint pti;
 	C2DPoint ptii;
 	double dArea = 0;
@@ -277,6 +285,8 @@ C2DPoint C2DPolyArc::GetCentroid(void) const
 
 	Centroid = Centroid / dTotalArea;
 
+	SetCachedCentroid(Centroid);
+
 	return Centroid;
 
 }
@@ -95,7 +95,7 @@ public:
 	void GetOverlaps(const C2DPolyArc& Other, C2DHoledPolyBaseSet& Polygons,
 										CGrid::eDegenerateHandling eDegen = CGrid::None) const ;
 
-	/// Returns the centroid.
+	/// Returns the centroid. Worked out once until the lines change.
 	C2DPoint GetCentroid(void) const;
 
 	/// Rotates the polygon to the right around the origin given.
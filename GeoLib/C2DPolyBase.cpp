@@ -27,6 +27,10 @@ is a closed set of lines of some sort.
 #include "C2DPointSet.h"
 #include "C2DSegment.h"
 #include "Sort.h"
+#include "GeoArena.h"
+#include "C2DRectTree.h"
+#include "Predicates.h"
+#include "SegmentSweep.h"
 
 
 _MEMORY_POOL_IMPLEMENATION(C2DPolyBase)
@@ -36,7 +40,8 @@ _MEMORY_POOL_IMPLEMENATION(C2DPolyBase)
 C2DPolyBase::C2DPolyBase <BR>
 \brief Constructor.
 <P>---------------------------------------------------------------------------*/
-C2DPolyBase::C2DPolyBase(void) : C2DBase(PolyBase)
+C2DPolyBase::C2DPolyBase(void) : C2DBase(PolyBase), m_pLineTree(0), m_nCached(0),
+	m_dAreaSigned(0), m_dPerimeter(0), m_dCentroidX(0), m_dCentroidY(0)
 {
 
 }
@@ -45,19 +50,31 @@ C2DPolyBase::C2DPolyBase(void) : C2DBase(PolyBase)
 C2DPolyBase::C2DPolyBase <BR>
 \brief Constructor.
 <P>---------------------------------------------------------------------------*/
-C2DPolyBase::C2DPolyBase(const C2DPolyBase& Other): C2DBase(PolyBase)
+C2DPolyBase::C2DPolyBase(const C2DPolyBase& Other): C2DBase(PolyBase), m_pLineTree(0),
+	m_nCached(0), m_dAreaSigned(0), m_dPerimeter(0), m_dCentroidX(0), m_dCentroidY(0)
 {
 	Set(Other);	
 }
 
 
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::C2DPolyBase <BR>
+\brief Constructor. Takes the lines of the other leaving it empty.
+<P>---------------------------------------------------------------------------*/
+C2DPolyBase::C2DPolyBase(C2DPolyBase&& Other): C2DBase(PolyBase), m_pLineTree(0),
+	m_nCached(0), m_dAreaSigned(0), m_dPerimeter(0), m_dCentroidX(0), m_dCentroidY(0)
+{
+	Take(Other);
+}
+
+
 /**--------------------------------------------------------------------------<BR>
 C2DPolyBase::~C2DPolyBase <BR>
 \brief Destructor.
 <P>---------------------------------------------------------------------------*/
 C2DPolyBase::~C2DPolyBase(void)
 {
-
+	InvalidateLineTree();
 }
 
 
@@ -78,6 +95,19 @@ const C2DLineBase* C2DPolyBase::GetLine(unsigned int i) const
 }
 
 
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::SetLineAttributes <BR>
+\brief Sets the attributes of the line. Cyclic past the last line.
+<P>---------------------------------------------------------------------------*/
+void C2DPolyBase::SetLineAttributes(unsigned int i, unsigned int nAttributes)
+{
+	unsigned int nLines = m_Lines.size();
+
+	if (nLines != 0)
+		m_Lines[i % nLines].SetAttributes(nAttributes);
+}
+
+
 
 /**--------------------------------------------------------------------------<BR>
 C2DPolyBase::GetLineRect <BR>
@@ -93,15 +123,381 @@ const C2DRect* C2DPolyBase::GetLineRect(unsigned int i) const
 	return &m_LineRects[i % nLinesRects];
 }
 
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::GetLineTree <BR>
+\brief Returns the tree over the line rects, building it on first use. Returns 0 if
+there are too few lines for it to help or the rects do not match the lines. If two
+threads build it at once the first one published is kept.
+<P>---------------------------------------------------------------------------*/
+const C2DRectTree* C2DPolyBase::GetLineTree(void) const
+{
+	unsigned int nCount = m_LineRects.size();
+
+	if (nCount < _LINE_TREE_MIN_LINES || nCount != m_Lines.size())
+		return 0;
+
+	C2DRectTree* pTree = m_pLineTree.load(std::memory_order_acquire);
+
+	if (pTree == 0)
+	{
+		C2DRectTree* pNewTree = new C2DRectTree(m_LineRects);
+
+		if (m_pLineTree.compare_exchange_strong(pTree, pNewTree,
+				std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			pTree = pNewTree;
+		}
+		else
+		{
+			delete pNewTree;
+		}
+	}
+
+	if (pTree->GetItemCount() != nCount)
+		return 0;
+
+	return pTree;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::InvalidateLineTree <BR>
+\brief Discards the line tree so it is rebuilt from the new rects when next used. The
+properties go too as the lines have changed with the rects.
+<P>---------------------------------------------------------------------------*/
+void C2DPolyBase::InvalidateLineTree(void)
+{
+	delete m_pLineTree.exchange(0, std::memory_order_acq_rel);
+
+	InvalidateProperties();
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::InvalidateProperties <BR>
+\brief Discards the cached properties so they are worked out again when next used.
+<P>---------------------------------------------------------------------------*/
+void C2DPolyBase::InvalidateProperties(void)
+{
+	m_nCached.store(0, std::memory_order_release);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::GetCachedProperties <BR>
+\brief Copies out the cached properties with the flags for those held.
+<P>---------------------------------------------------------------------------*/
+void C2DPolyBase::GetCachedProperties(sProperties& Properties) const
+{
+	Properties.nCached = m_nCached.load(std::memory_order_acquire);
+	Properties.dAreaSigned = m_dAreaSigned.load(std::memory_order_relaxed);
+	Properties.dPerimeter = m_dPerimeter.load(std::memory_order_relaxed);
+	Properties.ptCentroid.Set(m_dCentroidX.load(std::memory_order_relaxed),
+							  m_dCentroidY.load(std::memory_order_relaxed));
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::SetCachedProperties <BR>
+\brief Holds the properties given in place of those held. Only those flagged are used.
+<P>---------------------------------------------------------------------------*/
+void C2DPolyBase::SetCachedProperties(const sProperties& Properties) const
+{
+	m_dAreaSigned.store(Properties.dAreaSigned, std::memory_order_relaxed);
+	m_dPerimeter.store(Properties.dPerimeter, std::memory_order_relaxed);
+	m_dCentroidX.store(Properties.ptCentroid.x, std::memory_order_relaxed);
+	m_dCentroidY.store(Properties.ptCentroid.y, std::memory_order_relaxed);
+	m_nCached.store(Properties.nCached, std::memory_order_release);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::GetCachedCentroid <BR>
+\brief Returns the centroid if it is held. Derived classes work it out.
+<P>---------------------------------------------------------------------------*/
+bool C2DPolyBase::GetCachedCentroid(C2DPoint& ptCentroid) const
+{
+	if ((m_nCached.load(std::memory_order_acquire) & CachedCentroid) == 0)
+		return false;
+
+	ptCentroid.Set(m_dCentroidX.load(std::memory_order_relaxed),
+				   m_dCentroidY.load(std::memory_order_relaxed));
+	return true;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::SetCachedCentroid <BR>
+\brief Holds the centroid. Threads working it out at once store the same value.
+<P>---------------------------------------------------------------------------*/
+void C2DPolyBase::SetCachedCentroid(const C2DPoint& ptCentroid) const
+{
+	m_dCentroidX.store(ptCentroid.x, std::memory_order_relaxed);
+	m_dCentroidY.store(ptCentroid.y, std::memory_order_relaxed);
+	m_nCached.fetch_or(CachedCentroid, std::memory_order_release);
+}
+
 /**--------------------------------------------------------------------------<BR>
 C2DPolyBase::Contains <BR>
-\brief True if the point is contained.
+\brief True if the point is contained. Points within a tolerance relative to the
+size of the coordinates of a line are inside, as for point equality.
 <P>---------------------------------------------------------------------------*/
 bool C2DPolyBase::Contains(const C2DPoint& pt) const
 {
-	if (!m_BoundingRect.Contains(pt))
+	return Contains(pt, conEqualityTolerance * (fabs(pt.x) > fabs(pt.y) ? fabs(pt.x) : fabs(pt.y)));
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::Contains <BR>
+\brief True if the point is contained or within the tolerance of a line. Counts the
+lines crossed by a ray going right from the point. Only the lines which may cross
+the ray are looked at, found from the line tree if there is one. Takes no memory
+and sorts nothing.
+<P>---------------------------------------------------------------------------*/
+bool C2DPolyBase::Contains(const C2DPoint& pt, double dTolerance) const
+{
+	if (dTolerance < 0)
+		dTolerance = 0;
+
+	if (pt.x < m_BoundingRect.GetLeft() - dTolerance || pt.x > m_BoundingRect.GetRight() + dTolerance ||
+		pt.y < m_BoundingRect.GetBottom() - dTolerance || pt.y > m_BoundingRect.GetTop() + dTolerance)
+		return false;
+
+	assert (m_Lines.size() == m_LineRects.size());
+
+	// For each line, first checks whether the point is within the tolerance of it and if
+	// not whether a ray going right from the point crosses it. The ray test uses the sign
+	// of the cross product so needs no division. A line is counted if it has one end above
+	// the ray and one on or below it so vertices are counted once.
+	struct sPointTest
+	{
+		const C2DLineBaseSet* pLines;
+		double dX;
+		double dY;
+		double dToleranceSq;
+		bool bInside;
+		bool bOnLine;
+		bool bArc;
+
+		/// Tests the line with the index given. Returns true if no more are needed.
+		bool operator()(unsigned int nIndex)
+		{
+			const C2DLineBase& Line = (*pLines)[nIndex];
+			if (Line.GetType() != C2DBase::StraightLine)
+			{
+				bArc = true;
+				return true;
+			}
+
+			const C2DLine& Straight = static_cast<const C2DLine&>(Line);
+			double x1 = Straight.point.x;
+			double y1 = Straight.point.y;
+			double dx = Straight.vector.i;
+			double dy = Straight.vector.j;
+
+			double px = dX - x1;
+			double py = dY - y1;
+
+			double dLengthSq = dx * dx + dy * dy;
+			double t = dLengthSq > 0 ? (px * dx + py * dy) / dLengthSq : 0;
+			if (t < 0) t = 0;
+			else if (t > 1) t = 1;
+
+			double ex = px - t * dx;
+			double ey = py - t * dy;
+			if (ex * ex + ey * ey <= dToleranceSq)
+			{
+				bOnLine = true;
+				return true;
+			}
+
+			if ((y1 > dY) != (y1 + dy > dY))
+			{
+				double dCross = dx * py - px * dy;
+				if ((dCross > 0) == (dy > 0))
+					bInside = !bInside;
+			}
+
+			return false;
+		}
+	};
+
+	sPointTest Test;
+	Test.pLines = &m_Lines;
+	Test.dX = pt.x;
+	Test.dY = pt.y;
+	Test.dToleranceSq = dTolerance * dTolerance;
+	Test.bInside = false;
+	Test.bOnLine = false;
+	Test.bArc = false;
+
+	const C2DRectTree* pTree = GetLineTree();
+
+	if (pTree != 0)
+	{
+		pTree->VisitOverlapping(C2DRect(pt.x - dTolerance, pt.y + dTolerance,
+			m_BoundingRect.GetRight(), pt.y - dTolerance), Test);
+	}
+	else
+	{
+		unsigned int nCount = m_LineRects.size();
+		for (unsigned int i = 0; i < nCount; i++)
+		{
+			const C2DRect& Rect = m_LineRects[i];
+			if (Rect.GetTop() < pt.y - dTolerance || Rect.GetBottom() > pt.y + dTolerance ||
+				Rect.GetRight() < pt.x - dTolerance)
+				continue;
+
+			if (Test(i))
+				break;
+		}
+	}
+
+	if (Test.bArc)
+		return ContainsByRay(pt);
+
+	return Test.bOnLine || Test.bInside;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::Contains <BR>
+\brief Sets each result to 1 if the point is contained and 0 if not, with the same
+tolerance as for a single point. Each line is run over all the points at once in a
+loop with no branches so it can be vectorised. Lines which are entirely above or
+below all the points are skipped.
+<P>---------------------------------------------------------------------------*/
+void C2DPolyBase::Contains(const double* pX, const double* pY, size_t nCount, uint8_t* pResult) const
+{
+	if (nCount == 0)
+		return;
+
+	if (HasArcs())
+	{
+		for (size_t i = 0; i < nCount; i++)
+			pResult[i] = Contains(C2DPoint(pX[i], pY[i])) ? 1 : 0;
+		return;
+	}
+
+	double dMinY = pY[0];
+	double dMaxY = pY[0];
+	double dMaxAbs = 0;
+	for (size_t i = 0; i < nCount; i++)
+	{
+		pResult[i] = 0;
+		if (pY[i] < dMinY) dMinY = pY[i];
+		if (pY[i] > dMaxY) dMaxY = pY[i];
+		if (fabs(pX[i]) > dMaxAbs) dMaxAbs = fabs(pX[i]);
+		if (fabs(pY[i]) > dMaxAbs) dMaxAbs = fabs(pY[i]);
+	}
+
+	// No point has a larger tolerance than this.
+	double dMaxTolerance = conEqualityTolerance * dMaxAbs;
+
+	assert (m_Lines.size() == m_LineRects.size());
+
+	// Bit 0 is the crossing parity and bit 1 is set if the point is on a line.
+	unsigned int nLines = m_Lines.size();
+	for (unsigned int nLine = 0; nLine < nLines; nLine++)
+	{
+		const C2DRect& Rect = m_LineRects[nLine];
+		if (Rect.GetTop() < dMinY - dMaxTolerance || Rect.GetBottom() > dMaxY + dMaxTolerance)
+			continue;
+
+		const C2DLine& Line = static_cast<const C2DLine&>(m_Lines[nLine]);
+		const double x1 = Line.point.x;
+		const double y1 = Line.point.y;
+		const double dx = Line.vector.i;
+		const double dy = Line.vector.j;
+		const double y2 = y1 + dy;
+		const double dLengthSq = dx * dx + dy * dy;
+		const double dInvLengthSq = dLengthSq > 0 ? 1 / dLengthSq : 0;
+		const bool bUp = dy > 0;
+
+		for (size_t i = 0; i < nCount; i++)
+		{
+			const double x = pX[i];
+			const double y = pY[i];
+			const double px = x - x1;
+			const double py = y - y1;
+
+			const double ax = fabs(x);
+			const double ay = fabs(y);
+			const double dTolerance = conEqualityTolerance * (ax > ay ? ax : ay);
+
+			double t = (px * dx + py * dy) * dInvLengthSq;
+			t = t < 0 ? 0 : (t > 1 ? 1 : t);
+			const double ex = px - t * dx;
+			const double ey = py - t * dy;
+			const uint8_t nOnLine = (ex * ex + ey * ey <= dTolerance * dTolerance) ? 2 : 0;
+
+			const bool bSpans = (y1 > y) != (y2 > y);
+			const bool bRight = (dx * py - px * dy > 0) == bUp;
+			const uint8_t nCrosses = (bSpans && bRight) ? 1 : 0;
+
+			pResult[i] = (uint8_t)((pResult[i] ^ nCrosses) | nOnLine);
+		}
+	}
+
+	for (size_t i = 0; i < nCount; i++)
+		pResult[i] = pResult[i] != 0 ? 1 : 0;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::ContainsPerturbed <BR>
+\brief True if the point is contained with either the point or this moved by the
+infinitesimal vector (e, e * e). Counts the lines crossed by a ray going right from
+the point with exact predicates. The point can never be on a line so the answer is
+always inside or outside. Shapes with arcs are tested as they are.
+<P>---------------------------------------------------------------------------*/
+bool C2DPolyBase::ContainsPerturbed(const C2DPoint& pt, bool bMovePoint) const
+{
+	if (pt.x < m_BoundingRect.GetLeft() || pt.x > m_BoundingRect.GetRight() ||
+		pt.y < m_BoundingRect.GetBottom() || pt.y > m_BoundingRect.GetTop())
 		return false;
 
+	bool bMoveLines = !bMovePoint;
+	bool bInside = false;
+
+	for (unsigned int i = 0; i < m_Lines.size(); i++)
+	{
+		const C2DRect& Rect = m_LineRects[i];
+		if (Rect.GetTop() < pt.y || Rect.GetBottom() > pt.y || Rect.GetRight() < pt.x)
+			continue;
+
+		if (m_Lines[i].GetType() != C2DBase::StraightLine)
+			return Contains(pt);
+
+		const C2DLine& Line = static_cast<const C2DLine&>(m_Lines[i]);
+		C2DPoint ptFrom = Line.point;
+		C2DPoint ptTo = Line.GetPointTo();
+
+		bool bFromAbove = CPredicates::IsAbovePerturbed(ptFrom, bMoveLines, pt, bMovePoint);
+		bool bToAbove = CPredicates::IsAbovePerturbed(ptTo, bMoveLines, pt, bMovePoint);
+
+		if (bFromAbove != bToAbove)
+		{
+			int nSide = CPredicates::Orient2DPerturbed(ptFrom, bMoveLines, ptTo, bMoveLines,
+													pt, bMovePoint);
+			if ((nSide > 0) == bToAbove)
+				bInside = !bInside;
+		}
+	}
+
+	return bInside;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::ContainsByRay <BR>
+\brief True if the point is contained. Casts a ray and counts the intersections. Used
+when there are arcs.
+<P>---------------------------------------------------------------------------*/
+bool C2DPolyBase::ContainsByRay(const C2DPoint& pt) const
+{
 	C2DPointSet IntersectedPts;
 
 	C2DLine Ray(pt, C2DVector(m_BoundingRect.Width(), 0.000001)); // Make sure to leave
@@ -131,13 +527,68 @@ bool C2DPolyBase::Contains(const C2DPoint& pt) const
 
 /**--------------------------------------------------------------------------<BR>
 C2DPolyBase::HasCrossingLines <BR>
-\brief True if there are crossing lines.
+\brief True if there are crossing lines. Straight lines are swept, stopping at the
+first crossing, and lines meeting anywhere other than where they join count. Arcs
+are tested against the lines near them.
 <P>---------------------------------------------------------------------------*/
 bool C2DPolyBase::HasCrossingLines(void) const
 {
 	assert (m_Lines.size() == m_LineRects.size());
-	return m_Lines.HasCrossingLines();
 
+	for (unsigned int i = 0; i < m_Lines.size(); i++)
+	{
+		if (m_Lines[i].GetType() != C2DBase::StraightLine)
+			return m_Lines.HasCrossingLines();
+	}
+
+	CSegmentSweep Sweep;
+	Sweep.AddPoly(*this);
+
+	return Sweep.HasCrossing();
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::GetSelfIntersections <BR>
+\brief Gets the points where lines cross, touch or lie along each other other than
+lines meeting where they join, found in one sweep. The indexes of each pair of lines
+are added to those given, the lower first. Lines lying along each other have the
+point where they first meet going left to right.
+<P>---------------------------------------------------------------------------*/
+void C2DPolyBase::GetSelfIntersections(C2DPointSet* pPoints, CIndexSet* pIndexes1,
+			CIndexSet* pIndexes2) const
+{
+	CSegmentSweep Sweep;
+	Sweep.AddPoly(*this);
+
+	std::vector<CSegmentSweep::sCrossing> Crossings;
+	Sweep.GetCrossings(Crossings);
+
+	for (unsigned int i = 0; i < Crossings.size(); i++)
+	{
+		if (pPoints != 0)
+			pPoints->AddCopy(Crossings[i].pt);
+		if (pIndexes1 != 0)
+			pIndexes1->Add(Crossings[i].nLine1);
+		if (pIndexes2 != 0)
+			pIndexes2->Add(Crossings[i].nLine2);
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::MakeSimple <BR>
+\brief Adds the shapes made by splitting this where its lines cross to the set. The
+lines are split at every crossing in one sweep and the pieces bounding the inside,
+as given by the fill rule, are joined into rims and holes. Lines are taken as
+straight so arcs become their chords.
+<P>---------------------------------------------------------------------------*/
+void C2DPolyBase::MakeSimple(C2DHoledPolyBaseSet& Pieces, CPlaneSweep::eFillRule eFill) const
+{
+	CPlaneSweep Sweep;
+	Sweep.AddSubject(*this);
+
+	Sweep.Execute(CPlaneSweep::Union, Pieces, eFill);
 }
 
 
@@ -153,13 +604,41 @@ double C2DPolyBase::Distance(const C2DLineBase& Line) const
 	double dMin = m_Lines[0].Distance(Line);
 	double dDist;
 
-	for (unsigned int i = 1 ; i < m_Lines.size(); i++)
+	const C2DRectTree* pTree = GetLineTree();
+
+	if (pTree != 0)
 	{
-		dDist = m_Lines[i].Distance(Line);
-		if (dDist == 0 )
+		// Only lines whose rects are nearer than the best so far are measured.
+		struct sLineMeasure
+		{
+			const C2DLineBaseSet* pLines;
+			const C2DLineBase* pLine;
+			C2DRect LineRect;
+			double Bound(double dMinX, double dMinY, double dMaxX, double dMaxY)
+				{ return C2DRectTree::BoxDistance(dMinX, dMinY, dMaxX, dMaxY, LineRect);}
+			double Distance(unsigned int nIndex)
+				{ return (*pLines)[nIndex].Distance(*pLine);}
+		};
+
+		sLineMeasure Measure;
+		Measure.pLines = &m_Lines;
+		Measure.pLine = &Line;
+		Line.GetBoundingRect(Measure.LineRect);
+
+		dMin = pTree->GetNearest(Measure, dMin);
+		if (dMin == 0)
 			return 0;
-		if (dDist < dMin)
-			dMin = dDist;
+	}
+	else
+	{
+		for (unsigned int i = 1 ; i < m_Lines.size(); i++)
+		{
+			dDist = m_Lines[i].Distance(Line);
+			if (dDist == 0 )
+				return 0;
+			if (dDist < dMin)
+				dMin = dDist;
+		}
 	}
 
 	if ( Contains(Line.GetPointFrom()))
@@ -189,68 +668,121 @@ double C2DPolyBase::Distance(const C2DPolyBase& Other,
 	if (m_Lines.size() != m_LineRects.size())
 		return 0;
 
-	// First we find the closest line rect to the other's bounding rectangle.
-	unsigned int usThisClosestLineGuess = 0;
-	const C2DRect& OtherBoundingRect = Other.GetBoundingRect();
-	double dClosestDist = m_LineRects[0].Distance(OtherBoundingRect);
-	for (unsigned int i = 1; i < m_LineRects.size(); i++)
+	double dMinDistGuess;
+	C2DPoint ptOnThisTemp;
+	C2DPoint ptOnOtherTemp;
+
+	const C2DRectTree* pTree = GetLineTree();
+
+	if (pTree != 0)
 	{
-		double dDist = m_LineRects[i].Distance(OtherBoundingRect);
-		if (dDist < dClosestDist)
+		// Find the nearest of these lines to each of the other's through the tree
+		// with the best so far as the limit.
+		struct sLineMeasure
 		{
-			dClosestDist = dDist;
-			usThisClosestLineGuess = i;
+			const C2DLineBaseSet* pLines;
+			const C2DLineBase* pLine;
+			C2DRect LineRect;
+			double Bound(double dMinX, double dMinY, double dMaxX, double dMaxY)
+				{ return C2DRectTree::BoxDistance(dMinX, dMinY, dMaxX, dMaxY, LineRect);}
+			double Distance(unsigned int nIndex)
+				{ return (*pLines)[nIndex].Distance(*pLine);}
+		};
+
+		sLineMeasure Measure;
+		Measure.pLines = &m_Lines;
+
+		unsigned int usThisClosest = 0;
+		unsigned int usOtherClosest = 0;
+		dMinDistGuess = m_Lines[0].Distance(*Other.GetLine(0));
+
+		for (unsigned int j = 0; j < Other.GetLineCount() && dMinDistGuess > 0; j++)
+		{
+			Measure.pLine = Other.GetLine(j);
+			Measure.LineRect = *Other.GetLineRect(j);
+
+			unsigned int usIndex = 0;
+			double dDist = pTree->GetNearest(Measure, dMinDistGuess, &usIndex);
+			if (dDist < dMinDistGuess)
+			{
+				dMinDistGuess = dDist;
+				usThisClosest = usIndex;
+				usOtherClosest = j;
+			}
 		}
+
+		m_Lines[usThisClosest].Distance(*Other.GetLine(usOtherClosest), &ptOnThisTemp, &ptOnOtherTemp);
+
+		if (ptOnThis != 0)
+			*ptOnThis = ptOnThisTemp;
+		if (ptOnOther != 0)
+			*ptOnOther = ptOnOtherTemp;
+
+		if (dMinDistGuess == 0)
+			return 0;
 	}
-	// Now cycle through all the other poly's line rects to find the closest to the
-	// guessed at closest line on this.
-	unsigned int usOtherClosestLineGuess = 0;
-	dClosestDist = Other.GetLineRect(0)->Distance(m_LineRects[usThisClosestLineGuess]);
-	for (unsigned int j = 1; j < Other.GetLineRectCount(); j++)
+	else
 	{
-		double dDist = Other.GetLineRect(j)->Distance(m_LineRects[usThisClosestLineGuess]);
-		if (dDist < dClosestDist)
+		// First we find the closest line rect to the other's bounding rectangle.
+		unsigned int usThisClosestLineGuess = 0;
+		const C2DRect& OtherBoundingRect = Other.GetBoundingRect();
+		double dClosestDist = m_LineRects[0].Distance(OtherBoundingRect);
+		for (unsigned int i = 1; i < m_LineRects.size(); i++)
 		{
-			dClosestDist = dDist;
-			usOtherClosestLineGuess = j;
+			double dDist = m_LineRects[i].Distance(OtherBoundingRect);
+			if (dDist < dClosestDist)
+			{
+				dClosestDist = dDist;
+				usThisClosestLineGuess = i;
+			}
+		}
+		// Now cycle through all the other poly's line rects to find the closest to the
+		// guessed at closest line on this.
+		unsigned int usOtherClosestLineGuess = 0;
+		dClosestDist = Other.GetLineRect(0)->Distance(m_LineRects[usThisClosestLineGuess]);
+		for (unsigned int j = 1; j < Other.GetLineRectCount(); j++)
+		{
+			double dDist = Other.GetLineRect(j)->Distance(m_LineRects[usThisClosestLineGuess]);
+			if (dDist < dClosestDist)
+			{
+				dClosestDist = dDist;
+				usOtherClosestLineGuess = j;
+			}
 		}
-	}
-
-	// Now we have a guess at the 2 closest lines.
-	double dMinDistGuess = m_Lines[usThisClosestLineGuess].Distance(
-							*Other.GetLine(usOtherClosestLineGuess),
-							ptOnThis,
-							ptOnOther);
-	// If its 0 then return 0.
-	if (dMinDistGuess == 0)
-		return 0;
 
-	C2DPoint ptOnThisTemp;
-	C2DPoint ptOnOtherTemp;
+		// Now we have a guess at the 2 closest lines.
+		dMinDistGuess = m_Lines[usThisClosestLineGuess].Distance(
+								*Other.GetLine(usOtherClosestLineGuess),
+								ptOnThis,
+								ptOnOther);
+		// If its 0 then return 0.
+		if (dMinDistGuess == 0)
+			return 0;
 
-	// Now go through all of our line rects and only check further if they are closer
-	// to the other's bounding rect than the min guess.
-	for (unsigned int i = 0; i < m_Lines.size(); i++)
-	{
-		if (m_LineRects[i].Distance( OtherBoundingRect ) <  dMinDistGuess)
+		// Now go through all of our line rects and only check further if they are closer
+		// to the other's bounding rect than the min guess.
+		for (unsigned int i = 0; i < m_Lines.size(); i++)
 		{
-			for ( unsigned int j = 0 ; j < Other.GetLineCount() ; j++)
+			if (m_LineRects[i].Distance( OtherBoundingRect ) <  dMinDistGuess)
 			{
-				double dDist = m_Lines[i].Distance(*Other.GetLine(j),
-													&ptOnThisTemp,
-													&ptOnOtherTemp);
+				for ( unsigned int j = 0 ; j < Other.GetLineCount() ; j++)
+				{
+					double dDist = m_Lines[i].Distance(*Other.GetLine(j),
+														&ptOnThisTemp,
+														&ptOnOtherTemp);
 				
-				if (dDist < dMinDistGuess)
-				{	
-					if (ptOnThis != 0)
-						*ptOnThis = ptOnThisTemp;
-					if (ptOnOther != 0)
-						*ptOnOther = ptOnOtherTemp;
+					if (dDist < dMinDistGuess)
+					{	
+						if (ptOnThis != 0)
+							*ptOnThis = ptOnThisTemp;
+						if (ptOnOther != 0)
+							*ptOnOther = ptOnOtherTemp;
 
-					if (dDist == 0)
-						return 0;
+						if (dDist == 0)
+							return 0;
 
-					dMinDistGuess = dDist; 
+						dMinDistGuess = dDist; 
+					}
 				}
 			}
 		}
@@ -283,11 +815,35 @@ double C2DPolyBase::Distance(const C2DPoint& pt) const
 		return 0;
 
 	double dResult = m_Lines[0].Distance(pt);
-	for (unsigned int i = 1; i < m_Lines.size(); i++)
+
+	const C2DRectTree* pTree = GetLineTree();
+
+	if (pTree != 0)
+	{
+		struct sPointMeasure
+		{
+			const C2DLineBaseSet* pLines;
+			const C2DPoint* pPoint;
+			double Bound(double dMinX, double dMinY, double dMaxX, double dMaxY)
+				{ return C2DRectTree::BoxDistance(dMinX, dMinY, dMaxX, dMaxY, *pPoint);}
+			double Distance(unsigned int nIndex)
+				{ return (*pLines)[nIndex].Distance(*pPoint);}
+		};
+
+		sPointMeasure Measure;
+		Measure.pLines = &m_Lines;
+		Measure.pPoint = &pt;
+
+		dResult = pTree->GetNearest(Measure, dResult);
+	}
+	else
 	{
-		double dDist = m_Lines[i].Distance(pt);
-		if (dDist < dResult)
-			dResult = dDist;
+		for (unsigned int i = 1; i < m_Lines.size(); i++)
+		{
+			double dDist = m_Lines[i].Distance(pt);
+			if (dDist < dResult)
+				dResult = dDist;
+		}
 	}
 
 	if (Contains(pt))
@@ -302,6 +858,8 @@ C2DPolyBase::MakeBoundingRect <BR>
 <P>---------------------------------------------------------------------------*/
 void C2DPolyBase::MakeBoundingRect(void)
 {
+	InvalidateLineTree();
+
 	if ( m_LineRects.size() == 0)
 	{
 		m_BoundingRect.Clear();
@@ -309,11 +867,13 @@ void C2DPolyBase::MakeBoundingRect(void)
 	}
 	else
 	{
-		m_BoundingRect = m_LineRects[0];
+		const C2DRectSet& LineRects = m_LineRects;
+
+		m_BoundingRect = LineRects[0];
 
-		for (unsigned int i = 1 ; i  < m_LineRects.size(); i++)
+		for (unsigned int i = 1 ; i  < LineRects.size(); i++)
 		{
-			m_BoundingRect.ExpandToInclude(m_LineRects[i]);
+			m_BoundingRect.ExpandToInclude(LineRects[i]);
 		}
 	}
 }
@@ -324,6 +884,8 @@ C2DPolyBase::MakeLineRects <BR>
 <P>---------------------------------------------------------------------------*/
 void C2DPolyBase::MakeLineRects(void)
 {
+	InvalidateLineTree();
+
 	m_LineRects.DeleteAll();
 
 	unsigned int nCount = m_Lines.size();
@@ -345,6 +907,7 @@ C2DPolyBase::Clear <BR>
 <P>---------------------------------------------------------------------------*/
 void C2DPolyBase::Clear(void)
 {
+	InvalidateLineTree();
 	m_BoundingRect.Clear();
 	m_Lines.DeleteAll();
 	m_LineRects.DeleteAll();
@@ -371,6 +934,27 @@ bool C2DPolyBase::IsWithinDistance(const C2DPoint& pt, double dRange) const
 	if (this->Contains(pt))
 		return true;
 
+	const C2DRectTree* pTree = GetLineTree();
+
+	if (pTree != 0)
+	{
+		struct sWithin
+		{
+			const C2DLineBaseSet* pLines;
+			const C2DPoint* pPoint;
+			double dRange;
+			bool operator()(unsigned int nIndex)
+				{ return (*pLines)[nIndex].Distance(*pPoint) < dRange;}
+		};
+
+		sWithin Within;
+		Within.pLines = &m_Lines;
+		Within.pPoint = &pt;
+		Within.dRange = dRange;
+
+		return pTree->VisitOverlapping(C2DRect(pt.x - dRange, pt.y + dRange, pt.x + dRange, pt.y - dRange), Within);
+	}
+
 	for (unsigned int i = 1; i < m_Lines.size(); i++)
 	{
 		if(m_Lines[i].Distance(pt) < dRange)
@@ -386,6 +970,9 @@ C2DPolyBase::GetPerimeter <BR>
 <P>---------------------------------------------------------------------------*/
 double C2DPolyBase::GetPerimeter(void) const
 {
+	if (m_nCached.load(std::memory_order_acquire) & CachedPerimeter)
+		return m_dPerimeter.load(std::memory_order_relaxed);
+
 	double dResult = 0;
 
 	for (unsigned int i = 0; i < this->m_Lines.size(); i++)
@@ -393,13 +980,16 @@ double C2DPolyBase::GetPerimeter(void) const
 		dResult += m_Lines[i].GetLength();
 	}
 
+	m_dPerimeter.store(dResult, std::memory_order_relaxed);
+	m_nCached.fetch_or(CachedPerimeter, std::memory_order_release);
+
 	return dResult;
 }
 
 
 /**--------------------------------------------------------------------------<BR>
 C2DPolyBase::Move <BR>
-\brief Moves the shape.
+\brief Moves the shape. The cached properties are kept with the centroid moved.
 <P>---------------------------------------------------------------------------*/
 void C2DPolyBase::Move(const C2DVector& vector)
 {
@@ -409,6 +999,11 @@ void C2DPolyBase::Move(const C2DVector& vector)
 	if(m_Lines.size() != m_LineRects.size())
 		return;
 
+	sProperties Properties;
+	GetCachedProperties(Properties);
+
+	InvalidateLineTree();
+
 	for (unsigned int i = 0; i < this->m_Lines.size(); i++)
 	{
 		m_Lines[i].Move(vector);
@@ -417,12 +1012,14 @@ void C2DPolyBase::Move(const C2DVector& vector)
 
 	m_BoundingRect.Move(vector);
 
+	Properties.ptCentroid.Move(vector);
+	SetCachedProperties(Properties);
 }
 
 
 /**--------------------------------------------------------------------------<BR>
 C2DPolyBase::RotateToRight <BR>
-\brief Moves the shape.
+\brief Rotates the shape. The cached properties are kept with the centroid rotated.
 <P>---------------------------------------------------------------------------*/
 void C2DPolyBase::RotateToRight(double dAng, const C2DPoint& Origin)
 {
@@ -431,6 +1028,9 @@ void C2DPolyBase::RotateToRight(double dAng, const C2DPoint& Origin)
 	if(m_Lines.size() != m_LineRects.size())
 		return;
 
+	sProperties Properties;
+	GetCachedProperties(Properties);
+
 	for (unsigned int i = 0; i < m_Lines.size(); i++)
 	{
 		m_Lines[i].RotateToRight(dAng, Origin);
@@ -438,11 +1038,14 @@ void C2DPolyBase::RotateToRight(double dAng, const C2DPoint& Origin)
 	}
 
 	MakeBoundingRect();
+
+	Properties.ptCentroid.RotateToRight(dAng, Origin);
+	SetCachedProperties(Properties);
 }
 
 /**--------------------------------------------------------------------------<BR>
 C2DPolyBase::Grow <BR>
-\brief Grows the shape.
+\brief Grows the shape. The cached area and perimeter are scaled and the centroid grown.
 <P>---------------------------------------------------------------------------*/
 void C2DPolyBase::Grow(double dFactor, const C2DPoint& Origin)
 {
@@ -451,6 +1054,11 @@ void C2DPolyBase::Grow(double dFactor, const C2DPoint& Origin)
 	if(m_Lines.size() != m_LineRects.size())
 		return;
 
+	sProperties Properties;
+	GetCachedProperties(Properties);
+
+	InvalidateLineTree();
+
 	for (unsigned int i = 0; i < m_Lines.size(); i++)
 	{
 		m_Lines[i].Grow(dFactor, Origin);
@@ -459,11 +1067,16 @@ void C2DPolyBase::Grow(double dFactor, const C2DPoint& Origin)
 
 	m_BoundingRect.Grow(dFactor, Origin);
 
+	Properties.dAreaSigned *= dFactor * dFactor;
+	Properties.dPerimeter *= fabs(dFactor);
+	Properties.ptCentroid.Grow(dFactor, Origin);
+	SetCachedProperties(Properties);
 }
 
 /**--------------------------------------------------------------------------<BR>
 C2DPolyBase::Reflect <BR>
-\brief Reflect
+\brief Reflect. The cached properties are kept with the centroid reflected. The area
+changes sign as the direction is reversed.
 <P>---------------------------------------------------------------------------*/
 void C2DPolyBase::Reflect(const C2DPoint& point)
 {
@@ -472,6 +1085,9 @@ void C2DPolyBase::Reflect(const C2DPoint& point)
 	if(m_Lines.size() != m_LineRects.size())
 		return;
 
+	sProperties Properties;
+	GetCachedProperties(Properties);
+
 	for (unsigned int i = 0; i < m_Lines.size(); i++)
 	{
 		m_Lines[i].Reflect(point);
@@ -479,6 +1095,10 @@ void C2DPolyBase::Reflect(const C2DPoint& point)
 	ReverseDirection(); // ALSO MAKES THE LINES AGAIN.
 
 	m_BoundingRect.Reflect(point);
+
+	Properties.dAreaSigned = -Properties.dAreaSigned;
+	Properties.ptCentroid.Reflect(point);
+	SetCachedProperties(Properties);
 }
 
 
@@ -493,6 +1113,9 @@ void C2DPolyBase::Reflect(const C2DLine& Line)
 	if(m_Lines.size() != m_LineRects.size())
 		return;
 
+	sProperties Properties;
+	GetCachedProperties(Properties);
+
 	for (unsigned int i = 0; i < m_Lines.size(); i++)
 	{
 		m_Lines[i].Reflect(Line);
@@ -500,6 +1123,11 @@ void C2DPolyBase::Reflect(const C2DLine& Line)
 	ReverseDirection(); // ALSO MAKES THE LINES AGAIN.
 
 	m_BoundingRect.Reflect(Line);
+
+	// The reflection turns the winding over and reversing turns it back so the
+	// signed area is as it was.
+	Properties.ptCentroid.Reflect(Line);
+	SetCachedProperties(Properties);
 }
 
 
@@ -567,8 +1195,17 @@ bool C2DPolyBase::Crosses(const C2DLineBase& Line, C2DPointSet* IntersectionPts)
 
 	bool bResult = false;
 
-	for (unsigned int i = 0; i < this->m_Lines.size(); i++)
+	// With a tree only the lines near the line are tried, otherwise all of them.
+	const C2DRectTree* pTree = GetLineTree();
+	std::vector<unsigned int> Indexes;
+	if (pTree != 0)
+		pTree->GetOverlapping(LineRect, Indexes);
+
+	unsigned int nCount = pTree != 0 ? Indexes.size() : m_Lines.size();
+
+	for (unsigned int k = 0; k < nCount; k++)
 	{
+		unsigned int i = pTree != 0 ? Indexes[k] : k;
 		if (m_LineRects[i].Overlaps(LineRect) &&
 			m_Lines[i].Crosses(Line, &IntersectionTemp))
 		{
@@ -600,8 +1237,16 @@ bool C2DPolyBase::Crosses(const C2DLineBase &Line, C2DPointSet *IntersectionPts,
 
     bool bResult = false;
 
-    for (unsigned int i = 0; i < this->m_Lines.size(); i++)
+    const C2DRectTree* pTree = GetLineTree();
+    std::vector<unsigned int> Indexes;
+    if (pTree != 0)
+        pTree->GetOverlapping(LineRect, Indexes);
+
+    unsigned int nCount = pTree != 0 ? Indexes.size() : m_Lines.size();
+
+    for (unsigned int k = 0; k < nCount; k++)
     {
+        unsigned int i = pTree != 0 ? Indexes[k] : k;
         if (m_LineRects[i].Overlaps(LineRect) &&
             m_Lines[i].Crosses(Line, &IntersectionTemp))
         {
@@ -617,6 +1262,51 @@ bool C2DPolyBase::Crosses(const C2DLineBase &Line, C2DPointSet *IntersectionPts,
 }
 
 
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::GetCrossingLines <BR>
+\brief Adds the points where the line crosses the shape and the index of the line
+crossed for each, in the same order. Only the lines near the line are tried.
+<P>---------------------------------------------------------------------------*/
+bool C2DPolyBase::GetCrossingLines(const C2DLineBase& Line, std::vector<unsigned int>& Indexes,
+								   C2DPointSet& IntersectionPts) const
+{
+	C2DRect LineRect;
+	Line.GetBoundingRect(LineRect);
+
+	if (!m_BoundingRect.Overlaps(LineRect))
+		return false;
+
+	assert(m_Lines.size() == m_LineRects.size());
+
+	if(m_Lines.size() != m_LineRects.size())
+		return false;
+
+	const unsigned int nStart = IntersectionPts.size();
+
+	const C2DRectTree* pTree = GetLineTree();
+	std::vector<unsigned int> Near;
+	if (pTree != 0)
+		pTree->GetOverlapping(LineRect, Near);
+
+	unsigned int nCount = pTree != 0 ? Near.size() : m_Lines.size();
+
+	for (unsigned int k = 0; k < nCount; k++)
+	{
+		unsigned int i = pTree != 0 ? Near[k] : k;
+		if (!m_LineRects[i].Overlaps(LineRect))
+			continue;
+
+		unsigned int nBefore = IntersectionPts.size();
+		m_Lines[i].Crosses(Line, &IntersectionPts);
+		// An arc can cross twice so add the index for each point.
+		for (unsigned int j = nBefore; j < IntersectionPts.size(); j++)
+			Indexes.push_back(i);
+	}
+
+	return IntersectionPts.size() > nStart;
+}
+
+
 /**--------------------------------------------------------------------------<BR>
 C2DPolyBase::CrossesRay <BR>
 \brief True if the ray crosses the shape. Returns the points.
@@ -695,19 +1385,58 @@ C2DPolyBase::Set <BR>
 <P>---------------------------------------------------------------------------*/
 void C2DPolyBase::Set(const C2DPolyBase& Other)
 {
+	if (&Other == this)
+		return;
+
 	Clear();
 
-	for (unsigned int i = 0; i < Other.GetLineCount() ; i++)
-	{
-		m_Lines.AddCopy(*Other.GetLine(i));
-	}
+	// The lines and their rectangles are shared until either polygon changes them.
+	m_Lines = Other.m_Lines;
 
 	m_BoundingRect = Other.GetBoundingRect();
 
-	for (unsigned int i = 0 ; i < Other.GetLineRectCount() ; i ++)
-	{
-		m_LineRects.Add(new C2DRect(*Other.GetLineRect(i)));
-	}
+	m_LineRects = Other.m_LineRects;
+
+	sProperties Properties;
+	Other.GetCachedProperties(Properties);
+	SetCachedProperties(Properties);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::operator= <BR>
+\brief Assignment. Takes the lines of the other leaving it empty.
+<P>---------------------------------------------------------------------------*/
+const C2DPolyBase& C2DPolyBase::operator=(C2DPolyBase&& Other)
+{
+	Take(Other);
+
+	return *this;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::Take <BR>
+\brief Takes the lines of the other leaving it empty.
+<P>---------------------------------------------------------------------------*/
+void C2DPolyBase::Take(C2DPolyBase& Other)
+{
+	if (&Other == this)
+		return;
+
+	Clear();
+
+	m_Lines.Swap(Other.m_Lines);
+	m_LineRects.Swap(Other.m_LineRects);
+	m_BoundingRect = Other.GetBoundingRect();
+	m_pLineTree.store(Other.m_pLineTree.exchange(0, std::memory_order_acq_rel),
+					  std::memory_order_release);
+
+	sProperties Properties;
+	Other.GetCachedProperties(Properties);
+	SetCachedProperties(Properties);
+
+	Other.Clear();
 }
 
 
@@ -720,6 +1449,27 @@ bool C2DPolyBase::Crosses(const C2DLineBase& Line) const
 	C2DRect LineRect;
 	Line.GetBoundingRect(LineRect);
 
+	const C2DRectTree* pTree = GetLineTree();
+
+	if (pTree != 0)
+	{
+		struct sCrosses
+		{
+			const C2DPolyBase* pPoly;
+			const C2DLineBase* pLine;
+			const C2DRect* pLineRect;
+			bool operator()(unsigned int i)
+				{ return pPoly->m_LineRects[i].Overlaps( *pLineRect ) && pPoly->m_Lines[i].Crosses(*pLine);}
+		};
+
+		sCrosses Crosses;
+		Crosses.pPoly = this;
+		Crosses.pLine = &Line;
+		Crosses.pLineRect = &LineRect;
+
+		return pTree->VisitOverlapping(LineRect, Crosses);
+	}
+
 	for (unsigned int i = 0; i < this->m_Lines.size(); i++)
 	{
 		if (m_LineRects[i].Overlaps( LineRect ) &&  m_Lines[i].Crosses(Line))
@@ -796,10 +1546,13 @@ bool C2DPolyBase::Overlaps(const C2DHoledPolyBase& Other) const
 
 /**--------------------------------------------------------------------------<BR>
 C2DPolyBase::ReverseDirection <BR>
-\brief Reverses the direction of the lines.
+\brief Reverses the direction of the lines. The cached area changes sign.
 <P>---------------------------------------------------------------------------*/
 void C2DPolyBase::ReverseDirection(void)
 {
+	sProperties Properties;
+	GetCachedProperties(Properties);
+
 	m_Lines.ReverseOrder();
 
 	for (unsigned int i = 0; i < m_Lines.size() ; i++)
@@ -808,6 +1561,9 @@ void C2DPolyBase::ReverseDirection(void)
 	}	
 
 	MakeLineRects();
+
+	Properties.dAreaSigned = -Properties.dAreaSigned;
+	SetCachedProperties(Properties);
 }
 
 
@@ -918,14 +1674,33 @@ void C2DPolyBase::GetBoolean(const C2DPolyBase& Other, C2DHoledPolyBaseSet& Hole
 						bool bThisInside, bool bOtherInside, 
 						CGrid::eDegenerateHandling eDegen) const
 {
+	if (CGeoArena::GetCurrent() == 0)
+	{
+		// Build all the temporaries in the thread arena and copy out only the results.
+		CGeoArenaScope Arena;
+		C2DHoledPolyBaseSet Results;
+		GetBoolean( Other, Results, bThisInside, bOtherInside, eDegen);
+
+		Arena.Suspend();
+		for (unsigned int i = 0; i < Results.size(); i++)
+			HoledPolys.Add(new C2DHoledPolyBase( *Results.GetAt(i)));
+		return;
+	}
+
+	// The perturbed predicates are for straight lines only.
+	if (eDegen == CGrid::SymbolicPerturbation && (HasArcs() || Other.HasArcs()))
+		eDegen = CGrid::RandomPerturbation;
+
 	if (m_BoundingRect.Overlaps(Other.GetBoundingRect() ))
 	{
 		switch (eDegen)
 		{
 		case CGrid::None:
+		case CGrid::SymbolicPerturbation:
 			{
 				C2DLineBaseSetSet Routes1, Routes2;
-				C2DPolyBase::GetRoutes( *this, bThisInside, Other, bOtherInside, Routes1, Routes2);
+				C2DPolyBase::GetRoutes( *this, bThisInside, Other, bOtherInside, Routes1, Routes2,
+										eDegen == CGrid::SymbolicPerturbation);
 				Routes1 << Routes2;
 
 				if (Routes1.size() > 0)
@@ -943,6 +1718,11 @@ void C2DPolyBase::GetBoolean(const C2DPolyBase& Other, C2DHoledPolyBaseSet& Hole
 							Polygons.Add(new C2DPolyBase);
 							Polygons.GetLast()->CreateDirect( *pRoute);
 						}
+						else if (eDegen == CGrid::SymbolicPerturbation && pRoute->GetLength() == 0)
+						{
+							// Where the shapes touch the moved one overlaps by an infinitesimal
+							// amount which leaves a route collapsed to a point.
+						}
 						else
 						{
 							CGrid::LogDegenerateError();
@@ -1049,7 +1829,7 @@ void C2DPolyBase::GetRoutes(C2DPointSet& IntPts, CIndexSet& IntIndexes ,
 	if (this->GetLineCount() < 1) 
 		return;
 	// Sort the intersections by index so we can go through them in order.
-	GeoSort::PQuickSort<CIndexSet, unsigned int , C2DPointSet, C2DPoint>(IntIndexes, IntPts);
+	GeoSort::RadixSort(IntIndexes, IntPts);
 	// Set the inside / outside flag to the same as the start inside / outside flag.
 	bool bInside = bStartInside;
 	// If we are inside and want route inside or outside and want routes outside then add a new route.
@@ -1107,6 +1887,7 @@ void C2DPolyBase::GetRoutes(C2DPointSet& IntPts, CIndexSet& IntIndexes ,
 		}
 
 	}
+
 	// Put all the new routes into the provided collection.
 	Routes << NewRoutes;
 }
@@ -1118,7 +1899,8 @@ C2DPolyBase::GetRoutes<BR>
 <P>---------------------------------------------------------------------------*/
 void C2DPolyBase::GetRoutes(const C2DPolyBase& Poly1, bool bP1RoutesInside, 
 			const C2DPolyBase& Poly2, bool bP2RoutesInside, 
-			C2DLineBaseSetSet& Routes1, C2DLineBaseSetSet& Routes2)
+			C2DLineBaseSetSet& Routes1, C2DLineBaseSetSet& Routes2,
+			bool bPerturbPoly2)
 {
 		// Set up a collection of intersected points, and corresponding indexes.
 		C2DPointSet IntPoints;
@@ -1127,16 +1909,21 @@ void C2DPolyBase::GetRoutes(const C2DPolyBase& Poly1, bool bP1RoutesInside,
 		// Use the line collections in each shape to find the intersections between them.
 		Poly1.GetLines().GetIntersections( Poly2.GetLines(), &IntPoints, 
 											&Indexes1, &Indexes2,
-									&Poly1.GetBoundingRect(), &Poly2.GetBoundingRect());
+									&Poly1.GetBoundingRect(), &Poly2.GetBoundingRect(),
+									bPerturbPoly2);
 		// Make a copy of the point set because this will be sorted by line index in the 
 		// Get routes function later. We need an unsorted set for each polygon.
 		C2DPointSet IntPointsCopy;
 		IntPointsCopy.MakeCopy(IntPoints);
 
 		// Find out whether the first poly starts inside the second.
-		bool bP1StartInside = Poly2.Contains(  Poly1.GetLine(0)->GetPointFrom()  );
+		bool bP1StartInside = bPerturbPoly2 ?
+			Poly2.ContainsPerturbed(  Poly1.GetLine(0)->GetPointFrom(), false  ) :
+			Poly2.Contains(  Poly1.GetLine(0)->GetPointFrom()  );
 		// Find out if poly 2 starts inside poly 1.
-		bool bP2StartInside = Poly1.Contains(  Poly2.GetLine(0)->GetPointFrom()  );	
+		bool bP2StartInside = bPerturbPoly2 ?
+			Poly1.ContainsPerturbed(  Poly2.GetLine(0)->GetPointFrom(), true  ) :
+			Poly1.Contains(  Poly2.GetLine(0)->GetPointFrom()  );
 
 		if (IntPoints.size() == 0 && !bP1StartInside && !bP2StartInside)
 			return;	// No interaction between the 2.
@@ -1173,6 +1960,8 @@ C2DPolyBase::SnapToGrid <BR>
 <P>---------------------------------------------------------------------------*/
 void C2DPolyBase::SnapToGrid(void)
 {
+	InvalidateLineTree();
+
 	m_Lines.SnapToGrid();
 	m_LineRects.SnapToGrid();
 	m_BoundingRect.SnapToGrid();
@@ -1205,6 +1994,8 @@ unsigned int C2DPolyBase::MakeValidArcs(void)
 {
 	unsigned int nResult = 0;
 
+	InvalidateLineTree();
+
 	for (unsigned int i = 0; i < m_Lines.size(); i++)
 	{
 		C2DLineBase* pLine = m_Lines.GetAt(i);
@@ -1291,11 +2082,30 @@ double C2DPolyBase::GetArea(void) const
 }
 
 /**--------------------------------------------------------------------------<BR>
-C2DPolyArc::GetAreaSigned <BR>
+C2DPolyBase::GetAreaSigned <BR>
+\brief Returns the signed area, working it out the first time it is asked for after
+the lines change.
+<P>---------------------------------------------------------------------------*/
+double C2DPolyBase::GetAreaSigned(void) const
+{
+	if (m_nCached.load(std::memory_order_acquire) & CachedArea)
+		return m_dAreaSigned.load(std::memory_order_relaxed);
+
+	double dArea = CalculateAreaSigned();
+
+	m_dAreaSigned.store(dArea, std::memory_order_relaxed);
+	m_nCached.fetch_or(CachedArea, std::memory_order_release);
+
+	return dArea;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolyBase::CalculateAreaSigned <BR>
 \brief Calculates the area of the shape by first calculating the area of the simple
 polygon then adding or subtracting the segments defined by the arcs.
 <P>---------------------------------------------------------------------------*/
-double C2DPolyBase::GetAreaSigned(void) const
+double C2DPolyBase::CalculateAreaSigned(void) const
 {
 	double dArea = 0;
 
@@ -25,6 +25,9 @@ C2DLineBase. Lines can be of mixed type.
 #include "Grid.h"
 #include "C2DRectSet.h"
 #include "MemoryPool.h"
+#include "PlaneSweep.h"
+#include <atomic>
+#include <cstdint>
 
 
 
@@ -32,6 +35,9 @@ class C2DHoledPolyBase;
 class C2DHoledPolyBaseSet;
 class C2DPolyBaseSet;
 class C2DLineBaseSetSet;
+class C2DRectTree;
+class C2DPointSet;
+class CIndexSet;
 
 #ifdef _POLY_EXPORTING
 	#define POLY_DECLSPEC		__declspec(dllexport)
@@ -43,6 +49,10 @@ class C2DLineBaseSetSet;
 	#endif
 #endif
 
+
+#define _LINE_TREE_MIN_LINES 16 // Fewer lines than this are searched in order.
+
+
 class POLY_DECLSPEC C2DPolyBase : public C2DBase
 {
 public:
@@ -50,12 +60,18 @@ public:
 
 	/// Constructor
 	C2DPolyBase(void);
-	/// Constructor
+	/// Constructor. Shares the lines of the other until either is changed.
 	C2DPolyBase(const C2DPolyBase& Other);
+	/// Constructor. Takes the lines of the other leaving it empty.
+	C2DPolyBase(C2DPolyBase&& Other);
 	/// Destructor
 	~C2DPolyBase(void);
 	/// Assigment.
 	const C2DPolyBase& operator=(const C2DPolyBase& Other);
+	/// Assigment. Takes the lines of the other leaving it empty.
+	const C2DPolyBase& operator=(C2DPolyBase&& Other);
+	/// Takes the lines of the other leaving it empty.
+	void Take(C2DPolyBase& Other);
 	/// Assigment.
 	void Set(const C2DPolyBase& Other);
 
@@ -63,8 +79,15 @@ public:
 	void CreateDirect(C2DLineBaseSet& Lines);
 	/// Creates from the set of lines using copies.
 	void Create(const C2DLineBaseSet& Lines);
-	/// True if the point is in the shape.
+	/// True if the point is in the shape or on a line, to a tolerance relative to its coordinates.
 	bool Contains(const C2DPoint& pt) const;
+	/// True if the point is in the shape or within the tolerance of a line.
+	bool Contains(const C2DPoint& pt, double dTolerance) const;
+	/// Sets each result to 1 if the point is contained and 0 if not.
+	void Contains(const double* pX, const double* pY, size_t nCount, uint8_t* pResult) const;
+	/// True if the point is in the shape with either the point or the shape moved by an
+	/// infinitesimal amount so it is never on a line. See CPredicates.
+	bool ContainsPerturbed(const C2DPoint& pt, bool bMovePoint) const;
 	/// True if it entirely contains the other.
 	bool Contains(const C2DPolyBase& Other) const;
 	/// True if it entirely contains the other.
@@ -74,6 +97,13 @@ public:
 
 	/// True if any of the lines cross.
 	bool HasCrossingLines(void) const;
+	/// Gets the points where lines meet other than at their joins and optionally the
+	/// indexes of each pair. Lines are taken as straight so arcs become their chords.
+	void GetSelfIntersections(C2DPointSet* pPoints, CIndexSet* pIndexes1 = 0,
+			CIndexSet* pIndexes2 = 0) const;
+	/// Splits the shape where its lines cross into shapes whose lines do not, added to
+	/// the set. The fill rule decides which parts are inside.
+	void MakeSimple(C2DHoledPolyBaseSet& Pieces, CPlaneSweep::eFillRule eFill = CPlaneSweep::NonZero) const;
 	/// Distance of the point from the shape. Returns -ve if inside.
 	double Distance(const C2DPoint& pt) const;
 	/// Distance to the line.
@@ -92,13 +122,17 @@ public:
 	const C2DLineBase* GetLine(unsigned int i) const;
 	/// Returns the line set.
 	const C2DLineBaseSet& GetLines(void) const { return m_Lines;}
+	/// Sets the attributes of the line. Cyclically handles indexes over the max.
+	void SetLineAttributes(unsigned int i, unsigned int nAttributes);
 	/// Returns a pointer to the line rect.
 	const C2DRect* GetLineRect(unsigned int i) const;
 	/// number of line rectangles (should be the same as the number of lines!).
 	unsigned int GetLineRectCount(void) const {return m_LineRects.size();}
 	// Returns the number of lines.
 	unsigned int GetLineCount(void) const {return m_Lines.size();}
-	/// Calculates the perimeter.
+	/// Returns the tree over the line rects, building it if needed. 0 if there are few lines.
+	const C2DRectTree* GetLineTree(void) const;
+	/// Returns the perimeter. Worked out once until the lines change.
 	double GetPerimeter(void) const;
 
 
@@ -125,6 +159,9 @@ public:
 	bool Crosses(const C2DLineBase& Line, C2DPointSet* IntersectionPts) const;
     /// True if it crossed the line.Provides the intersection points and crossed lines
     bool Crosses(const C2DLineBase& Line,C2DPointSet* IntersectionPts,C2DLineBaseSet *IntersectionLines) const;
+	/// Adds the points where the line crosses and the index of the line crossed for each.
+	bool GetCrossingLines(const C2DLineBase& Line, std::vector<unsigned int>& Indexes,
+						  C2DPointSet& IntersectionPts) const;
 
 	/// True if it crosses the ray. Provides the intersection points.
 	bool CrossesRay(const C2DLine& Ray, C2DPointSet* IntersectionPts) const;
@@ -148,10 +185,11 @@ public:
 	// Removes all lines whose end is the same is the start. Returns the number found.
 	unsigned int RemoveNullLines(void);
 
+	/// Returns the area. Worked out once until the lines change.
 	double GetArea(void) const;
-
+	/// Returns the area signed (-ve if clockwise). Worked out once until the lines change.
 	virtual double GetAreaSigned(void) const;
-
+	/// True if the lines go clockwise.
 	bool IsClockwise(void) const;
 
 	void MakeClockwise(void);
@@ -191,10 +229,12 @@ public:
 
 	virtual void InverseTransform(CTransformation* pProject);
 
-	/// Returns the Route collections for 2 polygons.
+	/// Returns the Route collections for 2 polygons. Poly2 can be taken as moved by an
+	/// infinitesimal amount so no lines touch.
 	static void GetRoutes(const C2DPolyBase& Poly1, bool bP1RoutesInside, 
 				const C2DPolyBase& Poly2, bool bP2RoutesInside, 
-				C2DLineBaseSetSet& Routes1, C2DLineBaseSetSet& Routes2);
+				C2DLineBaseSetSet& Routes1, C2DLineBaseSetSet& Routes2,
+				bool bPerturbPoly2 = false);
 
 	/// Given a set of routes, this function converts them all to created polygon.
 	static void RoutesToPolygons(C2DPolyBaseSet& Polygons, C2DLineBaseSetSet& Routes);
@@ -208,12 +248,53 @@ protected:
 	void MakeBoundingRect(void);
 	/// Forms the bounding rectangle.
 	void MakeLineRects(void);
+	/// Discards the line tree and the cached properties. Called whenever the lines or
+	/// their rects change.
+	void InvalidateLineTree(void);
+	/// Discards the cached properties. Called whenever the lines change.
+	void InvalidateProperties(void);
+	/// Works out the signed area from the lines. Overridden where all lines are straight.
+	virtual double CalculateAreaSigned(void) const;
+
+	/// Flags for the properties held in the cache.
+	enum eCachedProperty {CachedArea = 1, CachedPerimeter = 2, CachedCentroid = 4};
+	/// The properties held in the cache with a flag set for each that is.
+	struct sProperties
+	{
+		unsigned int nCached;
+		double dAreaSigned;
+		double dPerimeter;
+		C2DPoint ptCentroid;
+	};
+	/// Copies out the properties held in the cache.
+	void GetCachedProperties(sProperties& Properties) const;
+	/// Holds the properties given in the cache in place of those held.
+	void SetCachedProperties(const sProperties& Properties) const;
+	/// Returns the centroid from the cache. False if it is not held.
+	bool GetCachedCentroid(C2DPoint& ptCentroid) const;
+	/// Holds the centroid in the cache.
+	void SetCachedCentroid(const C2DPoint& ptCentroid) const;
+
+	/// True if the point is contained, found by casting a ray. Handles arcs.
+	bool ContainsByRay(const C2DPoint& pt) const;
 	/// The lines
 	C2DLineBaseSet m_Lines;
 	/// The bounding rectangle.
 	C2DRect m_BoundingRect;
 	/// The LINE bounding rectangles.
 	C2DRectSet m_LineRects;
+	/// Tree over the line rects built on first use and shared by concurrent readers.
+	mutable std::atomic<C2DRectTree*> m_pLineTree;
+	/// Flags for the properties below, set once each is worked out. Cleared when the
+	/// lines change and carried over by moves, rotations, growing and reflecting.
+	mutable std::atomic<unsigned int> m_nCached;
+	/// The signed area.
+	mutable std::atomic<double> m_dAreaSigned;
+	/// The perimeter.
+	mutable std::atomic<double> m_dPerimeter;
+	/// The centroid, found by the derived class.
+	mutable std::atomic<double> m_dCentroidX;
+	mutable std::atomic<double> m_dCentroidY;
 };
 
 
@@ -27,6 +27,8 @@ convex or concave but doesn't contain holes.
 #include "C2DRoute.h"
 #include "Interval.h"
 #include "C2DLine.h"
+#include "Triangulator.h"
+#include <algorithm>
 
 _MEMORY_POOL_IMPLEMENATION(C2DPolygon)
 
@@ -59,6 +61,22 @@ C2DPolygon::C2DPolygon(const C2DPolygon& Other)
 	*this = Other;
 }
 
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolygon::C2DPolygon <BR>
+\brief Constructor. Takes the lines and sub areas of the other leaving it empty.
+<P>---------------------------------------------------------------------------*/
+C2DPolygon::C2DPolygon(C2DPolygon&& Other) : C2DPolyBase(std::move(Other))
+{
+	for (int i = 0; i < MAX_SUB_AREAS; i++)
+	{
+		m_SubArea[i] = Other.m_SubArea[i];
+		Other.m_SubArea[i] = 0;
+	}
+
+	m_Type = PolyLine;
+}
+
 /**--------------------------------------------------------------------------<BR>
 C2DPolygon::C2DPolygon <BR>
 \brief Constructor.
@@ -203,6 +221,9 @@ C2DPolygon::operator = <BR>
 <P>---------------------------------------------------------------------------*/
 const C2DPolygon& C2DPolygon::operator=(const C2DPolygon& Other)
 {
+	if (&Other == this)
+		return *this;
+
 	Clear();
 
 	const C2DPolygon* pSubArea = 0;
@@ -222,6 +243,29 @@ const C2DPolygon& C2DPolygon::operator=(const C2DPolygon& Other)
 }
 
 
+/**--------------------------------------------------------------------------<BR>
+C2DPolygon::operator = <BR>
+\brief Assignment. Takes the lines and sub areas of the other leaving it empty.
+<P>---------------------------------------------------------------------------*/
+const C2DPolygon& C2DPolygon::operator=(C2DPolygon&& Other)
+{
+	if (&Other == this)
+		return *this;
+
+	Clear();
+
+	for (int i = 0; i < MAX_SUB_AREAS; i++)
+	{
+		m_SubArea[i] = Other.m_SubArea[i];
+		Other.m_SubArea[i] = 0;
+	}
+
+	C2DPolyBase::Take(Other);
+
+	return *this;
+}
+
+
 /**--------------------------------------------------------------------------<BR>
 C2DPolygon::GetSubArea <BR>
 \brief Returns the sub area if created
@@ -426,7 +470,7 @@ bool C2DPolygon::CreateRegular(const C2DPoint& Centre, double dDistanceToPoints,
 
 /**--------------------------------------------------------------------------<BR>
 C2DPolygon::CreateConvexHull <BR>
-\brief Creates a convex hull from the other polygon. Uses Graham's algorithm.
+\brief Creates a convex hull from the other polygon. Uses Andrew's monotone chain.
 <P>---------------------------------------------------------------------------*/
 bool C2DPolygon::CreateConvexHull(const C2DPolygon& Other)
 {
@@ -546,7 +590,7 @@ C2DPolygon::Create <BR>
 \brief Creates from the points given.
 <P>---------------------------------------------------------------------------*/
 bool C2DPolygon::Create(const C2DPoint* pPoint, unsigned int nNumber, 
-						bool bReorderIfNeeded)
+						bool bReorderIfNeeded, double dMaxSeconds)
 {
 
 	C2DPointSet pts;
@@ -560,7 +604,7 @@ bool C2DPolygon::Create(const C2DPoint* pPoint, unsigned int nNumber,
 	}
 
 
-	return Create(pts, bReorderIfNeeded);
+	return Create(pts, bReorderIfNeeded, dMaxSeconds);
 }
 
 
@@ -612,9 +656,10 @@ bool C2DPolygon::Create(const double* pPoint, unsigned int nNumber)
 /**--------------------------------------------------------------------------<BR>
 C2DPolygon::Create <BR>
 \brief Main function which reorders the points if there are crossing lines 
-(or not if not specified) then ensures the points are ordered clockwise. 
+(or not if not specified) then ensures the points are ordered clockwise. Reordering
+stops improving the order after the seconds given, 0 for no limit.
 <P>---------------------------------------------------------------------------*/
-bool C2DPolygon::Create(const C2DPointSet& Points, bool bReorderIfNeeded)
+bool C2DPolygon::Create(const C2DPointSet& Points, bool bReorderIfNeeded, double dMaxSeconds)
 {
 	for (int i = 0; i < MAX_SUB_AREAS ; i ++)
 	{
@@ -641,7 +686,40 @@ bool C2DPolygon::Create(const C2DPointSet& Points, bool bReorderIfNeeded)
 #endif
 
     if (bReorderIfNeeded)
-        return Reorder();
+        return Reorder(dMaxSeconds);
+
+	return true;
+}
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolygon::Create <BR>
+\brief Creates from the points without reordering, setting the attributes of the
+line from each point. Missing attributes are 0. The lines keep them if the points
+are reversed to go clockwise.
+<P>---------------------------------------------------------------------------*/
+bool C2DPolygon::Create(const C2DPointSet& Points, const std::vector<unsigned int>& Attributes)
+{
+	for (int i = 0; i < MAX_SUB_AREAS ; i ++)
+	{
+		if (m_SubArea[i] != 0) 
+			delete m_SubArea[i];
+		m_SubArea[i] = 0;
+	}
+
+	if (Points.size() < 3)
+		return false;
+
+	MakeLines(Points);
+
+	for (unsigned int i = 0; i < m_Lines.size() && i < Attributes.size(); i++)
+		m_Lines[i].SetAttributes(Attributes[i]);
+
+	MakeLineRects();
+
+	if (!IsClockwise())
+		ReverseDirection();
+
+	MakeBoundingRect();
 
 	return true;
 }
@@ -682,6 +760,24 @@ void C2DPolygon::GetConvexSubAreas(C2DPolygonSet& SubAreas) const
 
 
 
+/**--------------------------------------------------------------------------<BR>
+C2DPolygon::Triangulate <BR>
+\brief Replaces the indexes with three for each triangle covering the polygon. An
+index is that of the point as given by GetPoint.
+<P>---------------------------------------------------------------------------*/
+void C2DPolygon::Triangulate(std::vector<uint32_t>& Indices) const
+{
+	unsigned int nCount = m_Lines.size();
+
+	std::vector<C2DPoint> Points(nCount);
+	for (unsigned int i = 0; i < nCount; i++)
+		Points[i] = m_Lines[i].GetPointFrom();
+
+	CTriangulator Triangulator;
+	Triangulator.Triangulate(Points.empty() ? 0 : &Points[0], nCount, 0, 0, Indices);
+}
+
+
 /**--------------------------------------------------------------------------<BR>
 C2DPolygon::CreateConvexSubAreas <BR>
 \brief Creates convex sub areas by joining inflection if possible or joining
@@ -811,11 +907,16 @@ void C2DPolygon::RotateToRight(double dAng)
 
 /**--------------------------------------------------------------------------<BR>
 C2DPolygon::GetCentroid <BR>
-\brief Returns the centroid.
+\brief Returns the centroid, working it out the first time it is asked for after the
+points change.
 <P>---------------------------------------------------------------------------*/
 const C2DPoint C2DPolygon::GetCentroid(void) const
 {
 	C2DPoint Centroid(0, 0);
+
+	if (GetCachedCentroid(Centroid))
+		return Centroid;
+
 	C2DPoint pti;
 	C2DPoint ptii;
 	double dArea = 0;
@@ -835,16 +936,18 @@ const C2DPoint C2DPolygon::GetCentroid(void) const
 	Centroid.x = Centroid.x / (6.0 * dArea);
 	Centroid.y = Centroid.y / (6.0 * dArea);
 
+	SetCachedCentroid(Centroid);
+
 	return Centroid;
 }
 
 
 
 /**--------------------------------------------------------------------------<BR>
-C2DPolygon::GetArea <BR>
-\brief Returns the area signed.
+C2DPolygon::CalculateAreaSigned <BR>
+\brief Calculates the area signed. The lines are all straight so no segments are added.
 <P>---------------------------------------------------------------------------*/
-double C2DPolygon::GetAreaSigned()  const
+double C2DPolygon::CalculateAreaSigned()  const
 {
 //	double dArea = 0;
 
@@ -985,8 +1088,10 @@ bool C2DPolygon::IsConvex(void) const
 /**--------------------------------------------------------------------------<BR>
 C2DPolygon::Reorder <BR>
 \brief Reorders the points to minimise the perimter and to remove crossing lines.
+The travelling salesman stops improving the order after the seconds given, 0 for
+no limit, and false is returned if lines may still cross.
 <P>---------------------------------------------------------------------------*/
-bool C2DPolygon::Reorder(void)
+bool C2DPolygon::Reorder(double dMaxSeconds)
 {
 	if (m_Lines.size() < 4 )
 		return true;
@@ -994,35 +1099,18 @@ bool C2DPolygon::Reorder(void)
 	C2DPointSet Points;
 	GetPointsCopy(Points);
 
-	// Make a convex hull from them.
-	C2DPointSet Hull;
-	Hull.ExtractConvexHull(Points);
-	// Close the hull.
-	Hull.AddCopy(Hull[0]);
-	// Get the bounding rect for the hull and sort the rest by the distance from it.
-	C2DRect Rect;
-	Hull.GetBoundingRect(Rect);
-	Points.SortByDistance(Rect.GetCentre(), false);
-
-	// Set up the travelling saleman and give him the route i.e. the now closed hull.
-	CTravellingSalesman TS;
-	TS.SetPointsDirect(Hull);
-
-	// Insert the rest starting with the closest (hopefully).
-	while (Points.size() > 0)
-		TS.InsertOptimally(Points.ExtractLast());
-
-	// Refine the TS.
-	TS.Refine();
-
-	// Get the points back
-	TS.ExtractPoints(Points);
+	// Get the order from the travelling salesman.
+	std::vector<unsigned int> Order;
+	bool bResult = CTravellingSalesman::OrderRoute(Points, Order, dMaxSeconds);
 
-	// Remove the closure.
-	Points.DeleteLast();
+	// Put the points in that order.
+	C2DPointSet Ordered;
+	for (unsigned int i = 0; i < Order.size(); i++)
+		Ordered.Add(dynamic_cast<C2DPoint*>(Points.ExtractAndSet(Order[i], 0)));
+	Points.RemoveAll();
 
 	// Make the lines again.
-	MakeLines(Points);
+	MakeLines(Ordered);
 	// Make the rectangles again.
 	MakeLineRects();
 	// Reverse direction if needed.
@@ -1030,66 +1118,20 @@ bool C2DPolygon::Reorder(void)
 		ReverseDirection();
 	// Remake the bounding rectangle.
 	MakeBoundingRect();
-	// Eliminate crossing lines.
-	if (!EliminateCrossingLines())
-		return false;
 
-	return true;
+	return bResult;
 }
 
 
 
-/**--------------------------------------------------------------------------<BR>
-C2DPolygon::EliminateCrossingLines <BR>
-\brief Removes crossing lines.
-<P>---------------------------------------------------------------------------*/
-bool C2DPolygon::EliminateCrossingLines(void)
-{
-	static const int conMaxIterations = 30;
-	bool bReordered = false;
-	bool bRepeat = true;
-	unsigned int nIt = 0;
-
-	while (bRepeat && nIt < conMaxIterations)
-	{
-		nIt++;
-		bRepeat = false;
-		for (unsigned int nCross1 = 0; nCross1 < m_Lines.size() ; nCross1++)
-		{
-			for (unsigned int nCross2 = nCross1 + 2; nCross2 < m_Lines.size() ; nCross2++)
-			{
-				if ( (nCross1 == 0) && (nCross2 == (m_Lines.size() - 1)) ) continue;
-
-				if (GetLineRect(nCross1)->Overlaps(*GetLineRect(nCross2)) &&
-					GetLine(nCross1)->Crosses(*GetLine(nCross2)))
-				{
-					unsigned int nSwapStart = nCross1 + 1; // end of first line
-					unsigned int nSwapEnd = nCross2;
-					assert(nSwapEnd > nSwapStart);
-					unsigned int nHalfway =	(nSwapEnd - nSwapStart) / 2;
-
-					for (unsigned int nPoint = 0; nPoint <= nHalfway; nPoint++)
-					{
-						SwapPositions( nSwapStart + nPoint, nSwapEnd - nPoint);
-					}
-					bReordered = true;	
-					bRepeat = true;
-				}
- 			}
-		}
-	}
-
-	MakeBoundingRect();
-
-	return (!bRepeat);
-}
-
 /**--------------------------------------------------------------------------<BR>
 C2DPolygon::InsertPoint <BR>
 \brief Inserts a new point in the polygon.
 <P>---------------------------------------------------------------------------*/
 void C2DPolygon::InsertPoint( unsigned int nPointIndex, const C2DPoint& Point)
 {
+	InvalidateLineTree();
+
 	if (nPointIndex >=  m_Lines.size() )
 		nPointIndex -= m_Lines.size();
 
@@ -1102,6 +1144,9 @@ void C2DPolygon::InsertPoint( unsigned int nPointIndex, const C2DPoint& Point)
 	C2DLine* pInsert = new C2DLine(Point, m_Lines[nPointIndex].GetPointFrom());
 	C2DRect* pInsertRect = new C2DRect;
 
+	// The new line is the end of the line before so it keeps its attributes.
+	pInsert->SetAttributes(m_Lines[nPointIndexBefore].GetAttributes());
+
 	pInsert->GetBoundingRect(*pInsertRect);
 
 	
@@ -1125,6 +1170,8 @@ C2DPolygon::RemovePoint <BR>
 <P>---------------------------------------------------------------------------*/
 void C2DPolygon::RemovePoint(unsigned int nPointIndex)
 {
+	InvalidateLineTree();
+
 	if (nPointIndex >=  m_Lines.size() )
 		nPointIndex -= m_Lines.size();
 
@@ -1153,6 +1200,8 @@ C2DPolygon::SetPoint <BR>
 <P>---------------------------------------------------------------------------*/
 void C2DPolygon::SetPoint(const C2DPoint& Point, unsigned int nPointIndex)
 {
+	InvalidateLineTree();
+
 	if (nPointIndex >=  m_Lines.size() )
 		nPointIndex -= m_Lines.size();
 
@@ -1182,19 +1231,6 @@ void C2DPolygon::SetPoint(const C2DPoint& Point, unsigned int nPointIndex)
 
 
 
-/**--------------------------------------------------------------------------<BR>
-C2DPolygon::SwapPositions <BR>
-\brief Swaps point positions.
-<P>---------------------------------------------------------------------------*/
-void C2DPolygon::SwapPositions(unsigned int Pos1, unsigned int Pos2)
-{
-	C2DPoint temp = *GetPoint(Pos1);
-
-	SetPoint(*GetPoint(Pos2), Pos1);
-	SetPoint(temp, Pos2);
-}
-
-
 /**--------------------------------------------------------------------------<BR>
 C2DPolygon::Move <BR>
 \brief Moves the polygon.
@@ -1332,7 +1368,7 @@ C2DPolygon::GetMinProjection <BR>
 \brief Returns the vector on which the projection of the whole set of polygons is minimal.
 Also returns the projection interval on that vector.
 <P>---------------------------------------------------------------------------*/
-void C2DPolygon::GetMinProjection(C2DPolygonSet& Polygons, C2DVector& Result, CInterval& Interval)
+void C2DPolygon::GetMinProjection(const C2DPolygonSet& Polygons, C2DVector& Result, CInterval& Interval)
 {
 	CInterval Single;
 	CInterval Combined;
@@ -1661,6 +1697,576 @@ void C2DPolygon::GetOverlaps(const C2DPolygon& Other, C2DHoledPolyBaseSet& Polyg
 
 
 
+/**--------------------------------------------------------------------------<BR>
+C2DPolygon::SplitByLine <BR>
+\brief Splits this by the infinite line through the line given. The side of every 
+vertex is found in one pass, the crossing points are sorted along the line and 
+paired into chords which are inside the polygon, then the pieces are traced by 
+walking the boundary and jumping across the chords. A run of vertices exactly on
+the line is treated as being on the side the inside is on next to it. A single
+vertex on the line is treated as being on the other side from its neighbours if
+they are both on one side, otherwise on the left. So a piece which only touches
+the line at a vertex is split there rather than pinched, and the point left on the
+other side is dropped. Crossings at the same
+point are ordered as though the line were moved a tiny distance off the vertex
+on it, towards the other end of the line crossed. Pieces to the left of the line
+are added to Left, those to the right to Right. Returns true if the line divides
+the polygon, otherwise a copy of this is added to the side it is on. A piece which
+jumps across one chord is this with the lines between the two crossed replaced, which
+is noted as it is traced so the piece can be spliced into this without comparing them.
+<P>---------------------------------------------------------------------------*/
+bool C2DPolygon::SplitByLine(const C2DLine& Line, C2DPolygonSet& Left, C2DPolygonSet& Right,
+					std::vector<sSplitSplice>* pLeftSplices,
+					std::vector<sSplitSplice>* pRightSplices) const
+{
+	unsigned int nCount = m_Lines.size();
+
+	if (nCount < 3)
+		return false;
+
+	// A vertex or a crossing point on the boundary walk.
+	struct sNode
+	{
+		const C2DPoint* pPoint;
+		C2DPoint ptCross;
+		unsigned int nPartner;
+		unsigned int nLine;
+		bool bCrossing;
+		bool bLeft;
+	};
+
+	// A crossing point position along the line.
+	struct sCrossing
+	{
+		double dPos;
+		double dTie;
+		unsigned int nNode;
+		bool operator<(const sCrossing& Other) const
+		{ return dPos < Other.dPos || (dPos == Other.dPos && dTie < Other.dTie);}
+	};
+
+	const C2DPoint& ptLine = Line.point;
+	const C2DVector& vLine = Line.vector;
+
+	std::vector<double> Sides(nCount);
+	std::vector<const C2DPoint*> Points(nCount);
+
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		Points[i] = GetPoint(i);
+		Sides[i] = vLine.i * (Points[i]->y - ptLine.y) - vLine.j * (Points[i]->x - ptLine.x);
+	}
+
+	// The side of each vertex. A run of them on the line takes the side the inside of
+	// this is on next to it. A single one takes the other side from its neighbours
+	// if they are both on one side, so a notch touching the line splits the piece.
+	std::vector<bool> Lefts(nCount, true);
+	unsigned int nOff = 0;
+	while (nOff < nCount && Sides[nOff] == 0)
+		nOff++;
+
+	bool bClockwise = nOff < nCount && IsClockwise();
+
+	for (unsigned int n = 0; n < nCount; )
+	{
+		unsigned int i = (nOff + n) % nCount;
+		if (Sides[i] != 0)
+		{
+			Lefts[i] = Sides[i] > 0;
+			n++;
+			continue;
+		}
+
+		unsigned int nRun = 0;
+		while (n + nRun < nCount && Sides[(i + nRun) % nCount] == 0)
+			nRun++;
+
+		bool bPrevLeft = Sides[(i + nCount - 1) % nCount] > 0;
+		bool bNextLeft = Sides[(i + nRun) % nCount] > 0;
+		bool bRunLeft = true;
+
+		// A run of repeated points is as a single one.
+		const C2DPoint& ptFirst = *Points[i];
+		const C2DPoint& ptLast = *Points[(i + nRun - 1) % nCount];
+		double dAlong = vLine.i * (ptLast.x - ptFirst.x) + vLine.j * (ptLast.y - ptFirst.y);
+
+		if (dAlong != 0)
+			bRunLeft = (dAlong > 0) != bClockwise;
+		else if (bPrevLeft == bNextLeft)
+			bRunLeft = !bPrevLeft;
+
+		for (unsigned int r = 0; r < nRun; r++)
+			Lefts[(i + r) % nCount] = bRunLeft;
+		n += nRun;
+	}
+
+	std::vector<sNode> Nodes;
+	Nodes.reserve(nCount * 2);
+	std::vector<sCrossing> Crossings;
+
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		unsigned int nNext = (i + 1) % nCount;
+		bool bLeft = Lefts[i];
+
+		sNode Vertex;
+		Vertex.pPoint = Points[i];
+		Vertex.nPartner = 0;
+		Vertex.nLine = i;
+		Vertex.bCrossing = false;
+		Vertex.bLeft = bLeft;
+		Nodes.push_back(Vertex);
+
+		if (bLeft == Lefts[nNext])
+			continue;
+
+		const C2DPoint& pt1 = *Points[i];
+		const C2DPoint& pt2 = *Points[nNext];
+		double dFactor = Sides[i] / (Sides[i] - Sides[nNext]);
+
+		sNode Cross;
+		if (Sides[nNext] == 0)
+			Cross.ptCross = pt2;
+		else
+			Cross.ptCross.Set(pt1.x + (pt2.x - pt1.x) * dFactor, pt1.y + (pt2.y - pt1.y) * dFactor);
+		Cross.pPoint = 0;
+		Cross.nPartner = 0;
+		Cross.nLine = i;
+		Cross.bCrossing = true;
+		Cross.bLeft = bLeft;
+
+		sCrossing Crossing;
+		Crossing.dPos = vLine.i * (Cross.ptCross.x - ptLine.x) + vLine.j * (Cross.ptCross.y - ptLine.y);
+		Crossing.dTie = 0;
+		Crossing.nNode = Nodes.size();
+
+		// If an end is on the line then order as though the line were moved slightly
+		// towards the other end.
+		if (Sides[i] == 0 || Sides[nNext] == 0)
+		{
+			const C2DPoint& ptOn = Sides[i] == 0 ? pt1 : pt2;
+			const C2DPoint& ptOff = Sides[i] == 0 ? pt2 : pt1;
+			double dSideOff = Sides[i] == 0 ? Sides[nNext] : Sides[i];
+
+			Crossing.dTie = (vLine.i * (ptOff.x - ptOn.x) + 
+							 vLine.j * (ptOff.y - ptOn.y)) / fabs(dSideOff);
+		}
+
+		Crossings.push_back(Crossing);
+		Nodes.push_back(Cross);
+	}
+
+	sSplitSplice Splice;
+	Splice.bValid = false;
+
+	if (Crossings.size() < 2)
+	{
+		if (Nodes[0].bLeft)
+		{
+			Left.AddCopy(*this);
+			if (pLeftSplices != 0)
+				pLeftSplices->push_back(Splice);
+		}
+		else
+		{
+			Right.AddCopy(*this);
+			if (pRightSplices != 0)
+				pRightSplices->push_back(Splice);
+		}
+		return false;
+	}
+
+	// The pieces are made clockwise so only go the same way as this if it is.
+	bool bSplice = (pLeftSplices != 0 || pRightSplices != 0) && IsClockwise();
+
+	std::sort(Crossings.begin(), Crossings.end());
+
+	// Consecutive crossings along the line bound the chords inside the polygon.
+	for (unsigned int i = 0; i + 1 < Crossings.size(); i += 2)
+	{
+		Nodes[Crossings[i].nNode].nPartner = Crossings[i + 1].nNode;
+		Nodes[Crossings[i + 1].nNode].nPartner = Crossings[i].nNode;
+	}
+
+	unsigned int nNodes = Nodes.size();
+	std::vector<bool> Visited(nNodes, false);
+	bool bFoundLeft = false;
+	bool bFoundRight = false;
+
+	for (unsigned int nStart = 0; nStart < nNodes; nStart++)
+	{
+		if (Nodes[nStart].bCrossing || Visited[nStart])
+			continue;
+
+		C2DPointSet PiecePoints;
+		// The attributes of the line from each point, those on the cut are 0.
+		std::vector<unsigned int> PieceAttributes;
+		unsigned int nNode = nStart;
+		unsigned int nSteps = 0;
+		unsigned int nJumps = 0;
+		unsigned int nJumpNode = 0;
+
+		do
+		{
+			const sNode& Node = Nodes[nNode];
+			const C2DPoint& pt = Node.bCrossing ? Node.ptCross : *Node.pPoint;
+
+			if (PiecePoints.size() == 0 || !(*PiecePoints.GetLast() == pt))
+			{
+				PiecePoints.AddCopy(pt);
+				PieceAttributes.push_back(0);
+			}
+			// The line from here goes along the cut or on along the edge.
+			PieceAttributes.back() = Node.bCrossing ? 0 : m_Lines[Node.nLine].GetAttributes();
+
+			if (Node.bCrossing)
+			{
+				const sNode& Partner = Nodes[Node.nPartner];
+				if (!(*PiecePoints.GetLast() == Partner.ptCross))
+				{
+					PiecePoints.AddCopy(Partner.ptCross);
+					PieceAttributes.push_back(0);
+				}
+				PieceAttributes.back() = m_Lines[Partner.nLine].GetAttributes();
+				nJumps++;
+				nJumpNode = nNode;
+				nNode = (Node.nPartner + 1) % nNodes;
+			}
+			else
+			{
+				Visited[nNode] = true;
+				nNode = (nNode + 1) % nNodes;
+			}
+			nSteps++;
+		}
+		while (nNode != nStart && nSteps <= nNodes);
+
+		if (PiecePoints.size() > 1 && PiecePoints[0] == *PiecePoints.GetLast())
+		{
+			PiecePoints.DeleteLast();
+			PieceAttributes.pop_back();
+		}
+
+		if (PiecePoints.size() < 3)
+			continue;
+
+		C2DPolygon* pPiece = new C2DPolygon;
+		pPiece->Create(PiecePoints, PieceAttributes);
+
+		// The piece runs from the end of the second line crossed round to the start of
+		// the first then across. The chain skips the points the trace did. A piece
+		// turned round to be clockwise no longer follows this.
+		Splice.bValid = false;
+		if (bSplice && nJumps == 1 && *pPiece->GetPoint(1) == PiecePoints[1])
+		{
+			const sNode& Cross = Nodes[nJumpNode];
+			const sNode& Partner = Nodes[Cross.nPartner];
+			const C2DPoint& ptEnd = *Points[(Partner.nLine + 1) % nCount];
+			C2DPoint ptLast = *Points[Cross.nLine];
+			unsigned int nChain = 0;
+
+			Splice.Attributes[0] = m_Lines[Cross.nLine].GetAttributes();
+			if (!(ptLast == Cross.ptCross))
+			{
+				ptLast = Cross.ptCross;
+				Splice.Chain[nChain++] = ptLast;
+			}
+			Splice.Attributes[nChain] = 0;
+			if (!(ptLast == Partner.ptCross))
+			{
+				ptLast = Partner.ptCross;
+				Splice.Chain[nChain++] = ptLast;
+			}
+			Splice.Attributes[nChain] = m_Lines[Partner.nLine].GetAttributes();
+
+			Splice.bValid = !(ptLast == ptEnd) || nChain > 0;
+			if (ptLast == ptEnd && nChain > 0)
+				nChain--;
+
+			Splice.nFirst = Cross.nLine;
+			Splice.nEnd = (Partner.nLine + 1) % nCount;
+			Splice.nChain = nChain;
+		}
+
+		if (Nodes[nStart].bLeft)
+		{
+			Left.Add(pPiece);
+			bFoundLeft = true;
+			if (pLeftSplices != 0)
+				pLeftSplices->push_back(Splice);
+		}
+		else
+		{
+			Right.Add(pPiece);
+			bFoundRight = true;
+			if (pRightSplices != 0)
+				pRightSplices->push_back(Splice);
+		}
+	}
+
+	return bFoundLeft && bFoundRight;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolygon::FindSplice <BR>
+\brief Finds the run of lines which differs from the other. Starting from a point they
+share the points are matched forwards and backwards, and the lines between where each
+stops are the run. Splicing the run in gives the points of the other whichever shared
+point is used.
+<P>---------------------------------------------------------------------------*/
+bool C2DPolygon::FindSplice(const C2DPolygon& Other, unsigned int& nFirst, unsigned int& nEnd,
+					unsigned int& nOtherFirst, unsigned int& nOtherEnd) const
+{
+	unsigned int nCount = m_Lines.size();
+	unsigned int nOtherCount = Other.m_Lines.size();
+
+	if (nCount < 3 || nOtherCount < 3)
+		return false;
+
+	unsigned int nOther = 0;
+	unsigned int nThis = nCount;
+
+	while (nOther < nOtherCount)
+	{
+		const C2DPoint pt = Other.m_Lines[nOther].GetPointFrom();
+
+		for (nThis = 0; nThis < nCount; nThis++)
+		{
+			if (m_Lines[nThis].GetPointFrom() == pt)
+				break;
+		}
+
+		if (nThis < nCount)
+			break;
+
+		nOther++;
+	}
+
+	if (nOther == nOtherCount)
+		return false;
+
+	unsigned int nAhead = 0;
+
+	while (nAhead + 1 < nCount && nAhead + 1 < nOtherCount &&
+		   m_Lines[(nThis + nAhead + 1) % nCount].GetPointFrom() ==
+		   Other.m_Lines[(nOther + nAhead + 1) % nOtherCount].GetPointFrom())
+	{
+		nAhead++;
+	}
+
+	if (nAhead + 1 == nCount && nCount == nOtherCount)
+		return false;
+
+	unsigned int nBehind = 0;
+
+	while (nAhead + nBehind + 1 < nCount && nAhead + nBehind + 1 < nOtherCount &&
+		   m_Lines[(nThis + nCount - nBehind - 1) % nCount].GetPointFrom() ==
+		   Other.m_Lines[(nOther + nOtherCount - nBehind - 1) % nOtherCount].GetPointFrom())
+	{
+		nBehind++;
+	}
+
+	nFirst = (nThis + nAhead) % nCount;
+	nEnd = (nThis + nCount - nBehind) % nCount;
+	nOtherFirst = (nOther + nAhead) % nOtherCount;
+	nOtherEnd = (nOther + nOtherCount - nBehind) % nOtherCount;
+
+	return true;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolygon::SpliceLines <BR>
+\brief Replaces a run of lines by a chain. The lines and their rects are taken out and
+put in as a block. The bounding rect is only made again if a line taken out was on
+it. The sums for the area and centroid are taken from the old lines and added from
+the new so any known are kept. The new index of each old point is its old index up
+to the first, shifted after the run, or from the end of the run if it wraps round.
+<P>---------------------------------------------------------------------------*/
+bool C2DPolygon::SpliceLines(unsigned int nFirst, unsigned int nEnd, const C2DPoint* pChain,
+					unsigned int nChain, const unsigned int* pAttributes,
+					std::vector<int>* pNewIndexes)
+{
+	unsigned int nCount = m_Lines.size();
+
+	if (nFirst >= nCount || nEnd >= nCount || nCount != m_LineRects.size())
+		return false;
+
+	unsigned int nRemove = (nEnd + nCount - nFirst - 1) % nCount + 1;
+
+	if (nCount - nRemove + nChain + 1 < 3)
+		return false;
+
+	for (int i = 0; i < MAX_SUB_AREAS ; i ++)
+	{
+		if (m_SubArea[i] != 0) 
+			delete m_SubArea[i];
+		m_SubArea[i] = 0;
+	}
+
+	sProperties Properties;
+	GetCachedProperties(Properties);
+
+	// Twice the area, six times the area times the centroid and the length.
+	double dArea = 0;
+	double dCentroidX = 0;
+	double dCentroidY = 0;
+	double dLength = 0;
+	bool bRemakeRect = false;
+
+	for (unsigned int i = 0; i < nRemove; i++)
+	{
+		unsigned int nLine = (nFirst + i) % nCount;
+		C2DPoint pt1 = m_Lines[nLine].GetPointFrom();
+		C2DPoint pt2 = m_Lines[nLine].GetPointTo();
+		double dCross = pt1.x * pt2.y - pt2.x * pt1.y;
+
+		dArea -= dCross;
+		dCentroidX -= (pt1.x + pt2.x) * dCross;
+		dCentroidY -= (pt1.y + pt2.y) * dCross;
+		dLength -= m_Lines[nLine].GetLength();
+
+		const C2DRect& Rect = m_LineRects[nLine];
+		if (Rect.GetLeft() <= m_BoundingRect.GetLeft() || Rect.GetRight() >= m_BoundingRect.GetRight() ||
+			Rect.GetTop() >= m_BoundingRect.GetTop() || Rect.GetBottom() <= m_BoundingRect.GetBottom())
+		{
+			bRemakeRect = true;
+		}
+	}
+
+	C2DPoint ptFrom = m_Lines[nFirst].GetPointFrom();
+	C2DPoint ptEnd = m_Lines[(nFirst + nRemove - 1) % nCount].GetPointTo();
+	C2DLineBaseSet NewLines;
+	C2DRectSet NewRects;
+
+	for (unsigned int i = 0; i <= nChain; i++)
+	{
+		const C2DPoint& ptTo = i < nChain ? pChain[i] : ptEnd;
+		double dCross = ptFrom.x * ptTo.y - ptTo.x * ptFrom.y;
+
+		dArea += dCross;
+		dCentroidX += (ptFrom.x + ptTo.x) * dCross;
+		dCentroidY += (ptFrom.y + ptTo.y) * dCross;
+
+		C2DLine* pLine = new C2DLine(ptFrom, ptTo);
+		if (pAttributes != 0)
+			pLine->SetAttributes(pAttributes[i]);
+		dLength += pLine->GetLength();
+
+		C2DRect* pRect = new C2DRect;
+		pLine->GetBoundingRect(*pRect);
+		if (!bRemakeRect)
+			m_BoundingRect.ExpandToInclude(*pRect);
+
+		NewLines.Add(pLine);
+		NewRects.Add(pRect);
+		ptFrom = ptTo;
+	}
+
+	unsigned int nWrap = nFirst + nRemove > nCount ? nFirst + nRemove - nCount : 0;
+
+	if (pNewIndexes != 0)
+	{
+		pNewIndexes->assign(nCount, -1);
+
+		if (nWrap == 0)
+		{
+			for (unsigned int i = 0; i <= nFirst; i++)
+				(*pNewIndexes)[i] = i;
+			for (unsigned int i = nFirst + nRemove; i < nCount; i++)
+				(*pNewIndexes)[i] = i - nRemove + nChain + 1;
+		}
+		else
+		{
+			for (unsigned int i = nWrap; i <= nFirst; i++)
+				(*pNewIndexes)[i] = i - nWrap;
+		}
+	}
+
+	if (nWrap == 0)
+	{
+		m_Lines.DeleteRange(nFirst, nRemove);
+		m_LineRects.DeleteRange(nFirst, nRemove);
+		m_Lines.InsertAt(nFirst, NewLines);
+		m_LineRects.InsertAt(nFirst, NewRects);
+	}
+	else
+	{
+		m_Lines.DeleteRange(nFirst, nCount - nFirst);
+		m_LineRects.DeleteRange(nFirst, nCount - nFirst);
+		m_Lines.DeleteRange(0, nWrap);
+		m_LineRects.DeleteRange(0, nWrap);
+		m_Lines.InsertAt(m_Lines.size(), NewLines);
+		m_LineRects.InsertAt(m_LineRects.size(), NewRects);
+	}
+
+	if (bRemakeRect)
+		MakeBoundingRect();
+	else
+		InvalidateLineTree();
+
+	if ((Properties.nCached & CachedArea) != 0)
+	{
+		double dOldArea = Properties.dAreaSigned;
+		Properties.dAreaSigned += dArea / 2.0;
+
+		if ((Properties.nCached & CachedCentroid) != 0 && dOldArea != 0 && Properties.dAreaSigned != 0)
+		{
+			Properties.ptCentroid.x = (Properties.ptCentroid.x * 6.0 * dOldArea + dCentroidX) /
+										(6.0 * Properties.dAreaSigned);
+			Properties.ptCentroid.y = (Properties.ptCentroid.y * 6.0 * dOldArea + dCentroidY) /
+										(6.0 * Properties.dAreaSigned);
+		}
+		else
+		{
+			Properties.nCached &= ~CachedCentroid;
+		}
+	}
+	else
+	{
+		Properties.nCached &= ~CachedCentroid;
+	}
+
+	Properties.dPerimeter += dLength;
+	SetCachedProperties(Properties);
+
+	return true;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DPolygon::SpliceLines <BR>
+\brief Replaces a run of lines by copies of a run of the other's lines, keeping their
+attributes.
+<P>---------------------------------------------------------------------------*/
+bool C2DPolygon::SpliceLines(unsigned int nFirst, unsigned int nEnd, const C2DPolygon& Other,
+					unsigned int nOtherFirst, unsigned int nOtherEnd,
+					std::vector<int>* pNewIndexes)
+{
+	unsigned int nOtherCount = Other.m_Lines.size();
+
+	if (nOtherFirst >= nOtherCount || nOtherEnd >= nOtherCount)
+		return false;
+
+	unsigned int nLines = (nOtherEnd + nOtherCount - nOtherFirst - 1) % nOtherCount + 1;
+	std::vector<C2DPoint> Chain(nLines - 1);
+	std::vector<unsigned int> Attributes(nLines);
+
+	for (unsigned int i = 0; i < nLines; i++)
+	{
+		const C2DLineBase& Line = Other.m_Lines[(nOtherFirst + i) % nOtherCount];
+		Attributes[i] = Line.GetAttributes();
+		if (i + 1 < nLines)
+			Chain[i] = Line.GetPointTo();
+	}
+
+	return SpliceLines(nFirst, nEnd, Chain.empty() ? 0 : &Chain[0], nLines - 1,
+					   &Attributes[0], pNewIndexes);
+}
+
+
+
 /**--------------------------------------------------------------------------<BR>
 C2DPolygon::OverlapsAbove <BR>
 \brief True if this polygon is above the other. Returns the vertical distance 
@@ -1721,7 +2327,7 @@ bool C2DPolygon::OverlapsAbove( const C2DPolygon& Other, double& dVerticalDistan
 		}
 	}
 
-	GeoSort::PQuickSort< std::vector<double>, double, std::vector<sLine*>, sLine*>( xValues, Lines);
+	GeoSort::RadixSort(xValues, Lines);
 
 	bool bResult = false;
 
@@ -1846,7 +2452,7 @@ bool C2DPolygon::OverlapsVertically( const C2DPolygon& Other, double& dVerticalD
 		}
 	}
 
-	GeoSort::PQuickSort< std::vector<double>, double, std::vector<sLine*>, sLine*>( xValues, Lines);
+	GeoSort::RadixSort(xValues, Lines);
 
 	bool bResult = false;
 
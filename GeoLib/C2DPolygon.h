@@ -33,6 +33,8 @@ and non-intersection of two polygons.
 #include "C2DPolyBase.h"
 #include "Constants.h"
 #include "MemoryPool.h"
+#include <vector>
+#include <cstdint>
 
 
 class C2DPolygonSet;
@@ -64,8 +66,10 @@ public:
 	C2DPolygon(const C2DPoint* pPoint, unsigned int nNumber, bool bReorderIfNeeded = false);
 	/// Constructor.
 	C2DPolygon(const C2DPointSet& Points, bool bReorderIfNeeded = false);
-	/// Constructor.
+	/// Constructor. Shares the lines of the other until either is changed.
 	C2DPolygon(const C2DPolygon& Other);
+	/// Constructor. Takes the lines and sub areas of the other leaving it empty.
+	C2DPolygon(C2DPolygon&& Other);
 	/// Constructor.
 	C2DPolygon(const C2DPolyBase& Other);
 	/// Destructor.
@@ -73,16 +77,21 @@ public:
 
 	/// Sets the point list to that of the route provided. Route can be closed or not. 
 	bool Create(const C2DRoute& Route);
-	/// Creates the polygon with optional reordering of points.
-	bool Create(const C2DPoint* pPoint, unsigned int nNumber, bool bReorderIfNeeded = false);
+	/// Creates the polygon with optional reordering of points, taking at most about the
+	/// seconds given to improve the order, 0 for no limit.
+	bool Create(const C2DPoint* pPoint, unsigned int nNumber, bool bReorderIfNeeded = false,
+				double dMaxSeconds = 0);
 
 	bool Create(const double* pPoint, unsigned int nNumber);
 
-	/// Creates the polygon with optional reordering of points.
-	bool Create(const C2DPointSet& Points, bool bReorderIfNeeded = false);
+	/// Creates the polygon with optional reordering of points, taking at most about the
+	/// seconds given to improve the order, 0 for no limit.
+	bool Create(const C2DPointSet& Points, bool bReorderIfNeeded = false, double dMaxSeconds = 0);
+	/// Creates the polygon giving the attributes of the line from each point.
+	bool Create(const C2DPointSet& Points, const std::vector<unsigned int>& Attributes);
 	/// Creates a regular polygon.
 	bool CreateRegular(const C2DPoint& Centre, double dDistanceToPoints, int nNumberSides);
-	/// Creates a convex hull from another polygon. Uses Graham's algorithm.
+	/// Creates a convex hull from another polygon. Uses Andrew's monotone chain.
 	bool CreateConvexHull(const C2DPolygon& Other);
 	/// Creates a randon polygon.
 	bool CreateRandom(const C2DRect& cBoundary, int nMinPoints, int nMaxPoints);
@@ -98,6 +107,11 @@ public:
 
 	/// True if the point is contained.
 	bool Contains(const C2DPoint& pt) const;
+	/// True if the point is contained or within the tolerance of a line.
+	bool Contains(const C2DPoint& pt, double dTolerance) const {return C2DPolyBase::Contains(pt, dTolerance);}
+	/// Sets each result to 1 if the point is contained and 0 if not.
+	void Contains(const double* pX, const double* pY, size_t nCount, uint8_t* pResult) const
+		{C2DPolyBase::Contains(pX, pY, nCount, pResult);}
 	/// True if the polygon is contained.
 	bool Contains(const C2DPolygon& Other) const;
 
@@ -139,6 +153,8 @@ public:
 
 	/// Assignment
 	const C2DPolygon& operator=(const C2DPolygon& Other);
+	/// Assignment. Takes the lines and sub areas of the other leaving it empty.
+	const C2DPolygon& operator=(C2DPolygon&& Other);
 	/// True if there are repeated points.
 	bool HasRepeatedPoints(void) const;
 
@@ -150,6 +166,8 @@ public:
 	const C2DPolygon* GetSubArea(int nIndex) const;
 	/// Returns the convex sub areas if created.
 	void GetConvexSubAreas(C2DPolygonSet& SubAreas) const;
+	/// Replaces the indexes with three for each triangle covering the polygon.
+	void Triangulate(std::vector<uint32_t>& Indices) const;
 	/// True if this overlaps another and returns the translation vector required to move
 	/// this apart. Exact if this is convex, approximate if concave. Better approximation
 	/// if convex sub areas have been created.
@@ -160,11 +178,8 @@ public:
 	void Avoid(const C2DPolygon& Other);
 	/// Returns the number of points.
 	unsigned int GetPointsCount(void) const { return m_Lines.size();}
-	/// Returns the centroid.
+	/// Returns the centroid. Worked out once until the points change.
 	const C2DPoint GetCentroid(void) const;
-
-	/// Returns the area signed (-ve if clockwise).
-	virtual double GetAreaSigned(void) const;
 	/// Returns a pointer to the point required;
 	const C2DPoint* GetPoint(unsigned int nPointIndex) const;
 	/// Copies the points into the set object provided.
@@ -201,6 +216,42 @@ public:
 	void GetOverlaps(const C2DPolygon& Other, C2DHoledPolyBaseSet& Polygons,
 										CGrid::eDegenerateHandling eDegen = CGrid::None) const ;
 
+	/// How a piece of a split is made from this polygon when it crosses the line once.
+	/// The lines from nFirst up to nEnd become lines through the chain, for SpliceLines.
+	struct sSplitSplice
+	{
+		bool bValid;
+		unsigned int nFirst;
+		unsigned int nEnd;
+		unsigned int nChain;
+		C2DPoint Chain[2];
+		unsigned int Attributes[3];
+	};
+	/// Splits this by the infinite line through the line given in a single pass. 
+	/// Pieces to the left of the line are added to Left, pieces to the right to Right.
+	/// Optionally adds how each piece is spliced from this, in the order they are added.
+	bool SplitByLine(const C2DLine& Line, C2DPolygonSet& Left, C2DPolygonSet& Right,
+					std::vector<sSplitSplice>* pLeftSplices = 0,
+					std::vector<sSplitSplice>* pRightSplices = 0) const;
+	/// Finds the run of lines to replace to make this into the other, which goes the same
+	/// way round. The lines from nFirst up to nEnd, cyclically, become the other's lines
+	/// from nOtherFirst up to nOtherEnd. False if they are the same or share no point.
+	bool FindSplice(const C2DPolygon& Other, unsigned int& nFirst, unsigned int& nEnd,
+					unsigned int& nOtherFirst, unsigned int& nOtherEnd) const;
+	/// Replaces the lines from nFirst up to nEnd, cyclically, by lines from the start of the
+	/// first through the chain to the end of the last. nEnd equal to nFirst replaces them all.
+	/// Optionally sets the attributes of each new line and gives the new index of each old
+	/// point, -1 if it went. Only the lines replaced are worked on and any area, perimeter
+	/// and centroid known are updated from them.
+	bool SpliceLines(unsigned int nFirst, unsigned int nEnd, const C2DPoint* pChain,
+					unsigned int nChain, const unsigned int* pAttributes = 0,
+					std::vector<int>* pNewIndexes = 0);
+	/// Replaces the lines from nFirst up to nEnd by copies of the other's lines from
+	/// nOtherFirst up to nOtherEnd, as found by FindSplice.
+	bool SpliceLines(unsigned int nFirst, unsigned int nEnd, const C2DPolygon& Other,
+					unsigned int nOtherFirst, unsigned int nOtherEnd,
+					std::vector<int>* pNewIndexes = 0);
+
 	/// True if this polygon is above the other. 
 	bool OverlapsAbove( const C2DPolygon& Other, double& dVerticalDistance,
 										C2DPoint& ptOnThis, C2DPoint& ptOnOther) const;
@@ -219,8 +270,12 @@ public:
 
 	/// Returns the vector which results in the smallest projection of all the polygons in the
 	/// array and the interval representing that translation.
-	static void GetMinProjection(C2DPolygonSet& Polygons, C2DVector& Result, CInterval& Interval);
+	static void GetMinProjection(const C2DPolygonSet& Polygons, C2DVector& Result, CInterval& Interval);
+
 
+protected:
+	/// Works out the signed area (-ve if clockwise) from the points.
+	virtual double CalculateAreaSigned(void) const;
 
 private:
 	/// Finds the first inflection.
@@ -233,12 +288,8 @@ private:
 	bool RemovesInflection(unsigned int nStart, unsigned int nEnd);
 	/// Creates to sub areas given 2 point indexes and pointers to the new areas.
 	bool CreateSubAreas(unsigned int nPt1, unsigned int nPt2, C2DPolygon*& pNewArea1, C2DPolygon*& pNewArea2);
-	/// Reorders the points.
-	bool Reorder(void);
-	/// Reorders to eliminate crossing lines.
-	bool EliminateCrossingLines(void);
-	/// Swaps the two points.
-	void SwapPositions(unsigned int Pos1, unsigned int Pos2);
+	/// Reorders the points, improving the order for at most the seconds given.
+	bool Reorder(double dMaxSeconds = 0);
 	/// Sets the point to the point provided.
 	void SetPoint(const C2DPoint& Point, unsigned int nPointIndex);
 	/// Inserts a point to the set.
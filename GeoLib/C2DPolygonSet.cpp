@@ -62,8 +62,7 @@ C2DPolygonSet::MakeCopy
 <P>---------------------------------------------------------------------------*/
 void C2DPolygonSet::MakeCopy( const C2DPolygonSet& Other)
 {
-	DeleteAll( );
-	AddCopy(Other);
+	C2DBaseSet::operator=(Other);
 
 }
 
@@ -43,6 +43,14 @@ public:
 	C2DPolygonSet(void);
 	/// destructor
 	~C2DPolygonSet(void);
+	/// Constructor. Shares the polygons of the other until either is changed.
+	C2DPolygonSet(const C2DPolygonSet& Other) : C2DBaseSet(Other) {}
+	/// Constructor. Takes the polygons of the other leaving it empty.
+	C2DPolygonSet(C2DPolygonSet&& Other) : C2DBaseSet(std::move(Other)) {}
+	/// Assignment. Shares the polygons of the other until either is changed.
+	const C2DPolygonSet& operator=(const C2DPolygonSet& Other) { C2DBaseSet::operator=(Other); return *this;}
+	/// Assignment. Takes the polygons of the other leaving it empty.
+	const C2DPolygonSet& operator=(C2DPolygonSet&& Other) { C2DBaseSet::operator=(std::move(Other)); return *this;}
 
 	/// Adds a copy of the other pointer array
 	void AddCopy(const C2DPolygonSet& Other);
@@ -357,6 +357,21 @@ bool C2DRect::Overlaps(const C2DRect& Other) const
 
 }
 
+/**--------------------------------------------------------------------------<BR>
+C2DRect::Touches <BR>
+\brief True if there is an overlap or the edges touch.
+<P>---------------------------------------------------------------------------*/
+bool C2DRect::Touches(const C2DRect& Other) const
+{
+	bool bOvX = !(Other.GetLeft() > m_BottomRight.x ||
+				  Other.GetRight() <  m_TopLeft.x);
+	
+	bool bOvY = !(Other.GetBottom() >  m_TopLeft.y ||
+				  Other.GetTop() < m_BottomRight.y);
+
+	return bOvX && bOvY;
+}
+
 /**--------------------------------------------------------------------------<BR>
 C2DRect::Overlaps <BR>
 \brief True if there is an overlap. Returns the overlap.
@@ -92,6 +92,8 @@ public:
 	bool Contains(const C2DRect& Other) const;
 	/// True if there is an overlap.
 	bool Overlaps(const C2DRect& Other) const;
+	/// True if there is an overlap or the edges touch.
+	bool Touches(const C2DRect& Other) const;
 	/// If the area is positive e.g. the top is greater than the bottom.
 	bool IsValid(void) const ;
 
@@ -0,0 +1,225 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file C2DRectTree.cpp
+\brief Implementation file for the C2DRectTree Class
+
+Implementation file for C2DRectTree, a static packed R-tree over a set of
+rectangles.
+<P>---------------------------------------------------------------------------*/
+
+
+#include "StdAfx.h"
+#include "C2DRectTree.h"
+#include "C2DRectSet.h"
+#include <algorithm>
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DRectTree::C2DRectTree <BR>
+\brief Constructor.
+<P>---------------------------------------------------------------------------*/
+C2DRectTree::C2DRectTree(void) : m_nLeaves(0)
+{
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DRectTree::C2DRectTree <BR>
+\brief Constructor.
+<P>---------------------------------------------------------------------------*/
+C2DRectTree::C2DRectTree(const C2DRectSet& Rects) : m_nLeaves(0)
+{
+	Create(Rects);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DRectTree::~C2DRectTree <BR>
+\brief Destructor.
+<P>---------------------------------------------------------------------------*/
+C2DRectTree::~C2DRectTree(void)
+{
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DRectTree::Clear <BR>
+\brief Clears all.
+<P>---------------------------------------------------------------------------*/
+void C2DRectTree::Clear(void)
+{
+	m_Items.clear();
+	m_Nodes.clear();
+	m_nLeaves = 0;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DRectTree::Create <BR>
+\brief Builds the tree. Each level is packed from the one below until a single
+root is left.
+<P>---------------------------------------------------------------------------*/
+void C2DRectTree::Create(const C2DRectSet& Rects)
+{
+	Clear();
+
+	unsigned int nCount = Rects.size();
+
+	if (nCount == 0)
+		return;
+
+	m_Items.resize(nCount);
+
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		const C2DRect& Rect = Rects[i];
+		sItem& Item = m_Items[i];
+		Item.dMinX = Rect.GetLeft();
+		Item.dMinY = Rect.GetBottom();
+		Item.dMaxX = Rect.GetRight();
+		Item.dMaxY = Rect.GetTop();
+		Item.nIndex = i;
+	}
+
+	std::vector<sNode> Level;
+	Pack(m_Items, Level);
+
+	m_nLeaves = (unsigned int)Level.size();
+
+	std::vector<sNode> Parents;
+
+	while (Level.size() > 1)
+	{
+		Pack(Level, Parents);
+
+		unsigned int nBase = (unsigned int)m_Nodes.size();
+		m_Nodes.insert(m_Nodes.end(), Level.begin(), Level.end());
+
+		for (unsigned int i = 0; i < Parents.size(); i++)
+			Parents[i].nFirst += nBase;
+
+		Level.swap(Parents);
+	}
+
+	m_Nodes.push_back(Level[0]);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DRectTree::GetOverlapping <BR>
+\brief Adds the indexes of the rectangles touching the one given, in index order.
+<P>---------------------------------------------------------------------------*/
+void C2DRectTree::GetOverlapping(const C2DRect& Rect, std::vector<unsigned int>& Indexes) const
+{
+	struct sCollect
+	{
+		std::vector<unsigned int>* pIndexes;
+		bool operator()(unsigned int nIndex) { pIndexes->push_back(nIndex); return false;}
+	};
+
+	size_t nStart = Indexes.size();
+
+	sCollect Collect;
+	Collect.pIndexes = &Indexes;
+	VisitOverlapping(Rect, Collect);
+
+	std::sort(Indexes.begin() + nStart, Indexes.end());
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DRectTree::BoxDistance <BR>
+\brief Distance from the box to the point, 0 if inside.
+<P>---------------------------------------------------------------------------*/
+double C2DRectTree::BoxDistance(double dMinX, double dMinY, double dMaxX, double dMaxY,
+								const C2DPoint& pt)
+{
+	double dx = pt.x < dMinX ? dMinX - pt.x : (pt.x > dMaxX ? pt.x - dMaxX : 0);
+	double dy = pt.y < dMinY ? dMinY - pt.y : (pt.y > dMaxY ? pt.y - dMaxY : 0);
+
+	return sqrt(dx * dx + dy * dy);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DRectTree::BoxDistance <BR>
+\brief Distance between the box and the rectangle, 0 if they touch.
+<P>---------------------------------------------------------------------------*/
+double C2DRectTree::BoxDistance(double dMinX, double dMinY, double dMaxX, double dMaxY,
+								const C2DRect& Rect)
+{
+	double dx = Rect.GetRight() < dMinX ? dMinX - Rect.GetRight() :
+				(Rect.GetLeft() > dMaxX ? Rect.GetLeft() - dMaxX : 0);
+	double dy = Rect.GetTop() < dMinY ? dMinY - Rect.GetTop() :
+				(Rect.GetBottom() > dMaxY ? Rect.GetBottom() - dMaxY : 0);
+
+	return sqrt(dx * dx + dy * dy);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DRectTree::Pack <BR>
+\brief Sort tile recursive packing. The boxes are sorted by the x of their centres
+into vertical slices, each slice is sorted by y and cut into full parents.
+<P>---------------------------------------------------------------------------*/
+template <class BOX>
+void C2DRectTree::Pack(std::vector<BOX>& Boxes, std::vector<sNode>& Parents)
+{
+	struct sByX
+	{
+		bool operator()(const BOX& A, const BOX& B) const
+			{ return A.dMinX + A.dMaxX < B.dMinX + B.dMaxX;}
+	};
+	struct sByY
+	{
+		bool operator()(const BOX& A, const BOX& B) const
+			{ return A.dMinY + A.dMaxY < B.dMinY + B.dMaxY;}
+	};
+
+	Parents.clear();
+
+	size_t nCount = Boxes.size();
+	size_t nParents = (nCount + _RECT_TREE_NODE_SIZE - 1) / _RECT_TREE_NODE_SIZE;
+	size_t nSlices = (size_t)ceil(sqrt((double)nParents));
+	size_t nSliceSize = nSlices * _RECT_TREE_NODE_SIZE;
+
+	std::sort(Boxes.begin(), Boxes.end(), sByX());
+
+	Parents.reserve(nParents + nSlices);
+
+	for (size_t nSlice = 0; nSlice < nCount; nSlice += nSliceSize)
+	{
+		size_t nSliceEnd = nSlice + nSliceSize < nCount ? nSlice + nSliceSize : nCount;
+
+		std::sort(Boxes.begin() + nSlice, Boxes.begin() + nSliceEnd, sByY());
+
+		for (size_t nFirst = nSlice; nFirst < nSliceEnd; nFirst += _RECT_TREE_NODE_SIZE)
+		{
+			size_t nEnd = nFirst + _RECT_TREE_NODE_SIZE < nSliceEnd ? nFirst + _RECT_TREE_NODE_SIZE : nSliceEnd;
+
+			sNode Parent;
+			Parent.dMinX = Boxes[nFirst].dMinX;
+			Parent.dMinY = Boxes[nFirst].dMinY;
+			Parent.dMaxX = Boxes[nFirst].dMaxX;
+			Parent.dMaxY = Boxes[nFirst].dMaxY;
+			Parent.nFirst = (unsigned int)nFirst;
+			Parent.nCount = (unsigned int)(nEnd - nFirst);
+
+			for (size_t i = nFirst + 1; i < nEnd; i++)
+			{
+				if (Boxes[i].dMinX < Parent.dMinX) Parent.dMinX = Boxes[i].dMinX;
+				if (Boxes[i].dMinY < Parent.dMinY) Parent.dMinY = Boxes[i].dMinY;
+				if (Boxes[i].dMaxX > Parent.dMaxX) Parent.dMaxX = Boxes[i].dMaxX;
+				if (Boxes[i].dMaxY > Parent.dMaxY) Parent.dMaxY = Boxes[i].dMaxY;
+			}
+
+			Parents.push_back(Parent);
+		}
+	}
+}
@@ -0,0 +1,261 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file C2DRectTree.h
+\brief Declaration file for the C2DRectTree class.
+
+Declaration file for C2DRectTree, a static packed R-tree over a set of rectangles.
+
+\class C2DRectTree.
+\brief A static packed R-tree over a set of rectangles.
+
+Built once by sort tile recursive packing so every node but the last on a level is
+full. The nodes are held level by level in one array with the root last. Searches
+walk the tree with a fixed stack and allocate nothing. Candidates are found with an
+inclusive test so callers apply their own exact test to each one.
+
+Not taken from the memory pools so a tree built while an arena is installed
+outlives it.
+<P>---------------------------------------------------------------------------*/
+
+#ifndef _GEOLIB_C2DRECTTREE_H
+#define _GEOLIB_C2DRECTTREE_H
+
+
+#include "C2DRect.h"
+#include <vector>
+
+
+class C2DRectSet;
+
+#ifdef _EXPORTING
+	#define CLASS_DECLSPEC		__declspec(dllexport)
+#else
+	#ifdef _STATIC
+		#define CLASS_DECLSPEC
+	#else
+		#define CLASS_DECLSPEC		__declspec(dllimport)
+	#endif
+#endif
+
+
+#define _RECT_TREE_NODE_SIZE 8 // Children per node.
+
+#define _RECT_TREE_STACK 128 // Enough for (_RECT_TREE_NODE_SIZE - 1) * depth + 1 with 2^32 items.
+
+
+class CLASS_DECLSPEC C2DRectTree
+{
+public:
+	/// Constructor.
+	C2DRectTree(void);
+	/// Constructor.
+	C2DRectTree(const C2DRectSet& Rects);
+	/// Destructor.
+	~C2DRectTree(void);
+
+	/// Builds the tree over the rectangles. The item indexes are their indexes in the set.
+	void Create(const C2DRectSet& Rects);
+	/// Clears all.
+	void Clear(void);
+
+	/// Returns the number of rectangles.
+	unsigned int GetItemCount(void) const { return (unsigned int)m_Items.size();}
+	/// Returns the number of nodes.
+	unsigned int GetNodeCount(void) const { return (unsigned int)m_Nodes.size();}
+
+	/// Adds the indexes of the rectangles touching the one given, in index order.
+	void GetOverlapping(const C2DRect& Rect, std::vector<unsigned int>& Indexes) const;
+
+	/// Calls Visitor(nIndex) for each rectangle touching the one given, in no
+	/// particular order. Stops and returns true as soon as the visitor does.
+	template <class VISITOR>
+	bool VisitOverlapping(const C2DRect& Rect, VISITOR& Visitor) const;
+
+	/// Finds the item with the smallest distance below dLimit. The measure gives a
+	/// lower bound for a box, Measure.Bound(dMinX, dMinY, dMaxX, dMaxY), and the
+	/// distance to an item, Measure.Distance(nIndex). Returns dLimit if there is none.
+	template <class MEASURE>
+	double GetNearest(MEASURE& Measure, double dLimit, unsigned int* pIndex = 0) const;
+
+	/// Distance from the box to the point, 0 if inside.
+	static double BoxDistance(double dMinX, double dMinY, double dMaxX, double dMaxY,
+								const C2DPoint& pt);
+	/// Distance between the box and the rectangle, 0 if they touch.
+	static double BoxDistance(double dMinX, double dMinY, double dMaxX, double dMaxY,
+								const C2DRect& Rect);
+
+private:
+	/// A node covering children [nFirst, nFirst + nCount) on the level below.
+	struct sNode
+	{
+		double dMinX;
+		double dMinY;
+		double dMaxX;
+		double dMaxY;
+		unsigned int nFirst;
+		unsigned int nCount;
+	};
+
+	/// A rectangle and its index in the set it was built from.
+	struct sItem
+	{
+		double dMinX;
+		double dMinY;
+		double dMaxX;
+		double dMaxY;
+		unsigned int nIndex;
+	};
+
+	/// Packs the boxes given into parents, sorting them into tiles first.
+	template <class BOX>
+	static void Pack(std::vector<BOX>& Boxes, std::vector<sNode>& Parents);
+
+	/// True if the box touches the rectangle.
+	template <class BOX>
+	static bool Touches(const BOX& Box, const C2DRect& Rect)
+	{
+		return !(Box.dMinX > Rect.GetRight() || Box.dMaxX < Rect.GetLeft() ||
+				 Box.dMinY > Rect.GetTop() || Box.dMaxY < Rect.GetBottom());
+	}
+
+	/// The items sorted so each leaf covers a consecutive run.
+	std::vector<sItem> m_Items;
+	/// The nodes, leaves first and the root last.
+	std::vector<sNode> m_Nodes;
+	/// The number of leaves which are the nodes whose children are items.
+	unsigned int m_nLeaves;
+};
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DRectTree::VisitOverlapping <BR>
+\brief Calls the visitor for each rectangle touching the one given.
+<P>---------------------------------------------------------------------------*/
+template <class VISITOR>
+bool C2DRectTree::VisitOverlapping(const C2DRect& Rect, VISITOR& Visitor) const
+{
+	if (m_Nodes.empty())
+		return false;
+
+	unsigned int Stack[_RECT_TREE_STACK];
+	unsigned int nStack = 0;
+
+	Stack[nStack++] = (unsigned int)m_Nodes.size() - 1;
+
+	while (nStack > 0)
+	{
+		unsigned int nNode = Stack[--nStack];
+		const sNode& Node = m_Nodes[nNode];
+
+		if (!Touches(Node, Rect))
+			continue;
+
+		unsigned int nEnd = Node.nFirst + Node.nCount;
+
+		if (nNode < m_nLeaves)
+		{
+			for (unsigned int i = Node.nFirst; i < nEnd; i++)
+			{
+				if (Touches(m_Items[i], Rect) && Visitor(m_Items[i].nIndex))
+					return true;
+			}
+		}
+		else
+		{
+			for (unsigned int i = Node.nFirst; i < nEnd; i++)
+				Stack[nStack++] = i;
+		}
+	}
+
+	return false;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+C2DRectTree::GetNearest <BR>
+\brief Branch and bound search for the nearest item. Children are visited nearest
+first so the limit falls quickly and most of the tree is never reached.
+<P>---------------------------------------------------------------------------*/
+template <class MEASURE>
+double C2DRectTree::GetNearest(MEASURE& Measure, double dLimit, unsigned int* pIndex) const
+{
+	if (m_Nodes.empty())
+		return dLimit;
+
+	struct sEntry
+	{
+		unsigned int nNode;
+		double dBound;
+	};
+
+	sEntry Stack[_RECT_TREE_STACK];
+	unsigned int nStack = 0;
+
+	const sNode& Root = m_Nodes.back();
+	Stack[0].nNode = (unsigned int)m_Nodes.size() - 1;
+	Stack[0].dBound = Measure.Bound(Root.dMinX, Root.dMinY, Root.dMaxX, Root.dMaxY);
+	nStack = 1;
+
+	while (nStack > 0)
+	{
+		sEntry Entry = Stack[--nStack];
+
+		if (Entry.dBound >= dLimit)
+			continue;
+
+		const sNode& Node = m_Nodes[Entry.nNode];
+		unsigned int nEnd = Node.nFirst + Node.nCount;
+
+		if (Entry.nNode < m_nLeaves)
+		{
+			for (unsigned int i = Node.nFirst; i < nEnd; i++)
+			{
+				const sItem& Item = m_Items[i];
+				if (Measure.Bound(Item.dMinX, Item.dMinY, Item.dMaxX, Item.dMaxY) >= dLimit)
+					continue;
+
+				double dDist = Measure.Distance(Item.nIndex);
+				if (dDist < dLimit)
+				{
+					dLimit = dDist;
+					if (pIndex != 0)
+						*pIndex = Item.nIndex;
+					if (dLimit <= 0)
+						return dLimit;
+				}
+			}
+		}
+		else
+		{
+			// Push the children furthest first so the nearest comes off the stack first.
+			unsigned int nFirstPushed = nStack;
+			for (unsigned int i = Node.nFirst; i < nEnd; i++)
+			{
+				const sNode& Child = m_Nodes[i];
+				double dBound = Measure.Bound(Child.dMinX, Child.dMinY, Child.dMaxX, Child.dMaxY);
+				if (dBound >= dLimit)
+					continue;
+
+				unsigned int j = nStack++;
+				while (j > nFirstPushed && Stack[j - 1].dBound < dBound)
+				{
+					Stack[j] = Stack[j - 1];
+					j--;
+				}
+				Stack[j].nNode = i;
+				Stack[j].dBound = dBound;
+			}
+		}
+	}
+
+	return dLimit;
+}
+
+
+#endif
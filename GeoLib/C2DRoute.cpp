@@ -124,7 +124,7 @@ C2DRoute::Crosses
 \brief True if the given lines crosses any line in the route. Records the intersection
 points.
 <P>---------------------------------------------------------------------------*/
-bool C2DRoute::Crosses(const C2DLine& Line, C2DPointSet* IntersectionPts)
+bool C2DRoute::Crosses(const C2DLine& Line, C2DPointSet* IntersectionPts) const
 {
 	bool bResult = false;
 
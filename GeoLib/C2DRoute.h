@@ -76,7 +76,7 @@ public:
 	/// Assignment to another.
 	const C2DRoute& operator=(const C2DRoute& Other);
 	/// Returns true if it crosses a line given and the list of intersection points.
-	bool Crosses(const C2DLine& Line, C2DPointSet* IntersectionPts);
+	bool Crosses(const C2DLine& Line, C2DPointSet* IntersectionPts) const;
 	/// Adds the points of another to this if they have a common end which is either
 	/// the first or last point.
 	bool AddIfCommonEnd(C2DRoute& Other);
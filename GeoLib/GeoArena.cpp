@@ -0,0 +1,275 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file GeoArena.cpp
+\brief Implementation file for the CGeoArena and CGeoArenaScope classes.
+<P>---------------------------------------------------------------------------*/
+
+
+#include "StdAfx.h"
+#include "GeoArena.h"
+
+
+static thread_local CGeoArena* ms_pCurrentArena = 0;
+
+/// Allocations are rounded to this so every object is aligned for a double or pointer.
+static const size_t const_nArenaAlignment = sizeof(double) > sizeof(void*) ? sizeof(double) : sizeof(void*);
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArena::CGeoArena <BR>
+\brief Constructor. No memory is taken until the first allocation.
+<P>---------------------------------------------------------------------------*/
+CGeoArena::CGeoArena(size_t nChunkSize) : m_nChunk(0), m_pNext(0), m_pEnd(0),
+		m_nChunkSize(nChunkSize > 0 ? nChunkSize : _ARENA_CHUNK_SIZE),
+		m_nBytesUsed(0), m_nAllocations(0)
+{
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArena::~CGeoArena <BR>
+\brief Destructor.
+<P>---------------------------------------------------------------------------*/
+CGeoArena::~CGeoArena(void)
+{
+	if (ms_pCurrentArena == this)
+		ms_pCurrentArena = 0;
+
+	Release();
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArena::Allocate <BR>
+\brief Allocates memory by moving the pointer through the current chunk.
+<P>---------------------------------------------------------------------------*/
+void* CGeoArena::Allocate(size_t nSize)
+{
+	nSize = (nSize + const_nArenaAlignment - 1) / const_nArenaAlignment * const_nArenaAlignment;
+
+	if (nSize == 0)
+		nSize = const_nArenaAlignment;
+
+	if (m_pNext == 0 || (size_t)(m_pEnd - m_pNext) < nSize)
+		NextChunk(nSize);
+
+	void* pResult = m_pNext;
+	m_pNext += nSize;
+
+	m_nBytesUsed += nSize;
+	m_nAllocations++;
+
+	return pResult;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArena::Reset <BR>
+\brief Releases everything allocated. If the last operation needed more than one
+chunk they are replaced by one large enough for all of it so the next operation
+of the same size needs no more memory.
+<P>---------------------------------------------------------------------------*/
+void CGeoArena::Reset(void)
+{
+	if (m_Chunks.size() > 1)
+	{
+		size_t nTotal = GetCapacity();
+
+		Release();
+
+		sChunk Chunk;
+		Chunk.pData = new char[nTotal];
+		Chunk.nSize = nTotal;
+		m_Chunks.push_back(Chunk);
+	}
+
+	m_nChunk = 0;
+
+	if (m_Chunks.empty())
+	{
+		m_pNext = 0;
+		m_pEnd = 0;
+	}
+	else
+	{
+		m_pNext = m_Chunks[0].pData;
+		m_pEnd = m_pNext + m_Chunks[0].nSize;
+	}
+
+	m_nBytesUsed = 0;
+	m_nAllocations = 0;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArena::Release <BR>
+\brief Frees all the memory held.
+<P>---------------------------------------------------------------------------*/
+void CGeoArena::Release(void)
+{
+	for (size_t i = 0; i < m_Chunks.size(); i++)
+	{
+		delete [] m_Chunks[i].pData;
+	}
+
+	m_Chunks.clear();
+
+	m_nChunk = 0;
+	m_pNext = 0;
+	m_pEnd = 0;
+
+	m_nBytesUsed = 0;
+	m_nAllocations = 0;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArena::GetCapacity <BR>
+\brief Returns the bytes of memory held.
+<P>---------------------------------------------------------------------------*/
+size_t CGeoArena::GetCapacity(void) const
+{
+	size_t nTotal = 0;
+
+	for (size_t i = 0; i < m_Chunks.size(); i++)
+		nTotal += m_Chunks[i].nSize;
+
+	return nTotal;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArena::NextChunk <BR>
+\brief Moves to the next chunk which has room for the size given, adding a new one
+twice the size of the last if there is none.
+<P>---------------------------------------------------------------------------*/
+void CGeoArena::NextChunk(size_t nSize)
+{
+	if (m_pNext != 0)
+		m_nChunk++;
+
+	while (m_nChunk < m_Chunks.size() && m_Chunks[m_nChunk].nSize < nSize)
+		m_nChunk++;
+
+	if (m_nChunk >= m_Chunks.size())
+	{
+		size_t nChunkSize = m_Chunks.empty() ? m_nChunkSize : m_Chunks.back().nSize * 2;
+		if (nChunkSize < nSize)
+			nChunkSize = nSize;
+
+		sChunk Chunk;
+		Chunk.pData = new char[nChunkSize];
+		Chunk.nSize = nChunkSize;
+		m_Chunks.push_back(Chunk);
+
+		m_nChunk = m_Chunks.size() - 1;
+	}
+
+	m_pNext = m_Chunks[m_nChunk].pData;
+	m_pEnd = m_pNext + m_Chunks[m_nChunk].nSize;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArena::GetCurrent <BR>
+\brief Returns the arena installed on the calling thread, 0 if none.
+<P>---------------------------------------------------------------------------*/
+CGeoArena* CGeoArena::GetCurrent(void)
+{
+	return ms_pCurrentArena;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArena::SetCurrent <BR>
+\brief Installs the arena on the calling thread and returns the one it replaces.
+<P>---------------------------------------------------------------------------*/
+CGeoArena* CGeoArena::SetCurrent(CGeoArena* pArena)
+{
+	CGeoArena* pPrevious = ms_pCurrentArena;
+
+	ms_pCurrentArena = pArena;
+
+	return pPrevious;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArena::GetThreadArena <BR>
+\brief Returns an arena kept for the calling thread and freed when it exits.
+<P>---------------------------------------------------------------------------*/
+CGeoArena& CGeoArena::GetThreadArena(void)
+{
+	static thread_local CGeoArena ThreadArena;
+
+	return ThreadArena;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArenaScope::CGeoArenaScope <BR>
+\brief Installs the thread arena unless an arena is already installed, in which
+case objects keep going to that one.
+<P>---------------------------------------------------------------------------*/
+CGeoArenaScope::CGeoArenaScope(void) : m_pArena(0), m_pPrevious(0), m_bReset(true)
+{
+	if (CGeoArena::GetCurrent() == 0)
+	{
+		m_pArena = &CGeoArena::GetThreadArena();
+		m_pPrevious = CGeoArena::SetCurrent(m_pArena);
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArenaScope::CGeoArenaScope <BR>
+\brief Installs the arena given.
+<P>---------------------------------------------------------------------------*/
+CGeoArenaScope::CGeoArenaScope(CGeoArena& Arena) : m_pArena(&Arena), m_pPrevious(0), m_bReset(false)
+{
+	m_pPrevious = CGeoArena::SetCurrent(m_pArena);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArenaScope::~CGeoArenaScope <BR>
+\brief Restores the previous arena and resets the thread arena if installed here.
+<P>---------------------------------------------------------------------------*/
+CGeoArenaScope::~CGeoArenaScope(void)
+{
+	if (m_pArena == 0)
+		return;
+
+	CGeoArena::SetCurrent(m_pPrevious);
+
+	if (m_bReset)
+		m_pArena->Reset();
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArenaScope::Suspend <BR>
+\brief Stops allocating from the arena. Objects from it can still be deleted.
+<P>---------------------------------------------------------------------------*/
+void CGeoArenaScope::Suspend(void)
+{
+	if (m_pArena != 0)
+		CGeoArena::SetCurrent(m_pPrevious);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CGeoArenaScope::Resume <BR>
+\brief Allocates from the arena again.
+<P>---------------------------------------------------------------------------*/
+void CGeoArenaScope::Resume(void)
+{
+	if (m_pArena != 0)
+		CGeoArena::SetCurrent(m_pArena);
+}
@@ -0,0 +1,134 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file GeoArena.h
+\brief Declaration file for the CGeoArena and CGeoArenaScope classes.
+
+\class CGeoArena
+\brief Monotonic allocator for the temporary objects of an operation.
+
+Hands out memory by moving a pointer through large chunks. Nothing is freed
+individually; Reset releases everything at once and keeps the memory for the next
+operation. While an arena is installed on a thread with CGeoArenaScope, every
+object the memory pools are asked for on that thread comes from it and deleting
+such an object does nothing. Objects created in an arena must not outlive its
+reset so results are copied out with the arena suspended.
+
+\class CGeoArenaScope
+\brief Installs an arena on the calling thread for the life of the scope.
+<P>---------------------------------------------------------------------------*/
+
+#ifndef _GEOLIB_CGEOARENA_H
+#define _GEOLIB_CGEOARENA_H
+
+#include <vector>
+#include <cstddef>
+
+#ifdef _EXPORTING
+	#define CLASS_DECLSPEC		__declspec(dllexport)
+#else
+	#ifdef _STATIC
+		#define CLASS_DECLSPEC
+	#else
+		#define CLASS_DECLSPEC		__declspec(dllimport)
+	#endif
+#endif
+
+
+#define _ARENA_CHUNK_SIZE 65536 // Default size in bytes of the first chunk.
+
+
+class CLASS_DECLSPEC CGeoArena
+{
+public:
+	/// Constructor.
+	CGeoArena(size_t nChunkSize = _ARENA_CHUNK_SIZE);
+	/// Destructor.
+	~CGeoArena(void);
+
+	/// Allocates memory aligned for a double.
+	void* Allocate(size_t nSize);
+	/// Releases everything allocated. Keeps the memory for reuse.
+	void Reset(void);
+	/// Frees all the memory held.
+	void Release(void);
+
+	/// Returns the bytes allocated since the last reset.
+	size_t GetBytesUsed(void) const { return m_nBytesUsed;}
+	/// Returns the bytes of memory held.
+	size_t GetCapacity(void) const;
+	/// Returns the number of allocations since the last reset.
+	size_t GetAllocations(void) const { return m_nAllocations;}
+
+	/// Returns the arena installed on the calling thread, 0 if none.
+	static CGeoArena* GetCurrent(void);
+	/// Returns an arena kept for the calling thread.
+	static CGeoArena& GetThreadArena(void);
+
+private:
+	friend class CGeoArenaScope;
+
+	/// Installs the arena on the calling thread and returns the one it replaces.
+	static CGeoArena* SetCurrent(CGeoArena* pArena);
+
+	/// Moves to the next chunk, adding one if needed, with room for the size given.
+	void NextChunk(size_t nSize);
+
+	/// Not copyable.
+	CGeoArena(const CGeoArena&);
+	CGeoArena& operator=(const CGeoArena&);
+
+	struct sChunk
+	{
+		char* pData;
+		size_t nSize;
+	};
+
+	std::vector<sChunk> m_Chunks;
+	/// The chunk being allocated from.
+	size_t m_nChunk;
+
+	char* m_pNext;
+	char* m_pEnd;
+
+	size_t m_nChunkSize;
+	size_t m_nBytesUsed;
+	size_t m_nAllocations;
+};
+
+
+class CLASS_DECLSPEC CGeoArenaScope
+{
+public:
+	/// Installs the thread arena unless an arena is already installed. Resets it on exit.
+	CGeoArenaScope(void);
+	/// Installs the arena given. It is not reset on exit.
+	CGeoArenaScope(CGeoArena& Arena);
+	/// Restores the previous arena.
+	~CGeoArenaScope(void);
+
+	/// True if this scope installed an arena.
+	bool IsInstalled(void) const { return m_pArena != 0;}
+
+	/// Stops allocating from the arena so objects go to the normal pools.
+	void Suspend(void);
+	/// Allocates from the arena again.
+	void Resume(void);
+
+private:
+	/// Not copyable.
+	CGeoArenaScope(const CGeoArenaScope&);
+	CGeoArenaScope& operator=(const CGeoArenaScope&);
+
+	CGeoArena* m_pArena;
+	CGeoArena* m_pPrevious;
+	bool m_bReset;
+};
+
+
+#endif
@@ -18,6 +18,7 @@ any modified versions of this cannot be resold to any other party.
 #include "C2DBase.h"
 #include "C2DBaseSet.h"
 #include "C2DCircle.h"
+#include "C2DFlatPolygon.h"
 #include "C2DHoledPolyArc.h"
 #include "C2DHoledPolyArcSet.h"
 #include "C2DHoledPolyBase.h"
@@ -39,18 +40,25 @@ any modified versions of this cannot be resold to any other party.
 #include "C2DPolygonSet.h"
 #include "C2DRect.h"
 #include "C2DRectSet.h"
+#include "C2DRectTree.h"
 #include "C2DRoute.h"
 #include "C2DSegment.h"
 #include "C2DTriangle.h"
 #include "C2DVector.h"
 #include "C3DPoint.h"
 #include "Constants.h"
+#include "GeoArena.h"
 //#include "Geodetic.h"
 #include "Grid.h"
 #include "IndexSet.h"
 #include "Interval.h"
 //#include "MapProject.h"
+#include "PlaneSweep.h"
+#include "PointWelder.h"
+#include "Predicates.h"
 #include "RandomNumber.h"
+#include "SegmentSweep.h"
 #include "TravellingSalesman.h"
+#include "Triangulator.h"
 
 #endif
\ No newline at end of file
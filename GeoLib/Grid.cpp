@@ -15,10 +15,11 @@ any modified versions of this cannot be resold to any other party.
 
 #include "Grid.h"
 #include "C2DRect.h"
+#include <atomic>
 
 
 static double ms_dGridSize = 0.0001;
-static unsigned int ms_nDegenerateErrors = 0;
+static std::atomic<unsigned int> ms_nDegenerateErrors(0); // Logged from any thread.
 
 const double const_dEqualityAvoidanceFactor = 1000.0;
 
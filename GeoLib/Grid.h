@@ -16,6 +16,10 @@ The grid is simply a spacing between allowable points. When objects are "Snapped
 to the grid, all points must then lie on the grid lines. This is used within 
 GeoLib to manage degenerate cases but has other applications. Also used to record
 degenerate errors. All functions are static. 
+
+SymbolicPerturbation needs no grid. The other shape is treated as moved by an
+infinitesimal amount and exact predicates decide every crossing, so there is no
+copy and no retry. It is for straight lines; shapes with arcs use RandomPerturbation.
 <P>---------------------------------------------------------------------------*/
 
 #ifndef _GEOLIB_CGRID_H 
@@ -44,6 +48,7 @@ public:
 		DynamicGrid,
 		PreDefinedGrid,
 		PreDefinedGridPreSnapped,
+		SymbolicPerturbation,
 	};
 	/// Constructor
 	CGrid(void) {;}
@@ -4,211 +4,679 @@
 
 Declaration file for the CMemoryPool class which allocates large chuncks on the
 heap to speed things up.
+
+Each thread allocates from its own pool so the fast path takes no lock. Objects
+freed by another thread are passed back to the owning pool through a lock free
+list which the owner collects when it runs out. Blocks are kept up to a retention
+limit rather than being destroyed whenever the object count reaches zero.
+
+While a CGeoArena is installed on the thread objects are taken from it instead and
+deleting them does nothing; the arena releases them all when it is reset.
 <P>---------------------------------------------------------------------------*/
 
 #pragma once
 
 
 #include <vector>
+#include <cstddef>
+#include <new>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include "GeoArena.h"
+
+
+#define _MEMORY_POOL_DECLARATION_PURE	virtual void* operator new(size_t) = 0;\
+										virtual void* operator new(size_t, const char*,int) = 0;\
+										virtual void operator delete(void* p, size_t) = 0;
 
+#define _MEMORY_POOL_DECLARATION void* operator new(size_t nSize);\
+								 void* operator new(size_t nSize, const char*,int);\
+								 void operator delete(void* p, size_t nSize);
 
-#define _MEMORY_POOL_DECLARATION_PURE	virtual void* operator new(unsigned int) = 0;\
-										virtual void* operator new(unsigned int, const char*,int) = 0;\
-										virtual void operator delete(void* p) = 0;
+#define _MEMORY_POOL_IMPLEMENATION(_TYPE) void* _TYPE::operator new(size_t nSize) \
+											{return CMemoryPool<_TYPE>::Allocate(nSize);} \
+										  void _TYPE::operator delete(void* p, size_t nSize) \
+											{CMemoryPool<_TYPE>::Deallocate(p, nSize);} \
+										  void* _TYPE::operator new(size_t nSize, const char*,int) \
+											{return CMemoryPool<_TYPE>::Allocate(nSize);}
 
-#define _MEMORY_POOL_DECLARATION void* operator new(unsigned int);\
-								 void* operator new(unsigned int, const char*,int);\
-								 void operator delete(void* p);
+#define _MEMORY_SIMPLE_IMPLEMENATION(_TYPE) void* _TYPE::operator new(size_t nSize) \
+											{return ::operator new(nSize);} \
+										  void _TYPE::operator delete(void* p, size_t) \
+											{::operator delete(p);} \
+										  void* _TYPE::operator new(size_t nSize, const char*,int) \
+											{return ::operator new(nSize);}
 
-#define _MEMORY_POOL_IMPLEMENATION(_TYPE) void* _TYPE::operator new(unsigned int) \
-											{return CMemoryPool<_TYPE>::Allocate();} \
-										  void _TYPE::operator delete(void* p) \
-											{CMemoryPool<_TYPE>::Deallocate(p);} \
-										  void* _TYPE::operator new(unsigned int, const char*,int) \
-											{return CMemoryPool<_TYPE>::Allocate();}
 
-#define _MEMORY_SIMPLE_IMPLEMENATION(_TYPE) void* _TYPE::operator new(unsigned int) \
-											{return ::new _TYPE;} \
-										  void _TYPE::operator delete(void* p) \
-											{::delete p;} \
-										  void* _TYPE::operator new(unsigned int, const char*,int) \
-											{return ::new _TYPE;}
+#define _BLOCK_SIZE 1000 // Default number of objects per block.
 
+#define _RETAINED_BLOCKS 4 // Default number of blocks kept when the pool empties.
 
-#define _BLOCK_SIZE 1000 // = 10kb / byte
+
+/**--------------------------------------------------------------------------<BR>
+\struct CMemoryPoolStatistics
+\brief Usage figures for the pool of one type summed over all threads.
+<P>---------------------------------------------------------------------------*/
+struct CMemoryPoolStatistics
+{
+	/// Objects currently allocated.
+	unsigned long long nOutstanding;
+	/// Blocks currently held.
+	unsigned long long nBlocks;
+	/// Sum of the highest number of objects allocated at once by each thread.
+	unsigned long long nHighWaterMark;
+	/// Allocations since the statistics were last reset.
+	unsigned long long nAllocations;
+	/// Allocations per second since the statistics were last reset.
+	double dAllocationsPerSecond;
+};
 
 
 template <class TYPE>
 class CMemoryPool
 {
 public:
+	/// Allocates memory for an object of the size given.
+	static void* Allocate(size_t nSize);
+	/// Deallocates memory for an object of the size given.
+	static void Deallocate(void* pData, size_t nSize);
+
+	/// Sets the number of objects in each new block.
+	static void SetBlockSize(unsigned int nObjects);
+	/// Returns the number of objects in each new block.
+	static unsigned int GetBlockSize(void) { return ms_nBlockSize.load(std::memory_order_relaxed);}
+	/// Sets the number of blocks each thread keeps when all its objects are freed.
+	static void SetRetainedBlocks(unsigned int nBlocks) { ms_nRetainedBlocks.store(nBlocks, std::memory_order_relaxed);}
+	/// Returns the number of blocks each thread keeps when all its objects are freed.
+	static unsigned int GetRetainedBlocks(void) { return ms_nRetainedBlocks.load(std::memory_order_relaxed);}
+
+	/// Returns the usage statistics.
+	static void GetStatistics(CMemoryPoolStatistics& Statistics);
+	/// Resets the allocation count and rate.
+	static void ResetStatistics(void);
+	/// Releases the blocks over the retention limit held by the calling thread if possible.
+	static void Trim(void);
+
+private:
 	/// Constructor
 	CMemoryPool(void);
 	/// Destructor
 	~CMemoryPool(void);
-	/// Allocated
-	static void* Allocate(void);
-	/// Deallocate
-	static void Deallocate(void* pData);
 
+	/// Placed in front of every object to identify the owning pool, 0 for an arena.
+	union sHeader
+	{
+		CMemoryPool<TYPE>* pOwner;
+		double dAlign;
+	};
 
-//	static CMemoryPool<TYPE>& GetInstance(void);
-private:
+	/// Free list entry which occupies the object space.
+	struct sFree
+	{
+		sFree* pNext;
+	};
 
-	void Clear(void);
+	/// A block and the number of objects in it.
+	struct sBlock
+	{
+		char* pData;
+		unsigned int nObjects;
+	};
+
+	/// Hands the pool on when the thread exits.
+	struct sThreadGuard
+	{
+		sThreadGuard(void) : pPool(0) {}
+		~sThreadGuard(void);
+		CMemoryPool<TYPE>* pPool;
+	};
+
+	/// The distance between objects in a block.
+	static size_t GetStride(void);
+	/// Returns the pool of the calling thread, creating or adopting one if needed.
+	static CMemoryPool<TYPE>* GetThreadPool(void);
 
+	/// Allocates from this pool. Owning thread only.
 	void* PAllocate(void);
-	/// Deallocate
+	/// Deallocates to this pool. Owning thread only.
 	void PDeallocate(void* pData);
+	/// Deallocates to this pool from another thread.
+	void RemoteDeallocate(void* pData);
+	/// Takes the objects freed by other threads.
+	void CollectRemote(void);
+	/// Adds a new block of free objects.
+	void AddBlock(void);
+	/// Frees the blocks over the retention limit. Only valid if nothing is allocated.
+	void ReleaseSurplus(void);
+	/// Frees all the blocks.
+	void Clear(void);
+	/// Records an allocation in the counters.
+	void CountAllocation(void);
+
+	/// Free objects for the owning thread.
+	sFree* m_pList;
+	/// Objects freed by other threads.
+	std::atomic<sFree*> m_pRemoteList;
+
+	std::vector<sBlock> m_Blocks;
+
+	/// Objects allocated which have not been collected back, owning thread only.
+	size_t m_nLive;
+
+	/// Counters written by the owning thread and read for the statistics.
+	std::atomic<unsigned long long> m_nAllocations;
+	std::atomic<unsigned long long> m_nHighWaterMark;
+	std::atomic<unsigned long long> m_nBlockCount;
+	std::atomic<unsigned long long> m_nLiveCount;
+	/// Frees made to this pool by other threads which have not yet been collected.
+	std::atomic<unsigned long long> m_nRemoteFrees;
+
+	/// Links for the list of all pools and the list of pools with no thread.
+	CMemoryPool<TYPE>* m_pNextPool;
+	CMemoryPool<TYPE>* m_pNextOrphan;
+
+	static thread_local CMemoryPool<TYPE>* ms_pThreadPool;
+
+	/// Guards the pool lists and the statistics reset.
+	static std::mutex ms_Mutex;
+	static CMemoryPool<TYPE>* ms_pPools;
+	static CMemoryPool<TYPE>* ms_pOrphans;
+
+	static std::atomic<unsigned int> ms_nBlockSize;
+	static std::atomic<unsigned int> ms_nRetainedBlocks;
+
+	/// Allocations made by pools which have been deleted.
+	static unsigned long long ms_nDeletedAllocations;
+	/// Allocation count and time at the last reset.
+	static unsigned long long ms_nResetAllocations;
+	static std::chrono::steady_clock::time_point ms_ResetTime;
+};
 
-	struct sList
-	{
-		TYPE cObject;
-		sList* pNext;
-	};
+template<class TYPE>
+thread_local CMemoryPool<TYPE>* CMemoryPool<TYPE>::ms_pThreadPool = 0;
 
-	sList* m_pList;
+template<class TYPE>
+std::mutex CMemoryPool<TYPE>::ms_Mutex;
 
-	std::vector<char*> m_Blocks;
+template<class TYPE>
+CMemoryPool<TYPE>* CMemoryPool<TYPE>::ms_pPools = 0;
 
-	static CMemoryPool<TYPE>* m_spInstance;
+template<class TYPE>
+CMemoryPool<TYPE>* CMemoryPool<TYPE>::ms_pOrphans = 0;
 
-	static unsigned int m_snCount;
-};
+template<class TYPE>
+std::atomic<unsigned int> CMemoryPool<TYPE>::ms_nBlockSize(_BLOCK_SIZE);
+
+template<class TYPE>
+std::atomic<unsigned int> CMemoryPool<TYPE>::ms_nRetainedBlocks(_RETAINED_BLOCKS);
 
 template<class TYPE>
-CMemoryPool<TYPE>* CMemoryPool<TYPE>::m_spInstance = 0;
+unsigned long long CMemoryPool<TYPE>::ms_nDeletedAllocations = 0;
 
 template<class TYPE>
-unsigned int CMemoryPool<TYPE>::m_snCount = 0;
+unsigned long long CMemoryPool<TYPE>::ms_nResetAllocations = 0;
+
+template<class TYPE>
+std::chrono::steady_clock::time_point CMemoryPool<TYPE>::ms_ResetTime = std::chrono::steady_clock::now();
+
 
 template<class TYPE>
 /**--------------------------------------------------------------------------<BR>
 CMemoryPool<TYPE>::CMemoryPool <BR>
 Constructor.
 <P>---------------------------------------------------------------------------*/
-CMemoryPool<TYPE>::CMemoryPool(void)
+CMemoryPool<TYPE>::CMemoryPool(void) : m_pList(0), m_pRemoteList(0), m_nLive(0),
+		m_nAllocations(0), m_nHighWaterMark(0), m_nBlockCount(0), m_nLiveCount(0),
+		m_nRemoteFrees(0), m_pNextPool(0), m_pNextOrphan(0)
 {
-    m_pList = 0;
+	std::lock_guard<std::mutex> Lock(ms_Mutex);
+
+	m_pNextPool = ms_pPools;
+	ms_pPools = this;
 }
 
 
 template<class TYPE>
 /**--------------------------------------------------------------------------<BR>
-CMemoryPool<TYPE>::CMemoryPool <BR>
-Constructor.
+CMemoryPool<TYPE>::~CMemoryPool <BR>
+Destructor.
 <P>---------------------------------------------------------------------------*/
 CMemoryPool<TYPE>::~CMemoryPool(void)
 {
+	{
+		std::lock_guard<std::mutex> Lock(ms_Mutex);
+
+		CMemoryPool<TYPE>** ppPool = &ms_pPools;
+		while (*ppPool != this)
+			ppPool = &(*ppPool)->m_pNextPool;
+		*ppPool = m_pNextPool;
+
+		ms_nDeletedAllocations += m_nAllocations.load(std::memory_order_relaxed);
+	}
+
 	Clear();
 }
 
 
 template<class TYPE>
 /**--------------------------------------------------------------------------<BR>
-CMemoryPool<TYPE>::Clear <BR>
-Clear.
+CMemoryPool<TYPE>::sThreadGuard::~sThreadGuard <BR>
+Deletes the pool of the exiting thread if it is empty, otherwise leaves it for
+another thread to adopt so the objects still in use stay valid.
 <P>---------------------------------------------------------------------------*/
-void CMemoryPool<TYPE>::Clear(void)
+CMemoryPool<TYPE>::sThreadGuard::~sThreadGuard(void)
 {
-	for (unsigned int i = 0; i < m_Blocks.size(); i++)
-	{
-		delete[] m_Blocks[i];
-	}
+	if (pPool == 0)
+		return;
 
-	m_Blocks.clear();
+	ms_pThreadPool = 0;
+
+	pPool->CollectRemote();
 
-    m_pList = 0;
+	if (pPool->m_nLive == 0)
+	{
+		delete pPool;
+	}
+	else
+	{
+		std::lock_guard<std::mutex> Lock(ms_Mutex);
+		pPool->m_pNextOrphan = ms_pOrphans;
+		ms_pOrphans = pPool;
+	}
+	pPool = 0;
 }
 
 
 template<class TYPE>
 /**--------------------------------------------------------------------------<BR>
-CMemoryPool<TYPE>::Allocate <BR>
-Allocates memory.
+CMemoryPool<TYPE>::GetStride <BR>
+The distance between objects in a block including the header.
 <P>---------------------------------------------------------------------------*/
-void* CMemoryPool<TYPE>::Allocate(void)
+size_t CMemoryPool<TYPE>::GetStride(void)
 {
-    if (m_spInstance == 0)
-		m_spInstance = new CMemoryPool<TYPE>;
+	size_t nSize = sizeof(TYPE) > sizeof(sFree) ? sizeof(TYPE) : sizeof(sFree);
 
-	m_snCount++;
+	nSize = (nSize + sizeof(sHeader) - 1) / sizeof(sHeader) * sizeof(sHeader);
 
-	return m_spInstance->PAllocate();
+	return nSize + sizeof(sHeader);
 }
 
+
 template<class TYPE>
 /**--------------------------------------------------------------------------<BR>
-CMemoryPool<TYPE>::Allocate <BR>
-Allocates memory.
+CMemoryPool<TYPE>::GetThreadPool <BR>
+Returns the pool of the calling thread. The first call on a thread adopts a pool
+left by a thread which has exited or creates a new one.
 <P>---------------------------------------------------------------------------*/
-void CMemoryPool<TYPE>::Deallocate(void* pData)
+CMemoryPool<TYPE>* CMemoryPool<TYPE>::GetThreadPool(void)
 {
-	if (m_spInstance)
+	CMemoryPool<TYPE>* pPool = ms_pThreadPool;
+
+	if (pPool != 0)
+		return pPool;
+
+	thread_local sThreadGuard Guard;
+
 	{
-		m_spInstance->PDeallocate(pData);
-		m_snCount--;
-		if (m_snCount == 0)
+		std::lock_guard<std::mutex> Lock(ms_Mutex);
+		if (ms_pOrphans != 0)
 		{
-			delete m_spInstance;
-            m_spInstance = 0;
+			pPool = ms_pOrphans;
+			ms_pOrphans = pPool->m_pNextOrphan;
+			pPool->m_pNextOrphan = 0;
 		}
 	}
+
+	if (pPool == 0)
+		pPool = new CMemoryPool<TYPE>;
+
+	Guard.pPool = pPool;
+	ms_pThreadPool = pPool;
+
+	return pPool;
 }
 
 
 template<class TYPE>
 /**--------------------------------------------------------------------------<BR>
 CMemoryPool<TYPE>::Allocate <BR>
+Allocates memory. Derived types which do not have their own pool are larger than
+the slots so are passed to the global heap. If an arena is installed it is used.
+<P>---------------------------------------------------------------------------*/
+void* CMemoryPool<TYPE>::Allocate(size_t nSize)
+{
+	if (nSize != sizeof(TYPE))
+		return ::operator new(nSize);
+
+	CGeoArena* pArena = CGeoArena::GetCurrent();
+	if (pArena != 0)
+	{
+		sHeader* pHeader = static_cast<sHeader*>(pArena->Allocate(sizeof(sHeader) + nSize));
+		pHeader->pOwner = 0;
+		return pHeader + 1;
+	}
+
+	return GetThreadPool()->PAllocate();
+}
+
+
+template<class TYPE>
+/**--------------------------------------------------------------------------<BR>
+CMemoryPool<TYPE>::Deallocate <BR>
+Deallocates memory, returning it to the pool which owns it. Memory from an arena
+is left for the arena to release.
+<P>---------------------------------------------------------------------------*/
+void CMemoryPool<TYPE>::Deallocate(void* pData, size_t nSize)
+{
+	if (pData == 0)
+		return;
+
+	if (nSize != sizeof(TYPE))
+	{
+		::operator delete(pData);
+		return;
+	}
+
+	sHeader* pHeader = reinterpret_cast<sHeader*>(static_cast<char*>(pData) - sizeof(sHeader));
+
+	CMemoryPool<TYPE>* pOwner = pHeader->pOwner;
+
+	if (pOwner == 0)
+		return;
+
+	if (pOwner == ms_pThreadPool)
+		pOwner->PDeallocate(pData);
+	else
+		pOwner->RemoteDeallocate(pData);
+}
+
+
+template<class TYPE>
+/**--------------------------------------------------------------------------<BR>
+CMemoryPool<TYPE>::SetBlockSize <BR>
+Sets the number of objects in each new block. Existing blocks are unchanged.
+<P>---------------------------------------------------------------------------*/
+void CMemoryPool<TYPE>::SetBlockSize(unsigned int nObjects)
+{
+	if (nObjects == 0)
+		nObjects = 1;
+
+	ms_nBlockSize.store(nObjects, std::memory_order_relaxed);
+}
+
+
+template<class TYPE>
+/**--------------------------------------------------------------------------<BR>
+CMemoryPool<TYPE>::GetStatistics <BR>
+Returns the usage statistics summed over all the pools.
+<P>---------------------------------------------------------------------------*/
+void CMemoryPool<TYPE>::GetStatistics(CMemoryPoolStatistics& Statistics)
+{
+	Statistics.nOutstanding = 0;
+	Statistics.nBlocks = 0;
+	Statistics.nHighWaterMark = 0;
+	Statistics.nAllocations = 0;
+	Statistics.dAllocationsPerSecond = 0;
+
+	std::lock_guard<std::mutex> Lock(ms_Mutex);
+
+	unsigned long long nTotal = ms_nDeletedAllocations;
+
+	for (CMemoryPool<TYPE>* pPool = ms_pPools; pPool != 0; pPool = pPool->m_pNextPool)
+	{
+		unsigned long long nLive = pPool->m_nLiveCount.load(std::memory_order_relaxed);
+		unsigned long long nRemote = pPool->m_nRemoteFrees.load(std::memory_order_relaxed);
+
+		Statistics.nOutstanding += nLive > nRemote ? nLive - nRemote : 0;
+		Statistics.nBlocks += pPool->m_nBlockCount.load(std::memory_order_relaxed);
+		Statistics.nHighWaterMark += pPool->m_nHighWaterMark.load(std::memory_order_relaxed);
+		nTotal += pPool->m_nAllocations.load(std::memory_order_relaxed);
+	}
+
+	Statistics.nAllocations = nTotal - ms_nResetAllocations;
+
+	std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - ms_ResetTime;
+	if (Elapsed.count() > 0)
+		Statistics.dAllocationsPerSecond = Statistics.nAllocations / Elapsed.count();
+}
+
+
+template<class TYPE>
+/**--------------------------------------------------------------------------<BR>
+CMemoryPool<TYPE>::ResetStatistics <BR>
+Resets the allocation count and the start time for the rate.
+<P>---------------------------------------------------------------------------*/
+void CMemoryPool<TYPE>::ResetStatistics(void)
+{
+	std::lock_guard<std::mutex> Lock(ms_Mutex);
+
+	unsigned long long nTotal = ms_nDeletedAllocations;
+
+	for (CMemoryPool<TYPE>* pPool = ms_pPools; pPool != 0; pPool = pPool->m_pNextPool)
+		nTotal += pPool->m_nAllocations.load(std::memory_order_relaxed);
+
+	ms_nResetAllocations = nTotal;
+	ms_ResetTime = std::chrono::steady_clock::now();
+}
+
+
+template<class TYPE>
+/**--------------------------------------------------------------------------<BR>
+CMemoryPool<TYPE>::Trim <BR>
+Releases the blocks over the retention limit held by the calling thread if none
+of its objects are in use.
+<P>---------------------------------------------------------------------------*/
+void CMemoryPool<TYPE>::Trim(void)
+{
+	CMemoryPool<TYPE>* pPool = ms_pThreadPool;
+
+	if (pPool == 0)
+		return;
+
+	pPool->CollectRemote();
+
+	if (pPool->m_nLive == 0)
+		pPool->ReleaseSurplus();
+}
+
+
+template<class TYPE>
+/**--------------------------------------------------------------------------<BR>
+CMemoryPool<TYPE>::PAllocate <BR>
 Allocates memory.
 <P>---------------------------------------------------------------------------*/
 void* CMemoryPool<TYPE>::PAllocate(void)
 {
-
-	// If we have no data then create some
-    if (m_pList == 0)
+	// If we have no data then take any freed by other threads or create some
+	if (m_pList == 0)
 	{
-		// Create a load of items - just allocate the memory
-	//	sList* pData = new sList[_BLOCK_SIZE];
+		CollectRemote();
 
-		char* pData = new char[sizeof(sList) * _BLOCK_SIZE];
-		// Record this for later deletion
-		m_Blocks.push_back(pData);
-		// Create a linked list for allocation
-		sList* pList = (sList*) pData;
-		// Initialise the head
-		m_pList = pList;
-		// Create the linked list
-		for (unsigned int i = 1; i < _BLOCK_SIZE; i++)
-		{
-		//	pData++;
-			pData += sizeof(sList);
-			pList->pNext = (sList*) pData;
-			pList = pList->pNext;
-		}
-		// Terminate the list
-        pList->pNext = 0;
+		if (m_pList == 0)
+			AddBlock();
 	}
-	// Get the return value
-	sList* pList = m_pList;
 	// Take it off the top of the list
-	m_pList = m_pList->pNext;
-	// Return it.
-	return pList;
+	sFree* pFree = m_pList;
+
+	m_pList = pFree->pNext;
+
+	CountAllocation();
+
+	return pFree;
 }
 
 
 template<class TYPE>
 /**--------------------------------------------------------------------------<BR>
-CMemoryPool<TYPE>::Allocate <BR>
-Deallocates/recycles memory.
+CMemoryPool<TYPE>::PDeallocate <BR>
+Deallocates/recycles memory. When the last object is freed the blocks over the
+retention limit are released.
 <P>---------------------------------------------------------------------------*/
 void CMemoryPool<TYPE>::PDeallocate(void* pData)
 {
-	// Cast this to a list entry
-	sList* pList = (sList*)pData;
+	sFree* pFree = static_cast<sFree*>(pData);
 	// Insert it for reallocation.
-	pList->pNext = m_pList;
+	pFree->pNext = m_pList;
+
+	m_pList = pFree;
+
+	m_nLive--;
+	m_nLiveCount.store(m_nLive, std::memory_order_relaxed);
+
+	if (m_nLive == 0 && m_Blocks.size() > ms_nRetainedBlocks.load(std::memory_order_relaxed))
+		ReleaseSurplus();
+}
+
+
+template<class TYPE>
+/**--------------------------------------------------------------------------<BR>
+CMemoryPool<TYPE>::RemoteDeallocate <BR>
+Passes memory freed by another thread back to this pool.
+<P>---------------------------------------------------------------------------*/
+void CMemoryPool<TYPE>::RemoteDeallocate(void* pData)
+{
+	sFree* pFree = static_cast<sFree*>(pData);
+
+	m_nRemoteFrees.fetch_add(1, std::memory_order_relaxed);
+
+	pFree->pNext = m_pRemoteList.load(std::memory_order_relaxed);
+
+	while (!m_pRemoteList.compare_exchange_weak(pFree->pNext, pFree,
+			std::memory_order_release, std::memory_order_relaxed))
+	{
+	}
+}
+
+
+template<class TYPE>
+/**--------------------------------------------------------------------------<BR>
+CMemoryPool<TYPE>::CollectRemote <BR>
+Takes all the objects freed by other threads in one exchange.
+<P>---------------------------------------------------------------------------*/
+void CMemoryPool<TYPE>::CollectRemote(void)
+{
+	sFree* pRemote = m_pRemoteList.exchange(0, std::memory_order_acquire);
+
+	if (pRemote == 0)
+		return;
+
+	size_t nCount = 1;
+	sFree* pLast = pRemote;
+	while (pLast->pNext != 0)
+	{
+		pLast = pLast->pNext;
+		nCount++;
+	}
+
+	pLast->pNext = m_pList;
+	m_pList = pRemote;
+
+	m_nRemoteFrees.fetch_sub(nCount, std::memory_order_relaxed);
+	m_nLive -= nCount;
+	m_nLiveCount.store(m_nLive, std::memory_order_relaxed);
+}
+
+
+template<class TYPE>
+/**--------------------------------------------------------------------------<BR>
+CMemoryPool<TYPE>::AddBlock <BR>
+Allocates a block and links its objects into the free list.
+<P>---------------------------------------------------------------------------*/
+void CMemoryPool<TYPE>::AddBlock(void)
+{
+	const size_t nStride = GetStride();
+
+	sBlock Block;
+	Block.nObjects = ms_nBlockSize.load(std::memory_order_relaxed);
+	Block.pData = new char[nStride * Block.nObjects];
+
+	// Record this for later deletion
+	m_Blocks.push_back(Block);
+	m_nBlockCount.store(m_Blocks.size(), std::memory_order_relaxed);
+
+	// Create the linked list backwards so allocation runs forwards through the block
+	char* pData = Block.pData + nStride * Block.nObjects;
+	for (unsigned int i = 0; i < Block.nObjects; i++)
+	{
+		pData -= nStride;
+		reinterpret_cast<sHeader*>(pData)->pOwner = this;
+
+		sFree* pFree = reinterpret_cast<sFree*>(pData + sizeof(sHeader));
+		pFree->pNext = m_pList;
+		m_pList = pFree;
+	}
+}
+
+
+template<class TYPE>
+/**--------------------------------------------------------------------------<BR>
+CMemoryPool<TYPE>::ReleaseSurplus <BR>
+Frees the blocks over the retention limit and relinks the free list through those
+kept. Only valid when no objects are allocated.
+<P>---------------------------------------------------------------------------*/
+void CMemoryPool<TYPE>::ReleaseSurplus(void)
+{
+	unsigned int nRetain = ms_nRetainedBlocks.load(std::memory_order_relaxed);
+
+	if (m_Blocks.size() <= nRetain)
+		return;
+
+	for (size_t i = nRetain; i < m_Blocks.size(); i++)
+		delete[] m_Blocks[i].pData;
+
+	m_Blocks.resize(nRetain);
+	m_nBlockCount.store(m_Blocks.size(), std::memory_order_relaxed);
+
+	const size_t nStride = GetStride();
+
+	m_pList = 0;
+	for (size_t b = 0; b < m_Blocks.size(); b++)
+	{
+		char* pData = m_Blocks[b].pData + nStride * m_Blocks[b].nObjects;
+		for (unsigned int i = 0; i < m_Blocks[b].nObjects; i++)
+		{
+			pData -= nStride;
+			sFree* pFree = reinterpret_cast<sFree*>(pData + sizeof(sHeader));
+			pFree->pNext = m_pList;
+			m_pList = pFree;
+		}
+	}
+}
+
+
+template<class TYPE>
+/**--------------------------------------------------------------------------<BR>
+CMemoryPool<TYPE>::Clear <BR>
+Clear.
+<P>---------------------------------------------------------------------------*/
+void CMemoryPool<TYPE>::Clear(void)
+{
+	for (size_t i = 0; i < m_Blocks.size(); i++)
+	{
+		delete[] m_Blocks[i].pData;
+	}
+
+	m_Blocks.clear();
+	m_nBlockCount.store(0, std::memory_order_relaxed);
+
+	m_pList = 0;
+}
+
+
+template<class TYPE>
+/**--------------------------------------------------------------------------<BR>
+CMemoryPool<TYPE>::CountAllocation <BR>
+Records an allocation. Only the owning thread writes these so no atomic read
+modify write is needed.
+<P>---------------------------------------------------------------------------*/
+void CMemoryPool<TYPE>::CountAllocation(void)
+{
+	m_nLive++;
+	m_nLiveCount.store(m_nLive, std::memory_order_relaxed);
+
+	m_nAllocations.store(m_nAllocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 
-	m_pList = pList;
+	if (m_nLive > m_nHighWaterMark.load(std::memory_order_relaxed))
+		m_nHighWaterMark.store(m_nLive, std::memory_order_relaxed);
 }
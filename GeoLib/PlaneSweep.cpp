@@ -0,0 +1,893 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file PlaneSweep.cpp
+\brief Implementation file for the CPlaneSweep class.
+
+Implementation file for CPlaneSweep, boolean operations on any number of polygons
+in one sweep.
+<P>---------------------------------------------------------------------------*/
+
+
+#include "StdAfx.h"
+#include "PlaneSweep.h"
+#include "Predicates.h"
+#include "SegmentSweep.h"
+#include "Grid.h"
+#include "C2DLine.h"
+#include "C2DLineBaseSet.h"
+#include "C2DPolyBase.h"
+#include "C2DHoledPolyBase.h"
+#include "C2DHoledPolyBaseSet.h"
+#include <algorithm>
+#include <set>
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::CPlaneSweep <BR>
+\brief Constructor.
+<P>---------------------------------------------------------------------------*/
+CPlaneSweep::CPlaneSweep(void)
+{
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::~CPlaneSweep <BR>
+\brief Destructor.
+<P>---------------------------------------------------------------------------*/
+CPlaneSweep::~CPlaneSweep(void)
+{
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::AddSubject <BR>
+\brief Adds the polygon to the subject.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::AddSubject(const C2DPolyBase& Poly)
+{
+	AddPoly(Poly, 0, false);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::AddSubject <BR>
+\brief Adds the holed polygon to the subject.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::AddSubject(const C2DHoledPolyBase& Poly)
+{
+	AddHoledPoly(Poly, 0);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::AddSubject <BR>
+\brief Adds the holed polygons to the subject.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::AddSubject(const C2DHoledPolyBaseSet& Polys)
+{
+	for (unsigned int i = 0; i < Polys.size(); i++)
+		AddHoledPoly(*Polys.GetAt(i), 0);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::AddClip <BR>
+\brief Adds the polygon to the clip.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::AddClip(const C2DPolyBase& Poly)
+{
+	AddPoly(Poly, 1, false);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::AddClip <BR>
+\brief Adds the holed polygon to the clip.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::AddClip(const C2DHoledPolyBase& Poly)
+{
+	AddHoledPoly(Poly, 1);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::AddClip <BR>
+\brief Adds the holed polygons to the clip.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::AddClip(const C2DHoledPolyBaseSet& Polys)
+{
+	for (unsigned int i = 0; i < Polys.size(); i++)
+		AddHoledPoly(*Polys.GetAt(i), 1);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::Clear <BR>
+\brief Clears all.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::Clear(void)
+{
+	m_Edges.clear();
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::AddHoledPoly <BR>
+\brief Adds the rim and the holes.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::AddHoledPoly(const C2DHoledPolyBase& Poly, unsigned int nGroup)
+{
+	if (Poly.GetRim() == 0)
+		return;
+
+	AddPoly(*Poly.GetRim(), nGroup, false);
+
+	for (unsigned int i = 0; i < Poly.GetHoleCount(); i++)
+		AddPoly(*Poly.GetHole(i), nGroup, true);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::AddPoly <BR>
+\brief Adds the lines so the winding is 1 inside a rim and drops by 1 inside a hole
+whichever way round the lines go.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::AddPoly(const C2DPolyBase& Poly, unsigned int nGroup, bool bHole)
+{
+	unsigned int nLines = Poly.GetLineCount();
+
+	if (nLines < 2)
+		return;
+
+	int nWind = Poly.IsClockwise() ? -1 : 1;
+	if (bHole)
+		nWind = -nWind;
+
+	// Lines hold their end as a vector from the start so it is taken from the next
+	// line to meet it exactly.
+	C2DPoint ptFirst = Poly.GetLine(0)->GetPointFrom();
+	C2DPoint ptFrom = ptFirst;
+
+	for (unsigned int i = 0; i < nLines; i++)
+	{
+		sEdge Edge;
+		Edge.ptFrom = ptFrom;
+		Edge.ptTo = i + 1 < nLines ? Poly.GetLine(i + 1)->GetPointFrom() : ptFirst;
+		ptFrom = Edge.ptTo;
+		Edge.nGroup = nGroup;
+		Edge.nWind = nWind;
+
+		if (!IsSame(Edge.ptFrom, Edge.ptTo))
+			m_Edges.push_back(Edge);
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::Execute <BR>
+\brief Finds the result in one sweep. A piece bounds the result if the result is
+inside on one side of it and not the other.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::Execute(eOperation eOp, C2DHoledPolyBaseSet& Result, eFillRule eFill) const
+{
+	struct sInside
+	{
+		eOperation eOp;
+		eFillRule eFill;
+
+		bool IsFilled(int nWind) const
+		{
+			switch (eFill)
+			{
+			case EvenOdd:
+				return (nWind & 1) != 0;
+			case NonZero:
+				return nWind != 0;
+			case Positive:
+				return nWind > 0;
+			}
+			return false;
+		}
+
+		bool operator()(const int* pWind) const
+		{
+			bool bSubject = IsFilled(pWind[0]);
+			bool bClip = IsFilled(pWind[1]);
+
+			switch (eOp)
+			{
+			case Union:
+				return bSubject || bClip;
+			case Intersection:
+				return bSubject && bClip;
+			case Difference:
+				return bSubject && !bClip;
+			case ExclusiveOr:
+				return bSubject != bClip;
+			}
+			return false;
+		}
+	};
+
+	if (m_Edges.empty())
+		return;
+
+	std::vector<sPiece> Pieces;
+	GetPieces(Pieces);
+	MergePieces(Pieces);
+	SetWinding(Pieces);
+
+	sInside Inside;
+	Inside.eOp = eOp;
+	Inside.eFill = eFill;
+
+	std::vector<sBound> Bounds;
+
+	for (size_t i = 0; i < Pieces.size(); i++)
+	{
+		const sPiece& Piece = Pieces[i];
+
+		bool bBelow = Inside(Piece.nBelow);
+		bool bAbove = Inside(Piece.nAbove);
+
+		if (bBelow == bAbove)
+			continue;
+
+		sBound Bound;
+		// Going left to right the piece has above on its left.
+		if (bAbove)
+		{
+			Bound.ptFrom = Piece.ptLeft;
+			Bound.ptTo = Piece.ptRight;
+		}
+		else
+		{
+			Bound.ptFrom = Piece.ptRight;
+			Bound.ptTo = Piece.ptLeft;
+		}
+		Bounds.push_back(Bound);
+	}
+
+	std::vector< std::vector<C2DPoint> > Loops;
+	GetLoops(Bounds, Loops);
+	MakePolygons(Loops, Result);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::GetPieces <BR>
+\brief Splits the edges into pieces which only meet at their ends. The pairs of edges
+which meet are found by a segment sweep so edges far apart are never tested.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::GetPieces(std::vector<sPiece>& Pieces) const
+{
+	struct sBySplit
+	{
+		bool operator()(const sSplit& S1, const sSplit& S2) const
+			{ return S1.nEdge < S2.nEdge || (S1.nEdge == S2.nEdge && S1.dPos < S2.dPos);}
+	};
+
+	unsigned int nEdges = (unsigned int)m_Edges.size();
+
+	CSegmentSweep Sweep;
+	for (unsigned int i = 0; i < nEdges; i++)
+		Sweep.AddLine(m_Edges[i].ptFrom, m_Edges[i].ptTo);
+
+	std::vector<CSegmentSweep::sCrossing> Crossings;
+	Sweep.GetCrossings(Crossings);
+
+	std::vector<sSplit> Splits;
+
+	for (size_t i = 0; i < Crossings.size(); i++)
+		GetSplits(Crossings[i].nLine1, Crossings[i].nLine2, Splits);
+
+	WeldSplits(Splits);
+
+	std::sort(Splits.begin(), Splits.end(), sBySplit());
+
+	Pieces.reserve(nEdges + Splits.size());
+
+	size_t nSplit = 0;
+
+	for (unsigned int i = 0; i < nEdges; i++)
+	{
+		const sEdge& Edge = m_Edges[i];
+
+		sPiece Piece;
+		Piece.nWind[0] = 0;
+		Piece.nWind[1] = 0;
+
+		C2DPoint ptLast = Edge.ptFrom;
+
+		while (true)
+		{
+			bool bEnd = nSplit >= Splits.size() || Splits[nSplit].nEdge != i;
+			const C2DPoint& ptNext = bEnd ? Edge.ptTo : Splits[nSplit].pt;
+
+			if (!IsSame(ptLast, ptNext))
+			{
+				bool bForward = IsBefore(ptLast, ptNext);
+				Piece.ptLeft = bForward ? ptLast : ptNext;
+				Piece.ptRight = bForward ? ptNext : ptLast;
+				Piece.nWind[Edge.nGroup] = bForward ? Edge.nWind : -Edge.nWind;
+				Pieces.push_back(Piece);
+
+				ptLast = ptNext;
+			}
+
+			if (bEnd)
+				break;
+			nSplit++;
+		}
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::GetSplits <BR>
+\brief Adds the splits for the pair of edges. Crossings are split on both, an end
+lying on the other edge splits that edge and edges in line split each other at
+their ends so the shared part becomes the same piece on both.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::GetSplits(unsigned int nEdge1, unsigned int nEdge2, std::vector<sSplit>& Splits) const
+{
+	struct sAdd
+	{
+		const std::vector<sEdge>* pEdges;
+		std::vector<sSplit>* pSplits;
+		void operator()(unsigned int nEdge, const C2DPoint& pt) const
+		{
+			const sEdge& Edge = (*pEdges)[nEdge];
+			sSplit Split;
+			Split.nEdge = nEdge;
+			Split.dPos = (pt.x - Edge.ptFrom.x) * (Edge.ptTo.x - Edge.ptFrom.x) +
+						 (pt.y - Edge.ptFrom.y) * (Edge.ptTo.y - Edge.ptFrom.y);
+			Split.pt = pt;
+			pSplits->push_back(Split);
+		}
+	};
+
+	sAdd Add;
+	Add.pEdges = &m_Edges;
+	Add.pSplits = &Splits;
+
+	const sEdge& Edge1 = m_Edges[nEdge1];
+	const sEdge& Edge2 = m_Edges[nEdge2];
+
+	double dOrient1 = CPredicates::Orient2D(Edge1.ptFrom, Edge1.ptTo, Edge2.ptFrom);
+	double dOrient2 = CPredicates::Orient2D(Edge1.ptFrom, Edge1.ptTo, Edge2.ptTo);
+
+	if (dOrient1 == 0 && dOrient2 == 0)
+	{
+		if (IsWithin(Edge1, Edge2.ptFrom))
+			Add(nEdge1, Edge2.ptFrom);
+		if (IsWithin(Edge1, Edge2.ptTo))
+			Add(nEdge1, Edge2.ptTo);
+		if (IsWithin(Edge2, Edge1.ptFrom))
+			Add(nEdge2, Edge1.ptFrom);
+		if (IsWithin(Edge2, Edge1.ptTo))
+			Add(nEdge2, Edge1.ptTo);
+		return;
+	}
+
+	double dOrient3 = CPredicates::Orient2D(Edge2.ptFrom, Edge2.ptTo, Edge1.ptFrom);
+	double dOrient4 = CPredicates::Orient2D(Edge2.ptFrom, Edge2.ptTo, Edge1.ptTo);
+
+	if (((dOrient1 > 0 && dOrient2 < 0) || (dOrient1 < 0 && dOrient2 > 0)) &&
+		((dOrient3 > 0 && dOrient4 < 0) || (dOrient3 < 0 && dOrient4 > 0)))
+	{
+		// The orientation is linear along the first edge so it is 0 this far along.
+		double dFactor = dOrient3 / (dOrient3 - dOrient4);
+
+		C2DPoint pt(Edge1.ptFrom.x + dFactor * (Edge1.ptTo.x - Edge1.ptFrom.x),
+					Edge1.ptFrom.y + dFactor * (Edge1.ptTo.y - Edge1.ptFrom.y));
+
+		// Keep the rounded point within both edges' bounds.
+		double dMinX = std::max(std::min(Edge1.ptFrom.x, Edge1.ptTo.x), std::min(Edge2.ptFrom.x, Edge2.ptTo.x));
+		double dMaxX = std::min(std::max(Edge1.ptFrom.x, Edge1.ptTo.x), std::max(Edge2.ptFrom.x, Edge2.ptTo.x));
+		double dMinY = std::max(std::min(Edge1.ptFrom.y, Edge1.ptTo.y), std::min(Edge2.ptFrom.y, Edge2.ptTo.y));
+		double dMaxY = std::min(std::max(Edge1.ptFrom.y, Edge1.ptTo.y), std::max(Edge2.ptFrom.y, Edge2.ptTo.y));
+		pt.x = std::min(std::max(pt.x, dMinX), dMaxX);
+		pt.y = std::min(std::max(pt.y, dMinY), dMaxY);
+
+		Add(nEdge1, pt);
+		Add(nEdge2, pt);
+		return;
+	}
+
+	if (dOrient1 == 0 && IsWithin(Edge1, Edge2.ptFrom))
+		Add(nEdge1, Edge2.ptFrom);
+	if (dOrient2 == 0 && IsWithin(Edge1, Edge2.ptTo))
+		Add(nEdge1, Edge2.ptTo);
+	if (dOrient3 == 0 && IsWithin(Edge2, Edge1.ptFrom))
+		Add(nEdge2, Edge1.ptFrom);
+	if (dOrient4 == 0 && IsWithin(Edge2, Edge1.ptTo))
+		Add(nEdge2, Edge1.ptTo);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::WeldSplits <BR>
+\brief Moves splits within the equality tolerance of each other or of the end of an
+edge to the same point. Where three or more edges cross at a point each pair rounds
+the crossing differently and without this the pieces would not meet. A group takes
+the end of an edge if it has one so the ends given are never moved.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::WeldSplits(std::vector<sSplit>& Splits) const
+{
+	struct sItem
+	{
+		C2DPoint pt;
+		unsigned int nGroup;
+		bool bEnd;
+	};
+	struct sByX
+	{
+		const std::vector<sItem>* pItems;
+		bool operator()(unsigned int n1, unsigned int n2) const
+			{ return (*pItems)[n1].pt.x < (*pItems)[n2].pt.x;}
+	};
+
+	if (Splits.empty())
+		return;
+
+	double dMax = 0;
+	for (size_t i = 0; i < m_Edges.size(); i++)
+	{
+		dMax = std::max(dMax, std::max(fabs(m_Edges[i].ptFrom.x), fabs(m_Edges[i].ptFrom.y)));
+	}
+	double dTol = dMax * conEqualityTolerance;
+
+	unsigned int nSplits = (unsigned int)Splits.size();
+	unsigned int nItems = nSplits + (unsigned int)m_Edges.size();
+
+	std::vector<sItem> Items(nItems);
+	std::vector<unsigned int> Order(nItems);
+
+	for (unsigned int i = 0; i < nItems; i++)
+	{
+		Items[i].pt = i < nSplits ? Splits[i].pt : m_Edges[i - nSplits].ptFrom;
+		Items[i].nGroup = i;
+		Items[i].bEnd = i >= nSplits;
+		Order[i] = i;
+	}
+
+	sByX ByX;
+	ByX.pItems = &Items;
+	std::sort(Order.begin(), Order.end(), ByX);
+
+	// Each item points along its group to the first, which is an end if the group has one.
+	for (unsigned int i = 0; i < nItems; i++)
+	{
+		const sItem& Item = Items[Order[i]];
+
+		for (unsigned int j = i + 1; j < nItems && Items[Order[j]].pt.x - Item.pt.x <= dTol; j++)
+		{
+			const sItem& Other = Items[Order[j]];
+			if (fabs(Other.pt.y - Item.pt.y) > dTol || (Item.bEnd && Other.bEnd))
+				continue;
+
+			unsigned int nRoot1 = Order[i];
+			while (Items[nRoot1].nGroup != nRoot1)
+				nRoot1 = Items[nRoot1].nGroup;
+			unsigned int nRoot2 = Order[j];
+			while (Items[nRoot2].nGroup != nRoot2)
+				nRoot2 = Items[nRoot2].nGroup;
+
+			if (nRoot1 == nRoot2 || (Items[nRoot1].bEnd && Items[nRoot2].bEnd))
+				continue;
+
+			if (Items[nRoot2].bEnd || (!Items[nRoot1].bEnd && nRoot2 < nRoot1))
+				Items[nRoot1].nGroup = nRoot2;
+			else
+				Items[nRoot2].nGroup = nRoot1;
+		}
+	}
+
+	for (unsigned int i = 0; i < nSplits; i++)
+	{
+		unsigned int nRoot = i;
+		while (Items[nRoot].nGroup != nRoot)
+			nRoot = Items[nRoot].nGroup;
+
+		if (nRoot == i)
+			continue;
+
+		sSplit& Split = Splits[i];
+		const sEdge& Edge = m_Edges[Split.nEdge];
+		Split.pt = Items[nRoot].pt;
+		Split.dPos = (Split.pt.x - Edge.ptFrom.x) * (Edge.ptTo.x - Edge.ptFrom.x) +
+					 (Split.pt.y - Edge.ptFrom.y) * (Edge.ptTo.y - Edge.ptFrom.y);
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::IsWithin <BR>
+\brief True if the point, known to be in line, is strictly between the ends of the
+edge. Compared along whichever axis the edge is longer in.
+<P>---------------------------------------------------------------------------*/
+bool CPlaneSweep::IsWithin(const sEdge& Edge, const C2DPoint& pt)
+{
+	double dx = Edge.ptTo.x - Edge.ptFrom.x;
+	double dy = Edge.ptTo.y - Edge.ptFrom.y;
+
+	if (fabs(dx) >= fabs(dy))
+		return dx > 0 ? (pt.x > Edge.ptFrom.x && pt.x < Edge.ptTo.x) :
+						(pt.x < Edge.ptFrom.x && pt.x > Edge.ptTo.x);
+	else
+		return dy > 0 ? (pt.y > Edge.ptFrom.y && pt.y < Edge.ptTo.y) :
+						(pt.y < Edge.ptFrom.y && pt.y > Edge.ptTo.y);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::MergePieces <BR>
+\brief Merges equal pieces summing their winding. Pieces that then add nothing to
+either group have the same on both sides so are dropped.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::MergePieces(std::vector<sPiece>& Pieces)
+{
+	struct sByEnds
+	{
+		bool operator()(const sPiece& P1, const sPiece& P2) const
+		{
+			if (!IsSame(P1.ptLeft, P2.ptLeft))
+				return IsBefore(P1.ptLeft, P2.ptLeft);
+			return IsBefore(P1.ptRight, P2.ptRight);
+		}
+	};
+
+	std::sort(Pieces.begin(), Pieces.end(), sByEnds());
+
+	size_t nOut = 0;
+
+	for (size_t i = 0; i < Pieces.size(); )
+	{
+		sPiece Piece = Pieces[i];
+
+		size_t j = i + 1;
+		while (j < Pieces.size() && IsSame(Pieces[j].ptLeft, Piece.ptLeft) &&
+				IsSame(Pieces[j].ptRight, Piece.ptRight))
+		{
+			Piece.nWind[0] += Pieces[j].nWind[0];
+			Piece.nWind[1] += Pieces[j].nWind[1];
+			j++;
+		}
+
+		if (Piece.nWind[0] != 0 || Piece.nWind[1] != 0)
+			Pieces[nOut++] = Piece;
+
+		i = j;
+	}
+
+	Pieces.resize(nOut);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::SetWinding <BR>
+\brief Sweeps the pieces from left to right, in x then y, keeping those the sweep
+line is on in an ordered set from bottom to top. Pieces only meet at their ends so
+one which starts is placed against each by which side of it its left end is on, or
+its right if the left is on it. When a piece starts the winding below it is the
+winding above the piece under it. Points are ordered in x then y so an upright
+piece has its right side below it. Pieces ending at a point are taken out before
+those starting there go in, bottom first.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::SetWinding(std::vector<sPiece>& Pieces)
+{
+	struct sEvent
+	{
+		unsigned int nPiece;
+		bool bStart;
+	};
+
+	struct sByPoint
+	{
+		const std::vector<sPiece>* pPieces;
+		bool operator()(const sEvent& E1, const sEvent& E2) const
+		{
+			const sPiece& P1 = (*pPieces)[E1.nPiece];
+			const sPiece& P2 = (*pPieces)[E2.nPiece];
+			const C2DPoint& pt1 = E1.bStart ? P1.ptLeft : P1.ptRight;
+			const C2DPoint& pt2 = E2.bStart ? P2.ptLeft : P2.ptRight;
+
+			if (!IsSame(pt1, pt2))
+				return IsBefore(pt1, pt2);
+			if (E1.bStart != E2.bStart)
+				return !E1.bStart;
+			if (E1.bStart)
+			{
+				double dOrient = CPredicates::Orient2D(pt1, P1.ptRight, P2.ptRight);
+				if (dOrient != 0)
+					return dOrient > 0;
+			}
+			return E1.nPiece < E2.nPiece;
+		}
+	};
+
+	struct sIsBelow
+	{
+		const std::vector<sPiece>* pPieces;
+		// Positive if the piece is above the other, which starts no later.
+		static double Side(const sPiece& Other, const sPiece& Piece)
+		{
+			double dOrient = CPredicates::Orient2D(Other.ptLeft, Other.ptRight, Piece.ptLeft);
+			if (dOrient == 0)
+				dOrient = CPredicates::Orient2D(Other.ptLeft, Other.ptRight, Piece.ptRight);
+			return dOrient;
+		}
+		bool operator()(unsigned int n1, unsigned int n2) const
+		{
+			if (n1 == n2)
+				return false;
+			const sPiece& P1 = (*pPieces)[n1];
+			const sPiece& P2 = (*pPieces)[n2];
+			if (IsBefore(P2.ptLeft, P1.ptLeft))
+				return Side(P2, P1) < 0;
+			return Side(P1, P2) > 0;
+		}
+	};
+	typedef std::multiset<unsigned int, sIsBelow> PieceSet;
+
+	unsigned int nPieces = (unsigned int)Pieces.size();
+
+	std::vector<sEvent> Events(2 * nPieces);
+	for (unsigned int i = 0; i < nPieces; i++)
+	{
+		Events[2 * i].nPiece = i;
+		Events[2 * i].bStart = true;
+		Events[2 * i + 1].nPiece = i;
+		Events[2 * i + 1].bStart = false;
+	}
+
+	sByPoint ByPoint;
+	ByPoint.pPieces = &Pieces;
+	std::sort(Events.begin(), Events.end(), ByPoint);
+
+	sIsBelow IsBelow;
+	IsBelow.pPieces = &Pieces;
+
+	PieceSet Active(IsBelow);
+	std::vector<PieceSet::iterator> Nodes(nPieces, Active.end());
+
+	for (size_t i = 0; i < Events.size(); i++)
+	{
+		unsigned int nPiece = Events[i].nPiece;
+
+		if (!Events[i].bStart)
+		{
+			if (Nodes[nPiece] != Active.end())
+			{
+				Active.erase(Nodes[nPiece]);
+				Nodes[nPiece] = Active.end();
+			}
+			continue;
+		}
+
+		PieceSet::iterator it = Active.insert(nPiece);
+		Nodes[nPiece] = it;
+
+		PieceSet::iterator itBelow = it;
+		bool bBelow = it != Active.begin();
+		if (bBelow)
+			--itBelow;
+
+		sPiece& Piece = Pieces[nPiece];
+		for (unsigned int g = 0; g < 2; g++)
+		{
+			Piece.nBelow[g] = bBelow ? Pieces[*itBelow].nAbove[g] : 0;
+			Piece.nAbove[g] = Piece.nBelow[g] + Piece.nWind[g];
+		}
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::GetLoops <BR>
+\brief Joins the bounds into loops. Where more than one leaves a point the one
+turning furthest left is taken so shapes touching at a point stay apart. Collinear
+points are then removed.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::GetLoops(std::vector<sBound>& Bounds, std::vector< std::vector<C2DPoint> >& Loops)
+{
+	struct sByFrom
+	{
+		bool operator()(const sBound& B1, const sBound& B2) const
+			{ return IsBefore(B1.ptFrom, B2.ptFrom);}
+		bool operator()(const sBound& B, const C2DPoint& pt) const
+			{ return IsBefore(B.ptFrom, pt);}
+	};
+
+	std::sort(Bounds.begin(), Bounds.end(), sByFrom());
+
+	std::vector<bool> Used(Bounds.size(), false);
+	std::vector<C2DPoint> Loop;
+
+	for (size_t nStart = 0; nStart < Bounds.size(); nStart++)
+	{
+		if (Used[nStart])
+			continue;
+
+		Loop.clear();
+
+		size_t nCurrent = nStart;
+		Used[nCurrent] = true;
+		bool bClosed = false;
+
+		while (true)
+		{
+			const sBound& Current = Bounds[nCurrent];
+			Loop.push_back(Current.ptFrom);
+
+			if (IsSame(Current.ptTo, Bounds[nStart].ptFrom))
+			{
+				bClosed = true;
+				break;
+			}
+
+			double dBackX = Current.ptFrom.x - Current.ptTo.x;
+			double dBackY = Current.ptFrom.y - Current.ptTo.y;
+
+			size_t nNext = Bounds.size();
+			double dBest = 0;
+
+			std::vector<sBound>::const_iterator it = std::lower_bound(Bounds.begin(), Bounds.end(),
+												Current.ptTo, sByFrom());
+			for (size_t i = it - Bounds.begin(); i < Bounds.size() && IsSame(Bounds[i].ptFrom, Current.ptTo); i++)
+			{
+				if (Used[i])
+					continue;
+
+				double dOutX = Bounds[i].ptTo.x - Current.ptTo.x;
+				double dOutY = Bounds[i].ptTo.y - Current.ptTo.y;
+
+				// The angle clockwise from the way back to the way out.
+				double dAng = -atan2(dBackX * dOutY - dBackY * dOutX, dBackX * dOutX + dBackY * dOutY);
+				if (dAng <= 0)
+					dAng += conTWOPI;
+
+				if (nNext == Bounds.size() || dAng < dBest)
+				{
+					nNext = i;
+					dBest = dAng;
+				}
+			}
+
+			if (nNext == Bounds.size())
+				break;
+
+			Used[nNext] = true;
+			nCurrent = nNext;
+		}
+
+		if (!bClosed)
+		{
+			CGrid::LogDegenerateError();
+			continue;
+		}
+
+		std::vector<C2DPoint> Simple;
+		Simple.reserve(Loop.size());
+
+		for (size_t i = 0; i < Loop.size(); i++)
+		{
+			while (Simple.size() >= 2 &&
+					CPredicates::Orient2D(Simple[Simple.size() - 2], Simple.back(), Loop[i]) == 0)
+				Simple.pop_back();
+			Simple.push_back(Loop[i]);
+		}
+
+		size_t nFirst = 0;
+		while (Simple.size() - nFirst >= 3)
+		{
+			if (CPredicates::Orient2D(Simple[Simple.size() - 2], Simple.back(), Simple[nFirst]) == 0)
+				Simple.pop_back();
+			else if (CPredicates::Orient2D(Simple.back(), Simple[nFirst], Simple[nFirst + 1]) == 0)
+				nFirst++;
+			else
+				break;
+		}
+
+		if (Simple.size() - nFirst < 3)
+			continue;
+
+		Loops.push_back(std::vector<C2DPoint>(Simple.begin() + nFirst, Simple.end()));
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPlaneSweep::MakePolygons <BR>
+\brief Makes the loops into polygons. The result is on the left of every loop so
+anticlockwise loops are rims and clockwise ones are holes. Each hole goes in the
+smallest rim containing the middle of its first line, which is never on another
+loop as loops only meet at points.
+<P>---------------------------------------------------------------------------*/
+void CPlaneSweep::MakePolygons(std::vector< std::vector<C2DPoint> >& Loops, C2DHoledPolyBaseSet& Result)
+{
+	struct sRim
+	{
+		double dArea;
+		C2DHoledPolyBase* pPoly;
+		bool operator<(const sRim& Other) const { return dArea < Other.dArea;}
+	};
+
+	std::vector<sRim> Rims;
+	std::vector<C2DPolyBase*> Holes;
+
+	for (size_t i = 0; i < Loops.size(); i++)
+	{
+		const std::vector<C2DPoint>& Loop = Loops[i];
+		size_t nCount = Loop.size();
+
+		double dArea = 0;
+		C2DLineBaseSet Lines;
+		for (size_t j = 0; j < nCount; j++)
+		{
+			const C2DPoint& pt1 = Loop[j];
+			const C2DPoint& pt2 = Loop[(j + 1) % nCount];
+			dArea += pt1.x * pt2.y - pt2.x * pt1.y;
+			Lines.Add(new C2DLine(pt1, pt2));
+		}
+
+		if (dArea == 0)
+			continue;
+
+		C2DPolyBase* pPoly = new C2DPolyBase;
+		pPoly->CreateDirect(Lines);
+
+		if (dArea > 0)
+		{
+			sRim Rim;
+			Rim.dArea = dArea;
+			Rim.pPoly = new C2DHoledPolyBase;
+			Rim.pPoly->SetRimDirect(pPoly);
+			Rims.push_back(Rim);
+		}
+		else
+		{
+			Holes.push_back(pPoly);
+		}
+	}
+
+	std::sort(Rims.begin(), Rims.end());
+
+	for (size_t i = 0; i < Holes.size(); i++)
+	{
+		C2DPolyBase* pHole = Holes[i];
+		const C2DLineBase* pLine = pHole->GetLine(0);
+		C2DPoint ptTest = pLine->GetPointFrom();
+		ptTest += pLine->GetPointTo();
+		ptTest *= 0.5;
+
+		size_t j = 0;
+		for (; j < Rims.size(); j++)
+		{
+			const C2DPolyBase* pRim = Rims[j].pPoly->GetRim();
+			if (pRim->GetBoundingRect().Contains(ptTest) && pRim->Contains(ptTest, 0))
+				break;
+		}
+
+		if (j < Rims.size())
+		{
+			Rims[j].pPoly->AddHoleDirect(pHole);
+		}
+		else
+		{
+			CGrid::LogDegenerateError();
+			delete pHole;
+		}
+	}
+
+	for (size_t i = 0; i < Rims.size(); i++)
+		Result.Add(Rims[i].pPoly);
+}
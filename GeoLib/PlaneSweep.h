@@ -0,0 +1,166 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file PlaneSweep.h
+\brief Declaration file for the CPlaneSweep class.
+
+\class CPlaneSweep
+\brief Boolean operations on any number of polygons in one sweep.
+
+The lines of every polygon added go in one of two groups, the subject and the clip.
+All crossings are found at once and each line is split at them, lines lying on each
+other are merged and a sweep from left to right gives the winding number of each
+group on both sides of every piece. The fill rule turns a winding number into inside
+or outside for each group and the operation combines the two. Pieces with the result
+inside on one side only are joined into rims and holes.
+
+So a union of hundreds of shapes is one pass instead of hundreds of pairwise unions.
+Orientation is decided by CPredicates so pieces are always ordered the same way, and
+crossings within rounding of each other are welded so the pieces always meet.
+Lines are taken as straight between their ends so arcs become their chords.
+<P>---------------------------------------------------------------------------*/
+
+#ifndef _GEOLIB_CPLANESWEEP_H
+#define _GEOLIB_CPLANESWEEP_H
+
+
+#include "C2DPoint.h"
+#include <vector>
+
+
+class C2DPolyBase;
+class C2DHoledPolyBase;
+class C2DHoledPolyBaseSet;
+
+#ifdef _EXPORTING
+	#define CLASS_DECLSPEC		__declspec(dllexport)
+#else
+	#ifdef _STATIC
+		#define CLASS_DECLSPEC
+	#else
+		#define CLASS_DECLSPEC		__declspec(dllimport)
+	#endif
+#endif
+
+
+class CLASS_DECLSPEC CPlaneSweep
+{
+public:
+	/// How the subject and clip are combined.
+	enum eOperation
+	{
+		Union,
+		Intersection,
+		Difference,
+		ExclusiveOr,
+	};
+	/// Which winding numbers count as inside a group. Each holed polygon is inside
+	/// itself by 1 whichever way round its lines go.
+	enum eFillRule
+	{
+		EvenOdd,
+		NonZero,
+		Positive,
+	};
+
+	/// Constructor.
+	CPlaneSweep(void);
+	/// Destructor.
+	~CPlaneSweep(void);
+
+	/// Adds the polygon to the subject.
+	void AddSubject(const C2DPolyBase& Poly);
+	/// Adds the holed polygon to the subject.
+	void AddSubject(const C2DHoledPolyBase& Poly);
+	/// Adds the holed polygons to the subject.
+	void AddSubject(const C2DHoledPolyBaseSet& Polys);
+	/// Adds the polygon to the clip.
+	void AddClip(const C2DPolyBase& Poly);
+	/// Adds the holed polygon to the clip.
+	void AddClip(const C2DHoledPolyBase& Poly);
+	/// Adds the holed polygons to the clip.
+	void AddClip(const C2DHoledPolyBaseSet& Polys);
+	/// Clears all.
+	void Clear(void);
+	/// Returns the number of lines added.
+	unsigned int GetLineCount(void) const { return (unsigned int)m_Edges.size();}
+
+	/// Adds the result of the operation to the set given as new holed polygons.
+	void Execute(eOperation eOp, C2DHoledPolyBaseSet& Result, eFillRule eFill = NonZero) const;
+
+private:
+	/// A line added and the amount crossing it from right to left adds to the winding.
+	struct sEdge
+	{
+		C2DPoint ptFrom;
+		C2DPoint ptTo;
+		unsigned int nGroup;
+		int nWind;
+	};
+
+	/// A point where an edge is to be split and its position along the edge.
+	struct sSplit
+	{
+		unsigned int nEdge;
+		double dPos;
+		C2DPoint pt;
+	};
+
+	/// A piece of the edges between splits running from its lower point in x then y.
+	/// The winding numbers are for each group below and above it.
+	struct sPiece
+	{
+		C2DPoint ptLeft;
+		C2DPoint ptRight;
+		int nWind[2];
+		int nBelow[2];
+		int nAbove[2];
+	};
+
+	/// A piece of the result going round with the inside on its left.
+	struct sBound
+	{
+		C2DPoint ptFrom;
+		C2DPoint ptTo;
+	};
+
+	/// Adds the lines of the polygon to the group given.
+	void AddPoly(const C2DPolyBase& Poly, unsigned int nGroup, bool bHole);
+	/// Adds the lines of the holed polygon to the group given.
+	void AddHoledPoly(const C2DHoledPolyBase& Poly, unsigned int nGroup);
+
+	/// Splits the edges at every crossing and touch into pieces.
+	void GetPieces(std::vector<sPiece>& Pieces) const;
+	/// Adds the splits for a pair of edges whose bounds touch.
+	void GetSplits(unsigned int nEdge1, unsigned int nEdge2, std::vector<sSplit>& Splits) const;
+	/// Moves splits within rounding of each other or of an end of an edge together.
+	void WeldSplits(std::vector<sSplit>& Splits) const;
+	/// Merges equal pieces summing their winding and drops those which then add none.
+	static void MergePieces(std::vector<sPiece>& Pieces);
+	/// Sweeps the pieces to find the winding on each side.
+	static void SetWinding(std::vector<sPiece>& Pieces);
+	/// Joins the bounding pieces into closed loops.
+	static void GetLoops(std::vector<sBound>& Bounds, std::vector< std::vector<C2DPoint> >& Loops);
+	/// Makes rims and holes from the loops and adds them to the set.
+	static void MakePolygons(std::vector< std::vector<C2DPoint> >& Loops, C2DHoledPolyBaseSet& Result);
+
+	/// True if the point, known to be in line, is strictly between the ends of the edge.
+	static bool IsWithin(const sEdge& Edge, const C2DPoint& pt);
+	/// True if the first point comes first in x then y.
+	static bool IsBefore(const C2DPoint& pt1, const C2DPoint& pt2)
+		{ return pt1.x < pt2.x || (pt1.x == pt2.x && pt1.y < pt2.y);}
+	/// True if the points are exactly the same.
+	static bool IsSame(const C2DPoint& pt1, const C2DPoint& pt2)
+		{ return pt1.x == pt2.x && pt1.y == pt2.y;}
+
+	/// The edges of both groups.
+	std::vector<sEdge> m_Edges;
+};
+
+
+#endif
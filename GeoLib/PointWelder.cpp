@@ -0,0 +1,234 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file PointWelder.cpp
+\brief Implementation file for the CPointWelder class.
+<P>---------------------------------------------------------------------------*/
+
+
+#include "StdAfx.h"
+#include "PointWelder.h"
+#include "C2DRect.h"
+#include "C2DPointSet.h"
+#include "Constants.h"
+#include <math.h>
+
+
+/**--------------------------------------------------------------------------<BR>
+CPointWelder::CPointWelder <BR>
+\brief Constructor.
+<P>---------------------------------------------------------------------------*/
+CPointWelder::CPointWelder(double dTolerance) : m_dTolerance(dTolerance), m_dCell(1), m_dInvCell(1)
+{
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPointWelder::~CPointWelder <BR>
+\brief Destructor.
+<P>---------------------------------------------------------------------------*/
+CPointWelder::~CPointWelder(void)
+{
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPointWelder::Reset <BR>
+\brief Clears and sizes the grid. With a tolerance the cells are that big. Without,
+points are only the same if within the relative tolerance of C2DPoint equality of
+each other, which is at most that of the largest coordinate in the bounds.
+<P>---------------------------------------------------------------------------*/
+void CPointWelder::Reset(const C2DRect& Bounds, unsigned int nExpected)
+{
+	if (m_dTolerance > 0)
+	{
+		m_dCell = m_dTolerance;
+	}
+	else
+	{
+		const C2DPoint& ptTopLeft = Bounds.GetTopLeft();
+		const C2DPoint& ptBottomRight = Bounds.GetBottomRight();
+		double dMax = fabs(ptTopLeft.x);
+		if (fabs(ptTopLeft.y) > dMax)
+			dMax = fabs(ptTopLeft.y);
+		if (fabs(ptBottomRight.x) > dMax)
+			dMax = fabs(ptBottomRight.x);
+		if (fabs(ptBottomRight.y) > dMax)
+			dMax = fabs(ptBottomRight.y);
+
+		m_dCell = dMax * conEqualityTolerance;
+		if (m_dCell == 0)
+			m_dCell = 1;
+	}
+	m_dInvCell = 1 / m_dCell;
+
+	m_Points.clear();
+	m_Cells.clear();
+	m_Next.clear();
+	m_Points.reserve(nExpected);
+	m_Cells.reserve(nExpected * 2);
+	m_Next.reserve(nExpected);
+
+	Rehash(nExpected);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPointWelder::Add <BR>
+\brief Adds the point if there is none the same. Returns the index of the weld.
+<P>---------------------------------------------------------------------------*/
+unsigned int CPointWelder::Add(const C2DPoint& pt)
+{
+	if (m_Buckets.empty())
+		Rehash(0);
+
+	int nFound = Find(pt);
+	if (nFound >= 0)
+		return (unsigned int)nFound;
+
+	unsigned int nIndex = (unsigned int)m_Points.size();
+	int64_t nX = Cell(pt.x);
+	int64_t nY = Cell(pt.y);
+
+	m_Points.push_back(pt);
+	m_Cells.push_back(nX);
+	m_Cells.push_back(nY);
+
+	if (m_Points.size() * 2 > m_Buckets.size())
+	{
+		m_Next.push_back(-1);
+		Rehash((unsigned int)m_Points.size());
+	}
+	else
+	{
+		uint32_t nBucket = Bucket(nX, nY);
+		m_Next.push_back(m_Buckets[nBucket]);
+		m_Buckets[nBucket] = (int32_t)nIndex;
+	}
+
+	return nIndex;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPointWelder::Find <BR>
+\brief Returns the index of the first weld the same as the point, -1 if none. Only
+the cell of the point and those next to it are looked in.
+<P>---------------------------------------------------------------------------*/
+int CPointWelder::Find(const C2DPoint& pt) const
+{
+	if (m_Points.empty())
+		return -1;
+
+	int64_t nX = Cell(pt.x);
+	int64_t nY = Cell(pt.y);
+
+	int nFound = -1;
+
+	for (int64_t x = nX - 1; x <= nX + 1; x++)
+	{
+		for (int64_t y = nY - 1; y <= nY + 1; y++)
+		{
+			// Cells sharing the bucket are in the chain too, so check the cell.
+			for (int32_t i = m_Buckets[Bucket(x, y)]; i >= 0; i = m_Next[i])
+			{
+				if ((nFound < 0 || i < nFound) && m_Cells[i * 2] == x && m_Cells[i * 2 + 1] == y &&
+					IsSame(m_Points[i], pt))
+				{
+					nFound = i;
+				}
+			}
+		}
+	}
+
+	return nFound;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPointWelder::Weld <BR>
+\brief Welds the points of the set, setting the index of the weld for each point.
+Returns the number of welds.
+<P>---------------------------------------------------------------------------*/
+unsigned int CPointWelder::Weld(const C2DPointSet& Points, std::vector<unsigned int>& Remap)
+{
+	C2DRect Bounds;
+	Points.GetBoundingRect(Bounds);
+
+	Reset(Bounds, Points.size());
+
+	Remap.resize(Points.size());
+	for (unsigned int i = 0; i < Points.size(); i++)
+		Remap[i] = Add(Points[i]);
+
+	return GetCount();
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPointWelder::Cell <BR>
+\brief The cell of the coordinate, limited so it cannot overflow.
+<P>---------------------------------------------------------------------------*/
+int64_t CPointWelder::Cell(double d) const
+{
+	double dCell = floor(d * m_dInvCell);
+
+	if (dCell > 4e18)
+		return (int64_t)4e18;
+	if (dCell < -4e18)
+		return (int64_t)-4e18;
+
+	return (int64_t)dCell;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPointWelder::Bucket <BR>
+\brief The bucket of the cell.
+<P>---------------------------------------------------------------------------*/
+uint32_t CPointWelder::Bucket(int64_t nX, int64_t nY) const
+{
+	uint64_t nHash = (uint64_t)nX * 0x9E3779B97F4A7C15ULL ^ (uint64_t)nY * 0xC2B2AE3D27D4EB4FULL;
+	nHash ^= nHash >> 32;
+
+	return (uint32_t)nHash & (uint32_t)(m_Buckets.size() - 1);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPointWelder::IsSame <BR>
+\brief True if the point kept and the other are the same.
+<P>---------------------------------------------------------------------------*/
+bool CPointWelder::IsSame(const C2DPoint& pt1, const C2DPoint& pt2) const
+{
+	if (m_dTolerance > 0)
+		return fabs(pt1.x - pt2.x) < m_dTolerance && fabs(pt1.y - pt2.y) < m_dTolerance;
+	else
+		return pt1 == pt2;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPointWelder::Rehash <BR>
+\brief Sets the buckets to a power of 2 at least twice the count and refills them.
+<P>---------------------------------------------------------------------------*/
+void CPointWelder::Rehash(unsigned int nCount)
+{
+	size_t nBuckets = 16;
+	while (nBuckets < (size_t)nCount * 2)
+		nBuckets *= 2;
+
+	m_Buckets.assign(nBuckets, -1);
+
+	for (unsigned int i = 0; i < m_Points.size(); i++)
+	{
+		uint32_t nBucket = Bucket(m_Cells[i * 2], m_Cells[i * 2 + 1]);
+		m_Next[i] = m_Buckets[nBucket];
+		m_Buckets[nBucket] = (int32_t)i;
+	}
+}
@@ -0,0 +1,104 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file PointWelder.h
+\brief Declaration file for the CPointWelder class.
+
+\class CPointWelder
+\brief Welds points which are the same to a tolerance using a hash of a grid.
+
+Each point kept goes in the cell of a grid as big as the tolerance, so a point the
+same as it can only be in that cell or one next to it. Finding or adding a point
+looks at those 9 cells only, so welding a set is expected linear time rather than
+comparing every pair. The first point added to a weld is the one kept and the index
+of a weld is the order in which it was first added, so the index of each point in a
+set can be remapped to the welded points.
+
+With no tolerance the points are the same by C2DPoint equality, which is relative to
+the size of the coordinates, and the grid is sized from the bounds given to Reset.
+<P>---------------------------------------------------------------------------*/
+
+#ifndef _GEOLIB_CPOINTWELDER_H
+#define _GEOLIB_CPOINTWELDER_H
+
+
+#include "C2DPoint.h"
+#include <vector>
+#include <cstdint>
+
+
+class C2DRect;
+class C2DPointSet;
+
+#ifdef _EXPORTING
+	#define CLASS_DECLSPEC		__declspec(dllexport)
+#else
+	#ifdef _STATIC
+		#define CLASS_DECLSPEC
+	#else
+		#define CLASS_DECLSPEC		__declspec(dllimport)
+	#endif
+#endif
+
+
+class CLASS_DECLSPEC CPointWelder
+{
+public:
+	/// Constructor. Points closer than the tolerance in both x and y are the same,
+	/// with no tolerance C2DPoint equality is used.
+	CPointWelder(double dTolerance = 0);
+	/// Destructor.
+	~CPointWelder(void);
+
+	/// Sets the tolerance. Takes effect from the next Reset.
+	void SetTolerance(double dTolerance) { m_dTolerance = dTolerance;}
+	/// Returns the tolerance.
+	double GetTolerance(void) const { return m_dTolerance;}
+
+	/// Clears ready for about the number of points given, all within the bounds.
+	void Reset(const C2DRect& Bounds, unsigned int nExpected);
+	/// Adds the point unless there is one the same. Returns the index of its weld.
+	unsigned int Add(const C2DPoint& pt);
+	/// Returns the index of the first weld the same as the point, -1 if none.
+	int Find(const C2DPoint& pt) const;
+
+	/// Welds the set. Remap gets the index of the weld for each point. Returns the welds.
+	unsigned int Weld(const C2DPointSet& Points, std::vector<unsigned int>& Remap);
+
+	/// Returns the number of welds.
+	unsigned int GetCount(void) const { return (unsigned int)m_Points.size();}
+	/// Returns the point kept for the weld.
+	const C2DPoint& GetPoint(unsigned int nIndex) const { return m_Points[nIndex];}
+
+private:
+	/// The cell of the coordinate.
+	int64_t Cell(double d) const;
+	/// The bucket of the cell.
+	uint32_t Bucket(int64_t nX, int64_t nY) const;
+	/// True if the points are the same.
+	bool IsSame(const C2DPoint& pt1, const C2DPoint& pt2) const;
+	/// Makes the buckets big enough for the number of points given and refills them.
+	void Rehash(unsigned int nCount);
+
+	/// The tolerance, 0 for C2DPoint equality.
+	double m_dTolerance;
+	/// The size of a cell and its inverse.
+	double m_dCell;
+	double m_dInvCell;
+	/// The points kept.
+	std::vector<C2DPoint> m_Points;
+	/// The cells of the points kept.
+	std::vector<int64_t> m_Cells;
+	/// The first point in each bucket, -1 if none.
+	std::vector<int32_t> m_Buckets;
+	/// The next point in the same bucket for each point, -1 if none.
+	std::vector<int32_t> m_Next;
+};
+
+
+#endif
@@ -0,0 +1,484 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file Predicates.cpp
+\brief Implementation file for the CPredicates class.
+
+The expansion arithmetic follows J. R. Shewchuk, "Adaptive Precision Floating-Point
+Arithmetic and Fast Robust Geometric Predicates". An expansion is an array of
+doubles in increasing order of magnitude, none overlapping, whose sum is the value.
+<P>---------------------------------------------------------------------------*/
+
+
+#include "StdAfx.h"
+#include "Predicates.h"
+#include "C2DPoint.h"
+
+
+/// Half the distance between 1 and the next double.
+static const double const_dEpsilon = 1.1102230246251565e-16;
+/// 2^27 + 1 used to split a double into two halves of 26 bits.
+static const double const_dSplitter = 134217729.0;
+/// Bound on the error of the floating point orientation relative to its terms.
+static const double const_dOrientBound = (3.0 + 16.0 * const_dEpsilon) * const_dEpsilon;
+/// Bound on the error of the floating point in circle test relative to its terms.
+static const double const_dInCircleBound = (10.0 + 96.0 * const_dEpsilon) * const_dEpsilon;
+/// Largest product of two expansions that is formed.
+static const int const_nMaxProduct = 512;
+
+
+/**--------------------------------------------------------------------------<BR>
+TwoSum <BR>
+\brief a + b exactly as x + y where x is the rounded sum.
+<P>---------------------------------------------------------------------------*/
+static inline void TwoSum(double a, double b, double& x, double& y)
+{
+	x = a + b;
+	double bVirtual = x - a;
+	double aVirtual = x - bVirtual;
+	y = (a - aVirtual) + (b - bVirtual);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+FastTwoSum <BR>
+\brief a + b exactly as x + y. Needs |a| >= |b|.
+<P>---------------------------------------------------------------------------*/
+static inline void FastTwoSum(double a, double b, double& x, double& y)
+{
+	x = a + b;
+	y = b - (x - a);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+TwoDiff <BR>
+\brief a - b exactly as x + y where x is the rounded difference.
+<P>---------------------------------------------------------------------------*/
+static inline void TwoDiff(double a, double b, double& x, double& y)
+{
+	x = a - b;
+	double bVirtual = a - x;
+	double aVirtual = x + bVirtual;
+	y = (a - aVirtual) + (bVirtual - b);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+Split <BR>
+\brief Splits a into two halves which each fit in 26 bits.
+<P>---------------------------------------------------------------------------*/
+static inline void Split(double a, double& dHigh, double& dLow)
+{
+	double c = const_dSplitter * a;
+	double dBig = c - a;
+	dHigh = c - dBig;
+	dLow = a - dHigh;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+TwoProduct <BR>
+\brief a * b exactly as x + y where x is the rounded product. b is given split.
+<P>---------------------------------------------------------------------------*/
+static inline void TwoProduct(double a, double b, double bHigh, double bLow, double& x, double& y)
+{
+	x = a * b;
+	double aHigh, aLow;
+	Split(a, aHigh, aLow);
+	double dErr1 = x - (aHigh * bHigh);
+	double dErr2 = dErr1 - (aLow * bHigh);
+	double dErr3 = dErr2 - (aHigh * bLow);
+	y = (aLow * bLow) - dErr3;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+ExpansionSum <BR>
+\brief Sums two expansions into h, dropping zeros. Returns the length of h which is
+at most nE + nF.
+<P>---------------------------------------------------------------------------*/
+static int ExpansionSum(int nE, const double* e, int nF, const double* f, double* h)
+{
+	int i = 0;
+	int j = 0;
+	int nH = 0;
+	double Q, QNew, hh;
+
+	// Take the components smallest first from either expansion.
+	if ((f[0] > e[0]) == (f[0] > -e[0]))
+		Q = e[i++];
+	else
+		Q = f[j++];
+
+	if (i < nE && j < nF)
+	{
+		if ((f[j] > e[i]) == (f[j] > -e[i]))
+			FastTwoSum(e[i++], Q, QNew, hh);
+		else
+			FastTwoSum(f[j++], Q, QNew, hh);
+		Q = QNew;
+		if (hh != 0.0)
+			h[nH++] = hh;
+
+		while (i < nE && j < nF)
+		{
+			if ((f[j] > e[i]) == (f[j] > -e[i]))
+				TwoSum(Q, e[i++], QNew, hh);
+			else
+				TwoSum(Q, f[j++], QNew, hh);
+			Q = QNew;
+			if (hh != 0.0)
+				h[nH++] = hh;
+		}
+	}
+
+	while (i < nE)
+	{
+		TwoSum(Q, e[i++], QNew, hh);
+		Q = QNew;
+		if (hh != 0.0)
+			h[nH++] = hh;
+	}
+
+	while (j < nF)
+	{
+		TwoSum(Q, f[j++], QNew, hh);
+		Q = QNew;
+		if (hh != 0.0)
+			h[nH++] = hh;
+	}
+
+	if (Q != 0.0 || nH == 0)
+		h[nH++] = Q;
+
+	return nH;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+ScaleExpansion <BR>
+\brief Multiplies the expansion by b into h, dropping zeros. Returns the length of
+h which is at most 2 * nE.
+<P>---------------------------------------------------------------------------*/
+static int ScaleExpansion(int nE, const double* e, double b, double* h)
+{
+	double bHigh, bLow;
+	Split(b, bHigh, bLow);
+
+	int nH = 0;
+	double Q, hh, dSum, dProduct1, dProduct0;
+
+	TwoProduct(e[0], b, bHigh, bLow, Q, hh);
+	if (hh != 0.0)
+		h[nH++] = hh;
+
+	for (int i = 1; i < nE; i++)
+	{
+		TwoProduct(e[i], b, bHigh, bLow, dProduct1, dProduct0);
+		TwoSum(Q, dProduct0, dSum, hh);
+		if (hh != 0.0)
+			h[nH++] = hh;
+		FastTwoSum(dProduct1, dSum, Q, hh);
+		if (hh != 0.0)
+			h[nH++] = hh;
+	}
+
+	if (Q != 0.0 || nH == 0)
+		h[nH++] = Q;
+
+	return nH;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+MultiplyExpansions <BR>
+\brief Multiplies two expansions into h. Returns the length of h which is at most
+2 * nE * nF and must not be more than const_nMaxProduct.
+<P>---------------------------------------------------------------------------*/
+static int MultiplyExpansions(int nE, const double* e, int nF, const double* f, double* h)
+{
+	assert(2 * nE * nF <= const_nMaxProduct);
+
+	double Scaled[const_nMaxProduct];
+	double Sum[const_nMaxProduct];
+
+	int nH = ScaleExpansion(nE, e, f[0], h);
+
+	for (int j = 1; j < nF; j++)
+	{
+		int nScaled = ScaleExpansion(nE, e, f[j], Scaled);
+		int nSum = ExpansionSum(nH, h, nScaled, Scaled, Sum);
+		for (int k = 0; k < nSum; k++)
+			h[k] = Sum[k];
+		nH = nSum;
+	}
+
+	return nH;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+NegateExpansion <BR>
+\brief Negates the expansion in place.
+<P>---------------------------------------------------------------------------*/
+static inline void NegateExpansion(int nE, double* e)
+{
+	for (int i = 0; i < nE; i++)
+		e[i] = -e[i];
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+Estimate <BR>
+\brief The expansion rounded to a double. Has the sign of the expansion.
+<P>---------------------------------------------------------------------------*/
+static inline double Estimate(int nE, const double* e)
+{
+	double dResult = e[0];
+	for (int i = 1; i < nE; i++)
+		dResult += e[i];
+	return dResult;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+Sign <BR>
+\brief The sign of a - b.
+<P>---------------------------------------------------------------------------*/
+static inline int Sign(double a, double b)
+{
+	return a > b ? 1 : (a < b ? -1 : 0);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPredicates::Orient2D <BR>
+\brief The orientation of the 3 points. Uses the floating point result unless it is
+within the error bound of 0.
+<P>---------------------------------------------------------------------------*/
+double CPredicates::Orient2D(const C2DPoint& pt1, const C2DPoint& pt2, const C2DPoint& pt3)
+{
+	double dLeft = (pt1.x - pt3.x) * (pt2.y - pt3.y);
+	double dRight = (pt1.y - pt3.y) * (pt2.x - pt3.x);
+	double dDet = dLeft - dRight;
+	double dDetSum;
+
+	if (dLeft > 0.0)
+	{
+		if (dRight <= 0.0)
+			return dDet;
+		dDetSum = dLeft + dRight;
+	}
+	else if (dLeft < 0.0)
+	{
+		if (dRight >= 0.0)
+			return dDet;
+		dDetSum = -dLeft - dRight;
+	}
+	else
+	{
+		return dDet;
+	}
+
+	double dBound = const_dOrientBound * dDetSum;
+	if (dDet >= dBound || -dDet >= dBound)
+		return dDet;
+
+	return Orient2DExact(pt1, pt2, pt3);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPredicates::Orient2DExact <BR>
+\brief The orientation worked out exactly. The differences are formed exactly as
+expansions of 2 so the determinant is exact.
+<P>---------------------------------------------------------------------------*/
+double CPredicates::Orient2DExact(const C2DPoint& pt1, const C2DPoint& pt2, const C2DPoint& pt3)
+{
+	double dx13[2], dy23[2], dy13[2], dx23[2];
+	TwoDiff(pt1.x, pt3.x, dx13[1], dx13[0]);
+	TwoDiff(pt2.y, pt3.y, dy23[1], dy23[0]);
+	TwoDiff(pt1.y, pt3.y, dy13[1], dy13[0]);
+	TwoDiff(pt2.x, pt3.x, dx23[1], dx23[0]);
+
+	double Left[8], Right[8], Det[16];
+	int nLeft = MultiplyExpansions(2, dx13, 2, dy23, Left);
+	int nRight = MultiplyExpansions(2, dy13, 2, dx23, Right);
+	NegateExpansion(nRight, Right);
+	int nDet = ExpansionSum(nLeft, Left, nRight, Right, Det);
+
+	return Estimate(nDet, Det);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPredicates::InCircle <BR>
+\brief The in circle test. Uses the floating point result unless it is within the
+error bound of 0.
+<P>---------------------------------------------------------------------------*/
+double CPredicates::InCircle(const C2DPoint& pt1, const C2DPoint& pt2, const C2DPoint& pt3,
+							const C2DPoint& pt4)
+{
+	double adx = pt1.x - pt4.x;
+	double bdx = pt2.x - pt4.x;
+	double cdx = pt3.x - pt4.x;
+	double ady = pt1.y - pt4.y;
+	double bdy = pt2.y - pt4.y;
+	double cdy = pt3.y - pt4.y;
+
+	double bdxcdy = bdx * cdy;
+	double cdxbdy = cdx * bdy;
+	double dALift = adx * adx + ady * ady;
+
+	double cdxady = cdx * ady;
+	double adxcdy = adx * cdy;
+	double dBLift = bdx * bdx + bdy * bdy;
+
+	double adxbdy = adx * bdy;
+	double bdxady = bdx * ady;
+	double dCLift = cdx * cdx + cdy * cdy;
+
+	double dDet = dALift * (bdxcdy - cdxbdy) + dBLift * (cdxady - adxcdy) +
+				  dCLift * (adxbdy - bdxady);
+
+	double dPermanent = (fabs(bdxcdy) + fabs(cdxbdy)) * dALift +
+						(fabs(cdxady) + fabs(adxcdy)) * dBLift +
+						(fabs(adxbdy) + fabs(bdxady)) * dCLift;
+
+	double dBound = const_dInCircleBound * dPermanent;
+	if (dDet > dBound || -dDet > dBound)
+		return dDet;
+
+	return InCircleExact(pt1, pt2, pt3, pt4);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPredicates::InCircleExact <BR>
+\brief The in circle test worked out exactly as the sum over the 3 points of the
+lifted distance to the fourth times the orientation of the other two.
+<P>---------------------------------------------------------------------------*/
+double CPredicates::InCircleExact(const C2DPoint& pt1, const C2DPoint& pt2, const C2DPoint& pt3,
+							const C2DPoint& pt4)
+{
+	const C2DPoint* Points[3] = {&pt1, &pt2, &pt3};
+
+	double dx[3][2], dy[3][2];
+	for (int i = 0; i < 3; i++)
+	{
+		TwoDiff(Points[i]->x, pt4.x, dx[i][1], dx[i][0]);
+		TwoDiff(Points[i]->y, pt4.y, dy[i][1], dy[i][0]);
+	}
+
+	double Det[3 * const_nMaxProduct];
+	int nDet = 0;
+
+	for (int i = 0; i < 3; i++)
+	{
+		int j = (i + 1) % 3;
+		int k = (i + 2) % 3;
+
+		// The lifted distance of point i.
+		double XX[8], YY[8], Lift[16];
+		int nXX = MultiplyExpansions(2, dx[i], 2, dx[i], XX);
+		int nYY = MultiplyExpansions(2, dy[i], 2, dy[i], YY);
+		int nLift = ExpansionSum(nXX, XX, nYY, YY, Lift);
+
+		// The orientation of points j and k about the fourth.
+		double JK[8], KJ[8], Orient[16];
+		int nJK = MultiplyExpansions(2, dx[j], 2, dy[k], JK);
+		int nKJ = MultiplyExpansions(2, dx[k], 2, dy[j], KJ);
+		NegateExpansion(nKJ, KJ);
+		int nOrient = ExpansionSum(nJK, JK, nKJ, KJ, Orient);
+
+		double Term[const_nMaxProduct];
+		int nTerm = MultiplyExpansions(nLift, Lift, nOrient, Orient, Term);
+
+		if (nDet == 0)
+		{
+			for (int n = 0; n < nTerm; n++)
+				Det[n] = Term[n];
+			nDet = nTerm;
+		}
+		else
+		{
+			double Sum[3 * const_nMaxProduct];
+			int nSum = ExpansionSum(nDet, Det, nTerm, Term, Sum);
+			for (int n = 0; n < nSum; n++)
+				Det[n] = Sum[n];
+			nDet = nSum;
+		}
+	}
+
+	return Estimate(nDet, Det);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPredicates::Orient2DPerturbed <BR>
+\brief The sign of the orientation with the flagged points moved by (e, e * e). If
+the exact orientation is 0 then one point must be moved differently from the other
+two and the sign is that of the first non zero coefficient of e or e * e in the
+orientation of the moved points. Each coefficient is a single difference of
+coordinates so its sign is found by comparison.
+<P>---------------------------------------------------------------------------*/
+int CPredicates::Orient2DPerturbed(const C2DPoint& pt1, bool bMoved1, const C2DPoint& pt2,
+							bool bMoved2, const C2DPoint& pt3, bool bMoved3)
+{
+	double dDet = Orient2D(pt1, pt2, pt3);
+
+	if (dDet > 0)
+		return 1;
+	else if (dDet < 0)
+		return -1;
+
+	int nE = 0;
+	int nE2 = 0;
+
+	if (bMoved1 == bMoved2)
+	{
+		if (bMoved3 == bMoved1)
+			return 0;
+		// Point 3 moved by d relative to the others.
+		int d = bMoved3 ? 1 : -1;
+		nE = -d * Sign(pt2.y, pt1.y);
+		nE2 = d * Sign(pt2.x, pt1.x);
+	}
+	else if (bMoved1 == bMoved3)
+	{
+		// Point 2 moved by d relative to the others.
+		int d = bMoved2 ? 1 : -1;
+		nE = d * Sign(pt3.y, pt1.y);
+		nE2 = -d * Sign(pt3.x, pt1.x);
+	}
+	else
+	{
+		// Points 2 and 3 moved by d relative to point 1.
+		int d = bMoved2 ? 1 : -1;
+		nE = d * Sign(pt3.y, pt2.y);
+		nE2 = d * Sign(pt2.x, pt3.x);
+	}
+
+	return nE != 0 ? nE : nE2;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CPredicates::IsAbovePerturbed <BR>
+\brief True if pt1 is above pt2 with the flagged points moved by (e, e * e). On a tie
+the moved point is above.
+<P>---------------------------------------------------------------------------*/
+bool CPredicates::IsAbovePerturbed(const C2DPoint& pt1, bool bMoved1,
+							const C2DPoint& pt2, bool bMoved2)
+{
+	if (pt1.y != pt2.y)
+		return pt1.y > pt2.y;
+
+	return bMoved1 && !bMoved2;
+}
@@ -0,0 +1,72 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file Predicates.h
+\brief Declaration file for the CPredicates class.
+
+\class CPredicates
+\brief Geometric predicates whose sign is always right.
+
+The orientation and in circle tests first work in plain floating point and check
+the result against an error bound. Only if it is too close to call are they worked
+out exactly by expansion arithmetic, in which a number is held as a sum of doubles
+that do not overlap. Needs strict IEEE double arithmetic so must not be built with
+options that let the compiler reassociate floating point operations.
+
+The perturbed tests treat some of the points as moved by the infinitesimal vector
+(e, e * e). Ties between points which are moved and points which are not are then
+broken the same way every time, so lines of one shape never touch lines of the
+other and degenerate cases never arise. All functions are static.
+<P>---------------------------------------------------------------------------*/
+
+#ifndef _GEOLIB_CPREDICATES_H
+#define _GEOLIB_CPREDICATES_H
+
+
+class C2DPoint;
+
+#ifdef _EXPORTING
+	#define CLASS_DECLSPEC		__declspec(dllexport)
+#else
+	#ifdef _STATIC
+		#define CLASS_DECLSPEC
+	#else
+		#define CLASS_DECLSPEC		__declspec(dllimport)
+	#endif
+#endif
+
+
+class CLASS_DECLSPEC CPredicates
+{
+public:
+	/// Positive if pt3 is to the left of the line from pt1 to pt2, negative if to the
+	/// right and 0 if on it. Twice the signed area of the triangle.
+	static double Orient2D(const C2DPoint& pt1, const C2DPoint& pt2, const C2DPoint& pt3);
+	/// Positive if pt4 is inside the circle through pt1, pt2 and pt3 which must be
+	/// anticlockwise, negative if outside and 0 if on it.
+	static double InCircle(const C2DPoint& pt1, const C2DPoint& pt2, const C2DPoint& pt3,
+							const C2DPoint& pt4);
+
+	/// The sign of Orient2D with the points flagged moved by (e, e * e). Only 0 if
+	/// all the flags are the same and the points are in line, or two points are equal.
+	static int Orient2DPerturbed(const C2DPoint& pt1, bool bMoved1, const C2DPoint& pt2,
+							bool bMoved2, const C2DPoint& pt3, bool bMoved3);
+	/// True if pt1 is above pt2 with the points flagged moved by (e, e * e).
+	static bool IsAbovePerturbed(const C2DPoint& pt1, bool bMoved1,
+							const C2DPoint& pt2, bool bMoved2);
+
+private:
+	/// Works out Orient2D exactly.
+	static double Orient2DExact(const C2DPoint& pt1, const C2DPoint& pt2, const C2DPoint& pt3);
+	/// Works out InCircle exactly.
+	static double InCircleExact(const C2DPoint& pt1, const C2DPoint& pt2, const C2DPoint& pt3,
+							const C2DPoint& pt4);
+};
+
+
+#endif
@@ -0,0 +1,659 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file SegmentSweep.cpp
+\brief Implementation file for the CSegmentSweep class.
+<P>---------------------------------------------------------------------------*/
+
+
+#include "StdAfx.h"
+#include "SegmentSweep.h"
+#include "C2DPolyBase.h"
+#include "Predicates.h"
+#include <set>
+#include <queue>
+#include <algorithm>
+
+
+/// The slot used to find where a point is rather than a line.
+const unsigned int conPointSlot = 0xFFFFFFFF;
+
+
+/**--------------------------------------------------------------------------<BR>
+\class CSweepLine
+\brief The lines crossing the sweep line in order from the bottom up. Each line is
+held in a slot of the ordered set and lines passing each other swap slots, so the
+order is only worked out when a line is put in, against the point where it goes in.
+<P>---------------------------------------------------------------------------*/
+class CSweepLine
+{
+public:
+	/// Constructor.
+	CSweepLine(const std::vector<C2DPoint>& From, const std::vector<C2DPoint>& To,
+			const std::vector<int>& Next, bool bFirstOnly, std::vector<CSegmentSweep::sCrossing>& Found);
+
+	/// Sweeps all the lines.
+	void Run(void);
+
+	/// True if the line in the first slot is below that in the second. One of them is
+	/// always the one being put in.
+	bool IsBelow(unsigned int nSlot1, unsigned int nSlot2) const;
+
+private:
+	/// Orders the slots.
+	struct sOrder
+	{
+		const CSweepLine* pSweep;
+		bool operator()(unsigned int nSlot1, unsigned int nSlot2) const
+			{ return pSweep->IsBelow(nSlot1, nSlot2);}
+	};
+	typedef std::set<unsigned int, sOrder> SlotSet;
+
+	/// Where two lines next to each other cross, the lower first.
+	struct sEvent
+	{
+		C2DPoint pt;
+		unsigned int nLine1;
+		unsigned int nLine2;
+	};
+	/// Puts the first event on the queue first.
+	struct sLater
+	{
+		bool operator()(const sEvent& Event1, const sEvent& Event2) const
+			{ return IsBefore(Event2.pt, Event1.pt);}
+	};
+
+	/// Takes out the lines through the point and puts back those going on with the
+	/// lines starting there.
+	void AtPoint(const C2DPoint& pt, const std::vector<unsigned int>& Starts,
+				const std::vector<unsigned int>& Ends);
+	/// Swaps lines which cross if still next to each other.
+	void AtCrossing(const sEvent& Event);
+	/// Puts the line in the slot at the point.
+	void Insert(unsigned int nSlot, const C2DPoint& pt);
+	/// Queues the crossing of the lines if they cross.
+	void Test(unsigned int nLower, unsigned int nUpper);
+	/// Adds the lines as meeting at the point unless they are only joined.
+	void Report(unsigned int nLine1, unsigned int nLine2, const C2DPoint& pt);
+	/// True if the lines are joined and only meet where they join.
+	bool IsJoin(unsigned int nLine1, unsigned int nLine2) const;
+
+	/// Positive if the point is above the line, negative if below.
+	double Side(unsigned int nLine, const C2DPoint& pt) const
+		{ return CPredicates::Orient2D(m_Left[nLine], m_Right[nLine], pt);}
+	/// True if the first point comes first in x then y.
+	static bool IsBefore(const C2DPoint& pt1, const C2DPoint& pt2)
+		{ return pt1.x < pt2.x || (pt1.x == pt2.x && pt1.y < pt2.y);}
+	/// True if the points are exactly the same.
+	static bool IsSame(const C2DPoint& pt1, const C2DPoint& pt2)
+		{ return pt1.x == pt2.x && pt1.y == pt2.y;}
+
+	/// The lines as given and running left to right.
+	const std::vector<C2DPoint>& m_From;
+	const std::vector<C2DPoint>& m_To;
+	const std::vector<int>& m_Next;
+	std::vector<C2DPoint> m_Left;
+	std::vector<C2DPoint> m_Right;
+	/// The slots in order, the node for each slot and the line in it and the slot for
+	/// each line.
+	SlotSet m_Status;
+	std::vector<SlotSet::iterator> m_Nodes;
+	std::vector<unsigned int> m_SlotLine;
+	std::vector<unsigned int> m_LineSlot;
+	std::vector<bool> m_InStatus;
+	/// The slot being put in, the point it goes in at and the line's right end.
+	unsigned int m_nKeySlot;
+	C2DPoint m_ptKey;
+	C2DPoint m_ptKeyTo;
+	/// The crossings to come.
+	std::priority_queue<sEvent, std::vector<sEvent>, sLater> m_Events;
+	/// The sweep position.
+	C2DPoint m_ptSweep;
+	/// The pairs found and whether to stop at the first.
+	std::vector<CSegmentSweep::sCrossing>& m_Found;
+	bool m_bFirstOnly;
+	bool m_bDone;
+};
+
+
+/**--------------------------------------------------------------------------<BR>
+CSegmentSweep::CSegmentSweep <BR>
+\brief Constructor.
+<P>---------------------------------------------------------------------------*/
+CSegmentSweep::CSegmentSweep(void)
+{
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSegmentSweep::~CSegmentSweep <BR>
+\brief Destructor.
+<P>---------------------------------------------------------------------------*/
+CSegmentSweep::~CSegmentSweep(void)
+{
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSegmentSweep::AddLine <BR>
+\brief Adds a line joined to nothing. Returns its index.
+<P>---------------------------------------------------------------------------*/
+unsigned int CSegmentSweep::AddLine(const C2DPoint& ptFrom, const C2DPoint& ptTo)
+{
+	sLine Line;
+	Line.ptFrom = ptFrom;
+	Line.ptTo = ptTo;
+	Line.nNext = -1;
+	m_Lines.push_back(Line);
+
+	return (unsigned int)m_Lines.size() - 1;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSegmentSweep::AddPoly <BR>
+\brief Adds the lines of the polygon, each joined to the next going round. Lines hold
+their end as a vector from the start so it is taken from the next line to meet it
+exactly. Lines of no length are kept so the indexes match but joined past.
+<P>---------------------------------------------------------------------------*/
+void CSegmentSweep::AddPoly(const C2DPolyBase& Poly)
+{
+	unsigned int nLines = Poly.GetLineCount();
+
+	if (nLines == 0)
+		return;
+
+	unsigned int nFirst = (unsigned int)m_Lines.size();
+	C2DPoint ptFirst = Poly.GetLine(0)->GetPointFrom();
+	C2DPoint ptFrom = ptFirst;
+
+	for (unsigned int i = 0; i < nLines; i++)
+	{
+		C2DPoint ptTo = i + 1 < nLines ? Poly.GetLine(i + 1)->GetPointFrom() : ptFirst;
+		AddLine(ptFrom, ptTo);
+		ptFrom = ptTo;
+	}
+
+	int nFirstJoined = -1;
+	int nLast = -1;
+	for (unsigned int i = nFirst; i < m_Lines.size(); i++)
+	{
+		if (m_Lines[i].ptFrom.x == m_Lines[i].ptTo.x && m_Lines[i].ptFrom.y == m_Lines[i].ptTo.y)
+			continue;
+
+		if (nLast >= 0)
+			m_Lines[nLast].nNext = i;
+		else
+			nFirstJoined = i;
+		nLast = i;
+	}
+
+	if (nLast >= 0 && nLast != nFirstJoined)
+		m_Lines[nLast].nNext = nFirstJoined;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSegmentSweep::Clear <BR>
+\brief Clears all.
+<P>---------------------------------------------------------------------------*/
+void CSegmentSweep::Clear(void)
+{
+	m_Lines.clear();
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSegmentSweep::HasCrossing <BR>
+\brief True if any lines meet other than joined lines at their join. The sweep stops
+at the first so never moves past a crossing and the answer is exact.
+<P>---------------------------------------------------------------------------*/
+bool CSegmentSweep::HasCrossing(void) const
+{
+	std::vector<sCrossing> Crossings;
+	Sweep(Crossings, true);
+
+	return !Crossings.empty();
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSegmentSweep::GetCrossings <BR>
+\brief Gets every pair of lines which meet other than joined lines at their join.
+Lines along each other can be found at both ends of where they meet so only the
+first is kept.
+<P>---------------------------------------------------------------------------*/
+void CSegmentSweep::GetCrossings(std::vector<sCrossing>& Crossings) const
+{
+	struct sByLines
+	{
+		bool operator()(const sCrossing& C1, const sCrossing& C2) const
+			{ return C1.nLine1 < C2.nLine1 || (C1.nLine1 == C2.nLine1 && C1.nLine2 < C2.nLine2);}
+	};
+	struct sSameLines
+	{
+		bool operator()(const sCrossing& C1, const sCrossing& C2) const
+			{ return C1.nLine1 == C2.nLine1 && C1.nLine2 == C2.nLine2;}
+	};
+
+	Crossings.clear();
+	Sweep(Crossings, false);
+
+	std::stable_sort(Crossings.begin(), Crossings.end(), sByLines());
+	Crossings.erase(std::unique(Crossings.begin(), Crossings.end(), sSameLines()), Crossings.end());
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSegmentSweep::Sweep <BR>
+\brief Sweeps the lines adding the pairs which meet to those given.
+<P>---------------------------------------------------------------------------*/
+void CSegmentSweep::Sweep(std::vector<sCrossing>& Crossings, bool bFirstOnly) const
+{
+	unsigned int nLines = (unsigned int)m_Lines.size();
+
+	std::vector<C2DPoint> From(nLines);
+	std::vector<C2DPoint> To(nLines);
+	std::vector<int> Next(nLines);
+	for (unsigned int i = 0; i < nLines; i++)
+	{
+		From[i] = m_Lines[i].ptFrom;
+		To[i] = m_Lines[i].ptTo;
+		Next[i] = m_Lines[i].nNext;
+	}
+
+	CSweepLine SweepLine(From, To, Next, bFirstOnly, Crossings);
+	SweepLine.Run();
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSweepLine::CSweepLine <BR>
+\brief Constructor.
+<P>---------------------------------------------------------------------------*/
+CSweepLine::CSweepLine(const std::vector<C2DPoint>& From, const std::vector<C2DPoint>& To,
+			const std::vector<int>& Next, bool bFirstOnly, std::vector<CSegmentSweep::sCrossing>& Found) :
+	m_From(From), m_To(To), m_Next(Next), m_nKeySlot(conPointSlot), m_Found(Found),
+	m_bFirstOnly(bFirstOnly), m_bDone(false)
+{
+	sOrder Order;
+	Order.pSweep = this;
+	m_Status = SlotSet(Order);
+
+	unsigned int nLines = (unsigned int)From.size();
+	m_Left.resize(nLines);
+	m_Right.resize(nLines);
+	for (unsigned int i = 0; i < nLines; i++)
+	{
+		bool bForward = IsBefore(From[i], To[i]);
+		m_Left[i] = bForward ? From[i] : To[i];
+		m_Right[i] = bForward ? To[i] : From[i];
+	}
+
+	m_Nodes.resize(nLines);
+	m_SlotLine.resize(nLines);
+	m_LineSlot.resize(nLines);
+	m_InStatus.assign(nLines, false);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSweepLine::Run <BR>
+\brief Sweeps the ends of the lines in order along with the crossings found on the
+way. A crossing at an end is taken first. Lines of no length are left out.
+<P>---------------------------------------------------------------------------*/
+void CSweepLine::Run(void)
+{
+	struct sByPoint
+	{
+		const std::vector<C2DPoint>* pPoints;
+		bool operator()(unsigned int n1, unsigned int n2) const
+			{ return IsBefore((*pPoints)[n1], (*pPoints)[n2]);}
+	};
+
+	unsigned int nLines = (unsigned int)m_Left.size();
+
+	// The ends, left ends first then right ends.
+	std::vector<C2DPoint> Ends;
+	std::vector<unsigned int> Order;
+	Ends.reserve(nLines * 2);
+	Order.reserve(nLines * 2);
+	for (unsigned int i = 0; i < nLines; i++)
+		Ends.push_back(m_Left[i]);
+	for (unsigned int i = 0; i < nLines; i++)
+		Ends.push_back(m_Right[i]);
+	for (unsigned int i = 0; i < nLines; i++)
+	{
+		if (!IsSame(m_Left[i], m_Right[i]))
+		{
+			Order.push_back(i);
+			Order.push_back(i + nLines);
+		}
+	}
+
+	sByPoint ByPoint;
+	ByPoint.pPoints = &Ends;
+	std::sort(Order.begin(), Order.end(), ByPoint);
+
+	std::vector<unsigned int> Starts;
+	std::vector<unsigned int> Stops;
+	unsigned int nEnd = 0;
+
+	while (!m_bDone && (nEnd < Order.size() || !m_Events.empty()))
+	{
+		if (!m_Events.empty() && (nEnd == Order.size() || !IsBefore(Ends[Order[nEnd]], m_Events.top().pt)))
+		{
+			sEvent Event = m_Events.top();
+			m_Events.pop();
+			AtCrossing(Event);
+			continue;
+		}
+
+		const C2DPoint pt = Ends[Order[nEnd]];
+		Starts.clear();
+		Stops.clear();
+		while (nEnd < Order.size() && IsSame(Ends[Order[nEnd]], pt))
+		{
+			if (Order[nEnd] < nLines)
+				Starts.push_back(Order[nEnd]);
+			else
+				Stops.push_back(Order[nEnd] - nLines);
+			nEnd++;
+		}
+
+		AtPoint(pt, Starts, Stops);
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSweepLine::IsBelow <BR>
+\brief True if the line in the first slot is below that in the second. The one being
+put in is compared at the point where it goes in, lines through that point being
+ordered by which way they go from it. A point being found is taken as on any line
+through it. Lines along each other go in the order of their index.
+<P>---------------------------------------------------------------------------*/
+bool CSweepLine::IsBelow(unsigned int nSlot1, unsigned int nSlot2) const
+{
+	if (nSlot1 == nSlot2)
+		return false;
+
+	bool bKeyFirst = nSlot1 == m_nKeySlot;
+	unsigned int nOther = m_SlotLine[bKeyFirst ? nSlot2 : nSlot1];
+
+	// Positive if the key is above the other line.
+	double dSide = Side(nOther, m_ptKey);
+	if (dSide == 0 && m_nKeySlot != conPointSlot)
+	{
+		dSide = Side(nOther, m_ptKeyTo);
+		if (dSide == 0)
+			dSide = m_SlotLine[m_nKeySlot] > nOther ? 1 : -1;
+	}
+
+	return bKeyFirst ? dSide < 0 : dSide > 0;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSweepLine::AtPoint <BR>
+\brief At the end of one or more lines. Every line through the point meets every line
+starting there and each other so all are reported. The lines through it are taken
+out and those going on put back with those starting, so they are in the order they
+leave the point. The new lowest and highest are tested against the lines below and
+above, or if none are put back those lines are tested against each other.
+<P>---------------------------------------------------------------------------*/
+void CSweepLine::AtPoint(const C2DPoint& pt, const std::vector<unsigned int>& Starts,
+				const std::vector<unsigned int>& Ends)
+{
+	m_ptSweep = pt;
+
+	m_nKeySlot = conPointSlot;
+	m_ptKey = pt;
+
+	SlotSet::iterator ItFirst = m_Status.lower_bound(conPointSlot);
+	SlotSet::iterator ItAbove = ItFirst;
+	std::vector<unsigned int> Through;
+	while (ItAbove != m_Status.end() && Side(m_SlotLine[*ItAbove], pt) == 0)
+	{
+		Through.push_back(m_SlotLine[*ItAbove]);
+		++ItAbove;
+	}
+
+	bool bBelow = ItFirst != m_Status.begin();
+	SlotSet::iterator ItBelow = ItFirst;
+	if (bBelow)
+		--ItBelow;
+
+	// Every pair meets here.
+	std::vector<unsigned int> All(Through);
+	All.insert(All.end(), Starts.begin(), Starts.end());
+	for (unsigned int i = 0; i < All.size(); i++)
+	{
+		for (unsigned int j = i + 1; j < All.size(); j++)
+		{
+			Report(All[i], All[j], pt);
+			if (m_bDone)
+				return;
+		}
+	}
+
+	m_Status.erase(ItFirst, ItAbove);
+
+	unsigned int nInserted = 0;
+	for (unsigned int i = 0; i < Through.size(); i++)
+	{
+		unsigned int nLine = Through[i];
+		if (IsSame(m_Right[nLine], pt))
+		{
+			m_InStatus[nLine] = false;
+		}
+		else
+		{
+			Insert(m_LineSlot[nLine], pt);
+			nInserted++;
+		}
+	}
+	for (unsigned int i = 0; i < Starts.size(); i++)
+	{
+		unsigned int nLine = Starts[i];
+		m_SlotLine[nLine] = nLine;
+		m_LineSlot[nLine] = nLine;
+		m_InStatus[nLine] = true;
+		Insert(nLine, pt);
+		nInserted++;
+	}
+
+	if (nInserted == 0)
+	{
+		if (bBelow && ItAbove != m_Status.end())
+			Test(m_SlotLine[*ItBelow], m_SlotLine[*ItAbove]);
+	}
+	else
+	{
+		// The lines put in are between those below and above.
+		if (bBelow)
+		{
+			SlotSet::iterator ItLowest = ItBelow;
+			++ItLowest;
+			Test(m_SlotLine[*ItBelow], m_SlotLine[*ItLowest]);
+		}
+		if (ItAbove != m_Status.end())
+		{
+			SlotSet::iterator ItHighest = ItAbove;
+			--ItHighest;
+			Test(m_SlotLine[*ItHighest], m_SlotLine[*ItAbove]);
+		}
+	}
+
+	// A line ending here not found through it, which rounding of a crossing can
+	// cause, still has to go.
+	for (unsigned int i = 0; i < Ends.size(); i++)
+	{
+		unsigned int nLine = Ends[i];
+		if (!m_InStatus[nLine])
+			continue;
+
+		SlotSet::iterator It = m_Nodes[m_LineSlot[nLine]];
+		SlotSet::iterator ItNext = It;
+		++ItNext;
+		bool bPrev = It != m_Status.begin();
+		SlotSet::iterator ItPrev = It;
+		if (bPrev)
+			--ItPrev;
+
+		m_Status.erase(It);
+		m_InStatus[nLine] = false;
+
+		if (bPrev && ItNext != m_Status.end())
+			Test(m_SlotLine[*ItPrev], m_SlotLine[*ItNext]);
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSweepLine::AtCrossing <BR>
+\brief Where two lines cross. If they are still next to each other and in the order
+before crossing they swap slots and each is tested against its new neighbour.
+<P>---------------------------------------------------------------------------*/
+void CSweepLine::AtCrossing(const sEvent& Event)
+{
+	m_ptSweep = Event.pt;
+
+	unsigned int nLower = Event.nLine1;
+	unsigned int nUpper = Event.nLine2;
+	if (!m_InStatus[nLower] || !m_InStatus[nUpper])
+		return;
+
+	unsigned int nSlotLower = m_LineSlot[nLower];
+	unsigned int nSlotUpper = m_LineSlot[nUpper];
+	SlotSet::iterator ItLower = m_Nodes[nSlotLower];
+	SlotSet::iterator ItUpper = ItLower;
+	++ItUpper;
+	if (ItUpper == m_Status.end() || *ItUpper != nSlotUpper)
+		return;
+
+	m_SlotLine[nSlotLower] = nUpper;
+	m_SlotLine[nSlotUpper] = nLower;
+	m_LineSlot[nUpper] = nSlotLower;
+	m_LineSlot[nLower] = nSlotUpper;
+
+	if (ItLower != m_Status.begin())
+	{
+		SlotSet::iterator ItBelow = ItLower;
+		--ItBelow;
+		Test(m_SlotLine[*ItBelow], nUpper);
+	}
+	SlotSet::iterator ItAbove = ItUpper;
+	++ItAbove;
+	if (ItAbove != m_Status.end())
+		Test(nLower, m_SlotLine[*ItAbove]);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSweepLine::Insert <BR>
+\brief Puts the line in the slot in order at the point.
+<P>---------------------------------------------------------------------------*/
+void CSweepLine::Insert(unsigned int nSlot, const C2DPoint& pt)
+{
+	m_nKeySlot = nSlot;
+	m_ptKey = pt;
+	m_ptKeyTo = m_Right[m_SlotLine[nSlot]];
+
+	m_Nodes[nSlot] = m_Status.insert(nSlot).first;
+
+	m_nKeySlot = conPointSlot;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSweepLine::Test <BR>
+\brief Reports and queues the crossing of the lines if each has its ends either side
+of the other and the upper one ends below the lower, so they have yet to pass. Lines
+which touch or lie along each other meet at an end of one of them so are found there.
+The point is kept within both lines' bounds and not before the sweep.
+<P>---------------------------------------------------------------------------*/
+void CSweepLine::Test(unsigned int nLower, unsigned int nUpper)
+{
+	double dSide1 = Side(nLower, m_Left[nUpper]);
+	double dSide2 = Side(nLower, m_Right[nUpper]);
+	if (!(dSide1 > 0 && dSide2 < 0))
+		return;
+
+	double dSide3 = Side(nUpper, m_Left[nLower]);
+	double dSide4 = Side(nUpper, m_Right[nLower]);
+	if (!((dSide3 > 0 && dSide4 < 0) || (dSide3 < 0 && dSide4 > 0)))
+		return;
+
+	// The side is linear along the lower line so it is 0 this far along.
+	const C2DPoint& ptLeft = m_Left[nLower];
+	const C2DPoint& ptRight = m_Right[nLower];
+	double dFactor = dSide3 / (dSide3 - dSide4);
+	C2DPoint pt(ptLeft.x + dFactor * (ptRight.x - ptLeft.x), ptLeft.y + dFactor * (ptRight.y - ptLeft.y));
+
+	double dMinX = std::max(ptLeft.x, m_Left[nUpper].x);
+	double dMaxX = std::min(ptRight.x, m_Right[nUpper].x);
+	double dMinY = std::max(std::min(ptLeft.y, ptRight.y), std::min(m_Left[nUpper].y, m_Right[nUpper].y));
+	double dMaxY = std::min(std::max(ptLeft.y, ptRight.y), std::max(m_Left[nUpper].y, m_Right[nUpper].y));
+	pt.x = std::min(std::max(pt.x, dMinX), dMaxX);
+	pt.y = std::min(std::max(pt.y, dMinY), dMaxY);
+
+	if (IsBefore(pt, m_ptSweep))
+		pt = m_ptSweep;
+
+	Report(nLower, nUpper, pt);
+
+	sEvent Event;
+	Event.pt = pt;
+	Event.nLine1 = nLower;
+	Event.nLine2 = nUpper;
+	m_Events.push(Event);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSweepLine::Report <BR>
+\brief Adds the lines as meeting at the point unless they are only joined.
+<P>---------------------------------------------------------------------------*/
+void CSweepLine::Report(unsigned int nLine1, unsigned int nLine2, const C2DPoint& pt)
+{
+	if (IsJoin(nLine1, nLine2))
+		return;
+
+	CSegmentSweep::sCrossing Crossing;
+	Crossing.nLine1 = std::min(nLine1, nLine2);
+	Crossing.nLine2 = std::max(nLine1, nLine2);
+	Crossing.pt = pt;
+	m_Found.push_back(Crossing);
+
+	if (m_bFirstOnly)
+		m_bDone = true;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CSweepLine::IsJoin <BR>
+\brief True if one line is joined to the other and they only meet at the join. Lines
+meeting at an end can only meet elsewhere if they double back along each other.
+<P>---------------------------------------------------------------------------*/
+bool CSweepLine::IsJoin(unsigned int nLine1, unsigned int nLine2) const
+{
+	if (m_Next[nLine2] == (int)nLine1)
+		std::swap(nLine1, nLine2);
+	else if (m_Next[nLine1] != (int)nLine2)
+		return false;
+
+	const C2DPoint& ptJoin = m_To[nLine1];
+	const C2DPoint& ptStart = m_From[nLine1];
+	const C2DPoint& ptEnd = m_To[nLine2];
+
+	if (CPredicates::Orient2D(ptStart, ptJoin, ptEnd) != 0)
+		return true;
+
+	return (ptStart.x - ptJoin.x) * (ptEnd.x - ptJoin.x) + (ptStart.y - ptJoin.y) * (ptEnd.y - ptJoin.y) <= 0;
+}
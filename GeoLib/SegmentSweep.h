@@ -0,0 +1,102 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file SegmentSweep.h
+\brief Declaration file for the CSegmentSweep class.
+
+\class CSegmentSweep
+\brief Finds where straight lines meet with a Bentley-Ottmann sweep.
+
+A line sweeps from left to right keeping the lines it crosses in order from the
+bottom up. Lines can only meet once they are next to each other in that order, so
+each is only tested against the lines either side of it as it is added, removed or
+passes another. Finding every pair which meets is O((n + k) log n) for n lines and
+k pairs rather than testing every pair.
+
+Which side of a line a point is on is decided exactly by CPredicates, so lines are
+always put in the right order and touching lines and lines along each other are
+found as well as crossings. A line only passes another at a crossing worked out in
+floating point, so finding every crossing can miss a pair meeting within rounding
+of another crossing. Finding whether there is any crossing stops at the first so is
+exact.
+
+Lines added from a polygon are joined to the lines either side of them, and joined
+lines only meet if they double back along each other.
+<P>---------------------------------------------------------------------------*/
+
+#ifndef _GEOLIB_CSEGMENTSWEEP_H
+#define _GEOLIB_CSEGMENTSWEEP_H
+
+
+#include "C2DPoint.h"
+#include <vector>
+
+
+class C2DPolyBase;
+
+#ifdef _EXPORTING
+	#define CLASS_DECLSPEC		__declspec(dllexport)
+#else
+	#ifdef _STATIC
+		#define CLASS_DECLSPEC
+	#else
+		#define CLASS_DECLSPEC		__declspec(dllimport)
+	#endif
+#endif
+
+
+class CLASS_DECLSPEC CSegmentSweep
+{
+public:
+	/// Two lines which meet and the point where they first meet going left to right.
+	struct sCrossing
+	{
+		unsigned int nLine1;
+		unsigned int nLine2;
+		C2DPoint pt;
+	};
+
+	/// Constructor.
+	CSegmentSweep(void);
+	/// Destructor.
+	~CSegmentSweep(void);
+
+	/// Adds a line. Returns its index.
+	unsigned int AddLine(const C2DPoint& ptFrom, const C2DPoint& ptTo);
+	/// Adds the lines of the polygon each joined to the next. The first added has the
+	/// index given by the count before. Lines are taken as straight so arcs become chords.
+	void AddPoly(const C2DPolyBase& Poly);
+	/// Clears all.
+	void Clear(void);
+	/// Returns the number of lines added.
+	unsigned int GetLineCount(void) const { return (unsigned int)m_Lines.size();}
+
+	/// True if any lines meet other than joined lines at their join.
+	bool HasCrossing(void) const;
+	/// Gets every pair of lines which meet other than joined lines at their join,
+	/// the lower index first, sorted by the lines.
+	void GetCrossings(std::vector<sCrossing>& Crossings) const;
+
+private:
+	/// A line added. The ends are as given and Next is the line joined to its end.
+	struct sLine
+	{
+		C2DPoint ptFrom;
+		C2DPoint ptTo;
+		int nNext;
+	};
+
+	/// Sweeps the lines, stopping at the first crossing if asked.
+	void Sweep(std::vector<sCrossing>& Crossings, bool bFirstOnly) const;
+
+	/// The lines.
+	std::vector<sLine> m_Lines;
+};
+
+
+#endif
@@ -7,44 +7,64 @@ any modified versions of this cannot be resold to any other party.
 
 /**--------------------------------------------------------------------------<BR>
 \file Sort.h
-\brief File for the sorting templates, all of which use the quick sort algorithm.
+\brief File for the sorting templates.
 
-File for a number of sorting algothithms, all of which sort items using the 
-quick sort algorithm. Main algorithms as follows:
+File for a number of sorting algothithms. Main algorithms as follows:
 1. Simple sort which sorts items in ascending order.
 2. Parallel sort which sorts items according to one array whilst sorting another
 in Parallel.
 3. A sort which uses a function call of the class being sorted e.g. GetLength().
 4. A sort which uses a function to determine which item out of 2 should come
 first in the array.
+5. A radix sort of double or unsigned int keys with a parallel array.
+6. A sort of keys with a parallel array split over threads for very large arrays.
+
+The quick sorts are introsorts. They take the pivot as the median of three, sort
+short runs by insertion and turn to a heap sort if the splits go too deep, so they
+are never worse than O(n log n). The function call sort calls the function once for
+each item rather than in every comparison. The radix sort is linear and best for
+the long arrays of coordinates sorted through the library.
 
 Any type of array can be sorted using the functions which ask to specify the
-limits of the sort (normally between the 0 and max element) but for convienience, 
-there are wrapper functions for all which sort between the 0 element and that 
-given by the size() function of the array less 1. 
+limits of the sort (normally between the 0 and max element) but for convienience,
+there are wrapper functions for all which sort between the 0 element and that
+given by the size() function of the array less 1.
 <P>---------------------------------------------------------------------------*/
 
 
-#ifndef _GEOLIB_SORT_H 
+#ifndef _GEOLIB_SORT_H
 #define _GEOLIB_SORT_H
 
 
+#include <vector>
+#include <thread>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
 
 /**--------------------------------------------------------------------------<BR>
 \namespace GeoSort
-\brief Namespace for a number of sorting algothithms, all of which sort items 
-using variations of the quick sort algorithm.
+\brief Namespace for a number of sorting algothithms.
 <P>---------------------------------------------------------------------------*/
 namespace GeoSort
 {
 
 
+/// Runs this short are sorted by insertion.
+const int conInsertionMax = 16;
+/// Arrays shorter than this are quick sorted rather than radix sorted.
+const unsigned int conRadixMin = 256;
+/// Arrays shorter than this are not split over threads.
+const unsigned int conParallelMin = 65536;
+
+
 /**--------------------------------------------------------------------------<BR>
 GeoSort::ReverseOrder
 \brief Reverses the order of an array.
 <P>---------------------------------------------------------------------------*/
-template<class ARRAY_TYPE, class TYPE>  
-void ReverseOrder(ARRAY_TYPE& Array) 
+template<class ARRAY_TYPE, class TYPE>
+void ReverseOrder(ARRAY_TYPE& Array)
 {
 	TYPE Temp;
 	unsigned int nCount = (unsigned int) Array.size();
@@ -55,179 +75,458 @@ void ReverseOrder(ARRAY_TYPE& Array)
 		Temp = Array[i];
 		Array[i] = Array[nCount - 1 - i];
 		Array[nCount - 1 - i] = Temp;
-	}	
+	}
 }
 
-	
+
 /**--------------------------------------------------------------------------<BR>
-GeoSort::FQuickSort
-\brief Wrapper for the function call sort.
+GeoSort::InsertionSort
+\brief Sorts a short run by insertion. The sorter compares and swaps items by index
+with Less(i, j) and Swap(i, j) so the same sort serves every array.
 <P>---------------------------------------------------------------------------*/
-template<class ARRAY_TYPE, class TYPE, typename COMPTYPE>  
-void FQuickSort(ARRAY_TYPE& Array, COMPTYPE (TYPE::*pFunctionCall)(void) const) 
+template<class SORTER>
+void InsertionSort(SORTER& Sorter, int lo0, int hi0)
 {
-	FQuickSort<ARRAY_TYPE, TYPE, COMPTYPE>(Array,  pFunctionCall , (int) 0, (int)(Array.size() - 1 ));
+	for (int i = lo0 + 1; i <= hi0; i++)
+	{
+		for (int j = i; j > lo0 && Sorter.Less(j, j - 1); j--)
+			Sorter.Swap(j, j - 1);
+	}
 }
 
+
 /**--------------------------------------------------------------------------<BR>
-GeoSort::FQuickSort
-\brief Sorts an array by calling a function for each object in the array e.g.
-GetLength().
+GeoSort::SiftDown
+\brief Moves the item at the root down the heap starting at lo0 until it is no less
+than those below it.
 <P>---------------------------------------------------------------------------*/
-template<class ARRAY_TYPE, class TYPE, typename COMPTYPE>  
-void FQuickSort(ARRAY_TYPE& Array, COMPTYPE (TYPE::*pFunctionCall)(void) const , int lo0, int hi0)
+template<class SORTER>
+void SiftDown(SORTER& Sorter, int lo0, int nRoot, int nCount)
 {
-	int lo = lo0;
-	int hi = hi0;
-	if (lo >= hi)  return;
+	while (true)
+	{
+		int nChild = 2 * nRoot + 1;
+		if (nChild >= nCount)
+			return;
+		if (nChild + 1 < nCount && Sorter.Less(lo0 + nChild, lo0 + nChild + 1))
+			nChild++;
+		if (!Sorter.Less(lo0 + nRoot, lo0 + nChild))
+			return;
+
+		Sorter.Swap(lo0 + nRoot, lo0 + nChild);
+		nRoot = nChild;
+	}
+}
 
-    else if( lo == hi - 1 )
+
+/**--------------------------------------------------------------------------<BR>
+GeoSort::HeapSort
+\brief Heap sort, which is O(n log n) whatever the order.
+<P>---------------------------------------------------------------------------*/
+template<class SORTER>
+void HeapSort(SORTER& Sorter, int lo0, int hi0)
+{
+	int nCount = hi0 - lo0 + 1;
+
+	for (int i = nCount / 2 - 1; i >= 0; i--)
+		SiftDown(Sorter, lo0, i, nCount);
+
+	for (int n = nCount - 1; n > 0; n--)
 	{
-            // sort a two element list by swapping if necessary 
-            if ((Array[lo].*pFunctionCall)() > (Array[hi].*pFunctionCall)()) 
-			{
-                TYPE T = Array[lo];
-                Array[lo] = Array[hi];
-                Array[hi] = T;
-            }
-            return;
+		Sorter.Swap(lo0, lo0 + n);
+		SiftDown(Sorter, lo0, 0, n);
 	}
+}
 
-    //  Pick a pivot and move it out of the way
 
-	TYPE pivot = Array[(lo + hi) / 2];
-        Array[(lo + hi) / 2] = Array[hi];
-        Array[hi] = pivot;
+/**--------------------------------------------------------------------------<BR>
+GeoSort::IntroSort
+\brief Quick sort with the median of three as the pivot. Splits stop at equal items
+from both sides so runs of the same item split evenly. The smaller side is sorted
+first so the stack stays shallow and after too many splits the rest is heap sorted.
+<P>---------------------------------------------------------------------------*/
+template<class SORTER>
+void IntroSort(SORTER& Sorter, int lo0, int hi0, int nDepth)
+{
+	while (hi0 - lo0 >= conInsertionMax)
+	{
+		if (nDepth-- == 0)
+		{
+			HeapSort(Sorter, lo0, hi0);
+			return;
+		}
 
-   while( lo < hi ) 
-   {
-        //  Search forward from a[lo] until an element is found that
-        //  is greater than the pivot or lo >= hi 
-            
-		while ((Array[lo].*pFunctionCall)() <= (pivot.*pFunctionCall)() && lo < hi) 
+		// Order the first, middle and last, then keep the median next to the end as
+		// the pivot.
+		int nMid = lo0 + (hi0 - lo0) / 2;
+		if (Sorter.Less(nMid, lo0))
+			Sorter.Swap(nMid, lo0);
+		if (Sorter.Less(hi0, lo0))
+			Sorter.Swap(hi0, lo0);
+		if (Sorter.Less(hi0, nMid))
+			Sorter.Swap(hi0, nMid);
+
+		int nPivot = hi0 - 1;
+		Sorter.Swap(nMid, nPivot);
+
+		// The searches are bounded because the ends only stop them if Less is strict.
+		// A switch function such as a >= b is true for equal items and would run on.
+		int lo = lo0;
+		int hi = nPivot;
+		while (true)
 		{
-			lo++;
+			while (++lo < nPivot && Sorter.Less(lo, nPivot))
+				;
+			while (--hi > lo0 && Sorter.Less(nPivot, hi))
+				;
+			if (lo >= hi)
+				break;
+			Sorter.Swap(lo, hi);
 		}
-		// Search backward from a[hi] until element is found that
-		//  is less than the pivot, or lo >= hi
-		     
-		while ((pivot.*pFunctionCall)() <= (Array[hi].*pFunctionCall)() && lo < hi ) 
+		Sorter.Swap(lo, nPivot);
+
+		// Elements lo0 to lo - 1 are no more than the pivot, lo + 1 to hi0 no less.
+		if (lo - lo0 < hi0 - lo)
 		{
-			hi--;
+			IntroSort(Sorter, lo0, lo - 1, nDepth);
+			lo0 = lo + 1;
 		}
-        //  Swap elements a[lo] and a[hi]
-		if( lo < hi ) 
+		else
 		{
-			TYPE T = Array[lo];
-			Array[lo] = Array[hi];
-			Array[hi] = T;
+			IntroSort(Sorter, lo + 1, hi0, nDepth);
+			hi0 = lo - 1;
 		}
 	}
 
-    //  Put the median in the "center" of the list
+	InsertionSort(Sorter, lo0, hi0);
+}
+
 
-	Array[hi0] = Array[hi];
-	Array[hi] = pivot;
+/**--------------------------------------------------------------------------<BR>
+GeoSort::IntroSort
+\brief Sorts between the limits, allowing splits to go twice the depth of a perfect
+split before turning to the heap sort.
+<P>---------------------------------------------------------------------------*/
+template<class SORTER>
+void IntroSort(SORTER& Sorter, int lo0, int hi0)
+{
+	if (lo0 >= hi0)
+		return;
 
-  	//Recursive calls, elements a[lo0] to a[lo-1] are less than or
-	//equal to pivot, elements a[hi+1] to a[hi0] are greater than
-	//pivot.
-         
-	FQuickSort<ARRAY_TYPE, TYPE>(Array, pFunctionCall, lo0, lo-1);
-	FQuickSort<ARRAY_TYPE, TYPE>(Array, pFunctionCall, hi+1, hi0);
+	int nDepth = 0;
+	for (int n = hi0 - lo0 + 1; n > 1; n >>= 1)
+		nDepth += 2;
+
+	IntroSort(Sorter, lo0, hi0, nDepth);
 }
 
 
 /**--------------------------------------------------------------------------<BR>
-GeoSort::FQuickSort
-\brief Wrapper for the function based sort.
+GeoSort::sArraySorter
+\brief Sorts an array by its items.
 <P>---------------------------------------------------------------------------*/
-template<class ARRAY_TYPE, class TYPE>  
-void FQuickSort(ARRAY_TYPE& Array, bool (*pSwitchIfTrue)(TYPE&, TYPE&)) 
+template<class ARRAY_TYPE, class TYPE>
+struct sArraySorter
 {
-	//  if pComparision returns true, the first element should be ordered after the second.
-	FQuickSort<ARRAY_TYPE, TYPE>(Array,  pSwitchIfTrue , (int) 0, (int)(Array.size() - 1 ));
-}
+	sArraySorter(ARRAY_TYPE& A) : Array(A) {}
+
+	bool Less(int i, int j) const { return Array[i] < Array[j];}
+	void Swap(int i, int j)
+	{
+		TYPE T = Array[i];
+		Array[i] = Array[j];
+		Array[j] = T;
+	}
+
+	ARRAY_TYPE& Array;
+};
 
 
 /**--------------------------------------------------------------------------<BR>
-GeoSort::FQuickSort
-\brief Sorts an array by calling a function which takes 2 objects in the array 
-and returns true if the first should be ordered after the second.
+GeoSort::sSwitchSorter
+\brief Sorts an array by a function returning true if the first item should be
+ordered after the second.
 <P>---------------------------------------------------------------------------*/
-template<class ARRAY_TYPE, class TYPE>  
-void FQuickSort(ARRAY_TYPE& Array, bool (*pSwitchIfTrue)(TYPE&, TYPE&), int lo0, int hi0) 
+template<class ARRAY_TYPE, class TYPE>
+struct sSwitchSorter
 {
-	//  if pComparision returns true, the first element should be ordered after the second.
-	int lo = lo0;
-	int hi = hi0;
-	if (lo >= hi)  return;
+	sSwitchSorter(ARRAY_TYPE& A, bool (*pSwitch)(TYPE&, TYPE&)) : Array(A), pSwitchIfTrue(pSwitch) {}
+
+	bool Less(int i, int j) const { return pSwitchIfTrue(Array[j], Array[i]);}
+	void Swap(int i, int j)
+	{
+		TYPE T = Array[i];
+		Array[i] = Array[j];
+		Array[j] = T;
+	}
+
+	ARRAY_TYPE& Array;
+	bool (*pSwitchIfTrue)(TYPE&, TYPE&);
+};
+
+
+/**--------------------------------------------------------------------------<BR>
+GeoSort::sParallelSorter
+\brief Sorts an array by its items whilst sorting another in the same way.
+<P>---------------------------------------------------------------------------*/
+template<class ARRAY_TYPE, class TYPE, class PARRAY_TYPE, class PTYPE>
+struct sParallelSorter
+{
+	sParallelSorter(ARRAY_TYPE& A, PARRAY_TYPE& P) : Array(A), ParArray(P) {}
 
-    else if( lo == hi - 1 )
+	bool Less(int i, int j) const { return Array[i] < Array[j];}
+	void Swap(int i, int j)
 	{
-            // sort a two element list by swapping if necessary 
-            if ( pSwitchIfTrue(Array[lo], Array[hi] )) /*Array[lo] > Array[hi])*/ 
-			{
-                TYPE T = Array[lo];
-                Array[lo] = Array[hi];
-                Array[hi] = T;
-            }
-            return;
+		TYPE T = Array[i];
+		Array[i] = Array[j];
+		Array[j] = T;
+
+		PTYPE PAR = ParArray[i];
+		ParArray[i] = ParArray[j];
+		ParArray[j] = PAR;
 	}
 
-    //  Pick a pivot and move it out of the way
+	ARRAY_TYPE& Array;
+	PARRAY_TYPE& ParArray;
+};
+
+
+/**--------------------------------------------------------------------------<BR>
+GeoSort::Permute
+\brief Puts the items between the limits in the order given by the indexes, which
+are of the items from lo0 on.
+<P>---------------------------------------------------------------------------*/
+template<class ARRAY_TYPE, class TYPE>
+void Permute(ARRAY_TYPE& Array, const std::vector<unsigned int>& Order, int lo0)
+{
+	std::vector<TYPE> Temp;
+	Temp.reserve(Order.size());
+	for (unsigned int i = 0; i < Order.size(); i++)
+		Temp.push_back(Array[lo0 + (int)Order[i]]);
+
+	for (unsigned int i = 0; i < Order.size(); i++)
+		Array[lo0 + (int)i] = Temp[i];
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+GeoSort::PQuickSort
+\brief Parallel quicksort which sorts the first array by its elements whilst
+also sorting the second in the same way.
+<P>---------------------------------------------------------------------------*/
+template<class ARRAY_TYPE, class TYPE, class PARRAY_TYPE, class PTYPE>
+void PQuickSort(ARRAY_TYPE& Array, PARRAY_TYPE& ParArray, int lo0, int hi0)
+{
+	sParallelSorter<ARRAY_TYPE, TYPE, PARRAY_TYPE, PTYPE> Sorter(Array, ParArray);
+	IntroSort(Sorter, lo0, hi0);
+}
 
-	TYPE pivot = Array[(lo + hi) / 2];
-        Array[(lo + hi) / 2] = Array[hi];
-        Array[hi] = pivot;
 
-   while( lo < hi ) 
-   {
-        //  Search forward from a[lo] until an element is found that
-        //  is greater than the pivot or lo >= hi 
-            
-		while ( !pSwitchIfTrue(Array[lo], pivot)   /*Array[lo] <= pivot*/ && lo < hi) 
+/**--------------------------------------------------------------------------<BR>
+GeoSort::PQuickSort
+\brief Wrapper for a Parallel quicksort.
+<P>---------------------------------------------------------------------------*/
+template<class ARRAY_TYPE, class TYPE, class PARRAY_TYPE, class PTYPE>
+void PQuickSort(ARRAY_TYPE& Array, PARRAY_TYPE& ParallelArray)
+{
+	PQuickSort<ARRAY_TYPE, TYPE, PARRAY_TYPE, PTYPE>(Array, ParallelArray, (int) 0, (int)(Array.size() - 1 ));
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+GeoSort::MergeRuns
+\brief Merges two sorted runs of keys and indexes next to each other into the same
+place in the arrays given.
+<P>---------------------------------------------------------------------------*/
+template<class TYPE>
+void MergeRuns(const std::vector<TYPE>& Keys, const std::vector<unsigned int>& Index,
+			std::vector<TYPE>& KeysOut, std::vector<unsigned int>& IndexOut,
+			unsigned int nStart, unsigned int nMid, unsigned int nEnd)
+{
+	unsigned int i = nStart;
+	unsigned int j = nMid;
+	unsigned int k = nStart;
+
+	while (i < nMid && j < nEnd)
+	{
+		if (Keys[j] < Keys[i])
 		{
-			lo++;
+			KeysOut[k] = Keys[j];
+			IndexOut[k++] = Index[j++];
 		}
-		// Search backward from a[hi] until element is found that
-		//  is less than the pivot, or lo >= hi
-		     
-		while (!pSwitchIfTrue(pivot, Array[hi]) /*pivot <= Array[hi]*/ && lo < hi ) 
+		else
 		{
-			hi--;
+			KeysOut[k] = Keys[i];
+			IndexOut[k++] = Index[i++];
 		}
-        //  Swap elements a[lo] and a[hi]
-		if( lo < hi ) 
+	}
+	while (i < nMid)
+	{
+		KeysOut[k] = Keys[i];
+		IndexOut[k++] = Index[i++];
+	}
+	while (j < nEnd)
+	{
+		KeysOut[k] = Keys[j];
+		IndexOut[k++] = Index[j++];
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+GeoSort::ParallelOrder
+\brief Sets the order of the keys as indexes into them. Very large arrays are split
+into a run for each thread, each quick sorted on its own thread, and the runs merged
+in pairs, each pair on its own thread.
+<P>---------------------------------------------------------------------------*/
+template<class TYPE>
+void ParallelOrder(const std::vector<TYPE>& Keys, std::vector<unsigned int>& Order)
+{
+	unsigned int nCount = (unsigned int)Keys.size();
+	std::vector<TYPE> Sorted(Keys);
+	Order.resize(nCount);
+	for (unsigned int i = 0; i < nCount; i++)
+		Order[i] = i;
+
+	unsigned int nThreads = std::thread::hardware_concurrency();
+	if (nCount < conParallelMin || nThreads < 2)
+	{
+		PQuickSort<std::vector<TYPE>, TYPE, std::vector<unsigned int>, unsigned int>(Sorted, Order);
+		return;
+	}
+
+	// The runs, each at least half the minimum long.
+	unsigned int nRuns = nThreads;
+	if (nRuns > nCount / (conParallelMin / 2))
+		nRuns = nCount / (conParallelMin / 2);
+	std::vector<unsigned int> Starts(nRuns + 1);
+	for (unsigned int i = 0; i <= nRuns; i++)
+		Starts[i] = (unsigned int)((uint64_t)nCount * i / nRuns);
+
+	std::vector<std::thread> Threads;
+	for (unsigned int i = 1; i < nRuns; i++)
+	{
+		int lo0 = (int)Starts[i];
+		int hi0 = (int)Starts[i + 1] - 1;
+		Threads.push_back(std::thread([&Sorted, &Order, lo0, hi0]()
+			{ PQuickSort<std::vector<TYPE>, TYPE, std::vector<unsigned int>, unsigned int>(Sorted, Order, lo0, hi0);}));
+	}
+	PQuickSort<std::vector<TYPE>, TYPE, std::vector<unsigned int>, unsigned int>(Sorted, Order, 0, (int)Starts[1] - 1);
+	for (unsigned int i = 0; i < Threads.size(); i++)
+		Threads[i].join();
+
+	std::vector<TYPE> KeysOut(nCount);
+	std::vector<unsigned int> OrderOut(nCount);
+	while (Starts.size() > 2)
+	{
+		std::vector<unsigned int> NewStarts;
+		Threads.clear();
+		for (unsigned int i = 0; i + 1 < Starts.size(); i += 2)
 		{
-			TYPE T = Array[lo];
-			Array[lo] = Array[hi];
-			Array[hi] = T;
+			NewStarts.push_back(Starts[i]);
+			unsigned int nEnd = i + 2 < Starts.size() ? Starts[i + 2] : Starts[i + 1];
+			unsigned int nMid = i + 2 < Starts.size() ? Starts[i + 1] : nEnd;
+			Threads.push_back(std::thread(MergeRuns<TYPE>, std::cref(Sorted), std::cref(Order),
+						std::ref(KeysOut), std::ref(OrderOut), Starts[i], nMid, nEnd));
 		}
+		NewStarts.push_back(nCount);
+		for (unsigned int i = 0; i < Threads.size(); i++)
+			Threads[i].join();
+
+		Sorted.swap(KeysOut);
+		Order.swap(OrderOut);
+		Starts.swap(NewStarts);
 	}
+}
 
-    //  Put the median in the "center" of the list
 
-	Array[hi0] = Array[hi];
-	Array[hi] = pivot;
+/**--------------------------------------------------------------------------<BR>
+GeoSort::ParallelSort
+\brief Sorts the first array by its elements whilst also sorting the second in the
+same way, splitting very large arrays over threads.
+<P>---------------------------------------------------------------------------*/
+template<class ARRAY_TYPE, class PARRAY_TYPE>
+void ParallelSort(ARRAY_TYPE& Array, PARRAY_TYPE& ParArray)
+{
+	typedef typename std::decay<decltype(Array[0])>::type TYPE;
+	typedef typename std::decay<decltype(ParArray[0])>::type PTYPE;
+
+	unsigned int nCount = (unsigned int)Array.size();
+	if (nCount < conParallelMin || std::thread::hardware_concurrency() < 2)
+	{
+		PQuickSort<ARRAY_TYPE, TYPE, PARRAY_TYPE, PTYPE>(Array, ParArray);
+		return;
+	}
+
+	std::vector<TYPE> Keys;
+	Keys.reserve(nCount);
+	for (unsigned int i = 0; i < nCount; i++)
+		Keys.push_back(Array[i]);
+
+	std::vector<unsigned int> Order;
+	ParallelOrder(Keys, Order);
 
-  	//Recursive calls, elements a[lo0] to a[lo-1] are less than or
-	//equal to pivot, elements a[hi+1] to a[hi0] are greater than
-	//pivot.
-         
-	FQuickSort<ARRAY_TYPE, TYPE>(Array,  pSwitchIfTrue , lo0, lo-1);
-	FQuickSort<ARRAY_TYPE, TYPE>(Array, pSwitchIfTrue  , hi+1, hi0);
+	Permute<ARRAY_TYPE, TYPE>(Array, Order, 0);
+	Permute<PARRAY_TYPE, PTYPE>(ParArray, Order, 0);
 }
 
 
 /**--------------------------------------------------------------------------<BR>
-GeoSort::SQuickSort
-\brief Wrapper for a simple quicksort.
+GeoSort::FQuickSort
+\brief Sorts an array by calling a function for each object in the array e.g.
+GetLength(). The function is called once for each object and the results sorted
+with the order of the objects, which are then moved into it.
 <P>---------------------------------------------------------------------------*/
-template<class ARRAY_TYPE, class TYPE>  
-void SQuickSort(ARRAY_TYPE& Array)
+template<class ARRAY_TYPE, class TYPE, typename COMPTYPE>
+void FQuickSort(ARRAY_TYPE& Array, COMPTYPE (TYPE::*pFunctionCall)(void) const , int lo0, int hi0)
 {
-	SQuickSort<ARRAY_TYPE, TYPE>(Array,(int) 0, (int)(Array.size() - 1 ));
+	if (lo0 >= hi0)
+		return;
+
+	std::vector<COMPTYPE> Keys;
+	Keys.reserve(hi0 - lo0 + 1);
+	for (int i = lo0; i <= hi0; i++)
+		Keys.push_back((Array[i].*pFunctionCall)());
+
+	std::vector<unsigned int> Order;
+	ParallelOrder(Keys, Order);
+
+	Permute<ARRAY_TYPE, TYPE>(Array, Order, lo0);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+GeoSort::FQuickSort
+\brief Wrapper for the function call sort.
+<P>---------------------------------------------------------------------------*/
+template<class ARRAY_TYPE, class TYPE, typename COMPTYPE>
+void FQuickSort(ARRAY_TYPE& Array, COMPTYPE (TYPE::*pFunctionCall)(void) const)
+{
+	FQuickSort<ARRAY_TYPE, TYPE, COMPTYPE>(Array,  pFunctionCall , (int) 0, (int)(Array.size() - 1 ));
+}
+
+/**--------------------------------------------------------------------------<BR>
+GeoSort::FQuickSort
+\brief Sorts an array by calling a function which takes 2 objects in the array
+and returns true if the first should be ordered after the second.
+<P>---------------------------------------------------------------------------*/
+template<class ARRAY_TYPE, class TYPE>
+void FQuickSort(ARRAY_TYPE& Array, bool (*pSwitchIfTrue)(TYPE&, TYPE&), int lo0, int hi0)
+{
+	sSwitchSorter<ARRAY_TYPE, TYPE> Sorter(Array, pSwitchIfTrue);
+	IntroSort(Sorter, lo0, hi0);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+GeoSort::FQuickSort
+\brief Wrapper for the function based sort.
+<P>---------------------------------------------------------------------------*/
+template<class ARRAY_TYPE, class TYPE>
+void FQuickSort(ARRAY_TYPE& Array, bool (*pSwitchIfTrue)(TYPE&, TYPE&))
+{
+	//  if pComparision returns true, the first element should be ordered after the second.
+	FQuickSort<ARRAY_TYPE, TYPE>(Array,  pSwitchIfTrue , (int) 0, (int)(Array.size() - 1 ));
 }
 
 
@@ -238,164 +537,181 @@ GeoSort::SQuickSort
 template<class ARRAY_TYPE, class TYPE>
 void SQuickSort(ARRAY_TYPE& Array, int lo0, int hi0)
 {
-	int lo = lo0;
-	int hi = hi0;
-	if (lo >= hi)  return;
+	sArraySorter<ARRAY_TYPE, TYPE> Sorter(Array);
+	IntroSort(Sorter, lo0, hi0);
+}
 
-    else if( lo == hi - 1 )
-	{
-            // sort a two element list by swapping if necessary 
-            if (Array[lo] > Array[hi]) 
-			{
-                TYPE T = Array[lo];
-                Array[lo] = Array[hi];
-                Array[hi] = T;
-            }
-            return;
-	}
 
-    //  Pick a pivot and move it out of the way
+/**--------------------------------------------------------------------------<BR>
+GeoSort::SQuickSort
+\brief Wrapper for a simple quicksort.
+<P>---------------------------------------------------------------------------*/
+template<class ARRAY_TYPE, class TYPE>
+void SQuickSort(ARRAY_TYPE& Array)
+{
+	SQuickSort<ARRAY_TYPE, TYPE>(Array,(int) 0, (int)(Array.size() - 1 ));
+}
 
-	TYPE pivot = Array[(lo + hi) / 2];
-        Array[(lo + hi) / 2] = Array[hi];
-        Array[hi] = pivot;
 
-   while( lo < hi ) 
-   {
-        //  Search forward from a[lo] until an element is found that
-        //  is greater than the pivot or lo >= hi 
-            
-		while (Array[lo] <= pivot && lo < hi) 
-		{
-			lo++;
-		}
-		// Search backward from a[hi] until element is found that
-		//  is less than the pivot, or lo >= hi
-		     
-		while (pivot <= Array[hi] && lo < hi ) 
-		{
-			hi--;
-		}
-        //  Swap elements a[lo] and a[hi]
-		if( lo < hi ) 
-		{
-			TYPE T = Array[lo];
-			Array[lo] = Array[hi];
-			Array[hi] = T;
-		}
-	}
+/**--------------------------------------------------------------------------<BR>
+GeoSort::RadixKey
+\brief The key of a double as an unsigned integer in the same order. The sign bit
+is set for positive numbers and all bits flipped for negative ones.
+<P>---------------------------------------------------------------------------*/
+inline uint64_t RadixKey(double d)
+{
+	uint64_t n;
+	memcpy(&n, &d, sizeof(n));
 
-    //  Put the median in the "center" of the list
+	return (n >> 63) ? ~n : n | 0x8000000000000000ULL;
+}
 
-	Array[hi0] = Array[hi];
-	Array[hi] = pivot;
 
-  	//Recursive calls, elements a[lo0] to a[lo-1] are less than or
-	//equal to pivot, elements a[hi+1] to a[hi0] are greater than
-	//pivot.
-         
-	SQuickSort<ARRAY_TYPE, TYPE>(Array, lo0, lo-1);
-	SQuickSort<ARRAY_TYPE, TYPE>(Array, hi+1, hi0);
+/**--------------------------------------------------------------------------<BR>
+GeoSort::RadixKey
+\brief The key of an unsigned int.
+<P>---------------------------------------------------------------------------*/
+inline uint64_t RadixKey(unsigned int n)
+{
+	return n;
 }
 
 
 /**--------------------------------------------------------------------------<BR>
-GeoSort::SQuickSort
-\brief Parallel quicksort which sorts the first array by its elements whilst
-also sorting the second in the same way.
+GeoSort::sRadixBuffer
+\brief Working space for the radix sort. A caller sorting many times can keep one
+so that once it has grown no sort allocates. Order holds the result.
 <P>---------------------------------------------------------------------------*/
-template<class ARRAY_TYPE, class TYPE, class PARRAY_TYPE, class PTYPE>
-void PQuickSort(ARRAY_TYPE& Array, PARRAY_TYPE& ParArray, int lo0, int hi0)
+struct sRadixBuffer
 {
-    int lo = lo0;
-    int hi = hi0;
-    if (lo >= hi)  return;
-
-    else if( lo == hi - 1 )
-    {
-            // sort a two element list by swapping if necessary
-            if (Array[lo] > Array[hi])
-            {
-                TYPE T = Array[lo];
-                Array[lo] = Array[hi];
-                Array[hi] = T;
-
-                PTYPE PAR = ParArray[lo];
-                ParArray[lo] = ParArray[hi];
-                ParArray[hi] = PAR;
-            }
-            return;
-    }
-
-    //  Pick a pivot and move it out of the way
-
-    TYPE pivot = Array[(lo + hi) / 2];
-        Array[(lo + hi) / 2] = Array[hi];
-        Array[hi] = pivot;
-
-    PTYPE ParPivot = ParArray[(lo + hi) / 2];
-        ParArray[(lo + hi) / 2] = ParArray[hi];
-        ParArray[hi] = ParPivot;
-
-
-   while( lo < hi )
-   {
-        //  Search forward from a[lo] until an element is found that
-        //  is greater than the pivot or lo >= hi
-
-        while (Array[lo] <= pivot && lo < hi)
-        {
-            lo++;
-        }
-        // Search backward from a[hi] until element is found that
-        //  is less than the pivot, or lo >= hi
-
-        while (pivot <= Array[hi] && lo < hi )
-        {
-            hi--;
-        }
-        //  Swap elements a[lo] and a[hi]
-        if( lo < hi )
-        {
-            TYPE T = Array[lo];
-            Array[lo] = Array[hi];
-            Array[hi] = T;
-
-            PTYPE PAR = ParArray[lo];
-            ParArray[lo] = ParArray[hi];
-            ParArray[hi] = PAR;
-
-        }
-    }
-
-    //  Put the median in the "center" of the list
-
-    Array[hi0] = Array[hi];
-    Array[hi] = pivot;
-
-    ParArray[hi0] = ParArray[hi];
-    ParArray[hi] = ParPivot;
-
-    //Recursive calls, elements a[lo0] to a[lo-1] are less than or
-    //equal to pivot, elements a[hi+1] to a[hi0] are greater than
-    //pivot.
-
-    PQuickSort< ARRAY_TYPE, TYPE, PARRAY_TYPE, PTYPE>(Array, ParArray, lo0, lo-1);
-    PQuickSort<ARRAY_TYPE, TYPE, PARRAY_TYPE, PTYPE>(Array, ParArray, hi+1, hi0);
-}
+	std::vector<uint64_t> Keys;
+	std::vector<uint64_t> KeysOut;
+	std::vector<unsigned int> Order;
+	std::vector<unsigned int> OrderOut;
+	std::vector<unsigned int> Counts;
+};
 
 
 /**--------------------------------------------------------------------------<BR>
-GeoSort::SQuickSort
-\brief Wrapper for a Parallel quicksort.
+GeoSort::sOrderSorter
+\brief Sorts indexes by the items of an array they index.
 <P>---------------------------------------------------------------------------*/
-template<class ARRAY_TYPE, class TYPE, class PARRAY_TYPE, class PTYPE> 
-void PQuickSort(ARRAY_TYPE& Array, PARRAY_TYPE& ParallelArray)
+template<class ARRAY_TYPE>
+struct sOrderSorter
 {
-	PQuickSort<ARRAY_TYPE, TYPE, PARRAY_TYPE, PTYPE>(Array, ParallelArray, (int) 0, (int)(Array.size() - 1 ));
+	sOrderSorter(const ARRAY_TYPE& A, std::vector<unsigned int>& O) : Array(A), Order(O) {}
+
+	bool Less(int i, int j) const { return Array[Order[i]] < Array[Order[j]];}
+	void Swap(int i, int j)
+	{
+		unsigned int T = Order[i];
+		Order[i] = Order[j];
+		Order[j] = T;
+	}
+
+	const ARRAY_TYPE& Array;
+	std::vector<unsigned int>& Order;
+};
+
+
+/**--------------------------------------------------------------------------<BR>
+GeoSort::RadixOrder
+\brief Sets the order of the buffer to the indexes of the double or unsigned int
+keys in sorted order, leaving the keys as they are. The keys are sorted 11 bits at a
+time from the lowest, all the counts being taken in one pass and bits which are the
+same for all skipped. Short arrays are quick sorted.
+<P>---------------------------------------------------------------------------*/
+template<class ARRAY_TYPE>
+void RadixOrder(const ARRAY_TYPE& Array, sRadixBuffer& Buffer)
+{
+	typedef typename std::decay<decltype(Array[0])>::type TYPE;
+
+	const unsigned int nBits = 11;
+	const unsigned int nRadix = 1 << nBits;
+	const unsigned int nDigits = (sizeof(TYPE) * 8 + nBits - 1) / nBits;
+
+	unsigned int nCount = (unsigned int)Array.size();
+	std::vector<unsigned int>& Order = Buffer.Order;
+	Order.resize(nCount);
+	for (unsigned int i = 0; i < nCount; i++)
+		Order[i] = i;
+
+	if (nCount < conRadixMin)
+	{
+		sOrderSorter<ARRAY_TYPE> Sorter(Array, Order);
+		IntroSort(Sorter, 0, (int)nCount - 1);
+		return;
+	}
+
+	std::vector<uint64_t>& Keys = Buffer.Keys;
+	std::vector<uint64_t>& KeysOut = Buffer.KeysOut;
+	std::vector<unsigned int>& OrderOut = Buffer.OrderOut;
+	std::vector<unsigned int>& Counts = Buffer.Counts;
+	Keys.resize(nCount);
+	KeysOut.resize(nCount);
+	OrderOut.resize(nCount);
+	Counts.assign(nDigits * nRadix, 0);
+	for (unsigned int i = 0; i < nCount; i++)
+	{
+		uint64_t nKey = RadixKey(Array[i]);
+		Keys[i] = nKey;
+		for (unsigned int d = 0; d < nDigits; d++)
+			Counts[d * nRadix + ((nKey >> (d * nBits)) & (nRadix - 1))]++;
+	}
+
+	for (unsigned int d = 0; d < nDigits; d++)
+	{
+		unsigned int* pCounts = &Counts[d * nRadix];
+		unsigned int nShift = d * nBits;
+		if (pCounts[(Keys[0] >> nShift) & (nRadix - 1)] == nCount)
+			continue;
+
+		// The counts become where each digit starts.
+		unsigned int nStart = 0;
+		for (unsigned int i = 0; i < nRadix; i++)
+		{
+			unsigned int nDigitCount = pCounts[i];
+			pCounts[i] = nStart;
+			nStart += nDigitCount;
+		}
+
+		for (unsigned int i = 0; i < nCount; i++)
+		{
+			unsigned int nTo = pCounts[(Keys[i] >> nShift) & (nRadix - 1)]++;
+			KeysOut[nTo] = Keys[i];
+			OrderOut[nTo] = Order[i];
+		}
+
+		Keys.swap(KeysOut);
+		Order.swap(OrderOut);
+	}
 }
 
 
+/**--------------------------------------------------------------------------<BR>
+GeoSort::RadixSort
+\brief Sorts an array of double or unsigned int keys whilst also sorting the second
+in the same way. The order is found by the radix sort and the arrays then put in it
+so each item is moved once. Short arrays are quick sorted.
+<P>---------------------------------------------------------------------------*/
+template<class ARRAY_TYPE, class PARRAY_TYPE>
+void RadixSort(ARRAY_TYPE& Array, PARRAY_TYPE& ParArray)
+{
+	typedef typename std::decay<decltype(Array[0])>::type TYPE;
+	typedef typename std::decay<decltype(ParArray[0])>::type PTYPE;
+
+	if (Array.size() < conRadixMin)
+	{
+		PQuickSort<ARRAY_TYPE, TYPE, PARRAY_TYPE, PTYPE>(Array, ParArray);
+		return;
+	}
+
+	sRadixBuffer Buffer;
+	RadixOrder(Array, Buffer);
+
+	Permute<ARRAY_TYPE, TYPE>(Array, Buffer.Order, 0);
+	Permute<PARRAY_TYPE, PTYPE>(ParArray, Buffer.Order, 0);
+}
 
 
 }
@@ -18,11 +18,21 @@ to help minimise routes between points. Used by the polygon for reordering point
 #include "Sort.h"
 #include "C2DPoint.h"
 #include "C2DPointSet.h"
+#include "C2DRect.h"
+#include "Predicates.h"
+#include "Constants.h"
 #include <list>
+#include <deque>
+#include <chrono>
+#include <algorithm>
+#include <math.h>
 
 
 const unsigned int conRefineProximity = 10;
 const unsigned int conMaxIterations = 5;
+const unsigned int conRouteNeighbours = 8;
+const unsigned int conInsertCandidates = 6;
+const unsigned int conMaxSegment = 3;
 
 
 class CPointList : public std::list<C2DPoint*>
@@ -31,6 +41,88 @@ class CPointList : public std::list<C2DPoint*>
 };
 
 
+/**--------------------------------------------------------------------------<BR>
+\class CRouteOptimiser
+\brief Orders points into a closed route held in flat arrays. A grid over the points
+means finding the points near another never looks at them all, so each step is about
+constant time however many points there are.
+<P>---------------------------------------------------------------------------*/
+class CRouteOptimiser
+{
+public:
+	/// Constructor.
+	CRouteOptimiser(const C2DPointSet& Points, double dMaxSeconds, unsigned int nMaxMoves);
+
+	/// Orders the points. False if lines may still cross.
+	bool Run(std::vector<unsigned int>& Order);
+
+private:
+	/// Sizes the grid and puts the points in it.
+	void MakeGrid(void);
+	/// The cell of the point.
+	unsigned int Cell(unsigned int nPoint) const;
+	/// Finds the nearest points in the cells, closest first, the point itself excluded.
+	void FindNearest(unsigned int nPoint, unsigned int nMax,
+		const std::vector< std::vector<unsigned int> >& Cells, std::vector<unsigned int>& Found);
+	/// Makes the route from the convex hull inserting the rest where they add least.
+	void Insert(void);
+	/// Makes the list of the nearest points to each point.
+	void MakeNeighbours(void);
+	/// Improves the route from the points queued until none improve.
+	void Improve(void);
+	/// Tries a 2-opt move from the point.
+	bool TryTwoOpt(unsigned int a);
+	/// Tries an Or-opt move of up to conMaxSegment points from the point.
+	bool TryOrOpt(unsigned int a);
+	/// Fixes crossing lines found with a sweep. True if there were none.
+	bool RemoveCrossings(void);
+	/// Removes the lines u1-u2 and v1-v2 adding u1-v1 and u2-v2.
+	void Make2Opt(unsigned int u1, unsigned int u2, unsigned int v1, unsigned int v2);
+	/// Reverses the route between the positions, or the rest of it if that is shorter.
+	void Reverse(unsigned int nFrom, unsigned int nTo);
+	/// Queues the point to be looked at again.
+	void Queue(unsigned int nPoint);
+	/// True if the seconds or moves allowed are used up.
+	bool OutOfBudget(void);
+
+	/// The point after and before in the route.
+	unsigned int Next(unsigned int nPoint) const {return m_Route[m_Pos[nPoint] + 1 == m_nCount ? 0 : m_Pos[nPoint] + 1];}
+	unsigned int Prev(unsigned int nPoint) const {return m_Route[m_Pos[nPoint] == 0 ? m_nCount - 1 : m_Pos[nPoint] - 1];}
+	/// The distance between points.
+	double Dist(unsigned int n1, unsigned int n2) const {return m_Pts[n1].Distance(m_Pts[n2]);}
+
+	/// The points.
+	std::vector<C2DPoint> m_Pts;
+	unsigned int m_nCount;
+	/// The grid.
+	double m_dLeft;
+	double m_dBottom;
+	double m_dInvCell;
+	double m_dCell;
+	unsigned int m_nCols;
+	unsigned int m_nRows;
+	std::vector< std::vector<unsigned int> > m_Cells;
+	/// The point at each position of the route and the position of each point.
+	std::vector<unsigned int> m_Route;
+	std::vector<unsigned int> m_Pos;
+	/// The nearest points to each, conRouteNeighbours each, closest first.
+	std::vector<unsigned int> m_Near;
+	unsigned int m_nNear;
+	/// The points to look at again and whether each is queued.
+	std::deque<unsigned int> m_Queue;
+	std::vector<bool> m_Queued;
+	/// The budget.
+	std::chrono::steady_clock::time_point m_Start;
+	double m_dMaxSeconds;
+	unsigned int m_nMaxMoves;
+	unsigned int m_nMoves;
+	unsigned int m_nChecks;
+	bool m_bOutOfBudget;
+	/// Scratch space for the nearest search.
+	std::vector< std::pair<double, unsigned int> > m_Best;
+};
+
+
 _MEMORY_POOL_IMPLEMENATION(CTravellingSalesman)
 
 
@@ -426,4 +518,627 @@ void CTravellingSalesman::Refine2(void)
 		}	
 
 	}
-}
\ No newline at end of file
+}
+
+
+
+/**--------------------------------------------------------------------------<BR>
+CTravellingSalesman::OrderRoute
+\brief Orders the points into a short closed route with no crossing lines. The route
+starts as the convex hull, the rest being inserted farthest from the centre first
+where they add least to it, looking only at the lines by the nearest points already
+in. It is then improved with 2-opt and Or-opt moves to each point's nearest neighbours
+and any lines still crossing are found with a sweep and uncrossed. Improvement stops
+once the seconds or moves given are used, 0 being no limit. Returns false if lines
+may still cross.
+<P>---------------------------------------------------------------------------*/
+bool CTravellingSalesman::OrderRoute(const C2DPointSet& Points, std::vector<unsigned int>& Order,
+							double dMaxSeconds, unsigned int nMaxMoves)
+{
+	CRouteOptimiser Optimiser(Points, dMaxSeconds, nMaxMoves);
+
+	return Optimiser.Run(Order);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::CRouteOptimiser
+\brief Constructor.
+<P>---------------------------------------------------------------------------*/
+CRouteOptimiser::CRouteOptimiser(const C2DPointSet& Points, double dMaxSeconds, unsigned int nMaxMoves) :
+	m_nCount(Points.size()), m_dLeft(0), m_dBottom(0), m_dInvCell(1), m_dCell(1), m_nCols(1), m_nRows(1),
+	m_nNear(0), m_dMaxSeconds(dMaxSeconds), m_nMaxMoves(nMaxMoves), m_nMoves(0), m_nChecks(0),
+	m_bOutOfBudget(false)
+{
+	m_Pts.reserve(m_nCount);
+	for (unsigned int i = 0; i < m_nCount; i++)
+		m_Pts.push_back(Points[i]);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::Run
+\brief Orders the points. False if lines may still cross.
+<P>---------------------------------------------------------------------------*/
+bool CRouteOptimiser::Run(std::vector<unsigned int>& Order)
+{
+	Order.clear();
+
+	if (m_nCount < 4)
+	{
+		for (unsigned int i = 0; i < m_nCount; i++)
+			Order.push_back(i);
+		return true;
+	}
+
+	m_Start = std::chrono::steady_clock::now();
+
+	MakeGrid();
+	Insert();
+	MakeNeighbours();
+
+	m_Queued.assign(m_nCount, false);
+	for (unsigned int i = 0; i < m_nCount; i++)
+		Queue(m_Route[i]);
+
+	bool bResult = false;
+	while (true)
+	{
+		Improve();
+		unsigned int nMoves = m_nMoves;
+		if (RemoveCrossings())
+		{
+			bResult = true;
+			break;
+		}
+		// Stop if the budget is used or no crossing could be uncrossed.
+		if (m_bOutOfBudget || nMoves == m_nMoves)
+			break;
+	}
+
+	Order = m_Route;
+
+	return bResult;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::MakeGrid
+\brief Sizes the grid to about 2 points a cell and puts the points in it. The cells
+are no longer than the bounds over half the points so a thin set has few cells.
+<P>---------------------------------------------------------------------------*/
+void CRouteOptimiser::MakeGrid(void)
+{
+	double dRight = m_Pts[0].x;
+	double dTop = m_Pts[0].y;
+	m_dLeft = dRight;
+	m_dBottom = dTop;
+	for (unsigned int i = 1; i < m_nCount; i++)
+	{
+		m_dLeft = std::min(m_dLeft, m_Pts[i].x);
+		dRight = std::max(dRight, m_Pts[i].x);
+		m_dBottom = std::min(m_dBottom, m_Pts[i].y);
+		dTop = std::max(dTop, m_Pts[i].y);
+	}
+
+	double dWidth = dRight - m_dLeft;
+	double dHeight = dTop - m_dBottom;
+	double dCells = m_nCount / 2;
+
+	m_dCell = std::max(sqrt(dWidth * dHeight / dCells), std::max(dWidth, dHeight) / dCells);
+	if (m_dCell <= 0)
+		m_dCell = 1;
+	m_dInvCell = 1 / m_dCell;
+
+	m_nCols = (unsigned int)(dWidth * m_dInvCell) + 1;
+	m_nRows = (unsigned int)(dHeight * m_dInvCell) + 1;
+
+	m_Cells.assign(m_nCols * m_nRows, std::vector<unsigned int>());
+	for (unsigned int i = 0; i < m_nCount; i++)
+		m_Cells[Cell(i)].push_back(i);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::Cell
+\brief The cell of the point.
+<P>---------------------------------------------------------------------------*/
+unsigned int CRouteOptimiser::Cell(unsigned int nPoint) const
+{
+	unsigned int nCol = std::min((unsigned int)((m_Pts[nPoint].x - m_dLeft) * m_dInvCell), m_nCols - 1);
+	unsigned int nRow = std::min((unsigned int)((m_Pts[nPoint].y - m_dBottom) * m_dInvCell), m_nRows - 1);
+
+	return nRow * m_nCols + nCol;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::FindNearest
+\brief Finds up to the number given of the points in the cells nearest the point,
+closest first. Looks in rings of cells going out from the point until no cell left
+can have a point closer than the furthest found.
+<P>---------------------------------------------------------------------------*/
+void CRouteOptimiser::FindNearest(unsigned int nPoint, unsigned int nMax,
+		const std::vector< std::vector<unsigned int> >& Cells, std::vector<unsigned int>& Found)
+{
+	Found.clear();
+	m_Best.clear();
+
+	unsigned int nCell = Cell(nPoint);
+	int nCol = nCell % m_nCols;
+	int nRow = nCell / m_nCols;
+	int nRings = (int)std::max(m_nCols, m_nRows);
+
+	for (int r = 0; r <= nRings; r++)
+	{
+		if (m_Best.size() == nMax && r > 1)
+		{
+			// Points in this ring are at least r - 1 cells away.
+			double dMin = (r - 1) * m_dCell;
+			if (dMin * dMin >= m_Best.back().first)
+				break;
+		}
+
+		for (int y = nRow - r; y <= nRow + r; y++)
+		{
+			if (y < 0 || y >= (int)m_nRows)
+				continue;
+			int nStep = (y == nRow - r || y == nRow + r) ? 1 : 2 * r;
+			for (int x = nCol - r; x <= nCol + r; x += std::max(nStep, 1))
+			{
+				if (x < 0 || x >= (int)m_nCols)
+					continue;
+
+				const std::vector<unsigned int>& Points = Cells[y * m_nCols + x];
+				for (unsigned int i = 0; i < Points.size(); i++)
+				{
+					unsigned int nOther = Points[i];
+					if (nOther == nPoint)
+						continue;
+					double dx = m_Pts[nOther].x - m_Pts[nPoint].x;
+					double dy = m_Pts[nOther].y - m_Pts[nPoint].y;
+					double dDist = dx * dx + dy * dy;
+					if (m_Best.size() == nMax && dDist >= m_Best.back().first)
+						continue;
+
+					std::pair<double, unsigned int> Entry(dDist, nOther);
+					m_Best.insert(std::upper_bound(m_Best.begin(), m_Best.end(), Entry), Entry);
+					if (m_Best.size() > nMax)
+						m_Best.pop_back();
+				}
+			}
+		}
+	}
+
+	for (unsigned int i = 0; i < m_Best.size(); i++)
+		Found.push_back(m_Best[i].second);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::Insert
+\brief Makes the route from the convex hull then inserts the rest, farthest from the
+centre of the hull first, in the line which adds least to the route out of those at
+the points already in that are nearest. The route is held as a linked list while
+inserting then put in the flat arrays.
+<P>---------------------------------------------------------------------------*/
+void CRouteOptimiser::Insert(void)
+{
+	std::vector<unsigned int> After(m_nCount);
+	std::vector<unsigned int> Before(m_nCount);
+	std::vector<bool> InRoute(m_nCount, false);
+	std::vector< std::vector<unsigned int> > Cells(m_Cells.size());
+
+	C2DPointSet Points;
+	for (unsigned int i = 0; i < m_nCount; i++)
+		Points.Add(new C2DPoint(m_Pts[i]));
+	std::vector<unsigned int> Hull;
+	Points.GetConvexHull(Hull);
+	if (Hull.empty())
+		Hull.push_back(0);
+
+	C2DRect Rect(m_Pts[Hull[0]]);
+	for (unsigned int i = 0; i < Hull.size(); i++)
+	{
+		unsigned int nPoint = Hull[i];
+		After[nPoint] = Hull[(i + 1) % Hull.size()];
+		Before[nPoint] = Hull[(i + Hull.size() - 1) % Hull.size()];
+		InRoute[nPoint] = true;
+		Cells[Cell(nPoint)].push_back(nPoint);
+		Rect.ExpandToInclude(m_Pts[nPoint]);
+	}
+
+	C2DPoint ptCentre = Rect.GetCentre();
+	std::vector< std::pair<double, unsigned int> > Rest;
+	for (unsigned int i = 0; i < m_nCount; i++)
+	{
+		if (!InRoute[i])
+			Rest.push_back(std::pair<double, unsigned int>(-m_Pts[i].Distance(ptCentre), i));
+	}
+	std::sort(Rest.begin(), Rest.end());
+
+	std::vector<unsigned int> Found;
+	for (unsigned int i = 0; i < Rest.size(); i++)
+	{
+		unsigned int nPoint = Rest[i].second;
+		FindNearest(nPoint, conInsertCandidates, Cells, Found);
+
+		unsigned int nBest = Found[0];
+		double dBest = -1;
+		for (unsigned int j = 0; j < Found.size(); j++)
+		{
+			// The lines from and to the point near.
+			unsigned int nFrom[2] = {Found[j], Before[Found[j]]};
+			for (unsigned int k = 0; k < 2; k++)
+			{
+				unsigned int nTo = After[nFrom[k]];
+				double dAdded = Dist(nFrom[k], nPoint) + Dist(nPoint, nTo) - Dist(nFrom[k], nTo);
+				if (dBest < 0 || dAdded < dBest)
+				{
+					dBest = dAdded;
+					nBest = nFrom[k];
+				}
+			}
+		}
+
+		After[nPoint] = After[nBest];
+		Before[nPoint] = nBest;
+		Before[After[nBest]] = nPoint;
+		After[nBest] = nPoint;
+		Cells[Cell(nPoint)].push_back(nPoint);
+	}
+
+	m_Route.resize(m_nCount);
+	m_Pos.resize(m_nCount);
+	unsigned int nPoint = Hull[0];
+	for (unsigned int i = 0; i < m_nCount; i++)
+	{
+		m_Route[i] = nPoint;
+		m_Pos[nPoint] = i;
+		nPoint = After[nPoint];
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::MakeNeighbours
+\brief Makes the list of the nearest points to each point.
+<P>---------------------------------------------------------------------------*/
+void CRouteOptimiser::MakeNeighbours(void)
+{
+	m_nNear = std::min(conRouteNeighbours, m_nCount - 1);
+	m_Near.assign(m_nCount * m_nNear, 0);
+
+	std::vector<unsigned int> Found;
+	for (unsigned int i = 0; i < m_nCount; i++)
+	{
+		FindNearest(i, m_nNear, m_Cells, Found);
+		for (unsigned int j = 0; j < m_nNear; j++)
+			m_Near[i * m_nNear + j] = Found[j];
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::Improve
+\brief Takes points off the queue trying moves from each until none are left or the
+budget is used. A point moved is queued again along with the others at the lines
+changed.
+<P>---------------------------------------------------------------------------*/
+void CRouteOptimiser::Improve(void)
+{
+	while (!m_Queue.empty() && !OutOfBudget())
+	{
+		unsigned int a = m_Queue.front();
+		m_Queue.pop_front();
+		m_Queued[a] = false;
+
+		if (TryTwoOpt(a) || TryOrOpt(a))
+			Queue(a);
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::TryTwoOpt
+\brief Tries replacing the line from the point, going each way, and the line from one
+of its neighbours with the line between them and the line between their other ends.
+Only neighbours closer than the line from the point can give a shorter route.
+<P>---------------------------------------------------------------------------*/
+bool CRouteOptimiser::TryTwoOpt(unsigned int a)
+{
+	for (unsigned int nDir = 0; nDir < 2; nDir++)
+	{
+		unsigned int b = nDir == 0 ? Next(a) : Prev(a);
+		double dAB = Dist(a, b);
+
+		for (unsigned int i = 0; i < m_nNear; i++)
+		{
+			unsigned int c = m_Near[a * m_nNear + i];
+			double dAC = Dist(a, c);
+			if (dAC >= dAB)
+				break;
+
+			unsigned int d = nDir == 0 ? Next(c) : Prev(c);
+			if (c == b || d == a)
+				continue;
+
+			double dCD = Dist(c, d);
+			double dGain = dAB + dCD - dAC - Dist(b, d);
+			if (dGain > conEqualityTolerance * (dAB + dCD))
+			{
+				Make2Opt(a, b, c, d);
+				Queue(b);
+				Queue(c);
+				Queue(d);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::TryOrOpt
+\brief Tries moving the points from this one on, up to conMaxSegment of them, to a
+line at a neighbour of either end, either way round. The move is made with 2-opt
+moves so the arrays are only changed between the places.
+<P>---------------------------------------------------------------------------*/
+bool CRouteOptimiser::TryOrOpt(unsigned int a)
+{
+	unsigned int e = a;
+	for (unsigned int nLength = 1; nLength <= conMaxSegment && nLength + 3 <= m_nCount; nLength++)
+	{
+		if (nLength > 1)
+			e = Next(e);
+
+		unsigned int p = Prev(a);
+		unsigned int nx = Next(e);
+		double dRemoved = Dist(p, a) + Dist(e, nx) - Dist(p, nx);
+		if (dRemoved <= 0)
+			continue;
+
+		unsigned int nEnds[2] = {a, e};
+		for (unsigned int nEnd = 0; nEnd < (nLength == 1 ? 1u : 2u); nEnd++)
+		{
+			unsigned int nFrom = nEnds[nEnd];
+			for (unsigned int i = 0; i < m_nNear; i++)
+			{
+				unsigned int c = m_Near[nFrom * m_nNear + i];
+				if (Dist(nFrom, c) >= dRemoved)
+					break;
+				if ((m_Pos[c] + m_nCount - m_Pos[a]) % m_nCount < nLength)
+					continue;
+
+				// The line after the neighbour and the one before it.
+				unsigned int nLines[2][2] = {{c, Next(c)}, {Prev(c), c}};
+				for (unsigned int j = 0; j < 2; j++)
+				{
+					unsigned int c1 = nLines[j][0];
+					unsigned int c2 = nLines[j][1];
+					if (c1 == e || c2 == a || c2 == p)
+						continue;
+
+					double dC1C2 = Dist(c1, c2);
+					double dAddedReversed = Dist(c1, e) + Dist(a, c2) - dC1C2;
+					double dAdded = Dist(c1, a) + Dist(e, c2) - dC1C2;
+					bool bReversed = dAddedReversed < dAdded;
+					if (dRemoved - std::min(dAdded, dAddedReversed) <= conEqualityTolerance * (dRemoved + dC1C2))
+						continue;
+
+					// p a..e nx .. c1 c2 becomes p c1 .. nx e..a c2 then p nx .. c1 e..a c2.
+					Make2Opt(p, a, c1, c2);
+					if (c1 != nx)
+						Make2Opt(p, c1, nx, e);
+					if (!bReversed && nLength > 1)
+						Make2Opt(c1, e, a, c2);
+
+					Queue(p);
+					Queue(nx);
+					Queue(e);
+					Queue(c1);
+					Queue(c2);
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::RemoveCrossings
+\brief Finds the lines which cross with a sweep along x, keeping the lines which span
+the sweep position, and uncrosses each with a 2-opt move, which always shortens the
+route. The points at the lines changed are queued. True if none crossed.
+<P>---------------------------------------------------------------------------*/
+bool CRouteOptimiser::RemoveCrossings(void)
+{
+	std::vector< std::pair<double, unsigned int> > Lines(m_nCount);
+	for (unsigned int i = 0; i < m_nCount; i++)
+	{
+		const C2DPoint& pt1 = m_Pts[m_Route[i]];
+		const C2DPoint& pt2 = m_Pts[m_Route[i + 1 == m_nCount ? 0 : i + 1]];
+		Lines[i] = std::pair<double, unsigned int>(std::min(pt1.x, pt2.x), m_Route[i]);
+	}
+	std::sort(Lines.begin(), Lines.end());
+
+	// Each line is kept as the point it starts from. The crossings are kept as the
+	// points at each line in turn.
+	std::vector<unsigned int> Active;
+	std::vector< std::pair<unsigned int, unsigned int> > Crossings;
+	for (unsigned int i = 0; i < m_nCount; i++)
+	{
+		unsigned int u1 = Lines[i].second;
+		unsigned int u2 = Next(u1);
+		const C2DPoint& ptU1 = m_Pts[u1];
+		const C2DPoint& ptU2 = m_Pts[u2];
+		double dMinY = std::min(ptU1.y, ptU2.y);
+		double dMaxY = std::max(ptU1.y, ptU2.y);
+
+		unsigned int nKept = 0;
+		for (unsigned int j = 0; j < Active.size(); j++)
+		{
+			unsigned int v1 = Active[j];
+			unsigned int v2 = Next(v1);
+			const C2DPoint& ptV1 = m_Pts[v1];
+			const C2DPoint& ptV2 = m_Pts[v2];
+			if (std::max(ptV1.x, ptV2.x) < Lines[i].first)
+				continue;
+			Active[nKept++] = v1;
+
+			if (v2 == u1 || u2 == v1 || std::max(ptV1.y, ptV2.y) < dMinY || std::min(ptV1.y, ptV2.y) > dMaxY)
+				continue;
+
+			double dO1 = CPredicates::Orient2D(ptU1, ptU2, ptV1);
+			double dO2 = CPredicates::Orient2D(ptU1, ptU2, ptV2);
+			double dO3 = CPredicates::Orient2D(ptV1, ptV2, ptU1);
+			double dO4 = CPredicates::Orient2D(ptV1, ptV2, ptU2);
+			bool bCross = ((dO1 > 0 && dO2 < 0) || (dO1 < 0 && dO2 > 0)) &&
+							((dO3 > 0 && dO4 < 0) || (dO3 < 0 && dO4 > 0));
+			// Lines along each other only count if uncrossing them is shorter.
+			if (!bCross && dO1 == 0 && dO2 == 0 &&
+				Dist(u1, v1) + Dist(u2, v2) < Dist(u1, u2) + Dist(v1, v2))
+			{
+				bCross = true;
+			}
+			if (bCross)
+			{
+				Crossings.push_back(std::pair<unsigned int, unsigned int>(u1, u2));
+				Crossings.push_back(std::pair<unsigned int, unsigned int>(v1, v2));
+			}
+		}
+		Active.resize(nKept);
+		Active.push_back(u1);
+	}
+
+	for (unsigned int i = 0; i < Crossings.size() && !OutOfBudget(); i++)
+	{
+		unsigned int u1 = Crossings[i].first;
+		unsigned int u2 = Crossings[i].second;
+		unsigned int v1 = Crossings[i + 1].first;
+		unsigned int v2 = Crossings[i + 1].second;
+		i++;
+
+		// An earlier move may have taken a line away or turned it round.
+		if (Next(u1) != u2)
+		{
+			if (Next(u2) != u1)
+				continue;
+			std::swap(u1, u2);
+		}
+		if (Next(v1) != v2)
+		{
+			if (Next(v2) != v1)
+				continue;
+			std::swap(v1, v2);
+		}
+		if (Dist(u1, v1) + Dist(u2, v2) >= Dist(u1, u2) + Dist(v1, v2))
+			continue;
+
+		Make2Opt(u1, u2, v1, v2);
+		Queue(u1);
+		Queue(u2);
+		Queue(v1);
+		Queue(v2);
+	}
+
+	return Crossings.empty();
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::Make2Opt
+\brief Removes the lines u1-u2 and v1-v2, which must go the same way round the route,
+and adds u1-v1 and u2-v2 by reversing the route between them.
+<P>---------------------------------------------------------------------------*/
+void CRouteOptimiser::Make2Opt(unsigned int u1, unsigned int u2, unsigned int v1, unsigned int v2)
+{
+	if (Next(u1) == u2)
+	{
+		assert(Next(v1) == v2);
+		Reverse(m_Pos[u2], m_Pos[v1]);
+	}
+	else
+	{
+		assert(Next(u2) == u1 && Next(v2) == v1);
+		Reverse(m_Pos[u1], m_Pos[v2]);
+	}
+
+	m_nMoves++;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::Reverse
+\brief Reverses the route from one position going forward to the other. The rest of
+the route is reversed instead if it is shorter, which is the same closed route the
+other way round, so a move is never more than half the points.
+<P>---------------------------------------------------------------------------*/
+void CRouteOptimiser::Reverse(unsigned int nFrom, unsigned int nTo)
+{
+	unsigned int nLength = (nTo + m_nCount - nFrom) % m_nCount + 1;
+	if (nLength * 2 > m_nCount)
+	{
+		unsigned int nRestFrom = nTo + 1 == m_nCount ? 0 : nTo + 1;
+		nTo = nFrom == 0 ? m_nCount - 1 : nFrom - 1;
+		nFrom = nRestFrom;
+		nLength = m_nCount - nLength;
+	}
+
+	for (unsigned int i = 0; i < nLength / 2; i++)
+	{
+		unsigned int n1 = m_Route[nFrom];
+		unsigned int n2 = m_Route[nTo];
+		m_Route[nFrom] = n2;
+		m_Pos[n2] = nFrom;
+		m_Route[nTo] = n1;
+		m_Pos[n1] = nTo;
+
+		nFrom = nFrom + 1 == m_nCount ? 0 : nFrom + 1;
+		nTo = nTo == 0 ? m_nCount - 1 : nTo - 1;
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::Queue
+\brief Queues the point to be looked at again unless it is already.
+<P>---------------------------------------------------------------------------*/
+void CRouteOptimiser::Queue(unsigned int nPoint)
+{
+	if (!m_Queued[nPoint])
+	{
+		m_Queued[nPoint] = true;
+		m_Queue.push_back(nPoint);
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CRouteOptimiser::OutOfBudget
+\brief True if the moves or seconds allowed are used up. The clock is only read every
+so often.
+<P>---------------------------------------------------------------------------*/
+bool CRouteOptimiser::OutOfBudget(void)
+{
+	if (m_bOutOfBudget)
+		return true;
+
+	if (m_nMaxMoves > 0 && m_nMoves >= m_nMaxMoves)
+		m_bOutOfBudget = true;
+
+	if (m_dMaxSeconds > 0 && (++m_nChecks & 63) == 0)
+	{
+		std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now() - m_Start;
+		if (Elapsed.count() >= m_dMaxSeconds)
+			m_bOutOfBudget = true;
+	}
+
+	return m_bOutOfBudget;
+}
+
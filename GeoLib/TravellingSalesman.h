@@ -21,6 +21,7 @@ Used by the polygon for reordering points.
 #define _CTRAVELLINGSALESMAN_H
 
 #include "MemoryPool.h"
+#include <vector>
 
 
 class C2DPoint;
@@ -63,6 +64,12 @@ public:
 	/// Deletes all
 	void DeleteAll(void);
 
+	/// Orders the points into a short closed route with no crossing lines, Order getting
+	/// the index of each point in turn. Stops improving the route after the seconds or
+	/// the number of moves given, 0 for no limit. False if lines may still cross.
+	static bool OrderRoute(const C2DPointSet& Points, std::vector<unsigned int>& Order,
+							double dMaxSeconds = 0, unsigned int nMaxMoves = 0);
+
 private:
 	/// The data - a list for quick insertion.
 	CPointList* m_Points;
@@ -0,0 +1,1338 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file Triangulator.cpp
+\brief Implementation file for the CTriangulator class.
+
+Implementation file for CTriangulator, which splits a polygon with holes into
+triangles given as indexes of its points.
+<P>---------------------------------------------------------------------------*/
+
+
+#include "StdAfx.h"
+#include "Triangulator.h"
+#include "C2DPoint.h"
+#include "Predicates.h"
+#include "SegmentSweep.h"
+#include <algorithm>
+#include <cfloat>
+#include <unordered_map>
+#include <unordered_set>
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::CTriangulator <BR>
+\brief Constructor.
+<P>---------------------------------------------------------------------------*/
+CTriangulator::CTriangulator(void) : m_nNodes(0), m_pIndices(0), m_dMinX(0), m_dMinY(0), m_dInvSize(0)
+{
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::~CTriangulator <BR>
+\brief Destructor.
+<P>---------------------------------------------------------------------------*/
+CTriangulator::~CTriangulator(void)
+{
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::Triangulate <BR>
+\brief Makes the outline into a clockwise ring and the holes anticlockwise, joins
+the holes in and clips ears.
+<P>---------------------------------------------------------------------------*/
+void CTriangulator::Triangulate(const C2DPoint* pPoints, unsigned int nCount,
+					const unsigned int* pHoleStarts, unsigned int nHoles,
+					std::vector<uint32_t>& Indices)
+{
+	Indices.clear();
+
+	m_nNodes = 0;
+	m_pIndices = &Indices;
+	m_dMinX = 0;
+	m_dMinY = 0;
+	m_dInvSize = 0;
+
+	unsigned int nOuterEnd = nHoles > 0 ? pHoleStarts[0] : nCount;
+
+	sNode* pOuter = MakeRing(pPoints, 0, nOuterEnd, true);
+
+	if (pOuter == 0 || pOuter->pNext == pOuter->pPrev)
+		return;
+
+	Indices.reserve(3 * (nCount + 2 * nHoles));
+
+	if (nHoles > 0)
+		pOuter = JoinHoles(pPoints, nCount, pHoleStarts, nHoles, pOuter);
+
+	if (nCount > _TRIANGULATOR_HASH_MIN)
+	{
+		double dMaxX = pPoints[0].x;
+		double dMaxY = pPoints[0].y;
+		m_dMinX = dMaxX;
+		m_dMinY = dMaxY;
+
+		for (unsigned int i = 1; i < nOuterEnd; i++)
+		{
+			const C2DPoint& pt = pPoints[i];
+			if (pt.x < m_dMinX) m_dMinX = pt.x;
+			if (pt.y < m_dMinY) m_dMinY = pt.y;
+			if (pt.x > dMaxX) dMaxX = pt.x;
+			if (pt.y > dMaxY) dMaxY = pt.y;
+		}
+
+		double dSize = std::max(dMaxX - m_dMinX, dMaxY - m_dMinY);
+		m_dInvSize = dSize != 0 ? 32767 / dSize : 0;
+	}
+
+	ClipEars(pOuter, 0);
+
+	// Ears can reach across where the ring touches itself, giving triangles which
+	// overlap, so then the ring is made again and each part clipped on its own.
+	if (!IsFilled(pPoints, nCount, pHoleStarts, nHoles, Indices))
+	{
+		Indices.clear();
+		m_nNodes = 0;
+
+		pOuter = MakeRing(pPoints, 0, nOuterEnd, true);
+		if (nHoles > 0)
+			pOuter = JoinHoles(pPoints, nCount, pHoleStarts, nHoles, pOuter);
+
+		std::vector<sNode*> Rings;
+		SplitTouches(pOuter, Rings);
+
+		for (size_t i = 0; i < Rings.size(); i++)
+			ClipEars(Rings[i], 0);
+	}
+
+	m_pIndices = 0;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::IsFilled <BR>
+\brief True if the triangles add up to the area of the outline less the holes, so
+none overlap.
+<P>---------------------------------------------------------------------------*/
+bool CTriangulator::IsFilled(const C2DPoint* pPoints, unsigned int nCount,
+					const unsigned int* pHoleStarts, unsigned int nHoles,
+					const std::vector<uint32_t>& Indices)
+{
+	double dArea = 0;
+
+	for (unsigned int h = 0; h <= nHoles; h++)
+	{
+		unsigned int nStart = h > 0 ? pHoleStarts[h - 1] : 0;
+		unsigned int nEnd = h < nHoles ? pHoleStarts[h] : nCount;
+
+		double dSum = 0;
+		for (unsigned int i = nStart, j = nEnd - 1; i < nEnd; j = i++)
+			dSum += (pPoints[j].x - pPoints[i].x) * (pPoints[i].y + pPoints[j].y);
+
+		dArea += h > 0 ? -fabs(dSum) : fabs(dSum);
+	}
+
+	double dTriangleSum = 0;
+	for (size_t i = 0; i + 2 < Indices.size(); i += 3)
+	{
+		const C2DPoint& p = pPoints[Indices[i]];
+		const C2DPoint& q = pPoints[Indices[i + 1]];
+		const C2DPoint& r = pPoints[Indices[i + 2]];
+		dTriangleSum += fabs((q.x - p.x) * (r.y - p.y) - (q.y - p.y) * (r.x - p.x));
+	}
+
+	return fabs(dTriangleSum - dArea) <= 1e-9 * (dTriangleSum + fabs(dArea));
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::Patch <BR>
+\brief Keeps the triangles whose points are all kept, as they are on the kept side of
+the new run, and drops those which lost a point or had a line replaced. The lines of
+the dropped triangles with the old run taken off and the new run put on, all made
+clockwise, cancel in opposite pairs and leave the rings round the gap. Each ring is
+clipped on its own and checked to be clockwise and filled by its triangles.
+<P>---------------------------------------------------------------------------*/
+bool CTriangulator::Patch(const C2DPoint* pPoints, unsigned int nCount,
+					const std::vector<int>& NewIndexes, std::vector<uint32_t>& Indices)
+{
+	unsigned int nOldCount = NewIndexes.size();
+
+	double dSum = 0;
+	for (unsigned int i = 0, j = nCount - 1; i < nCount; j = i++)
+		dSum += (pPoints[j].x - pPoints[i].x) * (pPoints[i].y + pPoints[j].y);
+
+	bool bDone = nCount >= 3 && nOldCount >= 3 && dSum != 0;
+	bool bClockwise = dSum > 0;
+
+	// Points by their new index, or after the new points by their old one if they went.
+	std::vector<uint32_t> Ids(nOldCount);
+	for (unsigned int i = 0; i < nOldCount; i++)
+		Ids[i] = NewIndexes[i] >= 0 ? (uint32_t)NewIndexes[i] : nCount + i;
+
+	std::unordered_set<uint64_t> Edges;
+	std::unordered_set<uint64_t> Replaced;
+
+	// Adds the line or cancels it against its reverse.
+	auto Toggle = [&](uint32_t a, uint32_t b)
+	{
+		if (Edges.erase(((uint64_t)b << 32) | a) == 0 && !Edges.insert(((uint64_t)a << 32) | b).second)
+			bDone = false;
+	};
+
+	std::vector<bool> Unchanged(bDone ? nCount : 0, false);
+
+	for (unsigned int i = 0; bDone && i < nOldCount; i++)
+	{
+		uint32_t a = Ids[i];
+		uint32_t b = Ids[(i + 1) % nOldCount];
+
+		if (a < nCount && b < nCount && b == (a + 1) % nCount)
+		{
+			Unchanged[a] = true;
+			continue;
+		}
+
+		if (a < nCount && b < nCount)
+			Replaced.insert(((uint64_t)std::min(a, b) << 32) | std::max(a, b));
+
+		if (bClockwise)
+			Toggle(b, a);
+		else
+			Toggle(a, b);
+	}
+
+	for (unsigned int i = 0; bDone && i < nCount; i++)
+	{
+		if (Unchanged[i])
+			continue;
+
+		uint32_t a = i;
+		uint32_t b = (i + 1) % nCount;
+
+		if (bClockwise)
+			Toggle(a, b);
+		else
+			Toggle(b, a);
+	}
+
+	size_t nKept = 0;
+
+	for (size_t i = 0; bDone && i + 2 < Indices.size(); i += 3)
+	{
+		if (Indices[i] >= nOldCount || Indices[i + 1] >= nOldCount || Indices[i + 2] >= nOldCount)
+		{
+			bDone = false;
+			break;
+		}
+
+		uint32_t Tri[3] = {Ids[Indices[i]], Ids[Indices[i + 1]], Ids[Indices[i + 2]]};
+		bool bKeep = Tri[0] < nCount && Tri[1] < nCount && Tri[2] < nCount;
+
+		for (unsigned int j = 0; bKeep && !Replaced.empty() && j < 3; j++)
+		{
+			uint32_t a = Tri[j];
+			uint32_t b = Tri[(j + 1) % 3];
+			if (Replaced.count(((uint64_t)std::min(a, b) << 32) | std::max(a, b)) != 0)
+				bKeep = false;
+		}
+
+		if (bKeep)
+		{
+			Indices[nKept++] = Tri[0];
+			Indices[nKept++] = Tri[1];
+			Indices[nKept++] = Tri[2];
+		}
+		else
+		{
+			Toggle(Tri[0], Tri[1]);
+			Toggle(Tri[1], Tri[2]);
+			Toggle(Tri[2], Tri[0]);
+		}
+	}
+
+	Indices.resize(bDone ? nKept : 0);
+
+	std::unordered_map<uint32_t, uint32_t> Next;
+
+	for (std::unordered_set<uint64_t>::const_iterator it = Edges.begin(); bDone && it != Edges.end(); ++it)
+	{
+		uint32_t a = (uint32_t)(*it >> 32);
+		uint32_t b = (uint32_t)(*it & 0xFFFFFFFF);
+
+		if (a >= nCount || b >= nCount || !Next.insert(std::make_pair(a, b)).second)
+			bDone = false;
+	}
+
+	std::vector<C2DPoint> Ring;
+	std::vector<uint32_t> RingIndexes;
+	std::vector<uint32_t> RingTriangles;
+
+	while (bDone && !Next.empty())
+	{
+		Ring.clear();
+		RingIndexes.clear();
+
+		uint32_t nPoint = Next.begin()->first;
+
+		while (true)
+		{
+			std::unordered_map<uint32_t, uint32_t>::iterator it = Next.find(nPoint);
+			if (it == Next.end())
+				break;
+			Ring.push_back(pPoints[nPoint]);
+			RingIndexes.push_back(nPoint);
+			nPoint = it->second;
+			Next.erase(it);
+		}
+
+		if (Ring.size() < 3 || nPoint != RingIndexes[0])
+		{
+			bDone = false;
+			break;
+		}
+
+		unsigned int nRing = Ring.size();
+		double dRingSum = 0;
+		for (unsigned int i = 0, j = nRing - 1; i < nRing; j = i++)
+			dRingSum += (Ring[j].x - Ring[i].x) * (Ring[i].y + Ring[j].y);
+
+		Triangulate(&Ring[0], nRing, 0, 0, RingTriangles);
+
+		double dTriangleSum = 0;
+		for (size_t i = 0; i + 2 < RingTriangles.size(); i += 3)
+		{
+			const C2DPoint& p = Ring[RingTriangles[i]];
+			const C2DPoint& q = Ring[RingTriangles[i + 1]];
+			const C2DPoint& r = Ring[RingTriangles[i + 2]];
+			dTriangleSum += fabs((q.x - p.x) * (r.y - p.y) - (q.y - p.y) * (r.x - p.x));
+		}
+
+		if (dRingSum <= 0 || fabs(dTriangleSum - dRingSum) > 1e-9 * (dTriangleSum + dRingSum))
+		{
+			bDone = false;
+			break;
+		}
+
+		for (size_t i = 0; i < RingTriangles.size(); i++)
+			Indices.push_back(RingIndexes[RingTriangles[i]]);
+	}
+
+	if (!bDone)
+		Triangulate(pPoints, nCount, 0, 0, Indices);
+
+	return bDone;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::MakeRing <BR>
+\brief Makes a ring of the points in the range going the way asked for. The sum is
+twice the area, positive if clockwise with y up.
+<P>---------------------------------------------------------------------------*/
+CTriangulator::sNode* CTriangulator::MakeRing(const C2DPoint* pPoints, unsigned int nStart,
+					unsigned int nEnd, bool bClockwise)
+{
+	if (nEnd <= nStart)
+		return 0;
+
+	double dSum = 0;
+	for (unsigned int i = nStart, j = nEnd - 1; i < nEnd; j = i++)
+		dSum += (pPoints[j].x - pPoints[i].x) * (pPoints[i].y + pPoints[j].y);
+
+	sNode* pLast = 0;
+
+	if (bClockwise == (dSum > 0))
+	{
+		for (unsigned int i = nStart; i < nEnd; i++)
+			pLast = InsertNode(i, pPoints[i].x, pPoints[i].y, pLast);
+	}
+	else
+	{
+		for (unsigned int i = nEnd; i-- > nStart; )
+			pLast = InsertNode(i, pPoints[i].x, pPoints[i].y, pLast);
+	}
+
+	if (pLast != 0 && Equals(pLast, pLast->pNext))
+	{
+		RemoveNode(pLast);
+		pLast = pLast->pNext;
+	}
+
+	return pLast;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::InsertNode <BR>
+\brief Adds a node after the last given, reusing one from an earlier call if there
+is one.
+<P>---------------------------------------------------------------------------*/
+CTriangulator::sNode* CTriangulator::InsertNode(uint32_t nIndex, double x, double y, sNode* pLast)
+{
+	if (m_nNodes == m_Nodes.size())
+		m_Nodes.push_back(sNode());
+
+	sNode* p = &m_Nodes[m_nNodes++];
+	p->nIndex = nIndex;
+	p->x = x;
+	p->y = y;
+	p->nZ = 0;
+	p->bSteiner = false;
+	p->pPrevZ = 0;
+	p->pNextZ = 0;
+
+	if (pLast == 0)
+	{
+		p->pPrev = p;
+		p->pNext = p;
+	}
+	else
+	{
+		p->pNext = pLast->pNext;
+		p->pPrev = pLast;
+		pLast->pNext->pPrev = p;
+		pLast->pNext = p;
+	}
+
+	return p;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::RemoveNode <BR>
+\brief Takes the node out of the ring and the z order.
+<P>---------------------------------------------------------------------------*/
+void CTriangulator::RemoveNode(sNode* p)
+{
+	p->pNext->pPrev = p->pPrev;
+	p->pPrev->pNext = p->pNext;
+
+	if (p->pPrevZ != 0)
+		p->pPrevZ->pNextZ = p->pNextZ;
+	if (p->pNextZ != 0)
+		p->pNextZ->pPrevZ = p->pPrevZ;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::FilterPoints <BR>
+\brief Removes repeated points and points in line, going round until none are left.
+<P>---------------------------------------------------------------------------*/
+CTriangulator::sNode* CTriangulator::FilterPoints(sNode* pStart, sNode* pEnd)
+{
+	if (pStart == 0)
+		return pStart;
+	if (pEnd == 0)
+		pEnd = pStart;
+
+	sNode* p = pStart;
+	bool bAgain;
+
+	do
+	{
+		bAgain = false;
+
+		if (!p->bSteiner && (Equals(p, p->pNext) || Area(p->pPrev, p, p->pNext) == 0))
+		{
+			RemoveNode(p);
+			p = pEnd = p->pPrev;
+			if (p == p->pNext)
+				break;
+			bAgain = true;
+		}
+		else
+		{
+			p = p->pNext;
+		}
+	}
+	while (bAgain || p != pEnd);
+
+	return pEnd;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::ClipEars <BR>
+\brief Clips ears until the ring is gone. If it goes all the way round without one
+the ring is cleaned of points in line, then of small self crossings and then split.
+<P>---------------------------------------------------------------------------*/
+void CTriangulator::ClipEars(sNode* pEar, int nPass)
+{
+	if (pEar == 0)
+		return;
+
+	if (nPass == 0 && m_dInvSize != 0)
+		IndexCurve(pEar);
+
+	sNode* pStop = pEar;
+
+	while (pEar->pPrev != pEar->pNext)
+	{
+		sNode* pPrev = pEar->pPrev;
+		sNode* pNext = pEar->pNext;
+
+		if (m_dInvSize != 0 ? IsEarHashed(pEar) : IsEar(pEar))
+		{
+			m_pIndices->push_back(pPrev->nIndex);
+			m_pIndices->push_back(pEar->nIndex);
+			m_pIndices->push_back(pNext->nIndex);
+
+			RemoveNode(pEar);
+
+			// Skipping the next one leaves fewer thin triangles.
+			pEar = pNext->pNext;
+			pStop = pNext->pNext;
+			continue;
+		}
+
+		pEar = pNext;
+
+		if (pEar == pStop)
+		{
+			if (nPass == 0)
+			{
+				ClipEars(FilterPoints(pEar), 1);
+			}
+			else if (nPass == 1)
+			{
+				pEar = CureLocalIntersections(FilterPoints(pEar));
+				ClipEars(pEar, 2);
+			}
+			else if (nPass == 2)
+			{
+				SplitAndClip(pEar);
+			}
+			break;
+		}
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::IsEar <BR>
+\brief True if the corner is convex and no reflex point of the ring is in it.
+<P>---------------------------------------------------------------------------*/
+bool CTriangulator::IsEar(const sNode* pEar)
+{
+	const sNode* a = pEar->pPrev;
+	const sNode* b = pEar;
+	const sNode* c = pEar->pNext;
+
+	if (Area(a, b, c) >= 0)
+		return false;
+
+	double dMinX = std::min(a->x, std::min(b->x, c->x));
+	double dMinY = std::min(a->y, std::min(b->y, c->y));
+	double dMaxX = std::max(a->x, std::max(b->x, c->x));
+	double dMaxY = std::max(a->y, std::max(b->y, c->y));
+
+	const sNode* p = c->pNext;
+	while (p != a)
+	{
+		if (p->x >= dMinX && p->x <= dMaxX && p->y >= dMinY && p->y <= dMaxY &&
+			PointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+			Area(p->pPrev, p, p->pNext) >= 0)
+			return false;
+		p = p->pNext;
+	}
+
+	return true;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::IsEarHashed <BR>
+\brief As IsEar but only the points whose z order is within that of the corners
+of the ear's bounds are looked at, going both ways from the ear at once.
+<P>---------------------------------------------------------------------------*/
+bool CTriangulator::IsEarHashed(const sNode* pEar) const
+{
+	const sNode* a = pEar->pPrev;
+	const sNode* b = pEar;
+	const sNode* c = pEar->pNext;
+
+	if (Area(a, b, c) >= 0)
+		return false;
+
+	double dMinX = std::min(a->x, std::min(b->x, c->x));
+	double dMinY = std::min(a->y, std::min(b->y, c->y));
+	double dMaxX = std::max(a->x, std::max(b->x, c->x));
+	double dMaxY = std::max(a->y, std::max(b->y, c->y));
+
+	int32_t nMinZ = ZOrder(dMinX, dMinY);
+	int32_t nMaxZ = ZOrder(dMaxX, dMaxY);
+
+	struct sBlocks
+	{
+		const sNode* a;
+		const sNode* b;
+		const sNode* c;
+		double dMinX, dMinY, dMaxX, dMaxY;
+		bool operator()(const sNode* p) const
+		{
+			return p->x >= dMinX && p->x <= dMaxX && p->y >= dMinY && p->y <= dMaxY &&
+				p != a && p != c &&
+				PointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+				Area(p->pPrev, p, p->pNext) >= 0;
+		}
+	};
+
+	sBlocks Blocks;
+	Blocks.a = a;
+	Blocks.b = b;
+	Blocks.c = c;
+	Blocks.dMinX = dMinX;
+	Blocks.dMinY = dMinY;
+	Blocks.dMaxX = dMaxX;
+	Blocks.dMaxY = dMaxY;
+
+	const sNode* p = pEar->pPrevZ;
+	const sNode* n = pEar->pNextZ;
+
+	while (p != 0 && p->nZ >= nMinZ && n != 0 && n->nZ <= nMaxZ)
+	{
+		if (Blocks(p))
+			return false;
+		p = p->pPrevZ;
+
+		if (Blocks(n))
+			return false;
+		n = n->pNextZ;
+	}
+
+	while (p != 0 && p->nZ >= nMinZ)
+	{
+		if (Blocks(p))
+			return false;
+		p = p->pPrevZ;
+	}
+
+	while (n != 0 && n->nZ <= nMaxZ)
+	{
+		if (Blocks(n))
+			return false;
+		n = n->pNextZ;
+	}
+
+	return true;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::CureLocalIntersections <BR>
+\brief Where two lines one apart cross, clips the triangle they make.
+<P>---------------------------------------------------------------------------*/
+CTriangulator::sNode* CTriangulator::CureLocalIntersections(sNode* pStart)
+{
+	sNode* p = pStart;
+
+	do
+	{
+		sNode* a = p->pPrev;
+		sNode* b = p->pNext->pNext;
+
+		if (!Equals(a, b) && Intersects(a, p, p->pNext, b) && IsLocallyInside(a, b) && IsLocallyInside(b, a))
+		{
+			m_pIndices->push_back(a->nIndex);
+			m_pIndices->push_back(p->nIndex);
+			m_pIndices->push_back(b->nIndex);
+
+			RemoveNode(p);
+			RemoveNode(p->pNext);
+
+			p = pStart = b;
+		}
+		p = p->pNext;
+	}
+	while (p != pStart);
+
+	return FilterPoints(p);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::SplitAndClip <BR>
+\brief Finds a diagonal which splits the ring and clips each half separately.
+<P>---------------------------------------------------------------------------*/
+void CTriangulator::SplitAndClip(sNode* pStart)
+{
+	sNode* a = pStart;
+
+	do
+	{
+		sNode* b = a->pNext->pNext;
+
+		while (b != a->pPrev)
+		{
+			if (a->nIndex != b->nIndex && IsValidDiagonal(a, b))
+			{
+				sNode* c = SplitRing(a, b);
+
+				a = FilterPoints(a, a->pNext);
+				c = FilterPoints(c, c->pNext);
+
+				ClipEars(a, 0);
+				ClipEars(c, 0);
+				return;
+			}
+			b = b->pNext;
+		}
+		a = a->pNext;
+	}
+	while (a != pStart);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::JoinHoles <BR>
+\brief Joins the holes to the outline from left to right, each by a bridge from its
+left most point.
+<P>---------------------------------------------------------------------------*/
+CTriangulator::sNode* CTriangulator::JoinHoles(const C2DPoint* pPoints, unsigned int nCount,
+					const unsigned int* pHoleStarts, unsigned int nHoles, sNode* pOuter)
+{
+	struct sByX
+	{
+		bool operator()(const sNode* p1, const sNode* p2) const
+			{ return p1->x < p2->x;}
+	};
+
+	std::vector<sNode*> Queue;
+	Queue.reserve(nHoles);
+
+	for (unsigned int i = 0; i < nHoles; i++)
+	{
+		unsigned int nStart = pHoleStarts[i];
+		unsigned int nEnd = i + 1 < nHoles ? pHoleStarts[i + 1] : nCount;
+
+		sNode* pList = MakeRing(pPoints, nStart, nEnd, false);
+		if (pList == 0)
+			continue;
+		if (pList == pList->pNext)
+			pList->bSteiner = true;
+
+		sNode* pLeft = pList;
+		sNode* p = pList;
+		do
+		{
+			if (p->x < pLeft->x || (p->x == pLeft->x && p->y < pLeft->y))
+				pLeft = p;
+			p = p->pNext;
+		}
+		while (p != pList);
+
+		Queue.push_back(pLeft);
+	}
+
+	std::sort(Queue.begin(), Queue.end(), sByX());
+
+	for (size_t i = 0; i < Queue.size(); i++)
+	{
+		sNode* pBridge = FindHoleBridge(Queue[i], pOuter);
+		if (pBridge == 0)
+			continue;
+
+		sNode* pBridgeReverse = SplitRing(pBridge, Queue[i]);
+
+		FilterPoints(pBridgeReverse, pBridgeReverse->pNext);
+		pOuter = FilterPoints(pBridge, pBridge->pNext);
+	}
+
+	return pOuter;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::FindHoleBridge <BR>
+\brief Finds a point of the outline the hole's point can see. A ray is cast to the
+left to the nearest line and the end of that line is taken unless a reflex point
+is inside the triangle so made, when the one at the smallest angle to the ray is.
+<P>---------------------------------------------------------------------------*/
+CTriangulator::sNode* CTriangulator::FindHoleBridge(sNode* pHole, sNode* pOuter)
+{
+	sNode* p = pOuter;
+	double hx = pHole->x;
+	double hy = pHole->y;
+	double qx = -DBL_MAX;
+	sNode* m = 0;
+
+	do
+	{
+		if (hy <= p->y && hy >= p->pNext->y && p->pNext->y != p->y)
+		{
+			double x = p->x + (hy - p->y) * (p->pNext->x - p->x) / (p->pNext->y - p->y);
+			if (x <= hx && x > qx)
+			{
+				qx = x;
+				m = p->x < p->pNext->x ? p : p->pNext;
+				if (x == hx)
+					return m;
+			}
+		}
+		p = p->pNext;
+	}
+	while (p != pOuter);
+
+	if (m == 0)
+		return 0;
+
+	const sNode* pStop = m;
+	double mx = m->x;
+	double my = m->y;
+	double dTanMin = DBL_MAX;
+
+	p = m;
+
+	do
+	{
+		if (hx >= p->x && p->x >= mx && hx != p->x &&
+			PointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y))
+		{
+			double dTan = fabs(hy - p->y) / (hx - p->x);
+
+			if (IsLocallyInside(p, pHole) &&
+				(dTan < dTanMin || (dTan == dTanMin && (p->x > m->x ||
+									(p->x == m->x && SectorContainsSector(m, p))))))
+			{
+				m = p;
+				dTanMin = dTan;
+			}
+		}
+		p = p->pNext;
+	}
+	while (p != pStop);
+
+	return m;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::SplitRing <BR>
+\brief Joins a and b by a pair of lines. The two new nodes copy a and b and if they
+were on one ring it becomes two, returning the one with the copies. If they were
+on different rings they become one.
+<P>---------------------------------------------------------------------------*/
+CTriangulator::sNode* CTriangulator::SplitRing(sNode* pA, sNode* pB)
+{
+	sNode* pA2 = InsertNode(pA->nIndex, pA->x, pA->y, 0);
+	sNode* pB2 = InsertNode(pB->nIndex, pB->x, pB->y, 0);
+	sNode* pAn = pA->pNext;
+	sNode* pBp = pB->pPrev;
+
+	pA->pNext = pB;
+	pB->pPrev = pA;
+
+	pA2->pNext = pAn;
+	pAn->pPrev = pA2;
+
+	pB2->pNext = pA2;
+	pA2->pPrev = pB2;
+
+	pBp->pNext = pB2;
+	pB2->pPrev = pBp;
+
+	return pB2;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::SplitTouches <BR>
+\brief Splits the ring where it touches itself. A point of the ring on one of its
+lines, or crossing it by no more than rounding as where a piece was cut through a
+point, is found by a sweep and first copied into that line so every touch is a
+point met more than once. The ring is then split between each visit to such a point and
+the next, which leaves each loop between them as a ring of its own. Copies made
+when joining holes have the same index and are not split, nor are two visits
+already on different rings. If any ring so made goes anticlockwise the ring
+crossed itself there rather than touching, so all the splits are undone.
+<P>---------------------------------------------------------------------------*/
+void CTriangulator::SplitTouches(sNode* pRing, std::vector<sNode*>& Rings)
+{
+	Rings.clear();
+
+	std::vector<sNode*> Lines;
+	CSegmentSweep Sweep;
+
+	sNode* p = pRing;
+	do
+	{
+		Lines.push_back(p);
+		Sweep.AddLine(C2DPoint(p->x, p->y), C2DPoint(p->pNext->x, p->pNext->y));
+		p = p->pNext;
+	}
+	while (p != pRing);
+
+	std::vector<CSegmentSweep::sCrossing> Crossings;
+	Sweep.GetCrossings(Crossings);
+
+	// A point on a line other than at its ends, by how far along.
+	struct sTouch
+	{
+		unsigned int nLine;
+		double dAlong;
+		sNode* pPoint;
+		bool operator<(const sTouch& Other) const
+			{ return nLine < Other.nLine || (nLine == Other.nLine && dAlong < Other.dAlong);}
+	};
+
+	std::vector<sTouch> Touches;
+
+	for (size_t i = 0; i < Crossings.size(); i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			unsigned int nLine = j < 2 ? Crossings[i].nLine1 : Crossings[i].nLine2;
+			sNode* a = Lines[nLine];
+			sNode* b = a->pNext;
+			sNode* pPoint = Lines[j < 2 ? Crossings[i].nLine2 : Crossings[i].nLine1];
+			if (j % 2 == 1)
+				pPoint = pPoint->pNext;
+
+			double dx = b->x - a->x;
+			double dy = b->y - a->y;
+			double dLengthSq = dx * dx + dy * dy;
+			double dAlong = (pPoint->x - a->x) * dx + (pPoint->y - a->y) * dy;
+			if (Equals(pPoint, a) || Equals(pPoint, b) || dAlong <= 0 || dAlong >= dLengthSq)
+				continue;
+
+			double dOff = fabs(CPredicates::Orient2D(C2DPoint(a->x, a->y), C2DPoint(b->x, b->y),
+									C2DPoint(pPoint->x, pPoint->y)));
+			double dTolerance = conEqualityTolerance * std::max(fabs(pPoint->x), fabs(pPoint->y));
+			if (dOff * dOff > dTolerance * dTolerance * dLengthSq)
+				continue;
+
+			sTouch Touch;
+			Touch.nLine = nLine;
+			Touch.dAlong = dAlong;
+			Touch.pPoint = pPoint;
+			Touches.push_back(Touch);
+		}
+	}
+
+	std::sort(Touches.begin(), Touches.end());
+
+	std::unordered_set<const sNode*> Copies;
+	sNode* pLast = 0;
+
+	for (size_t i = 0; i < Touches.size(); i++)
+	{
+		const sTouch& Touch = Touches[i];
+
+		if (i == 0 || Touch.nLine != Touches[i - 1].nLine)
+			pLast = Lines[Touch.nLine];
+		else if (Touch.pPoint == Touches[i - 1].pPoint)
+			continue;
+
+		pLast = InsertNode(Touch.pPoint->nIndex, Touch.pPoint->x, Touch.pPoint->y, pLast);
+		Copies.insert(pLast);
+	}
+
+	// Each point in order round the ring.
+	struct sVisit
+	{
+		sNode* pNode;
+		unsigned int nOrder;
+		bool operator<(const sVisit& Other) const
+		{
+			return pNode->x < Other.pNode->x || (pNode->x == Other.pNode->x &&
+				(pNode->y < Other.pNode->y || (pNode->y == Other.pNode->y && nOrder < Other.nOrder)));
+		}
+	};
+
+	std::vector<sVisit> Visits;
+	Visits.reserve(Lines.size() + Copies.size());
+
+	p = pRing;
+	do
+	{
+		sVisit Visit;
+		Visit.pNode = p;
+		Visit.nOrder = (unsigned int)Visits.size();
+		Visits.push_back(Visit);
+		p = p->pNext;
+	}
+	while (p != pRing);
+
+	std::sort(Visits.begin(), Visits.end());
+
+	// The splits made, by the nodes split and their order round the ring.
+	struct sSplit
+	{
+		sNode* pA;
+		sNode* pB;
+		unsigned int nA;
+		unsigned int nB;
+	};
+
+	std::vector<sSplit> Splits;
+
+	for (size_t i = 0; i < Visits.size(); )
+	{
+		size_t nEnd = i + 1;
+		while (nEnd < Visits.size() && Equals(Visits[nEnd].pNode, Visits[i].pNode))
+			nEnd++;
+
+		const sVisit* pPrev = 0;
+
+		for (size_t j = i; j < nEnd; j++)
+		{
+			const sVisit& Visit = Visits[j];
+
+			bool bCopy = false;
+			for (size_t k = i; k < j && !bCopy; k++)
+			{
+				bCopy = Visits[k].pNode->nIndex == Visit.pNode->nIndex &&
+					Copies.count(Visits[k].pNode) == 0 && Copies.count(Visit.pNode) == 0;
+			}
+			if (bCopy)
+				continue;
+
+			if (pPrev != 0)
+			{
+				// A split leaves the points from a to before b on one ring and the rest
+				// on the other.
+				bool bApart = false;
+				for (size_t k = 0; k < Splits.size() && !bApart; k++)
+				{
+					bool bIn1 = Splits[k].nA <= pPrev->nOrder && pPrev->nOrder < Splits[k].nB;
+					bool bIn2 = Splits[k].nA <= Visit.nOrder && Visit.nOrder < Splits[k].nB;
+					bApart = bIn1 != bIn2;
+				}
+
+				if (!bApart)
+				{
+					sSplit Split;
+					Split.pA = pPrev->pNode;
+					Split.pB = Visit.pNode;
+					Split.nA = pPrev->nOrder;
+					Split.nB = Visit.nOrder;
+					Splits.push_back(Split);
+					SwapPrev(Split.pA, Split.pB);
+				}
+			}
+			pPrev = &Visit;
+		}
+
+		i = nEnd;
+	}
+
+	std::unordered_set<const sNode*> Seen;
+	bool bClockwise = true;
+
+	for (size_t i = 0; i <= 2 * Splits.size(); i++)
+	{
+		sNode* pStart = i == 0 ? pRing : (i % 2 == 1 ? Splits[i / 2].pA : Splits[i / 2 - 1].pB);
+		if (!Seen.insert(pStart).second)
+			continue;
+
+		double dSum = 0;
+		p = pStart;
+		do
+		{
+			Seen.insert(p);
+			dSum += (p->pPrev->x - p->x) * (p->y + p->pPrev->y);
+			p = p->pNext;
+		}
+		while (p != pStart);
+
+		if (dSum < 0)
+			bClockwise = false;
+		else if (dSum > 0)
+			Rings.push_back(pStart);
+	}
+
+	if (!bClockwise)
+	{
+		for (size_t i = Splits.size(); i-- > 0; )
+			SwapPrev(Splits[i].pA, Splits[i].pB);
+
+		Rings.assign(1, pRing);
+	}
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::SwapPrev <BR>
+\brief Swaps the points before a and b. If they are on one ring it becomes two, one
+from a to before b and one from b to before a, and if on two they become one.
+<P>---------------------------------------------------------------------------*/
+void CTriangulator::SwapPrev(sNode* pA, sNode* pB)
+{
+	sNode* pAp = pA->pPrev;
+	sNode* pBp = pB->pPrev;
+
+	pA->pPrev = pBp;
+	pBp->pNext = pA;
+
+	pB->pPrev = pAp;
+	pAp->pNext = pB;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::IndexCurve <BR>
+\brief Sets the z order of each node and links them in that order.
+<P>---------------------------------------------------------------------------*/
+void CTriangulator::IndexCurve(sNode* pStart)
+{
+	sNode* p = pStart;
+
+	do
+	{
+		if (p->nZ == 0)
+			p->nZ = ZOrder(p->x, p->y);
+		p->pPrevZ = p->pPrev;
+		p->pNextZ = p->pNext;
+		p = p->pNext;
+	}
+	while (p != pStart);
+
+	p->pPrevZ->pNextZ = 0;
+	p->pPrevZ = 0;
+
+	SortLinked(p);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::SortLinked <BR>
+\brief Bottom up merge sort of the z links, needing no other memory.
+<P>---------------------------------------------------------------------------*/
+CTriangulator::sNode* CTriangulator::SortLinked(sNode* pList)
+{
+	int nInSize = 1;
+	int nMerges;
+
+	do
+	{
+		sNode* p = pList;
+		sNode* pTail = 0;
+		pList = 0;
+		nMerges = 0;
+
+		while (p != 0)
+		{
+			nMerges++;
+
+			sNode* q = p;
+			int nPSize = 0;
+			for (int i = 0; i < nInSize; i++)
+			{
+				nPSize++;
+				q = q->pNextZ;
+				if (q == 0)
+					break;
+			}
+
+			int nQSize = nInSize;
+
+			while (nPSize > 0 || (nQSize > 0 && q != 0))
+			{
+				sNode* e;
+				if (nPSize != 0 && (nQSize == 0 || q == 0 || p->nZ <= q->nZ))
+				{
+					e = p;
+					p = p->pNextZ;
+					nPSize--;
+				}
+				else
+				{
+					e = q;
+					q = q->pNextZ;
+					nQSize--;
+				}
+
+				if (pTail != 0)
+					pTail->pNextZ = e;
+				else
+					pList = e;
+
+				e->pPrevZ = pTail;
+				pTail = e;
+			}
+
+			p = q;
+		}
+
+		pTail->pNextZ = 0;
+		nInSize *= 2;
+	}
+	while (nMerges > 1);
+
+	return pList;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::ZOrder <BR>
+\brief The z order of the point, from coordinates scaled to 15 bits.
+<P>---------------------------------------------------------------------------*/
+int32_t CTriangulator::ZOrder(double x, double y) const
+{
+	int32_t nX = (int32_t)((x - m_dMinX) * m_dInvSize);
+	int32_t nY = (int32_t)((y - m_dMinY) * m_dInvSize);
+
+	nX = (nX | (nX << 8)) & 0x00FF00FF;
+	nX = (nX | (nX << 4)) & 0x0F0F0F0F;
+	nX = (nX | (nX << 2)) & 0x33333333;
+	nX = (nX | (nX << 1)) & 0x55555555;
+
+	nY = (nY | (nY << 8)) & 0x00FF00FF;
+	nY = (nY | (nY << 4)) & 0x0F0F0F0F;
+	nY = (nY | (nY << 2)) & 0x33333333;
+	nY = (nY | (nY << 1)) & 0x55555555;
+
+	return nX | (nY << 1);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::PointInTriangle <BR>
+\brief True if the point is in or on the triangle.
+<P>---------------------------------------------------------------------------*/
+bool CTriangulator::PointInTriangle(double ax, double ay, double bx, double by,
+								double cx, double cy, double px, double py)
+{
+	return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+		   (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+		   (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::Intersects <BR>
+\brief True if the segments cross or touch.
+<P>---------------------------------------------------------------------------*/
+bool CTriangulator::Intersects(const sNode* p1, const sNode* q1, const sNode* p2, const sNode* q2)
+{
+	double d1 = Area(p1, q1, p2);
+	double d2 = Area(p1, q1, q2);
+	double d3 = Area(p2, q2, p1);
+	double d4 = Area(p2, q2, q1);
+
+	int o1 = d1 > 0 ? 1 : (d1 < 0 ? -1 : 0);
+	int o2 = d2 > 0 ? 1 : (d2 < 0 ? -1 : 0);
+	int o3 = d3 > 0 ? 1 : (d3 < 0 ? -1 : 0);
+	int o4 = d4 > 0 ? 1 : (d4 < 0 ? -1 : 0);
+
+	if (o1 != o2 && o3 != o4)
+		return true;
+
+	if (o1 == 0 && OnSegment(p1, p2, q1))
+		return true;
+	if (o2 == 0 && OnSegment(p1, q2, q1))
+		return true;
+	if (o3 == 0 && OnSegment(p2, p1, q2))
+		return true;
+	if (o4 == 0 && OnSegment(p2, q1, q2))
+		return true;
+
+	return false;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::OnSegment <BR>
+\brief True if q, in line with p and r, is within their bounds.
+<P>---------------------------------------------------------------------------*/
+bool CTriangulator::OnSegment(const sNode* p, const sNode* q, const sNode* r)
+{
+	return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) &&
+		   q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::IntersectsRing <BR>
+\brief True if the diagonal crosses a line of the ring not ending at a or b.
+<P>---------------------------------------------------------------------------*/
+bool CTriangulator::IntersectsRing(const sNode* pA, const sNode* pB)
+{
+	const sNode* p = pA;
+
+	do
+	{
+		if (p->nIndex != pA->nIndex && p->pNext->nIndex != pA->nIndex &&
+			p->nIndex != pB->nIndex && p->pNext->nIndex != pB->nIndex &&
+			Intersects(p, p->pNext, pA, pB))
+			return true;
+		p = p->pNext;
+	}
+	while (p != pA);
+
+	return false;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::IsLocallyInside <BR>
+\brief True if the diagonal from a to b starts into the inside at a.
+<P>---------------------------------------------------------------------------*/
+bool CTriangulator::IsLocallyInside(const sNode* pA, const sNode* pB)
+{
+	if (Area(pA->pPrev, pA, pA->pNext) < 0)
+		return Area(pA, pB, pA->pNext) >= 0 && Area(pA, pA->pPrev, pB) >= 0;
+	else
+		return Area(pA, pB, pA->pPrev) < 0 || Area(pA, pA->pNext, pB) < 0;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::IsMiddleInside <BR>
+\brief True if the middle of the diagonal is inside the ring, by crossing count.
+<P>---------------------------------------------------------------------------*/
+bool CTriangulator::IsMiddleInside(const sNode* pA, const sNode* pB)
+{
+	const sNode* p = pA;
+	bool bInside = false;
+	double px = (pA->x + pB->x) / 2;
+	double py = (pA->y + pB->y) / 2;
+
+	do
+	{
+		if (((p->y > py) != (p->pNext->y > py)) && p->pNext->y != p->y &&
+			(px < (p->pNext->x - p->x) * (py - p->y) / (p->pNext->y - p->y) + p->x))
+			bInside = !bInside;
+		p = p->pNext;
+	}
+	while (p != pA);
+
+	return bInside;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::IsValidDiagonal <BR>
+\brief True if the diagonal is inside the ring and crosses none of it, so it can
+split the ring in two.
+<P>---------------------------------------------------------------------------*/
+bool CTriangulator::IsValidDiagonal(const sNode* pA, const sNode* pB)
+{
+	if (pA->pNext->nIndex == pB->nIndex || pA->pPrev->nIndex == pB->nIndex || IntersectsRing(pA, pB))
+		return false;
+
+	if (IsLocallyInside(pA, pB) && IsLocallyInside(pB, pA) && IsMiddleInside(pA, pB) &&
+		(Area(pA->pPrev, pA, pB->pPrev) != 0 || Area(pA, pB->pPrev, pB) != 0))
+		return true;
+
+	// Two copies of the same point with both corners convex.
+	return Equals(pA, pB) && Area(pA->pPrev, pA, pA->pNext) > 0 && Area(pB->pPrev, pB, pB->pNext) > 0;
+}
+
+
+/**--------------------------------------------------------------------------<BR>
+CTriangulator::SectorContainsSector <BR>
+\brief True if the sector at m contains the sector at p, both at the same point.
+<P>---------------------------------------------------------------------------*/
+bool CTriangulator::SectorContainsSector(const sNode* m, const sNode* p)
+{
+	return Area(m->pPrev, m, p->pPrev) < 0 && Area(p->pNext, m, m->pNext) < 0;
+}
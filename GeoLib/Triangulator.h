@@ -0,0 +1,177 @@
+/*---------------------------------------------------------------------------
+Copyright (C) GeoLib.
+This code is used under license from GeoLib (www.geolib.co.uk). This or
+any modified versions of this cannot be resold to any other party.
+---------------------------------------------------------------------------*/
+
+
+/**--------------------------------------------------------------------------<BR>
+\file Triangulator.h
+\brief Declaration file for the CTriangulator class.
+
+\class CTriangulator
+\brief Splits a polygon with holes into triangles given as indexes of its points.
+
+Ear clipping on a linked ring of the points. Each hole is first joined to the outline
+by a bridge to a point it can see, so there is one ring. For more than a few points
+the ring is also kept in z order so an ear is only tested against the points near
+it. That makes most shapes much quicker but not all, as ears are still looked for
+one after another round the ring, and a star with a spike at every other point
+is still n squared. If no ear is left the ring is cleaned of points in line, then
+of small self crossings, and then split in two by a diagonal.
+
+An ear can reach across where the ring touches itself, at a point met twice or a
+point on another of its lines, as for a piece pinched at a point. If the triangles
+do not add up to the area the ring is split at such points and each part clipped on
+its own. A polygon which crosses itself still gives triangles but they may overlap.
+
+The node buffer is kept between calls so triangulating again allocates nothing once
+it is large enough.
+
+After a cut only the triangles which lost a point need making again. The region they
+leave inside the new outline is bounded by their outer lines with the old run swapped
+for the new one, so it is found from those lines alone and clipped on its own.
+<P>---------------------------------------------------------------------------*/
+
+#ifndef _GEOLIB_CTRIANGULATOR_H
+#define _GEOLIB_CTRIANGULATOR_H
+
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+
+class C2DPoint;
+
+#ifdef _EXPORTING
+	#define CLASS_DECLSPEC		__declspec(dllexport)
+#else
+	#ifdef _STATIC
+		#define CLASS_DECLSPEC
+	#else
+		#define CLASS_DECLSPEC		__declspec(dllimport)
+	#endif
+#endif
+
+
+#define _TRIANGULATOR_HASH_MIN 80 // Rings with more points than this are kept in z order.
+
+
+class CLASS_DECLSPEC CTriangulator
+{
+public:
+	/// Constructor.
+	CTriangulator(void);
+	/// Destructor.
+	~CTriangulator(void);
+
+	/// Replaces the indexes with three for each triangle. The outline is the points up
+	/// to the first hole start and each hole runs to the next start. Either way round.
+	void Triangulate(const C2DPoint* pPoints, unsigned int nCount,
+					const unsigned int* pHoleStarts, unsigned int nHoles,
+					std::vector<uint32_t>& Indices);
+	/// Patches the indexes made for an outline after a run of its points was replaced by
+	/// one inside it, as for a cut. NewIndexes gives the new index of each old point or -1
+	/// if it went. Triangles of kept points are renumbered and only the rest is made
+	/// again. Returns false if the rest could not be found and all was made again.
+	bool Patch(const C2DPoint* pPoints, unsigned int nCount, const std::vector<int>& NewIndexes,
+					std::vector<uint32_t>& Indices);
+
+private:
+	/// A point on the ring.
+	struct sNode
+	{
+		uint32_t nIndex;
+		double x;
+		double y;
+		int32_t nZ;
+		bool bSteiner;
+		sNode* pPrev;
+		sNode* pNext;
+		sNode* pPrevZ;
+		sNode* pNextZ;
+	};
+
+	/// Makes a ring of the points in the range going the way asked for.
+	sNode* MakeRing(const C2DPoint* pPoints, unsigned int nStart, unsigned int nEnd, bool bClockwise);
+	/// Adds a node after the last given.
+	sNode* InsertNode(uint32_t nIndex, double x, double y, sNode* pLast);
+	/// Takes the node out of the ring and the z order.
+	static void RemoveNode(sNode* p);
+	/// Removes repeated points and points in line.
+	static sNode* FilterPoints(sNode* pStart, sNode* pEnd = 0);
+
+	/// True if the triangles add up to the area of the outline less the holes.
+	static bool IsFilled(const C2DPoint* pPoints, unsigned int nCount,
+					const unsigned int* pHoleStarts, unsigned int nHoles,
+					const std::vector<uint32_t>& Indices);
+	/// Splits the ring where it touches itself into the rings given, clockwise ones only.
+	void SplitTouches(sNode* pRing, std::vector<sNode*>& Rings);
+	/// Swaps the points before the two, splitting a ring in two or joining two.
+	static void SwapPrev(sNode* pA, sNode* pB);
+
+	/// Clips ears until the ring is gone, trying harder each pass if it gets stuck.
+	void ClipEars(sNode* pEar, int nPass);
+	/// True if the ear has no other point in it.
+	static bool IsEar(const sNode* pEar);
+	/// True if the ear has no other point in it, looking only at nearby z.
+	bool IsEarHashed(const sNode* pEar) const;
+	/// Clips ears made by small self crossings.
+	sNode* CureLocalIntersections(sNode* pStart);
+	/// Splits the ring by a diagonal and clips each half.
+	void SplitAndClip(sNode* pStart);
+
+	/// Joins all the holes to the outline.
+	sNode* JoinHoles(const C2DPoint* pPoints, unsigned int nCount,
+					const unsigned int* pHoleStarts, unsigned int nHoles, sNode* pOuter);
+	/// Finds a point of the outline the hole's left most point can see.
+	static sNode* FindHoleBridge(sNode* pHole, sNode* pOuter);
+	/// Joins the two points by a pair of lines making two rings, or one ring of two.
+	sNode* SplitRing(sNode* pA, sNode* pB);
+
+	/// Sets the z order of the ring and links it in that order.
+	void IndexCurve(sNode* pStart);
+	/// Sorts the z order links.
+	static sNode* SortLinked(sNode* pList);
+	/// The z order of the point.
+	int32_t ZOrder(double x, double y) const;
+
+	/// Twice the area of the triangle, negative if anticlockwise.
+	static double Area(const sNode* p, const sNode* q, const sNode* r)
+		{ return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);}
+	/// True if the points are the same.
+	static bool Equals(const sNode* p1, const sNode* p2)
+		{ return p1->x == p2->x && p1->y == p2->y;}
+	/// True if the point is in or on the triangle.
+	static bool PointInTriangle(double ax, double ay, double bx, double by,
+								double cx, double cy, double px, double py);
+	/// True if the segments cross or touch.
+	static bool Intersects(const sNode* p1, const sNode* q1, const sNode* p2, const sNode* q2);
+	/// True if the point q on line pr is within its bounds.
+	static bool OnSegment(const sNode* p, const sNode* q, const sNode* r);
+	/// True if the diagonal crosses a line of the ring.
+	static bool IntersectsRing(const sNode* pA, const sNode* pB);
+	/// True if the diagonal from a to b starts into the inside at a.
+	static bool IsLocallyInside(const sNode* pA, const sNode* pB);
+	/// True if the middle of the diagonal is inside the ring.
+	static bool IsMiddleInside(const sNode* pA, const sNode* pB);
+	/// True if the diagonal can split the ring.
+	static bool IsValidDiagonal(const sNode* pA, const sNode* pB);
+	/// True if the sector at m contains the sector at p.
+	static bool SectorContainsSector(const sNode* m, const sNode* p);
+
+	/// The nodes, kept between calls. A deque so nodes never move as more are added.
+	std::deque<sNode> m_Nodes;
+	/// The nodes in use.
+	size_t m_nNodes;
+	/// The triangles being made.
+	std::vector<uint32_t>* m_pIndices;
+	/// The corner and scale of the z order, no z order if the scale is 0.
+	double m_dMinX;
+	double m_dMinY;
+	double m_dInvSize;
+};
+
+
+#endif
@@ -41,7 +41,7 @@ var isMouseClicked = false;
 var isDraw = false;
 var isLineDrawn = false;
 var lineComp = null;
-var lineTimer = null;
+var lineBlocked = false;  //切割线碰到球后，重新开局前不许画线
 
 var db = null;
 var lockgrades = [true,true,true,true,true,true];
@@ -105,46 +105,28 @@ function gradeLevelIncrease()
     updateGradeLevel();
 }
 
-function addLineTimer(gameZone,progressBar)
+//每个物理步之后调用，球在这一步中扫过切割线即失败
+function checkLineOnStep(gameZone,progressBar)
 {
-    if(lineTimer == null)
+    if(lineComp == null || polyCom == null || lineBlocked)
+        return;
+
+    var vRet = polyCom.isBallCrossLine(lineComp.p1.x,lineComp.p1.y,lineComp.p2.x,lineComp.p2.y);
+    if(vRet == 1)
     {
-       lineTimer = Qt.createQmlObject("import QtQuick 2.0; Timer {}", gameZone);
-       lineTimer.interval = 50;
-       lineTimer.repeat = true;
-       lineTimer.triggeredOnStart = true;
-       lineTimer.triggered.connect(function () {
-           var ballsPos = [];
-           var ballsRadius = [];
-           for(var i = 0;i < balls.length;i++)
-           {
-               ballsPos.push(Qt.point(balls[i].x,balls[i].y));
-               ballsRadius.push(balls[i].radius);
-           }
-
-           if(lineComp == null)
-               return;
-
-           var vRet = polyCom.isBallCrossLine(lineComp.p1.x,lineComp.p1.y,lineComp.p2.x,lineComp.p2.y,ballsPos,ballsRadius);
-           if(vRet == 1)
-           {
-               gameZone._playSound(4);
-               lineTimer.interval = 999999;    //设置为999999代表现在不要画线，为了省一个控制变量
-               lineTimer.stop();
-               ballsSlowDown();
-               isDraw = false;
-               isLineDrawn = false;
-               isMouseClicked = false;
-               if(lineComp != null)
-               {
-                   lineComp.destroy(0);
-                   lineComp = null;
-               }
-               delay(gameZone,progressBar);
-           }
-       })
+        gameZone._playSound(4);
+        lineBlocked = true;
+        ballsSlowDown();
+        isDraw = false;
+        isLineDrawn = false;
+        isMouseClicked = false;
+        if(lineComp != null)
+        {
+            lineComp.destroy(0);
+            lineComp = null;
+        }
+        delay(gameZone,progressBar);
     }
-    lineTimer.start();
 }
 
 function initGameZone(gameZone,url)
@@ -233,12 +215,21 @@ function updateWall(gameZone,polygon)
     addWall(gameZone,polygon,1);
 }
 
+//按下或重新开始画线时调用，之后只检测手指新移动的一段
+function beginDrag(x,y)
+{
+    x1 = x;
+    y1 = y;
+    if(polyCom != null)
+        polyCom.beginDrag(x,y);
+}
+
 function isDrawLine(backGround,winDialog,gameZone,progressBar,x2,y2)
 {
     if(polyCom == null)
         return;
 
-    if(lineTimer != null && lineTimer.interval == 999999)
+    if(lineBlocked)
         return;
 
     if(!isMouseClicked)
@@ -247,7 +238,7 @@ function isDrawLine(backGround,winDialog,gameZone,progressBar,x2,y2)
     if(!isDraw)
     {
         //isDraw = polyCom.isShouldDrawLine(startX,startY,x2,y2);
-        var temp = polyCom.isCrossPolygon(x1,y1,x2,y2);
+        var temp = polyCom.dragTo(x2,y2);
         if(temp == 1)
         {
             isDraw = true;
@@ -258,6 +249,11 @@ function isDrawLine(backGround,winDialog,gameZone,progressBar,x2,y2)
             gameZone._playSound(3);
             gameZone._playSparkAnim(x2,y2);
         }
+        else if(temp >= 2)
+        {
+            //一次移动穿过了整个区域，从当前位置重新开始
+            beginDrag(x2,y2);
+        }
         if(!isDraw)
             return;
     }
@@ -280,26 +276,23 @@ function isDrawLine(backGround,winDialog,gameZone,progressBar,x2,y2)
                 return;
             }
             isLineDrawn = true;
-            addLineTimer(gameZone,progressBar);
         }
         else
         {
             lineComp.p2 = Qt.point(x2,y2);
-            var temp = polyCom.isCrossPolygon(x1,y1,x2,y2);
-            if(temp == 2)
+            var temp = polyCom.dragTo(x2,y2);
+            if(temp == 9999)
             {
-                x1 = x2;
-                y1 = y2;
+                beginDrag(x2,y2);
                 resetLine();
-                dealSlashPoly(backGround,winDialog,progressBar,gameZone,x2,y2);
+                gameZone._playSound(3);
+                gameZone._playSparkAnim(x2,y2);
             }
-            else if(temp == 9999)
+            else if(temp >= 2)
             {
-                x1 = x2;
-                y1 = y2;
+                beginDrag(x2,y2);
                 resetLine();
-                gameZone._playSound(3);
-                gameZone._playSparkAnim(x2,y2);
+                dealSlashPoly(backGround,winDialog,progressBar,gameZone,x2,y2);
             }
         }
     }
@@ -322,7 +315,7 @@ function delay(gameZone,progressBar)
     timer.triggeredOnStart = false;
     timer.triggered.connect(function () {
         console.log("I'm triggered once every second");
-        lineTimer.interval = 50;
+        lineBlocked = false;
 
         deInitGameZone(gameZone,progressBar);
         var temp = levelPath + grade + level + ".qml";
@@ -336,16 +329,26 @@ function delay(gameZone,progressBar)
 function dealSlashPoly(backGround,winDialog,progressBar,gameZone,x2,y2)
 {
     //处理画线切割多边形
-    //遍历当前球获取位置
-    var ballsPos = [];
-    var ballsRadius = [];
-    for(var i = 0;i < balls.length;i++)
-    {
-        ballsPos.push(Qt.point(balls[i].x,balls[i].y));
-        ballsRadius.push(balls[i].radius);
-    }
+    //在线程池中计算切割，完成后再处理结果，不阻塞界面
+    var com = polyCom;
+    var sx = startX;
+    var sy = startY;
+    var slashId = -1;
+    var onComputed = function(id,result) {
+        if(id != slashId)
+            return;
+        com.slashComputed.disconnect(onComputed);
+        if(com != polyCom)
+            return;
+        dealSlashResult(backGround,winDialog,progressBar,gameZone,sx,sy,x2,y2,result);
+    };
+    com.slashComputed.connect(onComputed);
+    slashId = com.calcSlashPolyAsync(refWidth * scaleW,refHeight * scaleH,sx,sy,x2,y2);
+}
 
-    var ret = polyCom.calcSlashPoly(refWidth * scaleW,refHeight * scaleH,startX,startY,x2,y2,ballsPos,ballsRadius);
+function dealSlashResult(backGround,winDialog,progressBar,gameZone,startX,startY,x2,y2,result)
+{
+    var ret = result.code;
     if(ret == 2)
     {
         gameZone._playSound(2);
@@ -366,10 +369,8 @@ function dealSlashPoly(backGround,winDialog,progressBar,gameZone,x2,y2)
     else if(ret == 0)
     {
         gameZone._playSound(1);
-        var pts = [];
-        pts = polyCom.getResultPoly(0);
-        updateWall(gameZone,pts);
-        var progress = polyCom.getProgress();
+        updateWall(gameZone,result.remain);
+        var progress = result.progress;
         progressBar.value = progress;
         if(progress > 0.8)
         {
@@ -409,7 +410,7 @@ function isCutPolygon()
     if(polyCom == null)
         return;
 
-    if(lineTimer != null && lineTimer.interval == 999999)
+    if(lineBlocked)
         return;
 
     resetLine();
@@ -459,26 +460,18 @@ function addPolygon(gameZone)
     if(gameLevel == null)
         return false;
 
-    var str = 'import LL.BPolygon 1.0;BPolygon{id: polygon;points:[';
-    for (var idx = 0,i = 0; idx < gameLevel.wallData.length; idx+=2,i++) {
-        str += 'Qt.point(';
-        str += gameLevel.wallData[idx]*scaleW;
-        str += ',';
-        str += gameLevel.wallData[idx+1]*scaleH;
-        str += '),';
-        str += 'Qt.point(';
-        str += gameLevel.wallRigid[i];
-        str += ',0),';
+    var xy = [];
+    for (var idx = 0; idx < gameLevel.wallData.length; idx+=2) {
+        xy.push(gameLevel.wallData[idx]*scaleW,gameLevel.wallData[idx+1]*scaleH);
     }
 
-    str += ']}';
-
-    polyCom = Qt.createQmlObject(str,gameZone,"dynamicSnippet1");
+    polyCom = Qt.createQmlObject('import LL.BPolygon 1.0;BPolygon{id: polygon;}',gameZone,"dynamicSnippet1");
     if(polyCom == null)
     {
         console.log("createQmlObject error");
         return false;
     }
+    polyCom.setOutlineData(xy,gameLevel.wallRigid);
 
     return true;
 }
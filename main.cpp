@@ -6,6 +6,7 @@
 
 #include "qquickpolygon.h"
 #include "qquickline.h"
+#include "qballset.h"
 
 int main(int argc, char *argv[])
 {
@@ -23,8 +24,10 @@ int main(int argc, char *argv[])
     translator.load(trPath);
     app.installTranslator(&translator);
 
+    qRegisterMetaType<QSlashResult>();
     qmlRegisterType<QQuickPolygon>("LL.BPolygon",1,0,"BPolygon");
     qmlRegisterType<QQuickLine>("LL.BLine", 1, 0, "BLine");
+    qmlRegisterSingletonType<QBallSet>("LL.BBallSet", 1, 0, "BallSet", QBallSet::provider);
 
     QQmlApplicationEngine engine;
     engine.load(QUrl(QStringLiteral("qrc:/main.qml")));
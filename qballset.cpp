@@ -0,0 +1,114 @@
+#include "qballset.h"
+
+#include <QQmlEngine>
+
+QBallSet::QBallSet (QObject * parent)
+    : QObject (parent)
+{
+}
+
+QBallSet * QBallSet::instance (void) {
+    static QBallSet * ballSet = new QBallSet;
+    return ballSet;
+}
+
+QObject * QBallSet::provider (QQmlEngine * engine, QJSEngine * scriptEngine) {
+    Q_UNUSED (engine)
+    Q_UNUSED (scriptEngine)
+    QBallSet * ballSet = instance ();
+    QQmlEngine::setObjectOwnership (ballSet, QQmlEngine::CppOwnership); // shared with QQuickPolygon
+    return ballSet;
+}
+
+int QBallSet::getCount (void) const {
+    return m_balls.size ();
+}
+
+const QVector<qreal> & QBallSet::getState (void) const {
+    return m_state;
+}
+
+const QVector<qreal> & QBallSet::getMotion (void) const {
+    return m_motion;
+}
+
+void QBallSet::endStep (void) {
+    for (int idx = 0; idx < m_balls.size (); idx++) {
+        for (int i = 0; i < 2; i++) {
+            m_motion [idx * 2 + i]    = m_state [idx * 3 + i] - m_stepStart [idx * 2 + i];
+            m_stepStart [idx * 2 + i] = m_state [idx * 3 + i];
+        }
+    }
+}
+
+void QBallSet::addBall (QQuickItem * ball) {
+    if (ball == Q_NULLPTR || m_balls.contains (ball)) {
+        return;
+    }
+    m_balls.append (ball);
+    const int idx = m_balls.size () -1;
+    m_state.resize (m_balls.size () * 3);
+    m_motion.resize (m_balls.size () * 2);
+    m_stepStart.resize (m_balls.size () * 2);
+    updateBall (idx);
+    m_motion [idx * 2]       = m_motion [idx * 2 +1] = 0.0;
+    m_stepStart [idx * 2]    = m_state [idx * 3];
+    m_stepStart [idx * 2 +1] = m_state [idx * 3 +1];
+    // Box2D moves the item every step, so this keeps the state current
+    connect (ball, &QQuickItem::xChanged,      this, &QBallSet::onBallMoved);
+    connect (ball, &QQuickItem::yChanged,      this, &QBallSet::onBallMoved);
+    connect (ball, &QQuickItem::widthChanged,  this, &QBallSet::onBallMoved);
+    connect (ball, &QQuickItem::heightChanged, this, &QBallSet::onBallMoved);
+    connect (ball, &QObject::destroyed,        this, &QBallSet::onBallDestroyed);
+    emit countChanged ();
+}
+
+void QBallSet::removeBall (QQuickItem * ball) {
+    const int idx = m_balls.indexOf (ball);
+    if (idx >= 0) {
+        disconnect (ball, Q_NULLPTR, this, Q_NULLPTR);
+        removeAt (idx);
+    }
+}
+
+void QBallSet::onBallMoved (void) {
+    const int idx = m_balls.indexOf (sender ());
+    if (idx >= 0) {
+        updateBall (idx);
+    }
+}
+
+void QBallSet::onBallDestroyed (QObject * ball) {
+    const int idx = m_balls.indexOf (ball);
+    if (idx >= 0) {
+        removeAt (idx);
+    }
+}
+
+void QBallSet::updateBall (int idx) {
+    const QQuickItem * ball = static_cast<QQuickItem *> (m_balls [idx]);
+    qreal * state = m_state.data () + idx * 3;
+    state [0] = ball->x () + ball->width ()  * 0.5;
+    state [1] = ball->y () + ball->height () * 0.5;
+    state [2] = ball->width () * 0.5;
+}
+
+void QBallSet::removeAt (int idx) {
+    // move the last ball into the gap so the state stays packed
+    const int last = m_balls.size () -1;
+    if (idx != last) {
+        m_balls [idx] = m_balls [last];
+        for (int i = 0; i < 3; i++) {
+            m_state [idx * 3 + i] = m_state [last * 3 + i];
+        }
+        for (int i = 0; i < 2; i++) {
+            m_motion [idx * 2 + i]    = m_motion [last * 2 + i];
+            m_stepStart [idx * 2 + i] = m_stepStart [last * 2 + i];
+        }
+    }
+    m_balls.removeLast ();
+    m_state.resize (last * 3);
+    m_motion.resize (last * 2);
+    m_stepStart.resize (last * 2);
+    emit countChanged ();
+}
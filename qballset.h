@@ -0,0 +1,51 @@
+#ifndef QBALLSET_H
+#define QBALLSET_H
+
+#include <QObject>
+#include <QVector>
+#include <QQuickItem>
+
+class QQmlEngine;
+class QJSEngine;
+
+// Registry of the balls in play. Every Ball.qml adds itself when created, and the
+// centre and radius of each ball are kept in one packed array that follows the
+// item as the physics step moves it, so C++ reads the latest state directly.
+class QBallSet : public QObject {
+    Q_OBJECT
+    Q_PROPERTY (int count READ getCount NOTIFY countChanged)
+
+public:
+    explicit QBallSet (QObject * parent = NULL);
+
+    static QBallSet * instance (void);
+    static QObject * provider (QQmlEngine * engine, QJSEngine * scriptEngine);
+
+    Q_INVOKABLE int  getCount   (void) const;
+    Q_INVOKABLE void addBall    (QQuickItem * ball);
+    Q_INVOKABLE void removeBall (QQuickItem * ball);
+    Q_INVOKABLE void endStep    (void); // call once the physics world has stepped
+
+    // x, y of the centre and radius for each ball in turn
+    const QVector<qreal> & getState (void) const;
+    // x, y the centre of each ball moved in the last step
+    const QVector<qreal> & getMotion (void) const;
+
+signals:
+    void countChanged (void);
+
+private slots:
+    void onBallMoved     (void);
+    void onBallDestroyed (QObject * ball);
+
+private:
+    void updateBall (int idx);
+    void removeAt   (int idx);
+
+    QVector<QObject *> m_balls;
+    QVector<qreal>     m_state;
+    QVector<qreal>     m_motion;
+    QVector<qreal>     m_stepStart; // centres when the current step began
+};
+
+#endif // QBALLSET_H
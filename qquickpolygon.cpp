@@ -1,5 +1,6 @@
 
 #include "qquickpolygon.h"
+#include "qballset.h"
 
 #include "C2DPoint.h"
 #include "C2DPointSet.h"
@@ -7,36 +8,38 @@
 #include "C2DHoledPolygonSet.h"
 #include "Grid.h"
 #include "C2DPolyBase.h"
+#include "C2DCircle.h"
+#include "PointWelder.h"
 
 #include <QGuiApplication>
+#include <QtConcurrent>
 #include <QDebug>
 #include <QWindow>
+#include <QTimer>
 #include <qmath.h>
 
+#include <algorithm>
+
 
 QQuickPolygon::QQuickPolygon (QQuickItem * parent)
     : QQuickItem (parent)
     , m_closed (true)
     , m_border (8.0)
-    , m_minX   (0.0)
-    , m_maxX   (0.0)
-    , m_minY   (0.0)
-    , m_maxY   (0.0)
     , m_color  (QColor(13,91,43))
     , m_stroke (QColor(255,218,143))
+    , m_dirty        (DirtyAll)
     , m_node         (Q_NULLPTR)
     , m_foreNode     (Q_NULLPTR)
     , m_backNode     (Q_NULLPTR)
-    , m_foreGeometry (Q_NULLPTR)
-    , m_backGeometry (Q_NULLPTR)
-    , m_foreMaterial (Q_NULLPTR)
-    , m_backMaterial (Q_NULLPTR)
     , m_poly(NULL)
     , m_remainIdx(-1)
     , m_flyIdx(-1)
     , m_totalArea(0.0)
     , m_progress(0.0)
     , m_flyArea(0.0)
+    , m_polySerial(0)
+    , m_slashId(0)
+    , m_dragCrossings(0)
 {
     setFlag (QQuickItem::ItemHasContents);
 }
@@ -57,6 +60,10 @@ QColor QQuickPolygon::getStroke (void) const {
     return m_stroke;
 }
 
+QPolygonF QQuickPolygon::getOutline (void) const {
+    return m_points;
+}
+
 QVariantList QQuickPolygon::getPoints (void) const {
     QVariantList ret;
     foreach (QPointF point, m_points) {
@@ -78,17 +85,6 @@ bool QQuickPolygon::isCutPolygon(qreal x1, qreal y1, qreal x2, qreal y2)
         return false;
 }
 
-void QQuickPolygon::createPolygon(const QVector<QPointF> &pts,C2DPolygon &poly)
-{
-    C2DPointSet polySet;
-    for(int i = 0;i < pts.size();++i)
-    {
-        C2DPoint pt(pts[i].x(),pts[i].y());
-        polySet.AddCopy(pt);
-    }
-    poly.Create(polySet,true);
-}
-
 bool QQuickPolygon::isCutPolygon(const C2DPolygon &poly, qreal x1, qreal y1, qreal x2, qreal y2)
 {
     C2DPointSet interSet;
@@ -105,102 +101,342 @@ bool QQuickPolygon::isCutPolygon(const C2DPolygon &poly, qreal x1, qreal y1, qre
 
 //返回1-失败，重新开局
 //2-画在了两球之间，画线闪烁
-int QQuickPolygon::calcSlashPoly(qreal w,qreal h,qreal x1, qreal y1, qreal x2, qreal y2,const QVariantList &ballsPos,const QVariantList &ballsRadius)
+//-1-多边形已经deInit，没有可切的
+//球的位置直接从QBallSet读取
+int QQuickPolygon::calcSlashPoly(qreal w,qreal h,qreal x1, qreal y1, qreal x2, qreal y2)
 {
-    m_lastPolySet.DeleteAll();
-    m_remainIdx = -1;
-    m_flyIdx = -1;
-
-    //1.计算画的线和大矩形框交割成的两个多边形
-    m_maxX = w;
-    m_maxY = h;
-    QVector<QPointF> polyPt1;
-    QVector<QPointF> polyPt2;
-    calParts(x1,y1,x2,y2,polyPt1,polyPt2);
-    //2.计算两个多边形和图中矩形重叠的多边形
-    C2DPolygon poly1;
-    C2DPolygon poly2;
-    createPolygon(polyPt1,poly1);
-    createPolygon(polyPt2,poly2);
-
-    C2DHoledPolygonSet overPolySet1;
-    C2DHoledPolygonSet overPolySet2;
-    poly1.GetOverlaps(*m_poly,overPolySet1,CGrid::RandomPerturbation);
-    poly2.GetOverlaps(*m_poly,overPolySet2,CGrid::RandomPerturbation);
-
-    //3.切割区域判断合并
+    Q_UNUSED(w)
+    Q_UNUSED(h)
+
+    if(m_poly == NULL)
+        return -1;
+    SlashResultPtr result = evalSlashPoly(*m_poly,x1,y1,x2,y2,QBallSet::instance()->getState());
+    return applySlashResult(*result);
+}
+
+//同calcSlashPoly，但在线程池中计算，结果通过slashComputed(id,result)返回
+//多边形在计算期间被替换或已经deInit时结果作废，result.code为-1
+int QQuickPolygon::calcSlashPolyAsync(qreal w,qreal h,qreal x1, qreal y1, qreal x2, qreal y2)
+{
+    Q_UNUSED(w)
+    Q_UNUSED(h)
+
+    const int id = ++m_slashId;
+    const quint64 serial = m_polySerial;
+
+    //调用方拿到id之后才能认出结果，所以也要等回到事件循环再发
+    if(m_poly == NULL)
+    {
+        QTimer::singleShot(0,this,[this,id]() {
+            emit slashComputed(id,getSlashResult(-1));
+        });
+        return id;
+    }
+
+    // the worker only sees its own copies, so the item stays free to draw and hit test
+    QSharedPointer<const C2DPolygon> snapshot(new C2DPolygon(*m_poly));
+    const QVector<qreal> balls = QBallSet::instance()->getState();
+
+    QFutureWatcher<SlashResultPtr> * watcher = new QFutureWatcher<SlashResultPtr>(this);
+    connect(watcher,&QFutureWatcherBase::finished,this,[this,watcher,id,serial]() {
+        SlashResultPtr result = watcher->result();
+        watcher->deleteLater();
+        if(serial != m_polySerial)
+        {
+            emit slashComputed(id,getSlashResult(-1));
+            return;
+        }
+        emit slashComputed(id,getSlashResult(applySlashResult(*result)));
+    });
+    watcher->setFuture(QtConcurrent::run([=]() {
+        return evalSlashPoly(*snapshot,x1,y1,x2,y2,balls);
+    }));
+    return id;
+}
+
+//code为calcSlashPoly的返回值，切割成功时带上剩余和切掉的多边形
+QSlashResult QQuickPolygon::getSlashResult(int code) const
+{
+    QSlashResult result;
+    result.code = code;
+    result.progress = m_progress;
+    if(code == 0)
+    {
+        result.remain = getResultPolyData(0);
+        result.flyAway = getResultPolyData(1);
+    }
+    return result;
+}
+
+//只读poly，可在任意线程调用
+QQuickPolygon::SlashResultPtr QQuickPolygon::evalSlashPoly(const C2DPolygon &poly, qreal x1, qreal y1, qreal x2, qreal y2, const QVector<qreal> &balls)
+{
+    SlashResultPtr result(new SlashResult);
+    result->ret = 2;
+    result->flyIdx = result->remainIdx = -1;
+    result->flyArea = 0.0;
+    result->splice = false;
+
+    //1.用画的线直接把游戏区域的多边形切成左右两侧的多边形
+    //同时记下每块是原多边形哪段边换成切口得来的，按块的指针找
+    C2DPolygonSet leftPolySet;
+    C2DPolygonSet rightPolySet;
+    std::vector<C2DPolygon::sSplitSplice> leftSplices;
+    std::vector<C2DPolygon::sSplitSplice> rightSplices;
+    poly.SplitByLine(C2DLine(C2DPoint(x1,y1),C2DPoint(x2,y2)),leftPolySet,rightPolySet,&leftSplices,&rightSplices);
+    if(leftPolySet.size() == 0 || rightPolySet.size() == 0)
+        return result;
+    QHash<const C2DPolygon *,C2DPolygon::sSplitSplice> splices;
+    for(size_t i = 0;i < leftPolySet.size();++i)
+        splices.insert(&leftPolySet[i],leftSplices[i]);
+    for(size_t i = 0;i < rightPolySet.size();++i)
+        splices.insert(&rightPolySet[i],rightSplices[i]);
+
+    //2.切割区域判断合并
     C2DPolygonSet onePolySet;
     C2DPolygonSet multiPolySet;
-    dealOverlaps(overPolySet1,onePolySet,multiPolySet);
-    dealOverlaps(overPolySet2,onePolySet,multiPolySet);
-
-    getLastPolys(onePolySet,multiPolySet,x1,y1,x2,y2);
+    dealOverlaps(leftPolySet,onePolySet,multiPolySet);
+    dealOverlaps(rightPolySet,onePolySet,multiPolySet);
+    if(onePolySet.size() == 0)
+        return result;
+
+    getLastPolys(onePolySet,multiPolySet,x1,y1,x2,y2,result->lastPolySet);
+    //只读，通过const访问，共享的多边形不会因此被复制
+    const C2DPolygonSet &lastPolySet = result->lastPolySet;
 #if 1
-    //4.判断切割线和球距离
+    //3.判断切割线和球距离
     C2DLine slashLine(C2DPoint(x1,y1),C2DPoint(x2,y2));
-    for (int idx = 0; idx < ballsPos.size(); idx++)
+    for (int idx = 0; idx + 2 < balls.size(); idx += 3)
     {
-        QPointF pt = ballsPos.at (idx).value<QPointF> ();
-        double dst = slashLine.Distance(C2DPoint(pt.x(),pt.y()));
-        double radius = ballsRadius.at(idx).value<double>();
+        double dst = slashLine.Distance(C2DPoint(balls[idx],balls[idx+1]));
+        double radius = balls[idx+2];
         if(dst < radius)
         {
             qDebug() << "line cross ball failed";
             //TODO 失败，重新开始
-            return 1;
+            result->ret = 1;
+            return result;
         }
     }
 #endif
-    m_flyIdx = m_remainIdx = -1;
-    for(size_t i = 0;i < m_lastPolySet.size();++i)
+    for(size_t i = 0;i < lastPolySet.size();++i)
     {
         int kk = 0;
-        for (int idx = 0; idx < ballsPos.size(); idx++)
+        for (int idx = 0; idx + 2 < balls.size(); idx += 3)
         {
-            QPointF pt = ballsPos.at (idx).value<QPointF> ();
-            if(m_lastPolySet[i].Contains(C2DPoint(pt.x(),pt.y())))
+            if(lastPolySet[i].Contains(C2DPoint(balls[idx],balls[idx+1])))
                 kk++;
         }
         if(kk == 0)
         {
             qDebug() << "I will fly away";
-            m_flyIdx = i;
+            result->flyIdx = i;
             break;
         }
     }
-    if(m_flyIdx != -1)
+    if(result->flyIdx != -1)
     {
-        m_remainIdx = 0;
-        if(m_flyIdx == 0)
-            m_remainIdx = 1;
-        //更新剩余面积信息
-        shownPolyUpdate(m_flyIdx,m_remainIdx);
-        return 0;
+        result->remainIdx = 0;
+        if(result->flyIdx == 0)
+            result->remainIdx = 1;
+        //剩余的多边形自交或在一点处和自己相接时，剖分出来的三角形会重叠，这一刀不算
+        if(lastPolySet[result->remainIdx].HasCrossingLines())
+        {
+            qDebug() << "remain is not simple";
+            result->flyIdx = result->remainIdx = -1;
+            return result;
+        }
+        result->flyArea = lastPolySet[result->flyIdx].GetArea();
+        //剩余的多边形一般只在切口处和原来不同，记下要换的那段边，到GUI线程中拼到原多边形上
+        //切割时记下了就直接用，合并过的才去和原多边形比对
+        const C2DPolygon &remain = lastPolySet[result->remainIdx];
+        QHash<const C2DPolygon *,C2DPolygon::sSplitSplice>::const_iterator it = splices.constFind(&remain);
+        if(it != splices.constEnd() && it->bValid)
+        {
+            result->splice = true;
+            result->spliceFirst = it->nFirst;
+            result->spliceEnd = it->nEnd;
+            result->spliceChain.assign(it->Chain,it->Chain + it->nChain);
+            result->spliceAttributes.assign(it->Attributes,it->Attributes + it->nChain + 1);
+        }
+        else
+        {
+            unsigned int remainFirst,remainEnd;
+            result->splice = poly.FindSplice(remain,result->spliceFirst,result->spliceEnd,remainFirst,remainEnd);
+            if(result->splice)
+            {
+                const C2DLineBaseSet &lines = remain.GetLines();
+                const unsigned int count = lines.size();
+                const unsigned int n = (remainEnd + count - remainFirst - 1) % count + 1;
+                for(unsigned int i = 0;i < n;++i)
+                {
+                    const C2DLineBase &line = lines[(remainFirst + i) % count];
+                    result->spliceAttributes.push_back(line.GetAttributes());
+                    if(i + 1 < n)
+                        result->spliceChain.push_back(line.GetPointTo());
+                }
+            }
+        }
+        if(!result->splice)
+        {
+            //更新剩余面积信息，连同三角剖分一起算好
+            //整个复制，边的属性（刚边）也一起带过来
+            result->poly.reset(new C2DPolygon(remain));
+            C2DPointSet pts;
+            result->poly->GetPointsCopy(pts);
+            result->points.reserve(pts.size());
+            for(size_t i = 0;i < pts.size();++i)
+            {
+                result->points.append(QPointF(pts[i].x,pts[i].y));
+            }
+            result->poly->Triangulate(result->triangles);
+        }
+        result->ret = 0;
     }
+    return result;
+}
 
-    return 2;
+//在GUI线程中一次性发布计算结果
+int QQuickPolygon::applySlashResult(SlashResult &result)
+{
+    m_lastPolySet.DeleteAll();
+    m_lastPolySet << result.lastPolySet;
+    m_flyIdx = result.flyIdx;
+    m_remainIdx = result.remainIdx;
+    if(result.ret == 0)
+    {
+        if(result.splice)
+        {
+            spliceRemain(result);
+        }
+        else
+        {
+            if(m_poly)
+                delete m_poly;
+            m_poly = result.poly.take();
+            m_points.swap(result.points);
+            m_triangles.swap(result.triangles);
+            //三角剖分用的点也换掉，下一刀才能在上面局部修补
+            m_triPoints.resize(m_points.size());
+            for(int i = 0;i < m_points.size();++i)
+                m_triPoints[i].Set(m_points[i].x(),m_points[i].y());
+        }
+        m_polySerial++;
+        m_flyArea += result.flyArea;
+        m_progress = m_flyArea / m_totalArea;
+        emit pointsChanged ();
+        markDirty (DirtyPoints);
+    }
+    return result.ret;
+}
+
+//把剩余多边形里不同的那段边拼到m_poly上，线段外框、面积、顶点和三角剖分都只改动切口附近
+void QQuickPolygon::spliceRemain(const SlashResult &result)
+{
+    const C2DPolygonSet &lastPolySet = m_lastPolySet;
+    const C2DPolygon &remain = lastPolySet[m_remainIdx];
+    const int oldCount = m_points.size();
+    const bool synced = (int(m_triPoints.size()) == oldCount);
+    std::vector<int> newIndexes;
+    if(oldCount != int(m_poly->GetPointsCount()) ||
+       !m_poly->SpliceLines(result.spliceFirst,result.spliceEnd,
+                            result.spliceChain.empty() ? 0 : &result.spliceChain[0],result.spliceChain.size(),
+                            &result.spliceAttributes[0],&newIndexes))
+    {
+        resetRemain(remain);
+        return;
+    }
+
+    //去掉spliceFirst之后的点，越过末尾的部分在开头，再在原位置插入新的点
+    const int first = int(result.spliceFirst);
+    const int removed = (int(result.spliceEnd) + oldCount - first - 1) % oldCount;
+    const int tail = qMin(removed,oldCount - first - 1);
+    const int head = removed - tail;
+    const int at = first - head + 1;
+    const int added = int(m_poly->GetPointsCount()) - (oldCount - removed);
+    m_points.erase(m_points.begin() + first + 1,m_points.begin() + first + 1 + tail);
+    m_points.erase(m_points.begin(),m_points.begin() + head);
+    for(int i = 0;i < added;++i)
+    {
+        const C2DPoint *pt = m_poly->GetPoint(at + i);
+        m_points.insert(at + i,QPointF(pt->x,pt->y));
+    }
+    if(!synced)
+    {
+        processTriangulation();
+        return;
+    }
+    m_triPoints.erase(m_triPoints.begin() + first + 1,m_triPoints.begin() + first + 1 + tail);
+    m_triPoints.erase(m_triPoints.begin(),m_triPoints.begin() + head);
+    for(int i = 0;i < added;++i)
+        m_triPoints.insert(m_triPoints.begin() + at + i,*m_poly->GetPoint(at + i));
+    //局部修补不了时已经整个重新剖分，三角形正好铺满拼好的多边形才用，否则从切出来的多边形重来
+    if(!m_triangulator.Patch(&m_triPoints[0],m_triPoints.size(),newIndexes,m_triangles) &&
+       !isTriangulationFilled())
+    {
+        qDebug() << "spliced remain does not triangulate";
+        resetRemain(remain);
+    }
+}
+
+//直接用切出来的剩余多边形，整个复制并重新剖分
+void QQuickPolygon::resetRemain(const C2DPolygon &remain)
+{
+    delete m_poly;
+    m_poly = new C2DPolygon(remain);
+    m_points.clear();
+    for(unsigned int i = 0;i < m_poly->GetPointsCount();++i)
+        m_points.append(QPointF(m_poly->GetPoint(i)->x,m_poly->GetPoint(i)->y));
+    processTriangulation();
+}
+
+//三角形面积加起来等于多边形面积，说明没有重叠
+bool QQuickPolygon::isTriangulationFilled() const
+{
+    double sum = 0.0;
+    for(size_t i = 0;i + 2 < m_triangles.size();i += 3)
+    {
+        const C2DPoint &p = m_triPoints[m_triangles[i]];
+        const C2DPoint &q = m_triPoints[m_triangles[i + 1]];
+        const C2DPoint &r = m_triPoints[m_triangles[i + 2]];
+        sum += qAbs((q.x - p.x) * (r.y - p.y) - (q.y - p.y) * (r.x - p.x));
+    }
+    const double area = 2.0 * m_poly->GetArea();
+    return qAbs(sum - area) <= 1e-9 * (sum + area);
 }
 
 //type 0-剩余的poly 1-切掉的poly
 QVariantList QQuickPolygon::getResultPoly(int type)
 {
     QVariantList list;
+    const QVector<qreal> data = getResultPolyData(type);
+    list.reserve(data.size());
+    for(int i = 0;i < data.size();++i)
+        list.append(data[i]);
+    return list;
+}
+
+//同getResultPoly，x,y依次排列，不复制多边形
+QVector<qreal> QQuickPolygon::getResultPolyData(int type) const
+{
+    QVector<qreal> data;
     int idx = -1;
     if(type == 0)
         idx = m_remainIdx;
     else
         idx = m_flyIdx;
-    if(idx < 0 || idx > m_lastPolySet.size())
-        return list;
-    C2DPolygon poly = m_lastPolySet[idx];
-    C2DPointSet pts;
-    poly.GetPointsCopy(pts);
-    for(size_t i = 0;i < pts.size();++i)
+    if(idx < 0 || idx >= int(m_lastPolySet.size()))
+        return data;
+    const C2DPolygon &poly = m_lastPolySet[idx];
+    const int count = poly.GetPointsCount();
+    data.reserve(count * 2);
+    for(int i = 0;i < count;++i)
     {
-        list.append(pts[i].x);
-        list.append(pts[i].y);
+        const C2DPoint *pt = poly.GetPoint(i);
+        data.append(pt->x);
+        data.append(pt->y);
     }
-    return list;
+    return data;
 }
 
 qreal QQuickPolygon::getProgress() const
@@ -212,11 +448,15 @@ void QQuickPolygon::deInit()
 {
     if(m_poly)
         delete m_poly;
+    m_poly = NULL;
     m_lastPolySet.DeleteAll();
     m_remainIdx = m_flyIdx = -1;
     m_totalArea = m_progress = 0.0;
     m_flyArea = 0.0;
     m_points.clear();
+    m_triangles.clear();
+    m_polySerial++;
+    markDirty(DirtyPoints);
 }
 
 bool QQuickPolygon::isShouldDrawLine(qreal x1, qreal y1, qreal x2, qreal y2)
@@ -241,19 +481,30 @@ QPointF QQuickPolygon::getLineStart()
     return m_lineStart;
 }
 
-int QQuickPolygon::isBallCrossLine(qreal x1,qreal y1,qreal x2,qreal y2,const QVariantList &ballsPos,const QVariantList &ballsRadius)
+//球沿上一物理步的位移扫过切割线即为失败，快速的球也不会穿过去
+int QQuickPolygon::isBallCrossLine(qreal x1,qreal y1,qreal x2,qreal y2)
 {
+    const QBallSet *ballSet = QBallSet::instance();
+    const QVector<qreal> &balls = ballSet->getState();
+    const QVector<qreal> &motion = ballSet->getMotion();
+    const int count = ballSet->getCount();
+    if(count == 0)
+        return 0;
+
+    std::vector<C2DCircle> circles(count);
+    std::vector<C2DVector> moves(count);
+    for (int idx = 0; idx < count; idx++)
+    {
+        const qreal dx = motion[idx*2];
+        const qreal dy = motion[idx*2+1];
+        circles[idx].Set(C2DPoint(balls[idx*3] - dx,balls[idx*3+1] - dy),balls[idx*3+2]);
+        moves[idx].Set(dx,dy);
+    }
     C2DLine slashLine(C2DPoint(x1,y1),C2DPoint(x2,y2));
-    for (int idx = 0; idx < ballsPos.size(); idx++)
+    if(slashLine.FirstContactTime(&circles[0],&moves[0],count,1.0) >= 0)
     {
-        QPointF pt = ballsPos.at (idx).value<QPointF> ();
-        double dst = slashLine.Distance(C2DPoint(pt.x(),pt.y()));
-        double radius = ballsRadius.at(idx).value<double>();
-        if(dst < radius)
-        {
-            qDebug() << "line cross ball failed";
-            return 1;
-        }
+        qDebug() << "line cross ball failed";
+        return 1;
     }
     return 0;
 }
@@ -281,121 +532,54 @@ int QQuickPolygon::isCrossPolygon(qreal x1, qreal y1, qreal x2, qreal y2)
     return interSet.size();
 }
 
-void QQuickPolygon::calParts(float sx, float sy, float ex, float ey,QVector<QPointF> &poly1,QVector<QPointF> &poly2)
+//按下时调用，之后每次移动只检测新增的一小段
+void QQuickPolygon::beginDrag(qreal x, qreal y)
 {
-    // 0[xmin,ymin]----------3[xmax,ymin]
-    // |                              |
-    // |                              |
-    // 1[xmin,ymax]----------2[xmax,ymax]
-
-    int currIndex = 0;
-    QVector<QPointF> a1;
-    a1.push_back(QPointF(m_minX,m_minY));
-    currIndex++;
-    int jd1Index = -1;
-    int jd2Index = -1;
-
-    float t = (m_minX - sx)/(ex - sx);
-    float y = (ey - sy) * t + sy;
-    if(y > m_minY && y < m_maxY)
-    {
-        jd1Index = currIndex;
-        a1.push_back(QPointF(m_minX,y));
-        currIndex++;
-    }
-
-    a1.push_back(QPointF(m_minX,m_maxY));
-    currIndex++;
-    t = (m_maxY - sy) / (ey - sy);
-    float x = (ex - sx) * t + sx;
-    if(x > m_minX && x < m_maxX)
-    {
-        if(jd1Index == -1)
-        {
-            jd1Index = currIndex;
-        }
-        else
-        {
-            jd2Index = currIndex;
-        }
-        a1.push_back(QPointF(x,m_maxY));
-        currIndex++;
-    }
-
-    a1.push_back(QPointF(m_maxX,m_maxY));
-    currIndex++;
-    t=(m_maxX-sx)/(ex-sx);
-    y=(ey-sy)*t+sy;
-    if(y>m_minY&&y<m_maxY)
-    {
-        if(jd1Index==-1)
-        {
-            jd1Index=currIndex;
-        }
-        else
-        {
-            jd2Index=currIndex;
-        }
-        a1.push_back(QPointF(m_maxX,y));
-        currIndex++;
-    }
+    m_dragLast = QPointF(x,y);
+    m_dragCrossings = 0;
+}
 
-    a1.push_back(QPointF(m_maxX,m_minY));
-    currIndex++;
+//返回从beginDrag起手指轨迹穿过多边形边的累计次数，穿过刚边返回9999
+int QQuickPolygon::dragTo(qreal x, qreal y)
+{
+    const C2DPoint from(m_dragLast.x(),m_dragLast.y());
+    const C2DPoint to(x,y);
+    m_dragLast = QPointF(x,y);
+    if(m_poly == NULL || (from.x == to.x && from.y == to.y))
+        return m_dragCrossings;
 
-    //求3--0线段传入切割线的交点 y=ymin
-    t=(m_minY-sy)/(ey-sy);
-    x=(ex-sx)*t+sx;
-    if(x>m_minX&&x<m_maxX)
-    {
-        if(jd1Index==-1)
-        {
-            jd1Index=currIndex;
-        }
-        else
-        {
-            jd2Index=currIndex;
-        }
-        a1.push_back(QPointF(x,m_minY));
-        currIndex++;
-    }
+    C2DLine step(from,to);
+    C2DPointSet interSet;
+    m_dragEdges.clear();
+    if(!m_poly->GetCrossingLines(step,m_dragEdges,interSet))
+        return m_dragCrossings;
 
-    //卷绕第一个多边形
-    int startIndex=jd1Index;
-    while(true)
+    //按离起点的距离排序，起点上的交点已在上一段中算过
+    QVector<QPair<double,int> > order;
+    for(size_t i = 0;i < interSet.size();i++)
     {
-        poly1.push_back(a1[startIndex]);
-        if(startIndex==jd2Index)
-        {
-            break;
-        }
-        startIndex=(startIndex+1)%a1.size();
+        double dist = from.Distance(interSet[i]);
+        if(dist > conEqualityTolerance)
+            order.append(qMakePair(dist,int(i)));
     }
+    std::sort(order.begin(),order.end());
 
-    startIndex=jd2Index;
-    while(true)
+    bool rigid = false;
+    for(int k = 0;k < order.size();k++)
     {
-        poly2.push_back(a1[startIndex]);
-        if(startIndex==jd1Index)
-        {
-            break;
-        }
-        startIndex=(startIndex+1)%a1.size();
+        const int i = order[k].second;
+        if(isEdgeRigid(m_dragEdges[i]))
+            rigid = true;
+        m_dragCrossings++;
+        if(m_dragCrossings == 1)
+            m_lineStart = QPointF(interSet[i].x,interSet[i].y);
+        else if(m_dragCrossings == 2)
+            m_interLine = C2DLine(C2DPoint(m_lineStart.x(),m_lineStart.y()),to);
     }
-}
+    if(rigid)
+        return 9999;
 
-int QQuickPolygon::isPointSetContain(const C2DPointSet &pts, const C2DPoint &pt)
-{
-    int index = -1;
-    for(size_t i = 0;i < pts.size();++i)
-    {
-        if(qAbs(pts[i].x - pt.x) < 0.001 && qAbs(pts[i].y - pt.y) < 0.001 )
-        {
-            index = i;
-            break;
-        }
-    }
-    return index;
+    return m_dragCrossings;
 }
 
 void QQuickPolygon::combinePolygon(C2DPolygon &poly1, C2DPolygon &poly2, C2DPolygon &comPoly)
@@ -406,53 +590,73 @@ void QQuickPolygon::combinePolygon(C2DPolygon &poly1, C2DPolygon &poly2, C2DPoly
     poly1.GetPointsCopy(pts1);
     poly2.GetPointsCopy(pts2);
 
-    QVector<int> repeatIdx;
+    //用网格哈希找重复点，代替逐个比较，first记录每个焊接点在pts2中的位置
+    C2DRect bounds;
+    poly1.GetBoundingRect(bounds);
+    bounds.ExpandToInclude(poly2.GetBoundingRect());
+    CPointWelder welder(0.001);
+    welder.Reset(bounds,pts1.size() + pts2.size());
+    std::vector<unsigned int> first;
+    first.reserve(pts1.size() + pts2.size());
+    std::vector<unsigned int> welds1(pts1.size());
+    std::vector<unsigned int> welds2(pts2.size());
+    for(size_t i = 0;i < pts2.size();++i)
+    {
+        welds2[i] = welder.Add(pts2[i]);
+        if(welds2[i] == first.size())
+            first.push_back(i);
+    }
+
+    std::vector<bool> repeated(pts1.size() + pts2.size(),false);
     for(size_t i = 0;i < pts1.size();++i)
     {
         const C2DPoint pt = pts1[i];
-        int index = isPointSetContain(pts2,pt);
-        if(index == -1)
+        unsigned int index = welder.Add(pt);
+        welds1[i] = index;
+        if(index == first.size())
         {
+            first.push_back(pts2.size());
             pts2.AddCopy(pt);
         }
         else
         {
-            repeatIdx.push_back(index);
-            //pts2.DeleteAndSet(index,pts2.GetAt((index+1)%pts2.size()));
+            repeated[first[index]] = true;
         }
     }
 
     C2DPointSet finalSet;
-    for(int i = 0;i < pts2.size();i++)
+    for(size_t i = 0;i < pts2.size();i++)
     {
-        if(repeatIdx.indexOf(i) == -1)
+        if(!repeated[i])
             finalSet.AddCopy(pts2[i]);
-        //pts2.DeleteAndSet(index,pts2.GetAt((index+1)%pts2.size()));
     }
 
+    //重建前先按焊接点记下两个多边形边的属性，poly2和comPoly可能是同一个
+    QHash<quint64,unsigned int> attributes;
+    collectEdgeAttributes(poly1,welds1,attributes);
+    collectEdgeAttributes(poly2,welds2,attributes);
+
     comPoly.Create(finalSet,true);
+    applyEdgeAttributes(welder,attributes,comPoly);
     debugPolygon(comPoly);
 #endif
 }
 
-void QQuickPolygon::dealOverlaps(const C2DHoledPolygonSet &holedPolySet, C2DPolygonSet &onePolySet, C2DPolygonSet &multiPolySet)
+//切出的多边形直接转移过去，不再复制，polySet会被清空
+void QQuickPolygon::dealOverlaps(C2DPolygonSet &polySet, C2DPolygonSet &onePolySet, C2DPolygonSet &multiPolySet)
 {
-    if(holedPolySet.size() == 1)
+    if(polySet.size() == 1)
     {
-        onePolySet.AddCopy(*(holedPolySet.GetAt(0)->GetRim()));
+        onePolySet.InsertAt(onePolySet.size(),polySet);
     }
     else
     {
-        for(size_t i = 0;i < holedPolySet.size();++i)
-        {
-            multiPolySet.AddCopy(*(holedPolySet.GetAt(i)->GetRim()));
-        }
+        multiPolySet.InsertAt(multiPolySet.size(),polySet);
     }
 }
 
-void QQuickPolygon::getLastPolys(C2DPolygonSet &onePolySet,C2DPolygonSet &multiPolySet, qreal x1, qreal y1, qreal x2, qreal y2)
+void QQuickPolygon::getLastPolys(C2DPolygonSet &onePolySet,C2DPolygonSet &multiPolySet, qreal x1, qreal y1, qreal x2, qreal y2, C2DPolygonSet &lastPolySet)
 {
-    C2DPolygonSet combineSet;
     if(multiPolySet.size() > 0)
     {
         int interIdx = 0;
@@ -466,97 +670,83 @@ void QQuickPolygon::getLastPolys(C2DPolygonSet &onePolySet,C2DPolygonSet &multiP
                 interIdx = i;
             }
         }
-        m_lastPolySet.AddCopy(multiPolySet[interIdx]);
-        for(size_t i = 0;i < multiPolySet.size();++i)
-        {
-            if(i != interIdx)
-                combineSet.AddCopy(multiPolySet[i]);
-        }
+        //切出来的多边形直接移过去，不复制，按指针还能找到切割时记下的拼接信息
+        lastPolySet.Add(multiPolySet.ExtractAt(interIdx));
 
-        if(combineSet.size() > 0)
+        if(multiPolySet.size() > 0)
         {
-            C2DPolygon onePoly = onePolySet[0];
+            //合并出来的是新的多边形，和切割时的不一样了
+            C2DPolygon *onePoly = new C2DPolygon(onePolySet[0]);
 
-            for(size_t i = 0;i < combineSet.size();++i)
+            for(size_t i = 0;i < multiPolySet.size();++i)
             {
-                combinePolygon(combineSet[i],onePoly,onePoly);
+                combinePolygon(multiPolySet[i],*onePoly,*onePoly);
             }
-            m_lastPolySet.AddCopy(onePoly);
+            lastPolySet.Add(onePoly);
         }
         else
         {
-            m_lastPolySet.AddCopy(onePolySet[0]);
+            lastPolySet.Add(onePolySet.ExtractAt(0));
         }
     }
     else
     {
-        for(size_t i = 0;i < onePolySet.size();++i)
-        {
-            m_lastPolySet.AddCopy(onePolySet[i]);
-        }
+        lastPolySet.InsertAt(lastPolySet.size(),onePolySet);
     }
 }
 
-void QQuickPolygon::shownPolyUpdate(int flyIdx,int remainIdx)
+//刚边的标记在多边形每条边的属性里，切割后跟着边走
+bool QQuickPolygon::isEdgeRigid(int idx) const
 {
-    m_points.clear();
-    if(m_poly)
-        delete m_poly;
-
-    C2DPointSet pts;
-    m_lastPolySet[remainIdx].GetPointsCopy(pts);
-    m_poly = new C2DPolygon(pts,false);
-    qreal area = m_lastPolySet[flyIdx].GetArea();
-    m_flyArea += area;
-    m_progress = m_flyArea / m_totalArea;
-
-    for(size_t i = 0;i < pts.size();++i)
-    {
-        m_points.append(QPointF(pts[i].x,pts[i].y));
-    }
-
-    processTriangulation ();
-    emit pointsChanged ();
-    update ();
+    if(m_poly == NULL || idx < 0 || idx >= int(m_poly->GetLines().size()))
+        return false;
+    return (m_poly->GetLines()[idx].GetAttributes() & EdgeRigid) != 0;
 }
 
-int QQuickPolygon::isPtRigid(QPointF &pt1, QPointF &pt2)
+bool QQuickPolygon::isLineRigid(const C2DLineBaseSet &lineSet)
 {
-    QPoint ppt1 = pt1.toPoint();
-    QPoint ppt2 = pt2.toPoint();
-    bool b1 = false,b2 = false;
-    for(int i = 0;i < m_rigidPt.size();i++)
+    for(size_t i = 0;i < lineSet.size();i++)
     {
-        if(isPtEqual(m_rigidPt[i],ppt1))
-            b1 = true;
-        if(isPtEqual(m_rigidPt[i],ppt2))
-            b2 = true;
-        if(b1 & b2)
-            return 1;
+        if(lineSet[i].GetAttributes() & EdgeRigid)
+            return true;
     }
+    return false;
+}
 
-    return 0;
+//边的两个焊接点组成的键，两个方向相同
+static inline quint64 edgeKey(unsigned int weld1, unsigned int weld2)
+{
+    if(weld1 > weld2)
+        std::swap(weld1,weld2);
+    return (quint64(weld1) << 32) | weld2;
 }
 
-int QQuickPolygon::isLineRigid(C2DLineBaseSet &lineSet)
+//合并时按点重建了多边形，边的属性要从原来的多边形里找回来
+//welds为from每个点的焊接点，第i条边从第i个点到下一个点，后记的覆盖先记的
+void QQuickPolygon::collectEdgeAttributes(const C2DPolygon &from, const std::vector<unsigned int> &welds, QHash<quint64,unsigned int> &attributes)
 {
-    for(int i = 0;i < lineSet.size();i++)
+    const C2DLineBaseSet &fromLines = from.GetLines();
+    const size_t n = fromLines.size();
+    for(size_t i = 0;i < n && i < welds.size();i++)
     {
-        C2DPoint pt1 = lineSet[i].GetPointFrom();
-        C2DPoint pt2 = lineSet[i].GetPointTo();
-        QPointF ppt1 = QPointF(pt1.x,pt1.y);
-        QPointF ppt2 = QPointF(pt2.x,pt2.y);
-        if(isPtRigid(ppt1,ppt2))
-            return true;
+        attributes.insert(edgeKey(welds[i],welds[(i + 1) % welds.size()]),fromLines[i].GetAttributes());
     }
-    return false;
 }
 
-int QQuickPolygon::isPtEqual(QPoint &pt1, QPoint &pt2)
+//每条新边按两个端点的焊接点查表，O(1)找回属性
+void QQuickPolygon::applyEdgeAttributes(const CPointWelder &welder, const QHash<quint64,unsigned int> &attributes, C2DPolygon &to)
 {
-    if(qAbs(pt1.x() - pt2.x()) < 3 && qAbs(pt1.y() - pt2.y()) < 3)
-        return 1;
-    return 0;
+    const C2DLineBaseSet &toLines = to.GetLines();
+    for(size_t i = 0;i < toLines.size();i++)
+    {
+        const int weld1 = welder.Find(toLines[i].GetPointFrom());
+        const int weld2 = welder.Find(toLines[i].GetPointTo());
+        if(weld1 < 0 || weld2 < 0)
+            continue;
+        QHash<quint64,unsigned int>::const_iterator it = attributes.constFind(edgeKey(weld1,weld2));
+        if(it != attributes.constEnd())
+            to.SetLineAttributes(i,it.value());
+    }
 }
 
 void QQuickPolygon::debugPolygon(C2DPolygon &poly)
@@ -573,7 +763,7 @@ void QQuickPolygon::setBorder (qreal border) {
     if (m_border != border) {
         m_border = border;
         emit borderChanged ();
-        update ();
+        markDirty (DirtyBorder);
     }
 }
 
@@ -581,7 +771,7 @@ void QQuickPolygon::setClosed (bool closed) {
     if (m_closed != closed) {
         m_closed = closed;
         emit closedChanged ();
-        update ();
+        markDirty (DirtyPoints);
     }
 }
 
@@ -589,7 +779,7 @@ void QQuickPolygon::setColor (const QColor & color) {
     if (m_color != color) {
         m_color = color;
         emit colorChanged ();
-        update ();
+        markDirty (DirtyColor);
     }
 }
 
@@ -597,92 +787,185 @@ void QQuickPolygon::setStroke (const QColor & stroke) {
     if (m_stroke != stroke) {
         m_stroke = stroke;
         emit strokeChanged ();
-        update ();
+        markDirty (DirtyStroke);
     }
 }
 void QQuickPolygon::setPoints (const QVariantList & points) {
-    bool dirty = false;
-    C2DPointSet pst;
-    const int count = points.size ();
-    if (m_points.size () != count/2) {
-        m_points.resize (count/2);
-        dirty = true;
-    }
-    for (int idx = 0,i = 0; idx < count; idx+=2,i++) {
-        QPointF pt = points.at (idx).value<QPointF> ();
-        QPoint rigidPt = points.at (idx+1).value<QPoint> ();
-        if (pt != m_points.at (i)) {
-            m_points [i] = pt;
-            dirty = true;
-        }
-        if(rigidPt.x())
-        {
-            QPoint nextPt = points.at ((idx+2)%count).value<QPoint> ();
-            m_rigidPt.push_back(pt.toPoint());
-            m_rigidPt.push_back(nextPt);
-            qDebug() << pt << nextPt;
+    // pairs of Qt.point, the vertex then x non zero if the edge from it is rigid
+    const int count = points.size () / 2;
+    QVector<qreal> xy (count * 2);
+    QVector<int> rigid (count);
+    for (int i = 0; i < count; i++) {
+        QPointF pt = points.at (i * 2).value<QPointF> ();
+        xy [i * 2]    = pt.x ();
+        xy [i * 2 +1] = pt.y ();
+        rigid [i] = points.at (i * 2 +1).value<QPoint> ().x ();
+    }
+    setOutlineData (xy, rigid);
+}
+
+void QQuickPolygon::setOutlineData (const QVector<qreal> & xy, const QVector<int> & rigid) {
+    const int count = xy.size () / 2;
+    QPolygonF outline (count);
+    for (int i = 0; i < count; i++) {
+        outline [i] = QPointF (xy [i * 2], xy [i * 2 +1]);
+    }
+    std::vector<unsigned int> attributes (count, 0);
+    for (int i = 0; i < count && i < rigid.size (); i++) {
+        if (rigid [i]) {
+            attributes [i] = EdgeRigid;
         }
-        C2DPoint cpt(pt.x(),pt.y());
-        pst.AddCopy(cpt);
     }
-    m_poly = new C2DPolygon(pst,false);
-    m_totalArea = m_poly->GetArea();
+    m_dirty |= DirtyPoints; // rigid edges change the stroke even if the points do not
+    resetOutline (outline, attributes);
+}
+
+void QQuickPolygon::setOutline (const QPolygonF & outline) {
+    resetOutline (outline, std::vector<unsigned int> ());
+}
+
+void QQuickPolygon::resetOutline (const QPolygonF & outline, const std::vector<unsigned int> & attributes) {
+    C2DPointSet pst;
+    for (int i = 0; i < outline.size (); i++) {
+        pst.AddCopy (C2DPoint (outline [i].x (), outline [i].y ()));
+    }
+    if (m_poly) {
+        delete m_poly;
+    }
+    m_poly = new C2DPolygon;
+    m_poly->Create (pst, attributes);
+    m_polySerial++;
+    m_totalArea = m_poly->GetArea ();
+    // the polygon may have turned the points clockwise, keep m_points in its order
+    // so edge i of the stroke is line i of the polygon
+    QPolygonF points;
+    points.reserve (m_poly->GetLines ().size ());
+    for (size_t i = 0; i < m_poly->GetLines ().size (); i++) {
+        const C2DPoint pt = m_poly->GetLines () [i].GetPointFrom ();
+        points.append (QPointF (pt.x, pt.y));
+    }
+    const bool dirty = (points != m_points);
+    m_points.swap (points);
     if (dirty) {
         processTriangulation ();
         emit pointsChanged ();
+        m_dirty |= DirtyPoints;
+    }
+    if (m_dirty) {
         update ();
     }
 }
 
+void QQuickPolygon::markDirty (int flags) {
+    m_dirty |= flags;
+    update ();
+}
+
 static inline qreal getAngleFromSegment (const QPointF & startPoint, const QPointF & endPoint) {
     return qAtan2 (endPoint.y () - startPoint.y (), endPoint.x () - startPoint.x ());
 }
 
+static QSGGeometryNode * createFlatNode (void) {
+    QSGGeometry * geometry = new QSGGeometry (QSGGeometry::defaultAttributes_Point2D (), 0, 0, GL_UNSIGNED_SHORT);
+    geometry->setDrawingMode (GL_TRIANGLES);
+    QSGGeometryNode * node = new QSGGeometryNode;
+    node->setGeometry (geometry);
+    node->setMaterial (new QSGFlatColorMaterial);
+    node->setFlag (QSGNode::OwnsGeometry);
+    node->setFlag (QSGNode::OwnsMaterial);
+    return node;
+}
+
 QSGNode * QQuickPolygon::updatePaintNode (QSGNode * oldNode, UpdatePaintNodeData * updatePaintNodeData) {
-    Q_UNUSED (oldNode)
     Q_UNUSED (updatePaintNodeData)
-    // remove old nodes
-    if (m_backMaterial != Q_NULLPTR) {
-        delete m_backMaterial;
-    }
-    if (m_foreMaterial != Q_NULLPTR) {
-        delete m_foreMaterial;
-    }
-    if (m_backGeometry != Q_NULLPTR) {
-        delete m_backGeometry;
-    }
-    if (m_foreGeometry != Q_NULLPTR) {
-        delete m_foreGeometry;
-    }
-    if (m_backNode != Q_NULLPTR) {
-        delete m_backNode;
-    }
-    if (m_foreNode != Q_NULLPTR) {
-        delete m_foreNode;
-    }
-    if (m_node != Q_NULLPTR) {
-        delete m_node;
-    }
-    m_node = new QSGNode;
-    // polygon background tesselation
-    if (!m_triangles.isEmpty () && m_color.alpha () > 0) {
-        m_backGeometry = new QSGGeometry (QSGGeometry::defaultAttributes_Point2D (), m_triangles.size ());
-        m_backGeometry->setDrawingMode (GL_TRIANGLES);
-        QSGGeometry::Point2D * vertex = m_backGeometry->vertexDataAsPoint2D ();
-        const int size = m_triangles.size ();
-        for (int idx = 0; idx < size; idx++) {
-            vertex [idx].x = m_triangles [idx].x ();
-            vertex [idx].y = m_triangles [idx].y ();
-        }
-        m_backMaterial = new QSGFlatColorMaterial;
-        m_backMaterial->setColor (m_color);
-        m_backNode = new QSGGeometryNode;
-        m_backNode->setGeometry (m_backGeometry);
-        m_backNode->setMaterial (m_backMaterial);
+    if (oldNode == Q_NULLPTR) {
+        // first frame, or the scene graph was invalidated and deleted the previous tree
+        m_node     = new QSGNode;
+        m_backNode = createFlatNode ();
+        m_foreNode = createFlatNode ();
         m_node->appendChildNode (m_backNode);
+        m_node->appendChildNode (m_foreNode);
+        m_dirty = DirtyAll;
+    }
+    if (m_dirty & (DirtyPoints | DirtyColor)) {
+        updateBackNode ();
+    }
+    if (m_dirty & (DirtyPoints | DirtyStroke | DirtyBorder)) {
+        updateForeNode ();
+    }
+    m_dirty = 0;
+    return m_node;
+}
+
+void QQuickPolygon::updateBackNode (void) {
+    // polygon background tesselation, indexed over m_points
+    const bool visible     = (!m_triangles.empty () && m_color.alpha () > 0);
+    const int pointsCount  = (visible ? m_points.size () : 0);
+    const int indicesCount = (visible ? int (m_triangles.size ()) : 0);
+    const int indexType    = (pointsCount <= 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT); // GLES 2 only has ushort indexes
+    QSGGeometry * geometry = m_backNode->geometry ();
+    if ((m_dirty & DirtyPoints) || geometry->vertexCount () != pointsCount) {
+        if (geometry->indexType () != indexType) {
+            geometry = new QSGGeometry (QSGGeometry::defaultAttributes_Point2D (), pointsCount, indicesCount, indexType);
+            geometry->setDrawingMode (GL_TRIANGLES);
+            m_backNode->setGeometry (geometry); // deletes the old one, the node owns it
+        }
+        else if (geometry->vertexCount () != pointsCount || geometry->indexCount () != indicesCount) {
+            geometry->allocate (pointsCount, indicesCount);
+        }
+        QSGGeometry::Point2D * vertex = geometry->vertexDataAsPoint2D ();
+        for (int idx = 0; idx < pointsCount; idx++) {
+            vertex [idx].x = m_points [idx].x ();
+            vertex [idx].y = m_points [idx].y ();
+        }
+        if (indexType == GL_UNSIGNED_SHORT) {
+            quint16 * index = geometry->indexDataAsUShort ();
+            for (int idx = 0; idx < indicesCount; idx++) {
+                index [idx] = quint16 (m_triangles [idx]);
+            }
+        }
+        else {
+            quint32 * index = geometry->indexDataAsUInt ();
+            for (int idx = 0; idx < indicesCount; idx++) {
+                index [idx] = m_triangles [idx];
+            }
+        }
+        m_backNode->markDirty (QSGNode::DirtyGeometry);
+    }
+    if (m_dirty & DirtyColor) {
+        static_cast<QSGFlatColorMaterial *> (m_backNode->material ())->setColor (m_color);
+        m_backNode->markDirty (QSGNode::DirtyMaterial);
+    }
+}
+
+void QQuickPolygon::updateForeNode (void) {
+    // polyline stroke, the mesh only depends on the points, closed and border
+    if (m_dirty & (DirtyPoints | DirtyBorder)) {
+        processStroke ();
+    }
+    const bool visible     = (m_points.size () >= 2 && m_border > 0 && m_stroke.alpha () > 0);
+    const int vertexCount  = (visible ? m_strokeTriangles.size () : 0);
+    QSGGeometry * geometry = m_foreNode->geometry ();
+    if ((m_dirty & (DirtyPoints | DirtyBorder)) || geometry->vertexCount () != vertexCount) {
+        if (geometry->vertexCount () != vertexCount) {
+            geometry->allocate (vertexCount);
+        }
+        QSGGeometry::Point2D * vertex = geometry->vertexDataAsPoint2D ();
+        for (int idx = 0; idx < vertexCount; idx++) {
+            vertex [idx].x = m_strokeTriangles [idx].x ();
+            vertex [idx].y = m_strokeTriangles [idx].y ();
+        }
+        m_foreNode->markDirty (QSGNode::DirtyGeometry);
     }
-    // polyline stroke generation
-    if (m_points.size () >= 2 && m_border > 0 && m_stroke.alpha () > 0) {
+    if (m_dirty & DirtyStroke) {
+        static_cast<QSGFlatColorMaterial *> (m_foreNode->material ())->setColor (m_stroke);
+        m_foreNode->markDirty (QSGNode::DirtyMaterial);
+    }
+}
+
+void QQuickPolygon::processStroke (void) {
+    m_strokeTriangles.clear ();
+    if (m_points.size () >= 2 && m_border > 0) {
         const int pointsCount    = m_points.size ();
         const int linesCount     = (m_closed ? pointsCount : pointsCount -1);
         const int trianglesCount = (linesCount * 2);
@@ -725,81 +1008,30 @@ QSGNode * QQuickPolygon::updatePaintNode (QSGNode * oldNode, UpdatePaintNodeData
             trianglesStroke << firstVec1 << firstVec2 << lastVec1;
         }
 
-        QVector<QPointF> finalTrianglesStroke;
-        for(int i = 0;i < m_points.size();i++)
+        // only the rigid edges get a border
+        m_strokeTriangles.reserve (vertexCount);
+        for(int i = 0;i < linesCount;i++)
         {
-            QPointF pt = m_points[i];
-            QPointF nextPt = m_points[(i+1)%m_points.size()];
-            if(isPtRigid(pt,nextPt))
+            if(isEdgeRigid(i))
             {
                 for(int j = i * 6;j < (i * 6 + 6);j++)
                 {
-                    finalTrianglesStroke.push_back(trianglesStroke[j]);
+                    m_strokeTriangles.push_back(trianglesStroke[j]);
                 }
             }
         }
-
-        m_foreGeometry = new QSGGeometry (QSGGeometry::defaultAttributes_Point2D (), finalTrianglesStroke.size ());
-        m_foreGeometry->setDrawingMode (GL_TRIANGLES);
-        QSGGeometry::Point2D * vertex = m_foreGeometry->vertexDataAsPoint2D ();
-        const int size = finalTrianglesStroke.size ();
-        for (int idx = 0; idx < size; idx++) {
-            vertex [idx].x = finalTrianglesStroke [idx].x ();
-            vertex [idx].y = finalTrianglesStroke [idx].y ();
-        }
-        m_foreMaterial = new QSGFlatColorMaterial;
-        m_foreMaterial->setColor (m_stroke);
-        m_foreNode = new QSGGeometryNode;
-        m_foreNode->setGeometry (m_foreGeometry);
-        m_foreNode->setMaterial (m_foreMaterial);
-        m_node->appendChildNode (m_foreNode);
     }
-    return m_node;
 }
 
 void QQuickPolygon::processTriangulation (void) {
-    // allocate and initialize list of Vertices in polygon
+    // ear clip into an index buffer over m_points, reusing the buffers between cuts
     const int n = m_points.size ();
     m_triangles.clear ();
-    m_triangles.reserve (n * 3);
     if (n >= 3) {
-        QVector<int> index (n);
+        m_triPoints.resize (n);
         for (int i = 0; i < n; i++) {
-            index [i] = i;
-        }
-        // remove nv-2 Vertices, creating 1 triangle every time
-        int nv = n;
-        int count = (2 * nv); // error detection
-        QPolygonF triangle (3);
-        for (int v = (nv -1), u, w; nv > 2;) {
-            // if we loop, it is probably a non-simple polygon
-            count--;
-            if (count > 0) {
-                // three consecutive vertices in current polygon, <u,v,w>
-                u = (v    < nv ? v    : 0); // previous
-                v = (u +1 < nv ? u +1 : 0); // new v
-                w = (v +1 < nv ? v +1 : 0); // next
-                triangle [0] = m_points [index [u]];
-                triangle [1] = m_points [index [v]];
-                triangle [2] = m_points [index [w]];
-                QPolygonF result = triangle.intersected (m_points);
-                if (result.isClosed ()) {
-                    result.removeLast ();
-                }
-                if (result == triangle) {
-                    // output Triangle
-                    m_triangles.append (m_points [index [u]]);
-                    m_triangles.append (m_points [index [v]]);
-                    m_triangles.append (m_points [index [w]]);
-                    index.remove (v); // remove v from remaining polygon
-                    nv--;
-                    count = (2 * nv); // reset error detection counter
-                }
-            }
-            else {
-                // Triangulate: ERROR - probable bad polygon!
-                break;
-            }
+            m_triPoints [i].Set (m_points [i].x (), m_points [i].y ());
         }
+        m_triangulator.Triangulate (&m_triPoints [0], n, Q_NULLPTR, 0, m_triangles);
     }
 }
@@ -11,10 +11,37 @@
 #include <QSGGeometry>
 #include <QSGGeometryNode>
 #include <QSGFlatColorMaterial>
+#include <QFutureWatcher>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QHash>
 
 #include "C2DPolygon.h"
 #include "C2DPolygonSet.h"
 #include "C2DLineSet.h"
+#include "Triangulator.h"
+
+#include <vector>
+
+class CPointWelder;
+
+// outcome of a slash as seen from QML, polygons are x,y pairs
+class QSlashResult {
+    Q_GADGET
+    Q_PROPERTY (int            code     MEMBER code)     // as calcSlashPoly, -1 if the polygon changed meanwhile or is gone
+    Q_PROPERTY (qreal          progress MEMBER progress)
+    Q_PROPERTY (QVector<qreal> remain   MEMBER remain)
+    Q_PROPERTY (QVector<qreal> flyAway  MEMBER flyAway)
+
+public:
+    QSlashResult (void) : code (2), progress (0.0) { }
+
+    int            code;
+    qreal          progress;
+    QVector<qreal> remain;
+    QVector<qreal> flyAway;
+};
+Q_DECLARE_METATYPE (QSlashResult)
 
 class QQuickPolygon : public QQuickItem {
     Q_OBJECT
@@ -23,8 +50,14 @@ class QQuickPolygon : public QQuickItem {
     Q_PROPERTY (QColor       color  READ getColor  WRITE setColor  NOTIFY colorChanged)  // back color
     Q_PROPERTY (QColor       stroke READ getStroke WRITE setStroke NOTIFY strokeChanged) // border color
     Q_PROPERTY (QVariantList points READ getPoints WRITE setPoints NOTIFY pointsChanged) // points list
+    Q_PROPERTY (QPolygonF    outline READ getOutline WRITE setOutline NOTIFY pointsChanged) // same points, typed
 
 public:
+    // flags kept in the attributes of each line of the polygon
+    enum EdgeAttribute {
+        EdgeRigid = 0x1,
+    };
+
     explicit QQuickPolygon (QQuickItem * parent = NULL);
 
     Q_INVOKABLE bool         getClosed (void) const;
@@ -32,34 +65,35 @@ public:
     Q_INVOKABLE QColor       getColor  (void) const;
     Q_INVOKABLE QColor       getStroke (void) const;
     Q_INVOKABLE QVariantList getPoints (void) const;
+    Q_INVOKABLE QPolygonF    getOutline (void) const;
     Q_INVOKABLE bool         isCutPolygon(qreal x1,qreal y1,qreal x2,qreal y2);
-    Q_INVOKABLE int calcSlashPoly(qreal w,qreal h,qreal x1,qreal y1,qreal x2,qreal y2,const QVariantList &ballsPos,const QVariantList &ballsRadius);
+    Q_INVOKABLE int calcSlashPoly(qreal w,qreal h,qreal x1,qreal y1,qreal x2,qreal y2);
+    Q_INVOKABLE int calcSlashPolyAsync(qreal w,qreal h,qreal x1,qreal y1,qreal x2,qreal y2);
+    Q_INVOKABLE QSlashResult getSlashResult(int code) const;
     Q_INVOKABLE QVariantList getResultPoly(int type);
+    Q_INVOKABLE QVector<qreal> getResultPolyData(int type) const;
     Q_INVOKABLE qreal        getProgress(void) const;
     Q_INVOKABLE void         deInit();
     Q_INVOKABLE bool         isShouldDrawLine(qreal x1,qreal y1,qreal x2,qreal y2);
     Q_INVOKABLE QPointF      getLineStart();
-    Q_INVOKABLE int          isBallCrossLine(qreal x1,qreal y1,qreal x2,qreal y2,const QVariantList &ballsPos,const QVariantList &ballsRadius);
+    Q_INVOKABLE int          isBallCrossLine(qreal x1,qreal y1,qreal x2,qreal y2);
     Q_INVOKABLE int          isCrossPolygon(qreal x1,qreal y1,qreal x2,qreal y2);
+    Q_INVOKABLE void         beginDrag(qreal x,qreal y);
+    Q_INVOKABLE int          dragTo(qreal x,qreal y); // crossings since beginDrag, 9999 on a rigid edge
 
 public:
-    void createPolygon(const QVector<QPointF> &pts,C2DPolygon &poly);
     bool isCutPolygon(const C2DPolygon &poly,qreal x1,qreal y1,qreal x2,qreal y2);
-    //画的线将整个屏幕划分为两个多边形，分别用着两个多边形和游戏区域的多边形计算重叠区域
-    void calParts(float sx,float sy,float ex,float ey,QVector<QPointF> &poly1,QVector<QPointF> &poly2);
 
-    //查看pt是否在pts中，如果在则返回index，否则返回-1
-    int isPointSetContain(const C2DPointSet &pts,const C2DPoint &pt);
-    void combinePolygon(C2DPolygon &poly1,C2DPolygon &poly2,C2DPolygon &comPoly);
-    void dealOverlaps(const C2DHoledPolygonSet &holedPolySet,C2DPolygonSet &onePolySet,C2DPolygonSet &multiPolySet);
-    void getLastPolys(C2DPolygonSet &onePolySet,C2DPolygonSet &multiPolySet,qreal x1,qreal y1,qreal x2,qreal y2);
-    void shownPolyUpdate(int flyIdx,int remainIdx);
+    static void combinePolygon(C2DPolygon &poly1,C2DPolygon &poly2,C2DPolygon &comPoly);
+    static void dealOverlaps(C2DPolygonSet &polySet,C2DPolygonSet &onePolySet,C2DPolygonSet &multiPolySet);
+    static void getLastPolys(C2DPolygonSet &onePolySet,C2DPolygonSet &multiPolySet,qreal x1,qreal y1,qreal x2,qreal y2,C2DPolygonSet &lastPolySet);
 
-    int isPtRigid(QPointF &pt1, QPointF &pt2);
-    int isLineRigid(C2DLineBaseSet &lineSet);
-    int isPtEqual(QPoint &pt1,QPoint &pt2);
+    static bool isLineRigid(const C2DLineBaseSet &lineSet);
+    static void collectEdgeAttributes(const C2DPolygon &from,const std::vector<unsigned int> &welds,QHash<quint64,unsigned int> &attributes);
+    static void applyEdgeAttributes(const CPointWelder &welder,const QHash<quint64,unsigned int> &attributes,C2DPolygon &to);
+    bool isEdgeRigid(int idx) const;
 
-    void debugPolygon(C2DPolygon &poly);
+    static void debugPolygon(C2DPolygon &poly);
 
 public slots:
     void setClosed (bool closed);
@@ -67,6 +101,8 @@ public slots:
     void setColor  (const QColor & color);
     void setStroke (const QColor & stroke);
     void setPoints (const QVariantList & points);
+    void setOutline (const QPolygonF & outline);
+    void setOutlineData (const QVector<qreal> & xy, const QVector<int> & rigid); // x,y pairs and a rigid flag per edge
 
 signals:
     void colorChanged  (void);
@@ -74,6 +110,7 @@ signals:
     void borderChanged (void);
     void closedChanged (void);
     void strokeChanged (void);
+    void slashComputed (int id, const QSlashResult & result);
 
 protected:
     virtual QSGNode * updatePaintNode (QSGNode * oldNode, UpdatePaintNodeData * updatePaintNodeData);
@@ -82,23 +119,56 @@ protected slots:
     void processTriangulation (void);
 
 private:
+    enum DirtyFlag {
+        DirtyPoints = 0x1, // outline or closed changed, both meshes are stale
+        DirtyColor  = 0x2,
+        DirtyStroke = 0x4,
+        DirtyBorder = 0x8,
+        DirtyAll    = 0xF,
+    };
+
+    // outcome of one slash, computed from a snapshot of the polygon on any thread
+    struct SlashResult {
+        int ret;
+        C2DPolygonSet lastPolySet;
+        int flyIdx;
+        int remainIdx;
+        QScopedPointer<C2DPolygon> poly;    // the remaining polygon when ret is 0 and not spliced
+        bool splice;                        // the remaining polygon only differs from the old in one run of lines
+        unsigned int spliceFirst;           // lines of the old polygon from spliceFirst up to spliceEnd
+        unsigned int spliceEnd;
+        std::vector<C2DPoint> spliceChain;  // become lines through these points
+        std::vector<unsigned int> spliceAttributes; // with these attributes, one more than the points
+        QPolygonF points;
+        std::vector<uint32_t> triangles;
+        qreal flyArea;
+    };
+    typedef QSharedPointer<SlashResult> SlashResultPtr;
+
+    static SlashResultPtr evalSlashPoly (const C2DPolygon & poly, qreal x1, qreal y1, qreal x2, qreal y2, const QVector<qreal> & balls);
+    int applySlashResult (SlashResult & result);
+    void spliceRemain (const SlashResult & result);
+    void resetRemain (const C2DPolygon & remain);
+    bool isTriangulationFilled (void) const;
+    void markDirty (int flags);
+    void resetOutline (const QPolygonF & outline, const std::vector<unsigned int> & attributes);
+    void processStroke (void);
+    void updateBackNode (void);
+    void updateForeNode (void);
+
     bool m_closed;
     qreal m_border;
-    qreal m_minX;
-    qreal m_maxX;
-    qreal m_minY;
-    qreal m_maxY;
     QColor m_color;
     QColor m_stroke;
     QPolygonF m_points;
-    QVector<QPointF> m_triangles;
-    QSGNode *              m_node;
+    std::vector<C2DPoint> m_triPoints;   // m_points as GeoLib points for the triangulator
+    std::vector<uint32_t> m_triangles;   // index buffer into m_points, 3 per triangle
+    CTriangulator          m_triangulator;
+    QVector<QPointF>       m_strokeTriangles; // cached stroke mesh, rebuilt on DirtyPoints / DirtyBorder
+    int                    m_dirty;
+    QSGNode *              m_node;            // retained, owned by the scene graph once returned
     QSGGeometryNode *      m_foreNode;
     QSGGeometryNode *      m_backNode;
-    QSGGeometry *          m_foreGeometry;
-    QSGGeometry *          m_backGeometry;
-    QSGFlatColorMaterial * m_foreMaterial;
-    QSGFlatColorMaterial * m_backMaterial;
 
     C2DPolygon *m_poly;
     C2DPolygonSet m_lastPolySet;
@@ -107,9 +177,13 @@ private:
     qreal m_totalArea;
     qreal m_flyArea;
     qreal m_progress;
+    quint64 m_polySerial; // bumped whenever m_poly is replaced, async slashes started before are dropped
+    int m_slashId;
     QPointF m_lineStart;
     C2DLine m_interLine;
-    QVector<QPoint> m_rigidPt;
+    QPointF m_dragLast;
+    int m_dragCrossings;
+    std::vector<unsigned int> m_dragEdges;
 };
 
 #endif // QMLPOLYGON_H
@@ -0,0 +1,122 @@
+#include <QtTest>
+
+#include "C2DLine.h"
+#include "C2DPointSet.h"
+#include "C2DPolygon.h"
+#include "C2DPolygonSet.h"
+#include "Triangulator.h"
+
+// GeoLib cases the game hits when slashing the level polygon
+class TestGeoLib : public QObject {
+    Q_OBJECT
+
+private slots:
+    void splitThroughVertex_data (void);
+    void splitThroughVertex (void);
+    void triangulateTouching_data (void);
+    void triangulateTouching (void);
+};
+
+static C2DPolygon makePolygon (const double * coords, int count)
+{
+    C2DPointSet pts;
+    for (int i = 0; i < count; ++i)
+        pts.AddCopy (C2DPoint (coords [i * 2], coords [i * 2 + 1]));
+    return C2DPolygon (pts);
+}
+
+void TestGeoLib::splitThroughVertex_data (void)
+{
+    QTest::addColumn<bool> ("notchUp");
+    QTest::addColumn<bool> ("lineRight");
+
+    QTest::newRow ("notch up, line to the right")   << true  << true;
+    QTest::newRow ("notch up, line to the left")    << true  << false;
+    QTest::newRow ("notch down, line to the right") << false << true;
+    QTest::newRow ("notch down, line to the left")  << false << false;
+}
+
+// the line passes through the tip of a notch whose two sides are on one side of it,
+// that side must come back as two pieces rather than one pinched at the tip
+void TestGeoLib::splitThroughVertex (void)
+{
+    QFETCH (bool, notchUp);
+    QFETCH (bool, lineRight);
+
+    const double up [] = {0,0, 10,0, 10,10, 5,3, 0,10};
+    const double down [] = {0,10, 10,10, 10,0, 5,7, 0,0};
+    const C2DPolygon poly = makePolygon (notchUp ? up : down, 5);
+    const double y = notchUp ? 3 : 7;
+    const C2DLine line = lineRight ? C2DLine (C2DPoint (-5,y),C2DPoint (20,y))
+                                   : C2DLine (C2DPoint (20,y),C2DPoint (-5,y));
+
+    C2DPolygonSet left;
+    C2DPolygonSet right;
+    QVERIFY (poly.SplitByLine (line,left,right));
+
+    // the lobes are on the far side of the line from the solid part
+    const bool lobesLeft = (notchUp == lineRight);
+    const C2DPolygonSet & lobes = lobesLeft ? left : right;
+    const C2DPolygonSet & solid = lobesLeft ? right : left;
+
+    QCOMPARE (int (lobes.size ()),2);
+    QCOMPARE (int (solid.size ()),1);
+    for (unsigned int i = 0; i < lobes.size (); ++i)
+    {
+        QVERIFY (!lobes [i].HasCrossingLines ());
+        QCOMPARE (lobes [i].GetArea (),17.5);
+    }
+    QVERIFY (!solid [0].HasCrossingLines ());
+    QCOMPARE (solid [0].GetArea (),30.0);
+}
+
+void TestGeoLib::triangulateTouching_data (void)
+{
+    QTest::addColumn<int> ("shape");
+
+    QTest::newRow ("cut piece as printed")       << 0;
+    QTest::newRow ("cut piece, touch in rounding") << 1;
+    QTest::newRow ("point on a line")             << 2;
+    QTest::newRow ("point met twice")             << 3;
+}
+
+// outlines pinched at a point, as the pieces of a cut through a point were, must give
+// triangles which fill them exactly rather than overlapping across the pinch
+void TestGeoLib::triangulateTouching (void)
+{
+    QFETCH (int, shape);
+
+    const double outlines [4][12] = {
+        {86,174, 94,154, 105,170, 114,164, 110.7,145.06, 88.56,156.9},
+        {86,174, 94,154, 105,170, 114,164, 110.7,145.06, 88.89314,156.733852},
+        {86,174, 94,154, 105,170, 114,164, 110.5,145.0625, 88.328125,157.072265625},
+        {0,0, 5,5, 10,0, 10,10, 5,5, 0,10}
+    };
+
+    C2DPoint points [6];
+    for (int i = 0; i < 6; ++i)
+        points [i] = C2DPoint (outlines [shape][i * 2], outlines [shape][i * 2 + 1]);
+
+    double area = 0;
+    for (int i = 0, j = 5; i < 6; j = i++)
+        area += (points [j].x - points [i].x) * (points [i].y + points [j].y);
+
+    CTriangulator triangulator;
+    std::vector<uint32_t> indices;
+    triangulator.Triangulate (points,6,0,0,indices);
+
+    double triangles = 0;
+    for (size_t i = 0; i + 2 < indices.size (); i += 3)
+    {
+        const C2DPoint & p = points [indices [i]];
+        const C2DPoint & q = points [indices [i + 1]];
+        const C2DPoint & r = points [indices [i + 2]];
+        triangles += fabs ((q.x - p.x) * (r.y - p.y) - (q.y - p.y) * (r.x - p.x));
+    }
+
+    QCOMPARE (triangles,fabs (area));
+}
+
+QTEST_APPLESS_MAIN (TestGeoLib)
+
+#include "tst_geolib.moc"
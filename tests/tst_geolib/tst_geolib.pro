@@ -0,0 +1,13 @@
+QT += testlib
+QT -= gui
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+TARGET = tst_geolib
+
+DEFINES += _STATIC
+INCLUDEPATH += ../../GeoLib
+
+SOURCES += tst_geolib.cpp \
+    $$files(../../GeoLib/*.cpp)